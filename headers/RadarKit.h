@@ -295,5 +295,6 @@
 #include <RadarKit/RKHealthRelayTweeta.h>
 #include <RadarKit/RKRadarRelay.h>
 #include <RadarKit/RKHostMonitor.h>
+#include <RadarKit/RKGridEngine.h>
 
 #endif /* defined(__RadarKit__) */
@@ -14,6 +14,9 @@
 #define __RadarKit_Client__
 
 #include <RadarKit/RKNetwork.h>
+#include <sys/uio.h>
+
+#define RKClientMaximumScatterCount   8
 
 //#ifdef __cplusplus
 //extern "C" {
@@ -68,6 +71,7 @@ struct rk_client {
     int                      (*init)(RKClient *);                // Connection initialization handler
     int                      (*recv)(RKClient *);                // Receive handler
     int                      (*exit)(RKClient *);                // Connection exit handler
+    int                      (*scatter)(RKClient *, struct iovec *, const int);   // Payload placement handler
 
     // Program set parameters
     char                     hostIP[32];                         // Host IP in numbers
@@ -87,6 +91,12 @@ struct rk_client {
     fd_set                   efd;                                // Error occurred
 
     RKNetDelimiter           netDelimiter;                       // A storage for latest delimiter
+    bool                     scattered;                          // The latest payload went to the scatter() iovecs, not userPayload
+
+    uint32_t                 datagramSequence;                   // Sequence number of the next datagram
+    uint64_t                 datagramCount;                      // Datagrams received
+    uint64_t                 datagramLostCount;                  // Datagrams that never arrived
+    uint64_t                 gapCount;                           // Breaks in the sequence, each one costs at least a packet
 };
 
 RKClient *RKClientInitWithDesc(RKClientDesc);
@@ -98,6 +108,7 @@ void RKClientSetUserResource(RKClient *, void *);
 void RKClientSetGreetHandler(RKClient *, int (*)(RKClient *));
 void RKClientSetReceiveHandler(RKClient *, int (*)(RKClient *));
 void RKClientSetCloseHandler(RKClient *, int (*)(RKClient *));
+void RKClientSetScatterHandler(RKClient *, int (*)(RKClient *, struct iovec *, const int));
 
 void RKClientStart(RKClient *, const bool waitForConnection);
 void RKClientStop(RKClient *);
@@ -11,8 +11,12 @@
 
 #include <RadarKit/RKRadar.h>
 
-#define RKCommandCenterMaxConnections 32
-#define RKCommandCenterMaxRadars       4
+#define RKCommandCenterMaxConnections  RKServerMaximumOperators                                    // Users are indexed by the instant identifier of the operator
+#define RKCommandCenterMaxRadars       8
+#define RKCommandCenterRayPacketCount  64                                                          // Must be more than RKServerMaximumWorkers, a packet is only held through one send
+#define RKRayPacketCompressionCount    (RKNetworkCompressionDeflate + 1)                            // Compressed forms of a ray packet, by RKNetworkCompression
+#define RKCommandCenterReplayRayCount  64                                                          // Rays of a replay sent per visit of the stream handler
+#define RKCommandCenterVolumeRayCount  64                                                          // Rays of a volume sent per visit of the stream handler
 
 typedef struct rk_user {
     char                             login[64];
@@ -31,11 +35,14 @@ typedef struct rk_user {
     uint32_t                         rayStatusIndex;                                               // The index to RKMomentEngine->raySatusBuffer
     uint32_t                         pulseIndex;                                                   // The index to the latest pulse
     uint32_t                         rayIndex;                                                     // The index to the latest ray
+    uint32_t                         rayIndices[RKCommandCenterMaxRadars];                         // The index to the latest ray of each radar for the combined streams
     uint32_t                         pingCount;                                                    // Counter of ping
     uint32_t                         commandCount;                                                 // Counter of command
     uint32_t                         controlFirstUID;                                              // UUID of the first control
     uint32_t                         scratchSpaceIndex;                                            // The index to the scratch space to use
     uint32_t                         transmitWaveIndex;                                            // The index to the filter of the pulse (for AScope use)
+    RKIdentifier                     volumeId;                                                     // Identifier of the last volume sent
+    RKIdentifier                     resumeIdentifier;                                             // Identifier of the last ray the user has, 0 for none
     RKTextPreferences                textPreferences;                                              // Text preference for terminal output
     struct winsize                   terminalSize;                                                 // Terminal window size of the user
     uint16_t                         pulseDownSamplingRatio;                                       // Additional down-sampling ratio for pulse live stream
@@ -43,17 +50,47 @@ typedef struct rk_user {
     uint16_t                         asciiArtStride;                                               // Gate stride for ASCII art
     uint16_t                         ascopeMode;                                                   // The ASCope mode: 1-4
     pthread_mutex_t                  mutex;                                                        //
-    char                             string[RKMaximumPacketSize];                                  // A local storage to buffer a packet
-    char                             scratch[RKMaximumPacketSize];                                 // A local storage as scratch space
-    char                             commandResponse[RKMaximumPacketSize];                         // A local storage as feedback
-    RKInt16C                         samples[2][RKMaximumGateCount];                               // A local storage for raw I/Q for AScope
+    char                             *string;                                                      // A local storage to buffer a packet, allocated on the first subscription
+    char                             *scratch;                                                     // A local storage as scratch space, allocated on the first subscription
+    char                             *commandResponse;                                             // A local storage as feedback, allocated when connected
+    RKInt16C                         *samples[2];                                                  // A local storage for raw I/Q for AScope, allocated on the first subscription
     RKOperator                       *serverOperator;                                              // The reference to the socket server operator
     RKRadar                          *radar;                                                       // The reference to the radar object
+    bool                             combined;                                                     // Product / display rays of all the radars
+    bool                             replaying;                                                    // Rays after the resume identifier are being sent
     uint8_t                          productCount;                                                 // Product count from PyRadarKit
     RKProductId                      productIds[RKMaximumProductCount];                            // Product identifiers for active algorithms of PyRadarKit
     RKProductDesc                    productDescriptions[RKMaximumProductCount];                   // Product descriptions for active algorithms of PyRadarKit
+    RKSweep                          *productSweep;                                                // Sweep of the user products that are coming back, held until they are all in
+    RKProduct                        *productInTransit;                                            // Product of which the data is coming next, NULL to discard the data
+    uint32_t                         productPayloadIndex;                                          // Payloads of the user products received, a header and the data of each
+    struct timeval                   productTimevalOrigin;                                         // Time when the sweep of the user products started going out
+    struct timeval                   productTimevalTx;                                             // Time when the sweep of the user products was sent
+    RKVolume                         *volume;                                                      // Volume that is going out, held until it is all sent
+    uint32_t                         volumeSweepIndex;                                             // The index to the sweep of the volume to send next
+    uint32_t                         volumeRayIndex;                                               // The index to the ray of that sweep to send next
+    size_t                           volumeSize;                                                   // Bytes of the volume sent so far
+    struct timeval                   volumeTimevalOrigin;                                          // Time when the volume started going out
 } RKUser;
 
+// A ray encoded for the product or display streams, shared by all the users of the same streams
+typedef struct rk_ray_packet {
+    RKRay                            *ray;                                                         // The ray in the ray buffer
+    RKIdentifier                     i;                                                            // Identifier of the ray when it was encoded
+    uint32_t                         baseMomentList;                                               // Products or displays in the packet
+    uint16_t                         downSamplingRatio;                                            // Gate down-sampling ratio
+    uint16_t                         refCount;                                                     // Users that are sending this packet
+    uint64_t                         tic;                                                          // Last use for the replacement policy
+    uint32_t                         size;                                                         // Delimiter, ray header and data in bytes
+    uint32_t                         capacity;                                                     // Allocated size of the buffer
+    void                             *buffer;                                                      // RKNetDelimiter, RKRayHeader and data
+    pthread_mutex_t                  lock;                                                         // Guards the compressed forms
+    bool                             compressed[RKRayPacketCompressionCount];                      // Compressed form at this level is current
+    uint32_t                         compressedSize[RKRayPacketCompressionCount];                  // Size of the compressed form, 0 if incompressible
+    uint32_t                         compressedCapacity[RKRayPacketCompressionCount];              // Allocated size of the compressed buffer
+    void                             *compressedBuffer[RKRayPacketCompressionCount];               // Deflated payload, followed by the shuffle scratch
+} RKRayPacket;
+
 typedef struct rk_command_center {
     // User set variables
     RKName                           name;
@@ -67,6 +104,20 @@ typedef struct rk_command_center {
     int                              radarCount;
     RKUser                           users[RKCommandCenterMaxConnections];
     pthread_mutex_t                  mutex;
+    RKRayPacket                      rayPackets[RKCommandCenterRayPacketCount];
+    pthread_mutex_t                  rayPacketMutex;
+    uint64_t                         rayPacketTic;
+    uint64_t                         rayPacketHitCount;
+    uint64_t                         rayPacketMissCount;
+    RKName                           multicastGroup;                                               // Multicast group of the display rays, empty to disable
+    int                              multicastPort;
+    uint32_t                         multicastMomentList;                                          // Display moments in the multicast
+    int                              multicastSocket;
+    struct sockaddr_in               multicastAddress;
+    bool                             multicastActive;
+    pthread_t                        tidMulticast;
+    uint32_t                         multicastSequence;                                            // Sequence number of the next datagram
+    uint64_t                         multicastRayCount;
     
     // Status / health
     size_t                           memoryUsage;
@@ -79,6 +130,7 @@ void RKCommandCenterSetVerbose(RKCommandCenter *, const int);
 void RKCommandCenterSetPort(RKCommandCenter *, const int);
 void RKCommandCenterAddRadar(RKCommandCenter *, RKRadar *);
 void RKCommandCenterRemoveRadar(RKCommandCenter *, RKRadar *);
+void RKCommandCenterSetMulticast(RKCommandCenter *, const char *group, const int port, const uint32_t baseMomentList);
 
 void RKCommandCenterStart(RKCommandCenter *);
 void RKCommandCenterStop(RKCommandCenter *);
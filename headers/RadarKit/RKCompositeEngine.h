@@ -0,0 +1,97 @@
+//
+//  RKCompositeEngine.h
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#ifndef __RadarKit_CompositeEngine__
+#define __RadarKit_CompositeEngine__
+
+#include <RadarKit/RKFoundation.h>
+#include <RadarKit/RKSIMD.h>
+#include <RadarKit/RKSweepEngine.h>
+#include <RadarKit/RKProduct.h>
+
+#define RKCompositeEngineAzimuthBinCount           360
+#define RKCompositeEngineDefaultEchoTopThreshold   18.0f                       // dBZ
+#define RKCompositeEngineHailCap                   56.0f                       // dBZ, cap of the liquid water content
+#define RKCompositeEngineProductCount              3
+
+typedef uint8_t RKCompositeProductList;
+enum RKCompositeProductList {
+    RKCompositeProductListNone                     = 0,
+    RKCompositeProductListCR                       = 1,                        // Composite reflectivity (dBZ)
+    RKCompositeProductListVIL                      = (1 << 1),                 // Vertically integrated liquid (kg / m^2)
+    RKCompositeProductListET                       = (1 << 2),                 // Echo top (km above the radar)
+    RKCompositeProductListAll                      = 0x07
+};
+
+typedef struct rk_composite_engine RKCompositeEngine;
+
+struct rk_composite_engine {
+    // User set variables
+    RKName                           name;
+    RKRadarDesc                      *radarDescription;
+    RKConfig                         *configBuffer;
+    uint32_t                         *configIndex;
+    RKBuffer                         rayBuffer;
+    uint32_t                         *rayIndex;
+    RKSweepEngine                    *sweepEngine;
+    uint8_t                          verbose;
+    RKCompositeProductList           productList;
+    float                            echoTopThreshold;
+
+    // Program set variables
+    pthread_t                        tidRayWatcher;
+    RKProductId                      productIds[RKCompositeEngineProductCount];
+    uint32_t                         capacity;                                 // Gates of an azimuth bin, same as the rays
+    uint32_t                         gateCount;                                // Ground-range cells that have been accumulated
+    float                            gateSizeMeters;
+    float                            sweepElevation;                           // Sweep elevation of the last ray
+    uint8_t                          scratchSpaceIndex;                        // Scratch space of the next sweep to publish
+    RKIdentifier                     rayId;                                    // Identifier of the last accumulated ray
+    RKFloat                          *range;                                   // Slant range of each gate (km)
+    RKFloat                          *height;                                  // Beam height of each gate of a ray (km)
+    RKFloat                          *liquid;                                  // Liquid water content of each gate of a ray
+    float                            mapElevation;                             // Elevation of the gate to ground-range cell map
+    int32_t                          *gateCell;                                // Ground-range cell of each gate
+    int32_t                          *cellGate;                                // First gate of each ground-range cell
+    int32_t                          *extraGate;                               // Other gates that fall in a cell already taken
+    int32_t                          *extraCell;                               // Ground-range cell of each of the other gates
+    uint32_t                         cellCount;                                // Ground-range cells of all the gates
+    uint32_t                         extraCount;                               // Other gates of all the gates
+    RKFloat                          *cellZ;                                   // Reflectivity of the first gate of each cell
+    RKFloat                          *cellHeight;                              // Height of the first gate of each cell
+    RKFloat                          *cellLiquid;                              // Liquid water content of the first gate of each cell
+    RKFloat                          *maxZ;                                    // Composite reflectivity, one row per azimuth bin
+    RKFloat                          *echoTop;                                 // Echo top
+    RKFloat                          *vil;                                     // Vertically integrated liquid
+    RKFloat                          *liquidBelow;                             // Liquid water content of the sample below
+    RKFloat                          *heightBelow;                             // Height of the sample below, NAN if none
+
+    // Status / health
+    uint32_t                         volumeCount;
+    uint32_t                         sweepCount;
+    RKEngineState                    state;
+    uint64_t                         tic;
+    float                            lag;
+    size_t                           memoryUsage;
+};
+
+RKCompositeEngine *RKCompositeEngineInit(void);
+void RKCompositeEngineFree(RKCompositeEngine *);
+
+void RKCompositeEngineSetVerbose(RKCompositeEngine *, const int);
+void RKCompositeEngineSetInputOutputBuffers(RKCompositeEngine *, RKRadarDesc *,
+                                            RKConfig *configBuffer, uint32_t *configIndex,
+                                            RKBuffer rayBuffer,     uint32_t *rayIndex,
+                                            RKSweepEngine *sweepEngine);
+void RKCompositeEngineSetProductList(RKCompositeEngine *, const RKCompositeProductList);
+void RKCompositeEngineSetEchoTopThreshold(RKCompositeEngine *, const float);
+
+int RKCompositeEngineStart(RKCompositeEngine *);
+int RKCompositeEngineStop(RKCompositeEngine *);
+
+#endif
@@ -122,6 +122,10 @@ RKInt16C *RKGetInt16CDataFromPulse(RKPulse *, const uint32_t channelIndex);
 RKComplex *RKGetComplexDataFromPulse(RKPulse *, const uint32_t channelIndex);
 RKIQZ RKGetSplitComplexDataFromPulse(RKPulse *, const uint32_t channelIndex);
 int RKClearPulseBuffer(RKBuffer, const uint32_t pulseCount);
+size_t RKRawDataSampleSize(const RKRawDataType);
+uint32_t RKRawDataGateCount(const RKPulseHeader *, const RKRawDataType);
+void RKRawDataEncodeSamples(void *dst, float *scale, const RKComplex *src, const uint32_t gateCount, const RKRawDataType);
+void RKRawDataDecodeSamples(RKComplex *dst, const void *src, const float scale, const uint32_t gateCount, const RKRawDataType);
 int RKReadPulseFromFileReference(RKPulse *pulse, RKRawDataType type, FILE *fid);
 
 // Ray
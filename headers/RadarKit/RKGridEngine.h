@@ -0,0 +1,96 @@
+//
+//  RKGridEngine.h
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#ifndef __RadarKit_GridEngine__
+#define __RadarKit_GridEngine__
+
+#include <RadarKit/RKFoundation.h>
+#include <RadarKit/RKSIMD.h>
+
+#define RKGridEngineTableSlotCount           4
+#define RKGridEngineDefaultWorkerCount       4
+#define RKGridEngineMaximumWorkerCount       16
+
+typedef uint8_t RKGridJobType;
+enum RKGridJobType {
+    RKGridJobTypeNull,
+    RKGridJobTypeBuildTable,
+    RKGridJobTypeGridSweep
+};
+
+// Range-azimuth to grid-cell weights of one sweep geometry. Cell k blends gates gate[k] and gate[k] + 1 of the rays
+// in azimuth bins bin[k] and bin[k] + 1, where a bin is 360 / rayCount degrees wide.
+typedef struct rk_grid_table {
+    float                            gateSizeMeters;
+    uint32_t                         gateCount;
+    uint32_t                         rayCount;
+    uint64_t                         tic;                                      // Last use, for the least recently used eviction
+    int32_t                          *gate;                                    // Near gate, -1 if outside of the range
+    int32_t                          *bin;                                     // Near azimuth bin
+    RKFloat                          *gateWeight;                              // Weight of the far gate
+    RKFloat                          *binWeight;                               // Weight of the far azimuth bin
+} RKGridTable;
+
+typedef struct rk_grid_engine RKGridEngine;
+
+typedef struct rk_grid_worker {
+    int                              id;
+    pthread_t                        tid;
+    RKGridEngine                     *parent;
+} RKGridWorker;
+
+struct rk_grid_engine {
+    // User set variables
+    RKName                           name;
+    uint8_t                          verbose;
+    uint8_t                          workerCount;
+    uint32_t                         width;                                    // Cells from west to east
+    uint32_t                         height;                                   // Cells from north to south
+    float                            cellSizeMeters;                           // The radar is at the center of the grid
+
+    // Program set variables
+    uint32_t                         cellCount;
+    RKGridTable                      tables[RKGridEngineTableSlotCount];
+    RKGridWorker                     workers[RKGridEngineMaximumWorkerCount];
+    pthread_mutex_t                  mutex;                                    // Only one sweep is gridded at a time
+    pthread_mutex_t                  jobMutex;
+    pthread_cond_t                   jobPosted;
+    pthread_cond_t                   jobDone;
+    uint32_t                         jobId;
+    uint32_t                         jobRemaining;                             // Workers yet to finish the job
+    RKGridJobType                    jobType;
+    RKGridTable                      *jobTable;
+    const RKSweep                    *jobSweep;
+    RKBaseMomentList                 jobMomentList;                            // Moments of the last gridded sweep
+    uint32_t                         baseRayIndex;                             // Ray at the lowest address, the origin of gathers
+    int32_t                          *binOffsets;                              // Ray data offset of each azimuth bin, -1 if no ray
+    int32_t                          *nearIndices;                             // Gather indices of each cell, near azimuth bin
+    int32_t                          *farIndices;                              // Gather indices of each cell, far azimuth bin
+    uint8_t                          *coverage;                                // Cells that are covered by the sweep
+    RKFloat                          *data[RKBaseMomentCount];                 // The gridded moments, NULL until gridded
+
+    // Status / health
+    RKEngineState                    state;
+    uint64_t                         tic;
+    size_t                           memoryUsage;
+};
+
+RKGridEngine *RKGridEngineInit(void);
+void RKGridEngineFree(RKGridEngine *);
+
+void RKGridEngineSetVerbose(RKGridEngine *, const int);
+void RKGridEngineSetWorkerCount(RKGridEngine *, const uint8_t);
+int RKGridEngineSetGrid(RKGridEngine *, const uint32_t width, const uint32_t height, const float cellSizeMeters);
+
+int RKGridEngineStart(RKGridEngine *);
+int RKGridEngineStop(RKGridEngine *);
+
+int RKGridEngineGridSweep(RKGridEngine *, const RKSweep *);
+RKFloat *RKGridEngineGetData(RKGridEngine *, const RKBaseMomentIndex);
+
+#endif
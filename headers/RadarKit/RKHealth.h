@@ -13,6 +13,49 @@
 #include <RadarKit/RKFileManager.h>
 #include <RadarKit/RKClient.h>
 
+#define RKHealthStoreCapacity            512                               // Distinct keys
+#define RKHealthStoreHashSize            1024                              // Slots of the key table, a power of 2
+#define RKHealthStoreEnumCount           8                                 // RKStatusEnumOld to RKStatusEnumCritical
+#define RKHealthRecordValueLength        256
+#define RKHealthKeyInvalid               ((RKHealthKey)-1)
+
+typedef uint16_t RKHealthKey;
+
+typedef uint8_t RKHealthValueType;
+enum RKHealthValueType {
+    RKHealthValueTypeNull,                                                 // Not in the latest health of the node
+    RKHealthValueTypeBool,
+    RKHealthValueTypeNumber,
+    RKHealthValueTypeString,
+    RKHealthValueTypeArray,
+    RKHealthValueTypeObject
+};
+
+typedef uint8_t RKHealthKeyRole;
+enum RKHealthKeyRole {
+    RKHealthKeyRoleNone,
+    RKHealthKeyRoleHeading,
+    RKHealthKeyRoleLatitude,
+    RKHealthKeyRoleLongitude,
+    RKHealthKeyRoleCount
+};
+
+//
+// A key and its latest value, e.g., "FPGA Temp":{"Value":"69.3degC","Enum":0} is kept as a String 69.3 with
+// an enum 0, and the JSON text of the value so that it can be sent as reported
+//
+typedef struct rk_health_record {
+    RKName                           name;                                     // Interned key
+    RKHealthNode                     node;                                     // The node that reported it last
+    RKHealthValueType                type;                                     // Type of the value, or the "Value" of an object
+    RKHealthKeyRole                  role;
+    bool                             hasEnum;
+    RKStatusEnum                     statusEnum;
+    uint32_t                         revision;                                 // Revision of the node when reported
+    double                           number;                                   // Value as a number, e.g., 69.3 of "69.3degC"
+    char                             text[RKHealthRecordValueLength];          // Value in JSON
+} RKHealthRecord;
+
 typedef struct rk_health_engine RKHealthEngine;
 
 struct rk_health_engine {
@@ -27,6 +70,17 @@ struct rk_health_engine {
     // Program set variables
     FILE                             *fid;
     pthread_t                        tidHealthConsolidator;
+    pthread_mutex_t                  mutex;                                    // Guards the records
+    RKHealthRecord                   *records;                                 // Indexed by RKHealthKey
+    uint16_t                         recordCount;
+    RKHealthKey                      keyTable[RKHealthStoreHashSize];          // Open addressing hash of the names
+    RKHealthKey                      roleKeys[RKHealthKeyRoleCount];           // The latest key of each role
+    uint32_t                         nodeRevisions[RKHealthNodeCount];
+    RKIdentifier                     nodeIdentifiers[RKHealthNodeCount];       // Identifier of the latest health ingested
+    uint16_t                         enumCounts[RKHealthNodeCount][RKHealthStoreEnumCount];
+    bool                             headingOverride;                          // Heading is from the descriptor, decided by the consolidator
+    bool                             locationOverride;                         // Location is from the descriptor, decided by the consolidator
+    char                             *scratch;                                 // Key and value space to parse the JSON
 
     // Status / health
     char                             statusBuffer[RKBufferSSlotCount][RKMaximumStringLength];
@@ -49,4 +103,13 @@ int RKHealthEngineStop(RKHealthEngine *);
 
 char *RKHealthEngineStatusString(RKHealthEngine *);
 
+RKHealthKey RKHealthEngineInternKey(RKHealthEngine *, const char *name);
+RKHealthKey RKHealthEngineFindKey(RKHealthEngine *, const char *name);
+int RKHealthEngineIngest(RKHealthEngine *, const RKHealthNode, const char *string);
+bool RKHealthEngineGetRecord(RKHealthEngine *, const RKHealthKey, RKHealthRecord *);
+RKStatusEnum RKHealthEngineGetEnum(RKHealthEngine *, const RKHealthKey);
+bool RKHealthEngineFindCondition(RKHealthEngine *, const RKHealthNode, const RKStatusEnum, char *firstKey, char *firstValue);
+size_t RKHealthEngineJSONString(RKHealthEngine *, char *string, const size_t capacity);
+char *RKHealthEngineHealthString(RKHealthEngine *, RKHealth *);
+
 #endif /* __RadarKit_Health__ */
@@ -11,6 +11,7 @@
 
 #include <RadarKit/RKFoundation.h>
 #include <RadarKit/RKFileManager.h>
+#include <RadarKit/RKHealth.h>
 
 typedef struct rk_health_logger RKHealthLogger;
 
@@ -25,6 +26,7 @@ struct rk_health_logger {
     bool                             record;
     RKHealthRelay                    healthRelay;
     RKFileManager                    *fileManager;
+    RKHealthEngine                   *healthEngine;                            // The engine that produces the strings, NULL if they are filled in
 
     // Program set variables
     FILE                             *fid;
@@ -44,6 +46,7 @@ void RKHealthLoggerFree(RKHealthLogger *);
 void RKHealthLoggerSetVerbose(RKHealthLogger *, const int);
 void RKHealthLoggerSetInputOutputBuffers(RKHealthLogger *, RKRadarDesc *, RKFileManager *,
                                          RKHealth *healthBuffer, uint32_t *healthIndex);
+void RKHealthLoggerSetHealthEngine(RKHealthLogger *, RKHealthEngine *);
 void RKHealthLoggerSetRecord(RKHealthLogger *, const bool);
 
 int RKHealthLoggerStart(RKHealthLogger *);
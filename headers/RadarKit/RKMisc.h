@@ -145,6 +145,11 @@ char *RKLastTwoPartsOfPath(const char *);
 char *RKLastNPartsOfPath(const char *, const int n);
 char *RKPathStringByExpandingTilde(const char *);
 void RKReplaceFileExtension(char *filename, const char *pattern, const char *replacement);
+bool RKFilePreallocate(const int fd, const size_t size);
+void RKFileReleasePreallocation(const int fd, const size_t size, const size_t reserved);
+size_t RKFileWriteBehind(const int fd, size_t *waited, const size_t synced, const size_t written, const size_t window);
+void RKFileDropCache(const int fd);
+void RKFileDropCacheOfFilename(const char *);
 
 char *RKSignalString(const int);
 
@@ -16,7 +16,8 @@
 #include <RadarKit/RKSpectralMoment.h>
 #include <RadarKit/RKCalibrator.h>
 
-#define RKMomentDFTPlanCount    16
+#define RKMomentDFTPlanCount             16
+#define RKMomentEngineRayPinTimeoutMs    100
 
 typedef struct rk_moment_worker RKMomentWorker;
 typedef struct rk_moment_engine RKMomentEngine;
@@ -53,6 +54,8 @@ struct rk_moment_engine {
     bool                             useSemaphore;
     int                              (*processor)(RKScratch *, RKPulse **, const uint16_t);
     void                             (*calibrator)(RKScratch *, RKConfig *);
+    void                             *rayHolder;                               // Owner of the references to the rays in place, if any
+    void                             (*rayEvictor)(void *, RKRay *);           // Makes the holder let go of a ray that is about to be reused
 
     // Program set variables
     RKModuloPath                     *momentSource;
@@ -87,6 +90,7 @@ void RKMomentEngineSetInputOutputBuffers(RKMomentEngine *, const RKRadarDesc *,
 void RKMomentEngineSetFFTModule(RKMomentEngine *, RKFFTModule *);
 void RKMomentEngineSetCoreCount(RKMomentEngine *, const uint8_t);
 void RKMomentEngineSetCoreOrigin(RKMomentEngine *, const uint8_t);
+void RKMomentEngineSetRayEvictor(RKMomentEngine *, void *, void (*)(void *, RKRay *));
 
 int RKMomentEngineStart(RKMomentEngine *);
 int RKMomentEngineStop(RKMomentEngine *);
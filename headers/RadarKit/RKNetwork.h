@@ -25,16 +25,19 @@
 typedef int RKNetworkSocketType;
 typedef int RKNetworkMessageFormat;
 typedef uint32_t RKNetworkPacketType;
+typedef uint8_t RKNetworkCompression;
 
 enum RKNetworkSocketType {
     RKNetworkSocketTypeTCP = 1,
-    RKNetworkSocketTypeUDP
+    RKNetworkSocketTypeUDP,
+    RKNetworkSocketTypeMulticast                           // Receive sequenced datagrams, the hostname is the group
 };
 
 enum RKNetworkMessageFormat {
     RKNetworkMessageFormatNewLine,                         // Line-by-line reading
     RKNetworkMessageFormatConstantSize,                    // Fixed length packets
-    RKNetworkMessageFormatHeaderDefinedSize                // The header is of type RKNetDelimiter
+    RKNetworkMessageFormatHeaderDefinedSize,               // The header is of type RKNetDelimiter
+    RKNetworkMessageFormatSequencedDatagram                // RKNetDelimiter packets in datagrams that lead with RKNetDatagramHeader
 };
 
 enum RKNetworkPacketType {
@@ -53,9 +56,25 @@ enum RKNetworkPacketType {
     RKNetworkPacketTypeConfig,
 	RKNetworkPacketTypeSweep,
     RKNetworkPacketTypeSweepHeader,
-    RKNetworkPacketTypeSweepRay
+    RKNetworkPacketTypeSweepRay,
+    RKNetworkPacketTypeVolumeHeader                        // Followed by the sweep header and rays of every sweep
 };
 
+enum RKNetworkCompression {
+    RKNetworkCompressionNone,
+    RKNetworkCompressionFast,                              // Byte shuffle, then deflate at the fastest level
+    RKNetworkCompressionDeflate                            // Byte shuffle, then deflate at the default level
+};
+
+// Sub-type bits of a compressed packet, size is what is on the wire and decodedSize is the original payload
+#define RKNetDelimiterSubtypeDeflated         0x8000       // Payload is deflated
+#define RKNetDelimiterSubtypeShuffleMask      0x000F       // Element size of the byte shuffle before deflate
+#define RKNetworkCompressionThreshold         1024         // Smaller payloads are always sent as they are
+
+#define RKNetworkMulticastDefaultGroup        "239.255.77.1"
+#define RKNetworkMulticastDefaultPort         10001
+#define RKNetworkMulticastDatagramSize        1400         // Keep every datagram within a typical MTU
+
 #pragma pack(push, 1)
 
 typedef union rk_net_delimiter {
@@ -64,10 +83,24 @@ typedef union rk_net_delimiter {
         uint16_t     subtype;                              // Sub-type
         uint32_t     size;                                 // Raw size in bytes to read / skip ahead
         uint32_t     decodedSize;                          // Decided size if this is a compressed block
+        uint16_t     source;                               // Index of the radar in a command center of several radars
     };
     RKByte bytes[16];                                      // Make this struct always fixed bytes
 } RKNetDelimiter;
 
+// Leads every datagram of a multicast stream, a packet (RKNetDelimiter and payload) spans one or more datagrams
+typedef union rk_net_datagram_header {
+    struct {
+        uint32_t     sequence;                             // Consecutive for every datagram of a sender, a gap is a loss
+        uint32_t     packetSize;                           // Size of the whole packet, RKNetDelimiter included
+        uint32_t     offset;                               // Offset of this fragment in the packet
+        uint32_t     size;                                 // Size of this fragment
+    };
+    RKByte bytes[16];
+} RKNetDatagramHeader;
+
+#define RKNetworkMulticastFragmentSize        (RKNetworkMulticastDatagramSize - sizeof(RKNetDatagramHeader))
+
 #pragma pack(pop)
 
 ssize_t RKNetworkSendPackets(int, ...);
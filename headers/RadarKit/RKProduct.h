@@ -15,6 +15,9 @@ size_t RKProductBufferAlloc(RKProduct **, const uint32_t depth, const uint32_t r
 void RKProductBufferFree(RKProduct *buffer, const int depth);
 
 int RKProductInitFromSweep(RKProduct *, const RKSweep *);
+int RKProductInitViewFromSweep(RKProduct *, const RKSweep *);
+int RKProductDetachView(RKProduct *);
+RKFloat *RKProductGetRayData(const RKProduct *, const uint32_t);
 void RKProductFree(RKProduct *);
 
 #endif
@@ -12,10 +12,14 @@
 #include <RadarKit/RKFoundation.h>
 #include <RadarKit/RKProduct.h>
 #include <netcdf.h>
+#include <netcdf_mem.h>
 
 #define W2_MISSING_DATA       -99900.0
 #define W2_RANGE_FOLDED       -99901.0
 
+#define RKProductFilePackedFillInt16   -32768
+#define RKProductFilePackedFillUInt8   255
+
 #if defined (COMPRESSED_NETCDF)
 #define NC_MODE  NC_NETCDF4
 #else
@@ -25,9 +29,19 @@
 void RKProductDimensionsFromFile(const char *, uint32_t *rayCount, uint32_t *gateCount);
 
 int RKProductFileWriterNC(RKProduct *, const char *);
+int RKProductFileWriterNCInt16(RKProduct *, const char *);
+int RKProductFileWriterNCUInt8(RKProduct *, const char *);
+int RKProductFileGetVariable(const int ncid, const int variableId, RKFloat *, const size_t count);
+int RKProductFileGetVariableRange(const int ncid, const int variableId, RKFloat *, const size_t *start, const size_t *count);
+int RKProductFilePutVariable(const int ncid, const int variableId, const RKProduct *);
+void RKProductFilePutGlobalAttributes(const int ncid, const RKProduct *, const char *moments);
 RKProduct *RKProductFileReaderNC(const char *, const bool);
 void RKProductReadFileIntoBuffer(RKProduct *buffer, const char *, const bool);
 
+// NetCDF is not thread safe, other modules that call the library directly serialize through these
+void RKProductFileLock(void);
+void RKProductFileUnlock(void);
+
 RKProductCollection *RKProductCollectionInitWithFilename(const char *);
 void RKProductCollectionFree(RKProductCollection *);
 
@@ -23,6 +23,7 @@
 #include <RadarKit/RKHealthLogger.h>
 #include <RadarKit/RKRawDataRecorder.h>
 #include <RadarKit/RKSweepEngine.h>
+#include <RadarKit/RKCompositeEngine.h>
 #include <RadarKit/RKProduct.h>
 #include <RadarKit/RKWaveform.h>
 #include <RadarKit/RKPreference.h>
@@ -124,6 +125,8 @@ struct rk_radar {
     RKRawDataRecorder                *rawDataRecorder;
     RKHealthLogger                   *healthLogger;
     RKSweepEngine                    *sweepEngine;
+    RKVolumeEngine                   *volumeEngine;
+    RKCompositeEngine                *compositeEngine;
     RKFileManager                    *fileManager;
     RKRadarRelay                     *radarRelay;
     RKHostMonitor                    *hostMonitor;
@@ -230,6 +233,7 @@ int RKSetVerbosityUsingArray(RKRadar *, const uint8_t *);
 int RKSetDataPath(RKRadar *, const char *);
 int RKSetDataUsageLimit(RKRadar *, const size_t limit);
 int RKSetRecordingLevel(RKRadar *, const int);
+int RKSetRawDataFormat(RKRadar *, const RKRawDataFormat);
 
 // Some operating parameters
 int RKSetWaveform(RKRadar *, RKWaveform *);
@@ -257,6 +261,14 @@ int RKSetMomentProcessorToSpectralMoment(RKRadar *);
 
 // Moment recorder (RadarKit uses netcdf by default)
 int RKSetProductRecorder(RKRadar *radar, int (*productRecorder)(RKProduct *, const char *));
+// All products of a sweep in one file, e.g., RKSweepFileWriterNC(), NULL for a file per product
+int RKSetSweepRecorder(RKRadar *radar, int (*sweepRecorder)(RKProduct **, const uint32_t, const char *));
+// Write the sweep file ray by ray as the rays arrive, only with a sweep recorder
+int RKSetSweepStreaming(RKRadar *radar, const bool);
+// Volumes kept in memory and the limit of their size, a depth of 0 (default) disables the volume cache
+int RKSetVolumeCache(RKRadar *radar, const uint8_t depth, const size_t memoryLimit);
+// Composite products of the volume so far, e.g., RKCompositeProductListCR | RKCompositeProductListET, set before going live
+int RKSetCompositeProducts(RKRadar *radar, const RKCompositeProductList);
 
 // Pulse ring filter (FIR / IIR ground clutter filter)
 int RKSetPulseRingFilterByType(RKRadar *, RKFilterType, const uint32_t);
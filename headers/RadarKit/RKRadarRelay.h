@@ -37,6 +37,7 @@ typedef struct rk_radar_relay {
     uint32_t                         *rayIndex;
     uint8_t                          verbose;
     RKFileManager                    *fileManager;
+    RKNetworkCompression             compression;                        // Compression to ask of the upstream
 
     // Program set variables
     RKClient                         *client;
@@ -46,6 +47,16 @@ typedef struct rk_radar_relay {
     pthread_t                        tidBackground;
     RKStream                         streams;
 
+    // For handling pulses that are read straight into the pulse buffer
+    RKPulseHeader                    pulseHeaderCache;
+    uint32_t                         pulseGateCount;                     // Gates of the scattered pulse that are kept
+    uint64_t                         pulseScatterCount;                  // Pulses that were read straight into the buffer
+
+    // For resuming the ray streams after a reconnect
+    RKIdentifier                     rayIdentifier;                      // Identifier of the latest ray, 0 for none
+    uint64_t                         rayGapCount;                        // Discontinuities of the ray identifiers
+    uint64_t                         rayLostCount;                       // Rays missed in the discontinuities
+
     // For handling sweeps
     RKSweepHeader                    sweepHeaderCache;
 	uint32_t                         sweepPacketCount;
@@ -74,6 +85,7 @@ void RKRadarRelaySetInputOutputBuffers(RKRadarRelay *, const RKRadarDesc *, RKFi
                                        RKBuffer pulseBuffer,   uint32_t *pulseIndex,
                                        RKBuffer rayBuffer,     uint32_t *rayIndex);
 void RKRadarRelaySetHost(RKRadarRelay *, const char *hostname);
+void RKRadarRelaySetCompression(RKRadarRelay *, const RKNetworkCompression);
 
 int RKRadarRelayStart(RKRadarRelay *);
 int RKRadarRelayStop(RKRadarRelay *);
@@ -0,0 +1,71 @@
+//
+//  RKRawDataFile.h
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#ifndef __RadarKit_RawDataFile__
+#define __RadarKit_RawDataFile__
+
+#include <RadarKit/RKFoundation.h>
+
+#define RKRawDataBlockIndexTag          "RKBI"
+#define RKRawDataPulseIndexTag          "RKPI"
+#define RKRawDataReaderReadAheadSize    (32 * 1024 * 1024)
+#define RKRawDataReaderReleaseSize      (64 * 1024 * 1024)
+
+typedef struct rk_raw_data_reader RKRawDataReader;
+
+// A pulse as it is in the file, samples are as recorded for the raw data type, see RKRawDataSampleSize()
+typedef struct rk_raw_data_pulse_view {
+    RKPulseHeader                    header;                         // A copy, headers in the file are not aligned
+    const void                       *data[2];                       // H and V samples, in place
+    float                            scale[2];                       // H and V scales of RKRawDataTypeAfterMatchedFilterInt16, 1 otherwise
+    uint32_t                         gateCount;
+} RKRawDataPulseView;
+
+struct rk_raw_data_reader {
+    FILE                             *fid;
+    RKRawDataType                    dataType;
+    RKRawDataFormat                  format;
+    long                             dataEndOffset;                  // Offset where the pulses end, 0 = end of file
+    size_t                           offset;                         // Offset of the next read
+    RKByte                           *map;                           // The file mapped read-only, NULL if reading through fid
+    size_t                           mapSize;
+    size_t                           mapReleased;                    // Pages before this offset have been released
+    RKRawDataBlockHeader             blockHeader;                    // Header of the current block
+    RKByte                           *block;                         // The current block after inflate, or a pulse when not mapped
+    RKByte                           *compressed;                    // The deflated payload as in file, only used when not mapped
+    RKByte                           *scratch;                       // Scratch space for the block filter
+    size_t                           blockCapacity;
+    size_t                           compressedCapacity;
+    size_t                           scratchCapacity;
+    size_t                           blockReadIndex;
+    uint32_t                         blockPulseIndex;
+    RKRawDataBlockIndex              *blockIndex;                    // Block index from the file trailer
+    uint32_t                         blockIndexCount;
+    RKRawDataPulseIndex              *pulseIndex;                    // Pulse index from the file trailer
+    uint32_t                         pulseIndexCount;
+    uint32_t                         pulseNumber;                    // Pulse number of the next read
+};
+
+void RKRawDataShuffle(void *dst, const void *src, const size_t size, const uint8_t elementSize);
+void RKRawDataUnshuffle(void *dst, const void *src, const size_t size, const uint8_t elementSize);
+
+size_t RKRawDataBlockBound(const size_t size);
+size_t RKRawDataBlockEncode(void *dst, const size_t capacity, const void *src, const size_t size,
+                            const RKRawDataBlockFilter filter, const uint8_t elementSize, void *scratch, const int level);
+int RKRawDataBlockDecode(void *dst, const size_t size, const void *src, const size_t compressedSize,
+                         const RKRawDataBlockFilter filter, const uint8_t elementSize, void *scratch);
+
+RKRawDataReader *RKRawDataReaderInit(FILE *fid, const RKFileHeader *fileHeader);
+void RKRawDataReaderFree(RKRawDataReader *);
+int RKRawDataReaderReadPulseView(RKRawDataReader *, RKRawDataPulseView *view);
+int RKRawDataReaderReadPulse(RKRawDataReader *, RKPulse *pulse);
+int RKRawDataReaderSeekToPulse(RKRawDataReader *, const uint32_t pulseNumber);
+int RKRawDataReaderSeekToTime(RKRawDataReader *, const double timeDouble);
+int RKRawDataReaderSeekToAzimuth(RKRawDataReader *, const float azimuthDegrees);
+
+#endif
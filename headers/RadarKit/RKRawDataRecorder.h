@@ -11,9 +11,33 @@
 
 #include <RadarKit/RKFoundation.h>
 #include <RadarKit/RKFileManager.h>
+#include <RadarKit/RKRawDataFile.h>
 
 #define RKRawDataRecorderDefaultMaximumRecorderDepth   100000
 #define RKRawDataRecorderDefaultCacheSize              32 * 1024 * 1024
+#define RKRawDataRecorderDefaultBlockDepth             200
+#define RKRawDataRecorderDefaultCompressorCount        2
+#define RKRawDataRecorderMaximumCompressorCount        8
+#define RKRawDataRecorderBlockSlotCount                16
+#define RKRawDataRecorderDefaultWriteBehindSize        64 * 1024 * 1024
+
+typedef uint8_t RKRawDataBlockState;
+enum RKRawDataBlockState {
+    RKRawDataBlockStateVacant,
+    RKRawDataBlockStateQueued,
+    RKRawDataBlockStateCompressing,
+    RKRawDataBlockStateCompressed
+};
+
+typedef struct rk_raw_data_recorder_block {
+    RKRawDataBlockHeader             header;
+    RKRawDataBlockState              state;
+    RKByte                           *raw;
+    RKByte                           *scratch;
+    RKByte                           *compressed;
+    size_t                           capacity;
+    size_t                           compressedCapacity;
+} RKRawDataRecorderBlock;
 
 typedef struct rk_data_recorder RKRawDataRecorder;
 
@@ -31,6 +55,13 @@ struct rk_data_recorder {
     size_t                           cacheSize;
     size_t                           maximumRecordDepth;
     RKFileManager                    *fileManager;
+    RKRawDataFormat                  rawDataFormat;                  // Plain or block compressed
+    RKRawDataBlockFilter             blockFilter;                    // Pre-filter of each block before deflate
+    uint32_t                         blockDepth;                     // Number of pulses in a block
+    int                              compressionLevel;               // zlib compression level
+    uint8_t                          compressorCount;                // Number of block compressors
+    bool                             preallocate;                    // Reserve disk space for maximumRecordDepth pulses
+    size_t                           writeBehindSize;                // Dirty bytes before write-back is started, 0 = kernel default
 
     // Program set variables
     int                              fd;
@@ -39,7 +70,29 @@ struct rk_data_recorder {
     size_t                           cacheWriteIndex;
     uint64_t                         cacheFlushCount;
     uint64_t                         fileWriteCount;
+    uint64_t                         fileOffset;                     // Bytes passed to the cache since the file was opened
+    uint64_t                         fileReserved;                   // Bytes preallocated for the current file
+    uint64_t                         fileSynced;                     // Bytes handed to write-back
+    size_t                           fileWaited;                     // Bytes written back and dropped from the page cache
+    RKRawDataPulseIndex              *pulseEntries;                  // Pulse index of the current file
+    uint32_t                         pulseEntryCount;
+    uint32_t                         pulseEntryCapacity;
+    RKByte                           *pulseScratch;                  // A pulse encoded in reduced precision
+    size_t                           pulseScratchCapacity;
     pthread_t                        tidPulseRecorder;
+    pthread_t                        tidBlockCompressors[RKRawDataRecorderMaximumCompressorCount];
+    pthread_mutex_t                  blockMutex;
+    pthread_cond_t                   blockQueued;                    // Signaled when a block is queued for compression
+    pthread_cond_t                   blockCompressed;                // Signaled when a block has been compressed
+    RKRawDataRecorderBlock           blocks[RKRawDataRecorderBlockSlotCount];
+    uint32_t                         blockFillIndex;
+    uint32_t                         blockWriteIndex;
+    RKRawDataBlockIndex              *blockIndex;
+    uint32_t                         blockIndexCount;
+    uint32_t                         blockIndexCapacity;
+    bool                             blockCompressorsActive;
+    uint64_t                         blockRawSize;                   // Block bytes before deflate of the current file
+    uint64_t                         blockCompressedSize;            // Block bytes after deflate of the current file
 
     // Status / health
     char                             statusBuffer[RKBufferSSlotCount][RKStatusStringLength];
@@ -61,6 +114,11 @@ void RKRawDataRecorderSetRecord(RKRawDataRecorder *engine, const bool);
 void RKRawDataRecorderSetRawDataType(RKRawDataRecorder *engine, const RKRawDataType);
 void RKRawDataRecorderSetMaximumRecordDepth(RKRawDataRecorder *engine, const uint32_t);
 void RKRawDataRecorderSetCacheSize(RKRawDataRecorder *engine, uint32_t size);
+void RKRawDataRecorderSetRawDataFormat(RKRawDataRecorder *engine, const RKRawDataFormat);
+void RKRawDataRecorderSetBlockCompression(RKRawDataRecorder *engine, const uint32_t depth, const RKRawDataBlockFilter, const int level);
+void RKRawDataRecorderSetCompressorCount(RKRawDataRecorder *engine, const uint8_t);
+void RKRawDataRecorderSetPreallocation(RKRawDataRecorder *engine, const bool);
+void RKRawDataRecorderSetWriteBehindSize(RKRawDataRecorder *engine, const size_t);
 
 int RKRawDataRecorderStart(RKRawDataRecorder *engine);
 int RKRawDataRecorderStop(RKRawDataRecorder *engine);
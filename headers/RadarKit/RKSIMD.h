@@ -38,6 +38,9 @@
 #include <spe.h>
 #endif
 
+#define RKSIMDHalfMaximum          65504.0f                                    // Largest finite half precision value
+#define RKSIMDHalfMaximumBits      0x7bff
+
 #if defined(__AVX512F__)
 
 // NOTE: Still need to define a lot of _mmXXX_XXX_pd equivalence for double precision calculations
@@ -54,14 +57,39 @@ typedef __m256i RKVecCvt;
 #define _rk_mm_movehdup_pf(a)        _mm512_movehdup_ps(a)
 #define _rk_mm_moveldup_pf(a)        _mm512_moveldup_ps(a)
 #define _rk_mm_shuffle_pf(a, b, m)   _mm512_shuffle_ps(a, b, m)
-//#define _rk_mm_fmaddsub_pf(a, b, c)  _mm512_fmaddsub_ps(a, b, c)
+#define _rk_mm_fmaddsub_pf(a, b, c)  _mm512_fmaddsub_ps(a, b, c)
 #define _rk_mm_setzero_si()          _mm512_setzero_si512()
 #define _rk_mm_cvtepi16_epi32(a)     _mm512_cvtepi16_epi32(a)                // AVX512
 #define _rk_mm_cvtepi32_pf(a)        _mm512_cvtepi32_ps(a)                   // AVX512
 #define _rk_mm_sqrt_pf(a)            _mm512_sqrt_ps(a)
-#define _rk_mm_rcp_pf(a)             _mm512_rcp_ps(a)
+#define _rk_mm_rcp_pf(a)             _mm512_rcp14_ps(a)
 #define _rk_mm_max_pf(a, b)          _mm512_max_ps(a, b)
 #define _rk_mm_min_pf(a, b)          _mm512_min_ps(a, b)
+typedef __m512i RKVecInt;
+typedef __mmask16 RKVecMask;
+#define _rk_mm_loadu_pf(p)           _mm512_loadu_ps(p)
+#define _rk_mm_storeu_pf(p, a)       _mm512_storeu_ps(p, a)
+#define _rk_mm_setzero_pf()          _mm512_setzero_ps()
+#define _rk_mm_abs_pf(a)             _mm512_abs_ps(a)
+#define _rk_mm_cmpeq_pf(a, b)        _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+#define _rk_mm_cmpge_pf(a, b)        _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ)
+#define _rk_mm_cmpgt_pf(a, b)        _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)
+#define _rk_mm_blend_pf(a, b, m)     _mm512_mask_blend_ps(m, a, b)           // b where m is set, a otherwise
+#define _rk_mm_maskz_pf(a, m)        _mm512_maskz_mov_ps(m, a)               // a where m is set, 0 otherwise
+#define _rk_mm_loadu_si(p)           _mm512_loadu_si512(p)
+#define _rk_mm_set1_epi32(a)         _mm512_set1_epi32(a)
+#define _rk_mm_add_epi32(a, b)       _mm512_add_epi32(a, b)
+#define _rk_mm_i32gather_pf(p, i)    _mm512_i32gather_ps(i, p, 4)
+#define _rk_mm_loadu_epi16_pf(p)     _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i *)(p))))
+#define _rk_mm_storeu_pf_epi16(p, a) _mm256_storeu_si256((__m256i *)(p), _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(a)))
+#define _rk_mm_loadu_epu8_pf(p)      _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(p))))
+#define _rk_mm_storeu_pf_epu8(p, a)  _mm_storeu_si128((__m128i *)(p), _mm512_cvtusepi32_epi8(_mm512_cvtps_epi32(a)))
+#define _rk_mm_loadu_ph_pf(p)        _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)(p)))
+#define _rk_mm_storeu_pf_ph(p, a)    _mm256_storeu_si256((__m256i *)(p), _mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT))
+#define _rk_mm_interleavelo_pf(a, b) _mm512_permutex2var_ps(a, _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 19, 3, 18, 2, 17, 1, 16, 0), b)
+#define _rk_mm_interleavehi_pf(a, b) _mm512_permutex2var_ps(a, _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 27, 11, 26, 10, 25, 9, 24, 8), b)
+#define _rk_mm_evens_pf(a, b)        _mm512_permutex2var_ps(a, _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0), b)
+#define _rk_mm_odds_pf(a, b)         _mm512_permutex2var_ps(a, _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1), b)
 //#if defined(_mm512_mul_ps)
 //#define _rk_mm_log10_pf(a)           _mm512_log10_ps(a)
 //#endif
@@ -92,6 +120,38 @@ typedef __m128i RKVecCvt;
 #define _rk_mm_rcp_pf(a)             _mm256_rcp_ps(a)
 #define _rk_mm_max_pf(a, b)          _mm256_max_ps(a, b)
 #define _rk_mm_min_pf(a, b)          _mm256_min_ps(a, b)
+typedef __m256i RKVecInt;
+typedef __m256 RKVecMask;
+#define _rk_mm_loadu_pf(p)           _mm256_loadu_ps(p)
+#define _rk_mm_storeu_pf(p, a)       _mm256_storeu_ps(p, a)
+#define _rk_mm_setzero_pf()          _mm256_setzero_ps()
+#define _rk_mm_abs_pf(a)             _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)))
+#define _rk_mm_cmpeq_pf(a, b)        _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define _rk_mm_cmpge_pf(a, b)        _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define _rk_mm_cmpgt_pf(a, b)        _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define _rk_mm_blend_pf(a, b, m)     _mm256_blendv_ps(a, b, m)               // b where m is set, a otherwise
+#define _rk_mm_maskz_pf(a, m)        _mm256_and_ps(a, m)                     // a where m is set, 0 otherwise
+#define _rk_mm_storeu_pf_epi16(p, a) _mm_storeu_si128((__m128i *)(p), _mm_packs_epi32(_mm256_castsi256_si128(_mm256_cvtps_epi32(a)), \
+                                                                                      _mm256_extractf128_si256(_mm256_cvtps_epi32(a), 1)))
+#define _rk_mm_storeu_pf_epu8(p, a)  _mm_storel_epi64((__m128i *)(p), _mm_packus_epi16(_mm_packs_epi32(_mm256_castsi256_si128(_mm256_cvtps_epi32(a)), \
+                                                                                                       _mm256_extractf128_si256(_mm256_cvtps_epi32(a), 1)), \
+                                                                                      _mm_setzero_si128()))
+#define _rk_mm_interleavelo_pf(a, b) _mm256_permute2f128_ps(_mm256_unpacklo_ps(a, b), _mm256_unpackhi_ps(a, b), 0x20)
+#define _rk_mm_interleavehi_pf(a, b) _mm256_permute2f128_ps(_mm256_unpacklo_ps(a, b), _mm256_unpackhi_ps(a, b), 0x31)
+#define _rk_mm_evens_pf(a, b)        _mm256_shuffle_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31), _MM_SHUFFLE(2, 0, 2, 0))
+#define _rk_mm_odds_pf(a, b)         _mm256_shuffle_ps(_mm256_permute2f128_ps(a, b, 0x20), _mm256_permute2f128_ps(a, b, 0x31), _MM_SHUFFLE(3, 1, 3, 1))
+#    if defined(__AVX2__)
+#        define _rk_mm_loadu_si(p)           _mm256_loadu_si256((const __m256i *)(p))                         // AVX2
+#        define _rk_mm_set1_epi32(a)         _mm256_set1_epi32(a)
+#        define _rk_mm_add_epi32(a, b)       _mm256_add_epi32(a, b)
+#        define _rk_mm_i32gather_pf(p, i)    _mm256_i32gather_ps(p, i, 4)
+#        define _rk_mm_loadu_epi16_pf(p)     _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(p))))
+#        define _rk_mm_loadu_epu8_pf(p)      _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(p))))
+#    endif
+#    if defined(__F16C__)
+#        define _rk_mm_loadu_ph_pf(p)        _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(p)))           // F16C
+#        define _rk_mm_storeu_pf_ph(p, a)    _mm_storeu_si128((__m128i *)(p), _mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT))
+#    endif
 //#if defined(_mm256_mul_ps)
 //#define _rk_mm_log10_pf(a)           _mm256_log10_ps(a)
 //#endif
@@ -123,6 +183,32 @@ typedef __m128 RKVec;
 #define _rk_mm_rcp_pf(a)             _mm_rcp_ps(a)
 #define _rk_mm_max_pf(a, b)          _mm_max_ps(a, b)
 #define _rk_mm_min_pf(a, b)          _mm_min_ps(a, b)
+typedef __m128i RKVecInt;
+typedef __m128 RKVecMask;
+#define _rk_mm_loadu_pf(p)           _mm_loadu_ps(p)
+#define _rk_mm_storeu_pf(p, a)       _mm_storeu_ps(p, a)
+#define _rk_mm_setzero_pf()          _mm_setzero_ps()
+#define _rk_mm_abs_pf(a)             _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)))
+#define _rk_mm_cmpeq_pf(a, b)        _mm_cmpeq_ps(a, b)
+#define _rk_mm_cmpge_pf(a, b)        _mm_cmpge_ps(a, b)
+#define _rk_mm_cmpgt_pf(a, b)        _mm_cmpgt_ps(a, b)
+#define _rk_mm_blend_pf(a, b, m)     _mm_blendv_ps(a, b, m)                  // SSE4.1, b where m is set, a otherwise
+#define _rk_mm_maskz_pf(a, m)        _mm_and_ps(a, m)                        // a where m is set, 0 otherwise
+#define _rk_mm_loadu_si(p)           _mm_loadu_si128((const __m128i *)(p))
+#define _rk_mm_set1_epi32(a)         _mm_set1_epi32(a)
+#define _rk_mm_add_epi32(a, b)       _mm_add_epi32(a, b)
+#define _rk_mm_loadu_epi16_pf(p)     _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(p))))          // SSE4.1
+#define _rk_mm_storeu_pf_epi16(p, a) _mm_storel_epi64((__m128i *)(p), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_setzero_si128()))
+#define _rk_mm_loadu_epu8_pf(p)      _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_loadu_si32(p)))                              // SSE4.1
+#define _rk_mm_storeu_pf_epu8(p, a)  _mm_storeu_si32(p, _mm_packus_epi16(_mm_packs_epi32(_mm_cvtps_epi32(a), _mm_setzero_si128()), _mm_setzero_si128()))
+#define _rk_mm_interleavelo_pf(a, b) _mm_unpacklo_ps(a, b)
+#define _rk_mm_interleavehi_pf(a, b) _mm_unpackhi_ps(a, b)
+#define _rk_mm_evens_pf(a, b)        _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))
+#define _rk_mm_odds_pf(a, b)         _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))
+#    if defined(__F16C__)
+#        define _rk_mm_loadu_ph_pf(p)        _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)(p)))              // F16C
+#        define _rk_mm_storeu_pf_ph(p, a)    _mm_storel_epi64((__m128i *)(p), _mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT))
+#    endif
 //#if defined(_mm_mul_ps)
 //#define _rk_mm_log10_pf(a)           _mm_log10_ps(a)
 //#endif
@@ -161,6 +247,21 @@ void RKSIMD_Complex2IQZ(RKComplex *src, RKIQZ *dst, const int n);
 void RKSIMD_Int2Complex(RKInt16C *src, RKComplex *dst, const int n);
 void RKSIMD_Int2Complex_reg(RKInt16C *src, RKComplex *dst, const int n);
 
+RKFloat RKSIMD_amax(const RKFloat *src, const int n);
+void RKSIMD_Float2Int16(const RKFloat *src, int16_t *dst, const RKFloat m, const int n);
+void RKSIMD_Int162Float(const int16_t *src, RKFloat *dst, const RKFloat m, const int n);
+void RKSIMD_Float2Half(const RKFloat *src, uint16_t *dst, const int n);
+void RKSIMD_Half2Float(const uint16_t *src, RKFloat *dst, const int n);
+void RKSIMD_Quantize16(const RKFloat *src, int16_t *dst, const RKFloat scale, const RKFloat offset, const int16_t fill, const int n);
+void RKSIMD_Quantize8(const RKFloat *src, uint8_t *dst, const RKFloat scale, const RKFloat offset, const uint8_t fill, const int n);
+void RKSIMD_Dequantize16(const int16_t *src, RKFloat *dst, const RKFloat scale, const RKFloat offset, const int16_t fill, const int n);
+void RKSIMD_Dequantize8(const uint8_t *src, RKFloat *dst, const RKFloat scale, const RKFloat offset, const uint8_t fill, const int n);
+void RKSIMD_BilinearGather(const RKFloat *src, const int32_t *a, const int32_t *b, const RKFloat *wb, const RKFloat *wg,
+                           RKFloat *dst, const int n);
+void RKSIMD_imax(const RKFloat *src, RKFloat *dst, const int n);
+void RKSIMD_EchoTop(const RKFloat *z, const RKFloat *h, const RKFloat threshold, RKFloat *top, const int n);
+void RKSIMD_VILLayer(const RKFloat *m, const RKFloat *h, RKFloat *mBelow, RKFloat *hBelow, RKFloat *vil, const int n);
+
 void RKSIMD_subc(RKFloat *src, const RKFloat f, RKFloat *dst, const int n);
 void RKSIMD_clamp(RKFloat *src, const RKFloat min, const RKFloat max, const int n);
 
@@ -10,10 +10,26 @@
 #define __RadarKit_Server__
 
 #include <RadarKit/RKNetwork.h>
+#include <sys/uio.h>
 
-#define RKServerMaximumOperators    16
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+
+#define RKServerMaximumOperators    512
+#define RKServerDefaultOperators    16
 #define RKServerSelectTimeoutUs     200;
 #define RKServerBufferDepth         8
+#define RKServerMaximumWorkers      16
+#define RKServerDefaultWorkers      4
+#define RKServerCommandWorkers      2                         // Threads that run the command handler, off the I/O workers
+#define RKServerStreamPeriodMs      1                         // Longest wait for socket events before the stream handlers are visited
+#define RKServerMaximumFragments    64                        // Payloads gathered into one sendmsg()
+#define RKServerSendQueueDepth      256                       // Packets an operator keeps for a client that falls behind, more if they may not be dropped
+#define RKServerSendQueueCapacity   (32 * 1024 * 1024)        // Bytes an operator keeps for a client that falls behind, more if they may not be dropped
+#define RKServerMaximumDropStreak   1000                      // Drops without progress before the operator is hung up
 
 //#ifdef __cplusplus
 //extern "C" {
@@ -46,8 +62,33 @@ enum RKServerOption {
 };
 
 
-typedef struct rk_server    RKServer;
-typedef struct rk_operator  RKOperator;
+typedef int RKOperatorSendPolicy;
+enum RKOperatorSendPolicy {
+    RKOperatorSendPolicyBlock,                             // Never dropped, the stream pauses when the queue is full, e.g., sweeps for archival
+    RKOperatorSendPolicyDropOldest                         // Drop the oldest packets when the queue is full, e.g., live displays
+};
+
+typedef struct rk_operator_packet {
+    void                  *buffer;                         // A copy of the packet
+    size_t                capacity;                        // Allocated size of the buffer
+    size_t                size;                            // Size of the packet
+    size_t                offset;                          // Bytes that have been sent
+    RKOperatorSendPolicy  policy;                          // Send policy when it was queued
+} RKOperatorPacket;
+
+typedef struct rk_server         RKServer;
+typedef struct rk_server_worker  RKServerWorker;
+typedef struct rk_operator       RKOperator;
+
+struct rk_server_worker {
+    RKServer         *M;                                   // Pointer to main server
+    int              id;                                   // Worker identifier
+    int              fd;                                   // Event descriptor, epoll on Linux, kqueue elsewhere
+    pthread_t        tid;                                  // Thread ID of the worker
+    pthread_mutex_t  lock;                                 // Guards the list of operators
+    int              operatorCount;                        // Number of operators served
+    RKOperator       *operators[RKServerMaximumOperators]; // Operators served by this worker
+};
 
 struct rk_server {
     RKName           name;                                  // A program name
@@ -57,6 +98,7 @@ struct rk_server {
     int              port;                                  // Port number of the server
     int              maxClient;                             // Maximum number of client connections
     int              timeoutSeconds;                        // Timeout in seconds
+    int              workerCount;                           // Number of I/O workers
     RKServerOption   options;                               // Server options
 
     int              ireq;                                  // A global instance request
@@ -66,6 +108,13 @@ struct rk_server {
 
     bool             busy[RKServerMaximumOperators];       // Operator occupied
     RKOperator       *operators[RKServerMaximumOperators]; // Operator reference
+    RKServerWorker   workers[RKServerMaximumWorkers];      // I/O workers that serve the operators
+    pthread_t        commandTids[RKServerCommandWorkers];  // Threads that run the command handler
+    pthread_mutex_t  commandLock;                          // Guards the command queue
+    pthread_cond_t   commandPosted;                        // Signals an operator that has commands to run
+    RKOperator       *commandQueue[RKServerMaximumOperators]; // Operators that have commands to run, each one once at most
+    int              commandQueueHead;                     // Index of the next operator to take
+    int              commandQueueCount;                    // Operators in the command queue
 
     int              (*w)(RKOperator *);                   // Function that sends initial welcome message
     int              (*c)(RKOperator *);                   // Function that answers command
@@ -82,8 +131,7 @@ struct rk_operator  {
     int              timeoutSeconds;                       // Timeout in seconds
     int              sid;                                  // Socket identifier of the client
     RKOperatorState  state;                                // Connection state
-    pthread_t        tidRead;                              // Thread ID of the operator ingest
-    pthread_t        tidExecute;                           // Thread ID of the operator execution
+    RKServerWorker   *worker;                              // The I/O worker that serves this operator
     pthread_mutex_t  lock;                                 // Thread safety mutex of the attendant
 
     RKName           name;                                 // Operator name
@@ -95,6 +143,32 @@ struct rk_operator  {
     RKNetDelimiter   beacon;                               // Beacon
 
     char             *cmd;                                 // Latest command
+    pthread_mutex_t  rxLock;                               // Guards the received bytes and the command state
+    char             rxBuffer[RKMaximumCommandLength];     // Received bytes that are not yet consumed
+    size_t           rxLength;                             // Number of bytes in rxBuffer
+    bool             rxPaused;                             // Socket is not watched until some of rxBuffer is taken
+    bool             commandQueued;                        // Queued for, or running, the command handler
+    bool             txWatched;                            // Socket is watched for writability, which follows blocked
+    uint32_t         payloadsExpected;                     // Payloads a stream handler is waiting for, they are not taken as commands
+    size_t           payloadOffset;                        // Bytes of delimRx and the payload that have been received
+    int              events;                               // Events of the socket that the worker is watching
+    struct timeval   latestReadTime;                       // Time of the latest receive
+    struct timeval   latestWriteTime;                      // Time of the latest send progress, or of an empty queue
+    RKOperatorSendPolicy sendPolicy;                       // Policy of the packets that are sent next
+    RKOperatorPacket *queue;                               // Packets that the client has not taken
+    uint32_t         queueDepth;                           // Allocated number of packets in the queue
+    uint32_t         queueHead;                            // Index of the oldest packet in the queue
+    uint32_t         queueCount;                           // Packets in the queue
+    uint32_t         queuePeakCount;                       // Highest queueCount so far
+    size_t           queueSize;                            // Bytes in the queue that have not been sent
+    bool             blocked;                              // Queue is over the limits with packets that may not be dropped
+    uint64_t         dropCount;                            // Packets dropped
+    uint32_t         dropStreak;                           // Packets dropped since the client last took something
+    RKNetworkCompression compression;                      // Compression negotiated with the client
+    void             *compressBuffer;                      // Gathered payload, shuffle scratch and deflated payload
+    size_t           compressCapacity;                     // Allocated size of compressBuffer
+    size_t           compressInputSize;                    // Payload bytes that went through compression
+    size_t           compressOutputSize;                   // Bytes that came out of compression
 
     RKCommand        commands[RKServerBufferDepth];        // A buffer to keep the latest N commands
     uint8_t          commandIndexWrite;                    // Index to write to the buffer
@@ -105,17 +179,27 @@ struct rk_operator  {
 
 
 ssize_t RKOperatorSendPackets(RKOperator *, ...);
+ssize_t RKOperatorSendCompressiblePackets(RKOperator *, const uint8_t elementSize, RKNetDelimiter *, ...);
+ssize_t RKOperatorSendCompressedPacket(RKOperator *, const uint8_t elementSize, RKNetDelimiter *, const void *block, const size_t blockSize, const size_t size);
 ssize_t RKOperatorSendString(RKOperator *, const char *);
 ssize_t RKOperatorSendDelimitedString(RKOperator *, const char *);
 ssize_t RKOperatorSendCommandResponse(RKOperator *, const char *);
 ssize_t RKOperatorSendBeacon(RKOperator *);
 void RKOperatorHangUp(RKOperator *);
+void RKOperatorSetSendPolicy(RKOperator *, const RKOperatorSendPolicy);
+void RKOperatorSetCompression(RKOperator *, const RKNetworkCompression);
+void RKOperatorExpectPayloads(RKOperator *, const uint32_t count);
+bool RKOperatorHasRoom(RKOperator *);
+ssize_t RKOperatorReceivePayload(RKOperator *, void *buffer, const size_t capacity);
 
 RKServer *RKServerInit(void);
 void RKServerFree(RKServer *);
 
 void RKServerSetName(RKServer *, const char *);
 void RKServerSetPort(RKServer *, const int);
+void RKServerSetMaximumClientCount(RKServer *, const int);
+void RKServerSetWorkerCount(RKServer *, const int);
+void RKServerSetOptions(RKServer *, const RKServerOption);
 void RKServerSetWelcomeHandler(RKServer *, int (*)(RKOperator *));
 void RKServerSetCommandHandler(RKServer *, int (*)(RKOperator *));
 void RKServerSetTerminateHandler(RKServer *, int (*)(RKOperator *));
@@ -129,6 +213,7 @@ void RKServerWait(RKServer *);
 void RKServerStop(RKServer *);
 
 ssize_t RKServerReceiveUserPayload(RKOperator *O, void *buffer, RKNetworkMessageFormat format);
+size_t RKServerCompressPayload(void *block, void *scratch, const void *payload, const size_t size, const uint8_t elementSize, const RKNetworkCompression);
 
 //#ifdef __cplusplus
 //}
@@ -9,13 +9,17 @@
 #ifndef __RadarKit_Sweep__
 #define __RadarKit_Sweep__
 
-#define RKSweepScratchSpaceDepth 4
+#define RKSweepScratchSpaceDepth                 4
+#define RKSweepEngineDefaultProductWriterCount   4
+#define RKSweepEngineMaximumProductWriterCount   8
+#define RKSweepEngineProductJobSlotCount         16
 
 #include <RadarKit/RKFoundation.h>
 #include <RadarKit/RKFileManager.h>
 #include <RadarKit/RKSweepFile.h>
 #include <RadarKit/RKProduct.h>
 #include <RadarKit/RKProductFile.h>
+#include <RadarKit/RKVolumeEngine.h>
 
 typedef struct rk_sweep_scratch {
     char                             filename[RKMaximumPathLength - 32];
@@ -23,8 +27,25 @@ typedef struct rk_sweep_scratch {
     char                             summary[RKMaximumStringLength];
     RKRay                            *rays[RKMaximumRaysPerSweep];
     uint32_t                         rayCount;
+    RKSweep                          *sweep;                                       // Shared snapshot of the rays, NULL until acquired
+    RKSweepFileStream                *stream;                                      // Sweep file streamed from the rays, if any
 } RKSweepScratchSpace;
 
+typedef uint8_t RKSweepProductJobState;
+enum RKSweepProductJobState {
+    RKSweepProductJobStateVacant,
+    RKSweepProductJobStateQueued,
+    RKSweepProductJobStateWriting,
+    RKSweepProductJobStateWritten
+};
+
+typedef struct rk_sweep_product_job {
+    RKProduct                        *product;
+    char                             filename[RKMaximumPathLength];
+    RKSweepProductJobState           state;
+    int                              result;                                       // Return value of the product recorder
+} RKSweepProductJob;
+
 typedef struct rk_sweep_engine RKSweepEngine;
 
 struct rk_sweep_engine {
@@ -47,14 +68,32 @@ struct rk_sweep_engine {
     uint32_t                         productTimeoutSeconds;
     char                             productFileExtension[RKMaximumFileExtensionLength];
     int                              (*productRecorder)(RKProduct *, const char *);
+    int                              (*sweepRecorder)(RKProduct **, const uint32_t, const char *);    // All products in one file if set
+    uint8_t                          productWriterCount;                           // Number of concurrent product writers
+    bool                             streamSweep;                                  // Write the sweep file ray by ray as the rays arrive
+    RKVolumeEngine                   *volumeEngine;                                // Volume cache that keeps a reference of every sweep, if any
 
     // Program set variables
     pthread_t                        tidRayGatherer;
     RKSweepScratchSpace              scratchSpaces[RKSweepScratchSpaceDepth];
     uint8_t                          scratchSpaceIndex;
-    pthread_mutex_t                  productMutex;
+    pthread_mutex_t                  sweepMutex;                                   // Guards the shared sweeps of the scratch spaces
+    pthread_mutex_t                  productMutex;                                 // Guards the product flags and the pinned sweep
+    RKSweep                          *pinnedSweep;                                 // Sweep whose rays the base products refer to in place, referenced
+    uint32_t                         viewReaderCount;                              // Writers that are reading the rays in place
+    pthread_cond_t                   viewReadersDone;                              // Signaled when the last of them is done
     RKBaseMomentList                 baseMomentList;
     RKProductId                      baseMomentProductIds[RKBaseMomentIndexCount];
+    pthread_t                        tidProductWriters[RKSweepEngineMaximumProductWriterCount];
+    pthread_mutex_t                  productJobMutex;
+    pthread_cond_t                   productJobQueued;                             // Signaled when a product is queued for writing
+    pthread_cond_t                   productJobWritten;                            // Signaled when a product has been written
+    RKSweepProductJob                productJobs[RKSweepEngineProductJobSlotCount];
+    uint32_t                         productJobPendingCount;                       // Queued products that have not been concluded
+    bool                             productWritersActive;
+    RKSweepFileStream                *sweepStream;                                 // Sweep file that is receiving the rays
+    bool                             sweepStreamArmed;                             // The next ray starts a sweep file stream
+    uint32_t                         sweepStreamCount;
 
     // Status / health
     uint32_t                         processedRayIndex;
@@ -79,6 +118,12 @@ void RKSweepEngineSetRecord(RKSweepEngine *, const bool);
 void RKSweepEngineSetProductTimeout(RKSweepEngine *, const uint32_t);
 void RKSweepEngineSetFilesHandlingScript(RKSweepEngine *, const char *, const RKScriptProperty);
 void RKSweepEngineSetProductRecorder(RKSweepEngine *, int (*)(RKProduct *, const char *));
+void RKSweepEngineSetSweepRecorder(RKSweepEngine *, int (*)(RKProduct **, const uint32_t, const char *));
+void RKSweepEngineSetProductWriterCount(RKSweepEngine *, const uint8_t);
+void RKSweepEngineSetSweepStreaming(RKSweepEngine *, const bool);
+void RKSweepEngineSetVolumeEngine(RKSweepEngine *, RKVolumeEngine *);
+
+void RKSweepEngineEvictRay(void *, RKRay *);
 
 int RKSweepEngineStart(RKSweepEngine *);
 int RKSweepEngineStop(RKSweepEngine *);
@@ -92,4 +137,7 @@ int RKSweepEngineSetProductComplete(RKSweepEngine *, RKSweep *, RKProduct *);
 RKSweep *RKSweepCollect(RKSweepEngine *, const uint8_t);
 int RKSweepFree(RKSweep *);
 
+RKSweep *RKSweepEngineAcquireSweep(RKSweepEngine *, const uint8_t);
+int RKSweepEngineReleaseSweep(RKSweepEngine *, RKSweep *);
+
 #endif /* RKSweep_h */
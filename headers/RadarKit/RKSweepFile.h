@@ -12,6 +12,68 @@
 #include <RadarKit/RKFoundation.h>
 #include <RadarKit/RKProductFile.h>
 
+#define RKSweepFileChunkRayCount     8
+#define RKSweepFileDeflateLevel      3
+#define RKSweepFileStreamQueueDepth  32
+
+// A sweep file that is written ray by ray as the rays arrive, in the layout of RKSweepFileWriterNC(). The rays are
+// copied into a queue and written to the file by a writer thread of the stream.
+typedef struct rk_sweep_file_stream {
+    int                              ncid;
+    char                             filename[RKMaximumPathLength];                // Temporary name until the stream is finished
+    int                              dimensionIds[2];
+    int                              coordinateIds[4];                             // Azimuth, elevation, beamwidth and gate width
+    int                              variableIds[RKBaseMomentIndexCount];
+    RKBaseMomentIndex                momentIndices[RKBaseMomentIndexCount];
+    RKProductDesc                    momentDescriptions[RKBaseMomentIndexCount];
+    RKFloat                          momentScales[RKBaseMomentIndexCount];         // 180 / pi for moments converted to degrees, 1 otherwise
+    uint32_t                         momentCount;
+    uint32_t                         gateCount;
+    uint32_t                         rayCount;                                     // Rays appended so far
+    uint32_t                         writtenRayCount;                              // Rays that have left the queue
+    RKIdentifier                     firstRayIdentifier;                           // Identity of the first ray appended
+    bool                             isPPI;
+    bool                             isRHI;
+    float                            *queue;                                       // Queued rays, the four ray angles then the moments
+    size_t                           queueSlotSize;                                // Number of floats of a queued ray
+    pthread_t                        tidWriter;
+    pthread_mutex_t                  mutex;
+    pthread_cond_t                   rayQueued;                                    // Signaled when a ray is queued or the stream is concluded
+    pthread_cond_t                   rayWritten;                                   // Signaled when a ray leaves the queue
+    bool                             active;                                       // Rays may still be appended
+    bool                             discarded;                                    // Queued rays are dropped
+    int                              result;                                       // First error of the writer
+} RKSweepFileStream;
+
+// A sweep whose header and ray angles are read once, the moment data are read only when they are first needed
+typedef struct rk_sweep_file_reader {
+    RKSweep                          *sweep;                                       // Moments are filled in as they are loaded
+    char                             filenames[RKBaseMomentCount][RKMaximumPathLength];   // File of each base moment, empty if not available
+    RKBaseMomentList                 availableMomentList;
+    RKBaseMomentList                 loadedMomentList;
+    uint32_t                         rayOrigin;                                    // The range of rays and gates in the file(s)
+    uint32_t                         gateOrigin;
+    uint32_t                         rayCount;
+    uint32_t                         gateCount;
+    float                            *scratch;
+} RKSweepFileReader;
+
 RKSweep *RKSweepFileRead(const char *);
+RKSweep *RKSweepFileReadMoments(const char *, const RKBaseMomentList);
+
+RKSweepFileReader *RKSweepFileReaderInit(const char *);
+RKSweepFileReader *RKSweepFileReaderInitWithRange(const char *, const uint32_t rayOrigin, const uint32_t rayCount,
+                                                  const uint32_t gateOrigin, const uint32_t gateCount);
+int RKSweepFileReaderLoadMoments(RKSweepFileReader *, const RKBaseMomentList);
+RKFloat *RKSweepFileReaderGetRayData(RKSweepFileReader *, const RKBaseMomentIndex, const uint32_t rayIndex);
+void RKSweepFileReaderFree(RKSweepFileReader *);
+
+int RKSweepFileWriterNC(RKProduct **, const uint32_t count, const char *);
+
+RKSweepFileStream *RKSweepFileStreamOpen(const char *filename, const RKProductDesc *, const uint32_t count, const uint32_t gateCount,
+                                         const bool isPPI, const bool isRHI, const bool convertToDegrees);
+int RKSweepFileStreamAppendRay(RKSweepFileStream *, RKRay *);
+int RKSweepFileStreamFinish(RKSweepFileStream *, RKProduct **, const uint32_t count, const char *filename);
+void RKSweepFileStreamDiscard(RKSweepFileStream *);
 
 #endif
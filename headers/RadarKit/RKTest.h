@@ -10,6 +10,8 @@
 #define __RadarKit_Test__
 
 #include <RadarKit/RKRadar.h>
+#include <RadarKit/RKGridEngine.h>
+#include <RadarKit/RKCommandCenter.h>
 
 #define RKTestWaveformCacheCount 2
 
@@ -120,6 +122,14 @@ void RKTestBufferOverviewText(const char *);
 void RKTestSweepRead(const char *);
 void RKTestProductRead(const char *);
 void RKTestProductWrite(void);
+void RKTestProductWriteConcurrently(void);
+void RKTestSweepFileStream(void);
+void RKTestSweepFileReaderRange(void);
+void RKTestVolumeCache(void);
+void RKTestRadarRelayScatter(void);
+void RKTestGridEngine(void);
+void RKTestCompositeEngine(void);
+void RKTestHealthRecords(void);
 void RKTestReviseLogicalValues(void);
 void RKTestReadIQ(const char *);
 
@@ -152,6 +162,15 @@ void RKTestPulseCompressionSpeed(void);
 void RKTestMomentProcessorSpeed(void);
 void RKTestCacheWrite(void);
 
+#pragma mark - Network Tests
+
+void RKTestServerWorkerPool(void);
+void RKTestServerGatherPackets(void);
+void RKTestServerCompression(void);
+void RKTestServerDropOldest(void);
+void RKTestResumeRayStream(void);
+void RKTestAggregateRayStreams(void);
+
 #pragma mark - Transceiver Emulator
 
 RKTransceiver RKTestTransceiverInit(RKRadar *, void *);
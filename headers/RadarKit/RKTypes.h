@@ -55,7 +55,7 @@
 
 #pragma mark - Constants
 
-#define RKRawDataBuildNo                     6                                 //
+#define RKRawDataBuildNo                     7                                 //
 #define RKBufferSSlotCount                   10                                // Status
 #define RKBufferCSlotCount                   10                                // Config
 #define RKBufferHSlotCount                   50                                // Health
@@ -75,6 +75,7 @@
 #define RKWorkerDutyCycleBufferDepth         1000                              //
 #define RKMaximumPulsesPerRay                2000                              //
 #define RKMaximumRaysPerSweep                1500                              // 1440 is 0.25-deg. This should be plenty
+#define RKMaximumSweepsPerVolume             32                                // Sweeps kept in one volume, a longer scan is split
 #define RKMaximumPacketSize                  16 * 1024 * 1024                  // Maximum network packet size
 #define RKNetworkTimeoutSeconds              20                                //
 #define RKNetworkReconnectSeconds            3                                 //
@@ -188,6 +189,14 @@ typedef struct rk_int16c {
     int16_t q;
 } RKInt16C;
 
+//
+// Fundamental unit of a (16-bit) + (16-bit) half precision complex IQ sample (IEEE 754 binary16)
+//
+typedef struct rk_float16c {
+    uint16_t i;
+    uint16_t q;
+} RKFloat16C;
+
 //
 // Interleaved complex format. Fundamental unit of a (float) + (float) raw complex IQ sample
 //
@@ -322,7 +331,12 @@ N(RKResultFailedToOpenFileForWriting) \
 N(RKResultRadarNotLive) \
 N(RKResultRawDataTypeUndefined) \
 N(RKResultNothingToRead) \
-N(RKResultNoRadar)
+N(RKResultNoRadar) \
+N(RKResultFailedToAllocateBuffer) \
+N(RKResultFailedToDecompress) \
+N(RKResultNoPulseIndex) \
+N(RKResultFailedToStartGridWorker) \
+N(RKResultFailedToStartRayWatcher)
 
 #define N(x) x,
 enum RKResult {
@@ -351,7 +365,10 @@ enum RKEngineColor {
     RKEngineColorMisc = 16,
     RKEngineColorEngineMonitor = 15,
     RKEngineColorConfig = 6,
-    RKEngineColorFFTModule = 15
+    RKEngineColorFFTModule = 15,
+    RKEngineColorGridEngine = 3,
+    RKEngineColorVolumeEngine = 14,
+    RKEngineColorCompositeEngine = 6
 };
 
 typedef uint32_t RKValueType;
@@ -468,7 +485,8 @@ typedef uint32_t RKHealthFlag;
 enum RKHealthFlag {
     RKHealthFlagVacant               = 0,
     RKHealthFlagReady                = 1,
-    RKHealthFlagUsed                 = (1 << 1)
+    RKHealthFlagUsed                 = (1 << 1),
+    RKHealthFlagDeferred             = (1 << 2)                                // The string is produced by the health engine when it is first read
 };
 
 typedef uint32_t RKMarker;
@@ -818,7 +836,8 @@ enum RKStream {
     RKStreamSweepZVWDPRKS                        = 0x01FF000000000000ULL,      //
     RKStreamSweepAll                             = 0x03FF000000000000ULL,      //
     RKStreamAlmostEverything                     = 0x03FF03FF03FFF000ULL,      // Don't use this.
-    RKStreamStatusTerminalChange                 = 0x0400000000000000ULL       // Change terminal size
+    RKStreamStatusTerminalChange                 = 0x0400000000000000ULL,      // Change terminal size
+    RKStreamVolume                               = 0x0800000000000000ULL       // Whole volumes from the volume cache
 };
 
 typedef uint8_t RKHostStatus;
@@ -836,6 +855,7 @@ enum RKProductStatus {
     RKProductStatusActive                        = (1 << 0),                   // This slot has been registered
     RKProductStatusBusy                          = (1 << 1),                   // Waiting for processing node
     RKProductStatusSkipped                       = (1 << 2),                   //
+    RKProductStatusView                          = (1 << 3),                   // Data is in the ray buffer, see RKProductInitViewFromSweep()
     RKProductStatusSleep0                        = (1 << 4),                   // Sleep stage 0 -
     RKProductStatusSleep1                        = (1 << 5),                   // Sleep stage 1 -
     RKProductStatusSleep2                        = (1 << 6),                   // Sleep stage 2 -
@@ -894,7 +914,22 @@ typedef uint8_t RKRawDataType;
 enum RKRawDataType {
     RKRawDataTypeNull,                                                         // No recording
     RKRawDataTypeFromTransceiver,                                              // Raw straight from the digital transceiver (RKInt16C)
-    RKRawDataTypeAfterMatchedFilter                                            // The I/Q samples after pulse compression (RKFloat)
+    RKRawDataTypeAfterMatchedFilter,                                           // The I/Q samples after pulse compression (RKFloat)
+    RKRawDataTypeAfterMatchedFilterInt16,                                      // After pulse compression, scaled per pulse (RKInt16C)
+    RKRawDataTypeAfterMatchedFilterFloat16                                     // After pulse compression, half precision (RKFloat16C)
+};
+
+typedef uint8_t RKRawDataFormat;
+enum RKRawDataFormat {
+    RKRawDataFormatPlain,                                                      // Pulse header and samples back to back
+    RKRawDataFormatBlockDeflate                                                // Pulses grouped into blocks, filtered and deflated (zlib), block index at the end
+};
+
+typedef uint8_t RKRawDataBlockFilter;
+enum RKRawDataBlockFilter {
+    RKRawDataBlockFilterNone          = 0,                                     // Block bytes as is
+    RKRawDataBlockFilterShuffle       = 1,                                     // Byte shuffle: byte k of every element is grouped together
+    RKRawDataBlockFilterDelta         = (1 << 1)                               // Delta of successive bytes (after shuffle if both are set)
 };
 
 #pragma mark - Structure Definitions
@@ -1222,9 +1257,31 @@ typedef struct rk_sweep_header {
 typedef struct rk_sweep {
     RKSweepHeader        header;
     RKBuffer             rayBuffer;
+    uint32_t             referenceCount;                                       // Holders of a shared sweep, see RKSweepEngineAcquireSweep()
     RKRay                *rays[RKMaximumRaysPerSweep];
 } RKSweep;
 
+//
+// Volume header
+//
+typedef struct rk_volume_header {
+    RKIdentifier         i;                                                    // Identifier of the volume
+    uint32_t             sweepCount;                                           // Number of sweeps
+    time_t               startTime;                                            // Start time of the first sweep
+    time_t               endTime;                                              // End time of the last sweep
+    bool                 complete;                                             // No more sweeps will be added
+} RKVolumeHeader;
+
+//
+// Volume
+//
+typedef struct rk_volume {
+    RKVolumeHeader       header;
+    uint32_t             referenceCount;                                       // Holders of a volume, see RKVolumeEngineAcquireVolume()
+    size_t               memoryUsage;                                          // Ray buffers of all the sweeps
+    RKSweep              *sweeps[RKMaximumSweepsPerVolume];                    // Immutable sweep snapshots in the order of collection
+} RKVolume;
+
 //
 // File header of raw I/Q data
 //
@@ -1244,13 +1301,61 @@ typedef union rk_file_header {
         RKName               preface;                                          // 128 B
         uint32_t             buildNo;                                          //   4 B
         RKRawDataType        dataType;                                         //   1 B
-        uint8_t              reserved[123];                                    // 123 B = 256 B
+        RKRawDataFormat      format;                                           //   1 B
+        RKRawDataBlockFilter blockFilter;                                      //   1 B
+        uint8_t              reserved1;                                        //   1 B
+        uint32_t             blockDepth;                                       //   4 B (pulses per block)
+        uint8_t              reserved[116];                                    // 116 B = 256 B
         RKRadarDesc          desc;                                             //
         RKConfig             config;                                           //
     };                                                                         //
     RKByte               bytes[4096];                                          //
 } RKFileHeader;
 
+//
+// Block of pulses in a RKRawDataFormatBlockDeflate file
+//
+typedef struct rk_raw_data_block_header {
+    uint32_t             pulseCount;                                           // Number of pulses in this block
+    RKRawDataBlockFilter filter;                                               // Pre-filter applied before deflate
+    uint8_t              elementSize;                                          // Element size used in byte shuffle
+    uint16_t             reserved;                                             //
+    uint32_t             pulseOrigin;                                          // Pulse number of the first pulse in the file
+    uint32_t             reserved2;                                            //
+    uint64_t             size;                                                 // Size of the block after inflate
+    uint64_t             compressedSize;                                       // Size of the deflated payload that follows
+} RKRawDataBlockHeader;
+
+typedef struct rk_raw_data_block_index {
+    uint64_t             offset;                                               // Offset of RKRawDataBlockHeader from the beginning of file
+    uint32_t             pulseOrigin;                                          // Pulse number of the first pulse in the file
+    uint32_t             pulseCount;                                           // Number of pulses in the block
+} RKRawDataBlockIndex;
+
+//
+// Block floating point scales of a RKRawDataTypeAfterMatchedFilterInt16 pulse, which follows RKPulseHeader
+//
+typedef struct rk_raw_data_pulse_scale {
+    float                scale[2];                                             // H and V, sample = RKInt16C x scale
+} RKRawDataPulseScale;
+
+typedef struct rk_raw_data_pulse_index {
+    uint64_t             offset;                                               // Offset of RKPulseHeader from the beginning of file (plain) or block (block)
+    double               timeDouble;                                           // Time in double representation
+    float                azimuthDegrees;                                       // Azimuth in degrees
+    float                elevationDegrees;                                     // Elevation in degrees
+} RKRawDataPulseIndex;
+
+//
+// The last 16 bytes of a raw data file with an index, e.g., tag = "RKBI" for an array of RKRawDataBlockIndex,
+// "RKPI" for an array of RKRawDataPulseIndex. An index may be preceded by another index and its trailer.
+//
+typedef struct rk_raw_data_trailer {
+    uint64_t             offset;                                               // Offset of the index array from the beginning of file
+    uint32_t             count;                                                // Number of elements
+    char                 tag[4];                                               // Four-character tag of the index
+} RKRawDataTrailer;
+
 //
 // Preference entry
 //
@@ -1401,6 +1506,7 @@ typedef struct rk_product {                                                    /
     RKFloat              *startElevation;                                      // Start elevation of each ray
     RKFloat              *endElevation;                                        // End elevation of each ray
     RKFloat              *data;                                                // Flattened array of user product
+    RKFloat              **rayData;                                            // Data of each ray in place if flag has RKProductStatusView
 } RKProduct;
 
 typedef struct rk_product_collection {
@@ -0,0 +1,60 @@
+//
+//  RKVolumeEngine.h
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#ifndef __RadarKit_VolumeEngine__
+#define __RadarKit_VolumeEngine__
+
+#include <RadarKit/RKFoundation.h>
+
+#define RKVolumeEngineDefaultDepth           0
+#define RKVolumeEngineMaximumDepth           16
+#define RKVolumeEngineDefaultMemoryLimit     (256 * 1024 * 1024)
+
+typedef struct rk_volume_engine RKVolumeEngine;
+
+struct rk_volume_engine {
+    // User set variables
+    RKName                           name;
+    uint8_t                          verbose;
+    uint8_t                          depth;                                    // Volumes to keep, 0 (default) to disable the cache
+    size_t                           memoryLimit;                              // Ray buffers of all the kept volumes
+    void                             *sweepOwner;                              // Reference counts of the sweeps, if not kept here
+    void                             (*sweepRetainer)(void *, RKSweep *);
+    void                             (*sweepReleaser)(void *, RKSweep *);
+
+    // Program set variables
+    pthread_mutex_t                  mutex;                                    // Guards the volumes and all the reference counts
+    RKVolume                         *volumes[RKVolumeEngineMaximumDepth];     // Oldest first, the last one is the current volume
+    uint8_t                          volumeCount;
+    RKIdentifier                     volumeId;                                 // Identifier of the next volume
+
+    // Status / health
+    uint32_t                         sweepCount;
+    size_t                           memoryUsage;
+};
+
+RKVolumeEngine *RKVolumeEngineInit(void);
+void RKVolumeEngineFree(RKVolumeEngine *);
+
+void RKVolumeEngineSetVerbose(RKVolumeEngine *, const int);
+void RKVolumeEngineSetDepth(RKVolumeEngine *, const uint8_t);
+void RKVolumeEngineSetMemoryLimit(RKVolumeEngine *, const size_t);
+void RKVolumeEngineSetSweepOwner(RKVolumeEngine *, void *, void (*)(void *, RKSweep *), void (*)(void *, RKSweep *));
+
+int RKVolumeEngineAddSweep(RKVolumeEngine *, RKSweep *);
+
+// Volumes must not be modified and must be returned through RKVolumeEngineReleaseVolume()
+RKVolume *RKVolumeEngineAcquireVolume(RKVolumeEngine *, const uint8_t age);
+RKVolume *RKVolumeEngineAcquireCompleteVolume(RKVolumeEngine *);
+RKVolume *RKVolumeEngineAcquireVolumeAtTime(RKVolumeEngine *, const time_t);
+int RKVolumeEngineReleaseVolume(RKVolumeEngine *, RKVolume *);
+
+RKSweep *RKVolumeGetSweepAtElevation(RKVolume *, const float elevation);
+RKSweep *RKVolumeGetSweepAtTime(RKVolume *, const time_t);
+
+#endif
@@ -56,6 +56,14 @@ classdef iqread
             if self.header.buildNo >= 5
                 self.header.dataType = fread(fid, 1, 'uint8');
             end
+
+            % Fourth component: (RKRawDataFormat format), only plain pulses are read here
+            if self.header.buildNo >= 7
+                self.header.format = fread(fid, 1, 'uint8');
+                if self.header.format ~= 0
+                    error('Block compressed raw data is not supported.');
+                end
+            end
             
             % Radar description: (RKRadarDesc desc)
             if self.header.buildNo >= 2
@@ -137,7 +145,7 @@ classdef iqread
             
             % Header->config
             if self.header.buildNo >= 5
-                if self.header.buildNo == 6
+                if self.header.buildNo >= 6
                     % (RKRadarDescOffset = 256) + (RKRadarDesc) --> RKConfig
                     offset = self.constants.RKRadarDescOffset + self.constants.RKRadarDesc;
                 else
@@ -202,7 +210,7 @@ classdef iqread
                 end
                 self.header.config.waveform = deblank(char(c3.data.waveform_raw));
                 self.header.config.vcpDefinition = deblank(char(c3.data.vcpDefinition_raw));
-                if self.header.buildNo == 6
+                if self.header.buildNo >= 6
                     % Read in RKWaveFileGlobalHeader
                     offset = self.constants.RKFileHeader;
                     w = memmapfile(self.filename, ...
@@ -371,6 +379,15 @@ classdef iqread
             capacity = fread(fid, 1, 'uint32');
             gateCount = fread(fid, 1, 'uint32');
             downSampledGateCount = fread(fid, 1, 'uint32');
+
+            % Pulse index trailer, if present, tells the number of pulses
+            fseek(fid, -16, 'eof');
+            fread(fid, 1, 'uint64');
+            count = fread(fid, 1, 'uint32');
+            tag = fread(fid, [1 4], 'char=>char');
+            if strcmp(tag, 'RKPI')
+                maxPulse = min(maxPulse, count);
+            end
             fclose(fid);
             fprintf('gateCount = %d   capacity = %d   downSampledGateCount = %d\n', gateCount, capacity, downSampledGateCount);
             
@@ -412,6 +429,65 @@ classdef iqread
                         'single', [1 1], 'elevationVelocityDegreesPerSecond'; ...
                         'single', [1 1], 'azimuthVelocityDegreesPerSecond'; ...
                         'single', [2 downSampledGateCount 2], 'iq'});
+            elseif self.header.dataType == 3
+                % Compressed I/Q in int16, each pulse has a scale for H and V
+                m = memmapfile(self.filename, ...
+                    'Offset', offset, ...
+                    'Repeat', maxPulse, ...
+                    'Format', { ...
+                        'uint64', [1 1], 'i'; ...
+                        'uint64', [1 1], 'n'; ...
+                        'uint64', [1 1], 't'; ...
+                        'uint32', [1 1], 's'; ...
+                        'uint32', [1 1], 'capacity'; ...
+                        'uint32', [1 1], 'gateCount'; ...
+                        'uint32', [1 1], 'downSampledGateCount'; ...
+                        'uint32', [1 1], 'marker'; ...
+                        'uint32', [1 1], 'pulseWidthSampleCount'; ...
+                        'uint64', [1 1], 'time_tv_sec'; ...
+                        'uint64', [1 1], 'time_tv_usec'; ...
+                        'double', [1 1], 'timeDouble'; ...
+                        'uint8',  [1 4], 'rawAzimuth'; ...
+                        'uint8',  [1 4], 'rawElevation'; ...
+                        'uint16', [1 1], 'configIndex'; ...
+                        'uint16', [1 1], 'configSubIndex'; ...
+                        'uint16', [1 1], 'azimuthBinIndex'; ...
+                        'single', [1 1], 'gateSizeMeters'; ...
+                        'single', [1 1], 'elevationDegrees'; ...
+                        'single', [1 1], 'azimuthDegrees'; ...
+                        'single', [1 1], 'elevationVelocityDegreesPerSecond'; ...
+                        'single', [1 1], 'azimuthVelocityDegreesPerSecond'; ...
+                        'single', [1 2], 'scale'; ...
+                        'int16',  [2 downSampledGateCount 2], 'iq'});
+            elseif self.header.dataType == 4
+                % Compressed I/Q in half precision
+                m = memmapfile(self.filename, ...
+                    'Offset', offset, ...
+                    'Repeat', maxPulse, ...
+                    'Format', { ...
+                        'uint64', [1 1], 'i'; ...
+                        'uint64', [1 1], 'n'; ...
+                        'uint64', [1 1], 't'; ...
+                        'uint32', [1 1], 's'; ...
+                        'uint32', [1 1], 'capacity'; ...
+                        'uint32', [1 1], 'gateCount'; ...
+                        'uint32', [1 1], 'downSampledGateCount'; ...
+                        'uint32', [1 1], 'marker'; ...
+                        'uint32', [1 1], 'pulseWidthSampleCount'; ...
+                        'uint64', [1 1], 'time_tv_sec'; ...
+                        'uint64', [1 1], 'time_tv_usec'; ...
+                        'double', [1 1], 'timeDouble'; ...
+                        'uint8',  [1 4], 'rawAzimuth'; ...
+                        'uint8',  [1 4], 'rawElevation'; ...
+                        'uint16', [1 1], 'configIndex'; ...
+                        'uint16', [1 1], 'configSubIndex'; ...
+                        'uint16', [1 1], 'azimuthBinIndex'; ...
+                        'single', [1 1], 'gateSizeMeters'; ...
+                        'single', [1 1], 'elevationDegrees'; ...
+                        'single', [1 1], 'azimuthDegrees'; ...
+                        'single', [1 1], 'elevationVelocityDegreesPerSecond'; ...
+                        'single', [1 1], 'azimuthVelocityDegreesPerSecond'; ...
+                        'uint16', [2 downSampledGateCount 2], 'iq'});
             else
                 % Raw I/Q straight from the transceiver
                 m = memmapfile(self.filename, ...
@@ -444,11 +520,28 @@ classdef iqread
             end
             self.pulses = m.Data;
 
+            % Reduced precision I/Q back to single
+            if self.header.dataType == 3 || self.header.dataType == 4
+                pulses = rmfield(self.pulses, 'iq');
+                for k = 1:numel(pulses)
+                    if self.header.dataType == 3
+                        pulses(k).iq = single(self.pulses(k).iq) .* reshape(self.pulses(k).scale, [1 1 2]);
+                    else
+                        pulses(k).iq = iqread.half2single(self.pulses(k).iq);
+                    end
+                end
+                self.pulses = pulses;
+            end
+
             % Convert dataType to string
             if self.header.dataType == 1
                 str = 'raw';
             elseif self.header.dataType == 2
                 str = 'compressed';
+            elseif self.header.dataType == 3
+                str = 'compressed int16';
+            elseif self.header.dataType == 4
+                str = 'compressed float16';
             else
                 str = 'unknown';
             end
@@ -460,4 +553,17 @@ classdef iqread
             end
         end
     end
+    methods (Static)
+        % IEEE 754 half precision (as uint16) to single
+        function y = half2single(x)
+            x = double(x);
+            s = 1 - 2 * floor(x / 32768);
+            e = mod(floor(x / 1024), 32);
+            m = mod(x, 1024);
+            y = s .* ((e > 0) .* (1 + m / 1024) .* 2 .^ (e - 15) + (e == 0) .* m / 1024 * 2 ^ -14);
+            y(e == 31) = inf * s(e == 31);
+            y(e == 31 & m > 0) = nan;
+            y = single(y);
+        end
+    end
 end
@@ -128,7 +128,7 @@ void proc(UserParams *arg) {
     const uint32_t rayCapacity = ((uint32_t)ceilf((float)fileHeader->desc.pulseCapacity / fileHeader->desc.pulseToRayRatio / (float)RKSIMDAlignSize)) * RKSIMDAlignSize;
     if (fileHeader->dataType == RKRawDataTypeFromTransceiver) {
         u32 = fileHeader->desc.pulseCapacity;
-    } else if (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter) {
+    } else if (RKRawDataSampleSize(fileHeader->dataType)) {
         u32 = (uint32_t)ceilf((float)rayCapacity * sizeof(int16_t) / RKSIMDAlignSize) * RKSIMDAlignSize / sizeof(int16_t);
     } else {
         RKLog("Error. Unable to handle dataType %d", fileHeader->dataType);
@@ -177,15 +177,28 @@ void proc(UserParams *arg) {
     }
     mem += bytes;
 
+    // Pulses are read through a reader, which handles plain and block-compressed files
+    long fpos = ftell(fid);
+    RKRawDataReader *reader = RKRawDataReaderInit(fid, fileHeader);
+    if (reader == NULL) {
+        exit(EXIT_FAILURE);
+    }
+
     if (arg->verbose) {
-        long fpos = ftell(fid);
         RKPulse *pulse = RKGetPulseFromBuffer(pulseBuffer, p);
-        RKReadPulseFromFileReference(pulse, fileHeader->dataType, fid);
+        RKRawDataReaderReadPulse(reader, pulse);
+        RKRawDataReaderFree(reader);
         fseek(fid, fpos, SEEK_SET);
+        reader = RKRawDataReaderInit(fid, fileHeader);
         RKLog(">fileHeader.preface = '%s'   buildNo = %d\n", fileHeader->preface, fileHeader->buildNo);
         RKLog(">fileHeader.dataType = '%s'\n",
                fileHeader->dataType == RKRawDataTypeFromTransceiver ? "Raw" :
-               (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter ? "Compressed" : "Unknown"));
+               (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter ? "Compressed" :
+                (fileHeader->dataType == RKRawDataTypeAfterMatchedFilterInt16 ? "Compressed, scaled int16" :
+                 (fileHeader->dataType == RKRawDataTypeAfterMatchedFilterFloat16 ? "Compressed, float16" : "Unknown"))));
+        if (reader->format == RKRawDataFormatBlockDeflate) {
+            RKLog(">fileHeader.format = 'Block deflate'   blockDepth = %u   blockFilter = %d\n", fileHeader->blockDepth, fileHeader->blockFilter);
+        }
         RKLog(">desc.name = '%s'\n", fileHeader->desc.name);
         RKLog(">desc.latitude, longitude = %.6f, %.6f\n", fileHeader->desc.latitude, fileHeader->desc.longitude);
         RKLog(">desc.pulseCapacity = %s\n", RKIntegerToCommaStyleString(fileHeader->desc.pulseCapacity));
@@ -294,7 +307,7 @@ void proc(UserParams *arg) {
     r = 0;    // total rays per sweep
     for (k = 0; k < RKRawDataRecorderDefaultMaximumRecorderDepth && more; k++) {
         RKPulse *pulse = RKGetPulseFromBuffer(pulseBuffer, p);
-        j = RKReadPulseFromFileReference(pulse, fileHeader->dataType, fid);
+        j = RKRawDataReaderReadPulse(reader, pulse);
         if (j == RKResultSuccess) {
             if (p == 0 && arg->verbose) {
                 RKLog("pulse[0].downSampledGateCount = %s\n", RKIntegerToCommaStyleString(pulse->header.downSampledGateCount));
@@ -465,16 +478,17 @@ void proc(UserParams *arg) {
     }
     if (arg->verbose) {
         RKLog("fpos = %s / %s   pulse count = %s   ray count = %s\n",
-              RKUIntegerToCommaStyleString(ftell(fid)), RKUIntegerToCommaStyleString(filesize),
+              RKUIntegerToCommaStyleString(reader->offset), RKUIntegerToCommaStyleString(filesize),
               RKIntegerToCommaStyleString(k),
               RKIntegerToCommaStyleString(r));
     }
-    if (ftell(fid) != filesize) {
+    if (reader->offset != (size_t)(reader->dataEndOffset ? reader->dataEndOffset : filesize)) {
         RKLog("Warning. There is leftover in the file.");
     } else if (r == 0) {
         RKLog("No rays generated. Perhaps this is a transition file.\n");
     }
 
+    RKRawDataReaderFree(reader);
     fclose(fid);
     free(fileHeader);
 
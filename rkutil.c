@@ -17,11 +17,13 @@ typedef struct user_params {
     RKName                   pedzyHost;
     RKName                   tweetaHost;
     RKName                   relayHost;
+    RKName                   multicastGroup;                                     // Multicast group[:port] of the display rays
     RKName                   ringFilter;
     RKName                   momentMethod;
     RKName                   goCommand;
     RKName                   stopCommand;
     RKName                   streams;
+    RKNetworkCompression     relayCompression;                                   // Compression to ask of the relayed hosts
     uint8_t                  verbose;                                            // Verbosity
     int                      port;                                               // Server port other than the default 10000
     int                      coresForPulseCompression;                           // Number of cores for pulse compression
@@ -35,6 +37,7 @@ typedef struct user_params {
     int                      recordLevel;                                        // Data recording (1 - moment + health logs only, 2 - everything)
     bool                     simulate;                                           // Run with transceiver simulator
     bool                     ignoreGPS;                                          // Ignore GPS from health relay
+    bool                     compressRawData;                                    // Record raw data in deflated blocks
     uint32_t                 ringFilterGateCount;                                // Number of range gates to apply ring filter
     float                    systemZCal[2];                                      // System calibration for Z
     float                    systemDCal;                                         // System calibration for D
@@ -93,6 +96,11 @@ static void showHelp() {
            "         Set styles of text to be empty. No color / underline. This should be set\n"
            "         for terminals that do not support color output through escape sequence.\n"
            "\n"
+           "  -E (--relay-compression) " UNDERLINE("mode") "\n"
+           "         Sets the compression a relay asks of its hosts, where " UNDERLINE("mode") " is one of\n"
+           "         none, fast or deflate. Pulses without compression are read straight into\n"
+           "         the pulse buffer. If not specified, the default is none.\n"
+           "\n"
            "  -f (--prf) " UNDERLINE("value") "\n"
            "         Sets the pulse repetition frequency (PRF) to " UNDERLINE("value") " in Hz.\n"
            "         If not specified, the default PRF is 1,000 Hz.\n"
@@ -109,6 +117,10 @@ static void showHelp() {
            "  -h (--help)\n"
            "         Shows this help text.\n"
            "\n"
+           "  -M (--multicast) " UNDERLINE("group[:port]") "\n"
+           "         Publishes the display rays to the multicast " UNDERLINE("group") ", e.g., " RKNetworkMulticastDefaultGroup ".\n"
+           "         If not specified, the default port is %d.\n"
+           "\n"
            "  -S (--system) " UNDERLINE("level") "\n"
            "         Sets the simulation to run one of the following levels:\n"
            "          1 - 5-MHz 2,000 gates\n"
@@ -120,6 +132,8 @@ static void showHelp() {
            "  -r (--relay) " UNDERLINE("host") " [symbols]\n"
            "         Runs as a relay and connect to remote " UNDERLINE("host") "\n"
            "         If [symbols] are supplied, they will be requested initially.\n"
+           "         Several hosts, separated by commas, are relayed as radars of their host names,\n"
+           "         e.g., -r radar1,radar2:10000 selected through command 'r radar1' or 'r *' for all.\n"
            "\n"
            "  -p (--pedzy-host)\n"
            "         Sets the host of pedzy pedestal controller.\n"
@@ -169,6 +183,7 @@ static void showHelp() {
            "\n\n"
            "%s (RadarKit %s)\n\n",
            name,
+           RKNetworkMulticastDefaultPort,
            RKTestByNumberDescription(9),
            name,
            RKVersionString());
@@ -335,6 +350,8 @@ static void updateSystemPreferencesFromControlFile(UserParams *user) {
     RKPreferenceGetValueOfKeyword(userPreferences, verb, "GoCommand",        &user->goCommand,           RKParameterTypeString, RKNameLength);
     RKPreferenceGetValueOfKeyword(userPreferences, verb, "StopCommand",      &user->stopCommand,         RKParameterTypeString, RKNameLength);
     RKPreferenceGetValueOfKeyword(userPreferences, verb, "IgnoreGPS",        &user->ignoreGPS,           RKParameterTypeBool, 1);
+    RKPreferenceGetValueOfKeyword(userPreferences, verb, "CompressRawData",  &user->compressRawData,     RKParameterTypeBool, 1);
+    RKPreferenceGetValueOfKeyword(userPreferences, verb, "MulticastGroup",   user->multicastGroup,       RKParameterTypeString, RKNameLength);
     
     // Shortcuts
     k = 0;
@@ -385,6 +402,8 @@ static void updateSystemPreferencesFromCommandLine(UserParams *user, int argc, c
         {"alarm"             , no_argument      , NULL, 'A'},    // ASCII 65 - 90 : A - Z
         {"clock"             , no_argument      , NULL, 'C'},
         {"dir"               , required_argument, NULL, 'D'},
+        {"relay-compression" , required_argument, NULL, 'E'},
+        {"multicast"         , required_argument, NULL, 'M'},
         {"port"              , required_argument, NULL, 'P'},
         {"system"            , required_argument, NULL, 'S'},
         {"test"              , required_argument, NULL, 'T'},
@@ -472,6 +491,21 @@ static void updateSystemPreferencesFromCommandLine(UserParams *user, int argc, c
                 strncpy(user->playbackFolder, RKPathStringByExpandingTilde(optarg), sizeof(user->playbackFolder));
                 RKLog("==> %s ==> %s\n", optarg, user->playbackFolder);
                 break;
+            case 'E':
+                if (!strcasecmp(optarg, "none") || !strcmp(optarg, "0")) {
+                    user->relayCompression = RKNetworkCompressionNone;
+                } else if (!strcasecmp(optarg, "fast") || !strcmp(optarg, "1")) {
+                    user->relayCompression = RKNetworkCompressionFast;
+                } else if (!strcasecmp(optarg, "deflate") || !strcmp(optarg, "2")) {
+                    user->relayCompression = RKNetworkCompressionDeflate;
+                } else {
+                    RKLog("Error. Unknown relay compression %s.\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'M':
+                strncpy(user->multicastGroup, optarg, sizeof(user->multicastGroup) - 1);
+                break;
             case 'P':
                 user->port = atoi(optarg);
                 break;
@@ -691,6 +725,9 @@ static void updateRadarParameters(UserParams *systemPreferences) {
                                   systemPreferences->coresForPulseRingFilter,
                                   systemPreferences->coresForMomentProcessor);
         RKSetRecordingLevel(myRadar, systemPreferences->recordLevel);
+        if (systemPreferences->compressRawData) {
+            RKSetRawDataFormat(myRadar, RKRawDataFormatBlockDeflate);
+        }
         RKSweepEngineSetFilesHandlingScript(myRadar->sweepEngine, "scripts/handlefiles.sh", RKScriptPropertyProduceTarXz);
         if (systemPreferences->diskUsageLimitGB) {
             RKLog("Setting disk usage limit to %s GB ...\n", RKIntegerToCommaStyleString(systemPreferences->diskUsageLimitGB));
@@ -795,7 +832,9 @@ static void handlePreferenceFileUpdate(void *in) {
 
 int main(int argc, const char **argv) {
 
-    int k;
+    int i, k;
+    char *c;
+    RKRadar *relays[RKCommandCenterMaxRadars];
     RKCommand cmd = "";
     char name[] = __FILE__;
     *strrchr(name, '.') = '\0';
@@ -855,6 +894,13 @@ int main(int argc, const char **argv) {
     RKCommandCenter *center = RKCommandCenterInit();
     RKCommandCenterSetVerbose(center, systemPreferences->verbose);
     RKCommandCenterSetPort(center, systemPreferences->port);
+    if (strlen(systemPreferences->multicastGroup)) {
+        char *c = strchr(systemPreferences->multicastGroup, ':');
+        if (c) {
+            *c++ = '\0';
+        }
+        RKCommandCenterSetMulticast(center, systemPreferences->multicastGroup, c ? atoi(c) : RKNetworkMulticastDefaultPort, RKBaseMomentListDisplayZVWDPRK);
+    }
     RKCommandCenterStart(center);
     RKCommandCenterAddRadar(center, myRadar);
 
@@ -958,18 +1004,57 @@ int main(int argc, const char **argv) {
 
     } else if (systemPreferences->desc.initFlags == RKInitFlagRelay) {
 
-        RKRadarRelaySetHost(myRadar->radarRelay, systemPreferences->relayHost);
+        // Every host is a radar of its own buffers, the first one is myRadar
+        char *host = strtok(systemPreferences->relayHost, ",");
+        RKRadarRelaySetHost(myRadar->radarRelay, host);
+        RKRadarRelaySetCompression(myRadar->radarRelay, systemPreferences->relayCompression);
+        k = 0;
+        while ((host = strtok(NULL, ",")) != NULL && k < RKCommandCenterMaxRadars - 1) {
+            RKRadarDesc desc = systemPreferences->desc;
+            strncpy(desc.name, host, RKNameLength - 1);
+            if ((c = strchr(desc.name, ':')) != NULL) {
+                *c = '\0';
+            }
+            relays[k] = RKInitWithDesc(desc);
+            if (relays[k] == NULL) {
+                RKLog("Error. Could not allocate a radar for %s.\n", host);
+                break;
+            }
+            RKSetVerbosity(relays[k], systemPreferences->verbose);
+            RKRadarRelaySetHost(relays[k]->radarRelay, host);
+            RKRadarRelaySetCompression(relays[k]->radarRelay, systemPreferences->relayCompression);
+            RKSetRecordingLevel(relays[k], 0);
+            RKCommandCenterAddRadar(center, relays[k]);
+            k++;
+        }
+        if (k) {
+            snprintf(myRadar->desc.name, RKNameLength, "%s", myRadar->radarRelay->host);
+            if ((c = strchr(myRadar->desc.name, ':')) != NULL) {
+                *c = '\0';
+            }
+        }
         RKSetRecordingLevel(myRadar, 0);
 
         // Assembly a string that describes streams
         if (strlen(systemPreferences->streams)) {
             RKRadarRelayUpdateStreams(myRadar->radarRelay, RKStreamFromString(systemPreferences->streams));
+            for (i = 0; i < k; i++) {
+                RKRadarRelayUpdateStreams(relays[i]->radarRelay, RKStreamFromString(systemPreferences->streams));
+            }
         }
         
-        // Radar going live, then wait indefinitely until something happens
+        // Radars going live, then wait indefinitely until something happens
+        for (i = 0; i < k; i++) {
+            RKGoLive(relays[i]);
+        }
         RKGoLive(myRadar);
         RKWaitWhileActive(myRadar);
-        
+
+        for (i = 0; i < k; i++) {
+            RKCommandCenterRemoveRadar(center, relays[i]);
+            RKFree(relays[i]);
+        }
+
     } else if (systemPreferences->desc.initFlags == RKInitFlagIQPlayback) {
 
         // Build a series of options for transceiver, only pass down the relevant parameters
@@ -0,0 +1,5 @@
+#!/bin/bash
+# usage: run.sh march
+cd /tmp/t/simd
+L=/root/.pyenv/versions/3.11.7/lib/python3.11/site-packages/netcdf4.libs
+gcc -std=gnu99 -O2 -g -w -D_GNU_SOURCE -march=$1 -fsanitize=address -I /root/repo/headers -I /tmp/stubs m.c /root/repo/source/RKSIMD.c /root/repo/source/RKTest.c /root/repo/source/RKRawDataFile.c -Wl,--allow-multiple-definition -L/tmp/stubs -lradarkitnc -lnetcdf -Wl,-rpath-link,$L -lz -lm -lpthread -lrt -o x_$1 && LD_LIBRARY_PATH=$L ASAN_OPTIONS=detect_leaks=0 ./x_$1 2>&1 | grep -i "fail\|pass\|ok\|x " | sed 's/\x1b\[[0-9;]*m//g' | tail -40
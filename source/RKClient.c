@@ -9,6 +9,7 @@
 //
 
 #include <RadarKit/RKClient.h>
+#include <RadarKit/RKRawDataFile.h>
 
 // Internal functions
 
@@ -22,7 +23,7 @@ void *theClient(void *in) {
     RKClient *C = (RKClient *)in;
 
     int r;
-    int k;
+    int j, k;
     int flags;
     int readCount, timeoutCount;
     struct timeval timeout;
@@ -40,6 +41,15 @@ void *theClient(void *in) {
     }
     void *delimiter = &C->netDelimiter;
     char *cbuf = (char *)buf;
+    void *zbuf = NULL;                // Compressed payload, then the scratch space to inflate it
+    void *dst;
+    void *dbuf = NULL;                // A datagram, then the packet being assembled
+    uint32_t assembledSize = 0;
+    RKNetDatagramHeader *datagramHeader;
+    struct ip_mreq membership;
+    struct iovec iov[RKClientMaximumScatterCount];
+    struct iovec *v;
+    int count;
 
     C->userPayload = buf;
 
@@ -72,7 +82,8 @@ void *theClient(void *in) {
         if (C->verbose > 1) {
             RKLog("%s Opening a %s socket ...\n", C->name,
                   C->type == RKNetworkSocketTypeTCP ? "TCP" :
-                  (C->type == RKNetworkSocketTypeUDP ? "UDP" : "(NULL)"));
+                  (C->type == RKNetworkSocketTypeUDP ? "UDP" :
+                  (C->type == RKNetworkSocketTypeMulticast ? "multicast" : "(NULL)")));
         }
         if (C->type == RKNetworkSocketTypeTCP) {
             if ((C->sd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
@@ -80,7 +91,7 @@ void *theClient(void *in) {
                 C->state = RKClientStateDisconnected;
                 return NULL;
             }
-        } else if (C->type == RKNetworkSocketTypeUDP) {
+        } else if (C->type == RKNetworkSocketTypeUDP || C->type == RKNetworkSocketTypeMulticast) {
             if ((C->sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
                 RKLog("%s Error. Unable to create a UDP socket.\n", C->name);
                 C->state = RKClientStateDisconnected;
@@ -128,27 +139,59 @@ void *theClient(void *in) {
         }
         pthread_mutex_unlock(&C->lock);
 
-        // Connect through the IP address and port number
-        if (C->verbose) {
-            RKLog("%s Connecting %s:%d ...\n", C->name, C->hostIP, C->port);
-        }
-        if ((r = connect(C->sd, (struct sockaddr *)&C->sa, sizeof(struct sockaddr))) < 0) {
-            // In progress is not a true failure
-            if (errno != EINPROGRESS) {
+        // Multicast: join the group instead of connecting to a server, nothing goes back to the sender
+        if (C->type == RKNetworkSocketTypeMulticast) {
+            r = 1;
+            setsockopt(C->sd, SOL_SOCKET, SO_REUSEADDR, &r, sizeof(r));
+            #if defined(SO_REUSEPORT)
+            setsockopt(C->sd, SOL_SOCKET, SO_REUSEPORT, &r, sizeof(r));
+            #endif
+            membership.imr_multiaddr.s_addr = inet_addr(C->hostIP);
+            membership.imr_interface.s_addr = htonl(INADDR_ANY);
+            C->sa.sin_addr.s_addr = htonl(INADDR_ANY);
+            if (bind(C->sd, (struct sockaddr *)&C->sa, sizeof(struct sockaddr_in)) < 0 ||
+                setsockopt(C->sd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+                RKLog("%s Error. Unable to join %s:%d   errno = %d (%s)\n", C->name, C->hostIP, C->port, errno, RKErrnoString(errno));
                 close(C->sd);
                 k = RKNetworkReconnectSeconds * 10;
                 do {
-                    if (C->verbose > 1 && k % 10 == 0) {
-                        RKLog("%s Connection failed (errno = %d). Retry in %d second%s ...\n", C->name, errno, k, k > 1 ? "s" : "");
-                    }
                     usleep(100000);
                 } while (k-- > 0 && C->state < RKClientStateDisconnecting);
                 continue;
             }
+            if (dbuf == NULL && (dbuf = malloc(RKNetworkMulticastDatagramSize + RKMaximumPacketSize)) == NULL) {
+                RKLog("%s Error. Unable to allocate space for datagrams.\n", C->name);
+                close(C->sd);
+                break;
+            }
+            if (C->verbose) {
+                RKLog("%s Joined %s:%d\n", C->name, C->hostIP, C->port);
+            }
+            assembledSize = 0;
+            C->datagramCount = 0;
+        } else {
+            // Connect through the IP address and port number
+            if (C->verbose) {
+                RKLog("%s Connecting %s:%d ...\n", C->name, C->hostIP, C->port);
+            }
+            if ((r = connect(C->sd, (struct sockaddr *)&C->sa, sizeof(struct sockaddr))) < 0) {
+                // In progress is not a true failure
+                if (errno != EINPROGRESS) {
+                    close(C->sd);
+                    k = RKNetworkReconnectSeconds * 10;
+                    do {
+                        if (C->verbose > 1 && k % 10 == 0) {
+                            RKLog("%s Connection failed (errno = %d). Retry in %d second%s ...\n", C->name, errno, k, k > 1 ? "s" : "");
+                        }
+                        usleep(100000);
+                    } while (k-- > 0 && C->state < RKClientStateDisconnecting);
+                    continue;
+                }
+            }
         }
 
         // Server is almost ready to receive (could still be in EINPROGRESS, then select() -> 0)
-        if (C->init) {
+        if (C->init && C->type != RKNetworkSocketTypeMulticast) {
             fid = NULL;
             FD_ZERO(&C->wfd);
             FD_ZERO(&C->efd);
@@ -204,6 +247,7 @@ void *theClient(void *in) {
             timeout.tv_sec = 0;
             timeout.tv_usec = 100000;
             readOkay = false;
+            C->scattered = false;
             r = select(C->sd + 1, &C->rfd, NULL, &C->efd, &timeout);
             if (C->verbose > 3 || FD_ISSET(C->sd, &C->efd)) {
                 RKLog("%s select() returned r = %d   FD_ISSET(rfd) = %d   FD_ISSET(efd) = %d   errno = %d.\n",
@@ -311,17 +355,80 @@ void *theClient(void *in) {
                             }
                             readOkay = true;
                             break;
-                        } else if (C->netDelimiter.size > RKMaximumPacketSize) {
+                        } else if (C->netDelimiter.size > RKMaximumPacketSize ||
+                                   (C->netDelimiter.subtype & RKNetDelimiterSubtypeDeflated && C->netDelimiter.decodedSize >= RKMaximumPacketSize)) {
                             RKLog("%s Error. Payload size = %s (type %d) is more than what I can handle.\n",
                                   C->name, RKIntegerToCommaStyleString(C->netDelimiter.size), C->netDelimiter.type);
                             readOkay = false;
                             break;
                         }
+                        // The payload may go straight to where it belongs, laid out by the scatter handler
+                        count = 0;
+                        if (C->scatter && !(C->netDelimiter.subtype & RKNetDelimiterSubtypeDeflated)) {
+                            count = C->scatter(C, iov, RKClientMaximumScatterCount);
+                            for (k = 0, j = 0; j < count; j++) {
+                                k += iov[j].iov_len;
+                            }
+                            if (count > 0 && k != C->netDelimiter.size) {
+                                RKLog("%s Error. Scatter handler laid out %s B for a payload of %s B.\n", C->name,
+                                      RKIntegerToCommaStyleString(k), RKIntegerToCommaStyleString(C->netDelimiter.size));
+                                count = 0;
+                            }
+                        }
+                        if (count > 0) {
+                            k = 0;
+                            v = iov;
+                            readCount = 0;
+                            while (readCount++ < C->timeoutSeconds * 100 && count > 0) {
+                                if ((r = (int)readv(C->sd, v, count)) > 0) {
+                                    k += r;
+                                    // Skip the iovecs that are filled, then advance into the partially filled one
+                                    while (count > 0 && r >= v->iov_len) {
+                                        r -= v->iov_len;
+                                        v++;
+                                        count--;
+                                    }
+                                    if (count > 0) {
+                                        v->iov_base = (uint8_t *)v->iov_base + r;
+                                        v->iov_len -= r;
+                                    }
+                                } else if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                                    RKLog("%s Error. Scattered read  size=%d  r=%d  k=%d  errno=%d (%s)\n",
+                                          C->name, C->netDelimiter.size, r, k, errno, RKErrnoString(errno));
+                                    break;
+                                } else {
+                                    usleep(10000);
+                                }
+                            }
+                            if (count > 0) {
+                                pthread_mutex_lock(&C->lock);
+                                if (C->state < RKClientStateDisconnecting) {
+                                    C->state = RKClientStateReconnecting;
+                                }
+                                pthread_mutex_unlock(&C->lock);
+                                break;
+                            }
+                            cbuf[0] = '\0';
+                            C->scattered = true;
+                            readOkay = true;
+                            break;
+                        }
+                        // A compressed payload goes to zbuf first
+                        if (C->netDelimiter.subtype & RKNetDelimiterSubtypeDeflated) {
+                            if (zbuf == NULL && (zbuf = malloc(2 * RKMaximumPacketSize)) == NULL) {
+                                RKLog("%s Error. Unable to allocate space for compressed payloads.\n", C->name);
+                                readOkay = false;
+                                break;
+                            }
+                            dst = zbuf;
+                        } else {
+                            dst = buf;
+                        }
                         // Now the actual payload
                         k = 0;
                         readCount = 0;
                         while (readCount++ < C->timeoutSeconds * 100) {
-                            if ((r = (int)read(C->sd, buf + k, C->netDelimiter.size - k)) > 0) {
+                            if ((r = (int)read(C->sd, dst + k, C->netDelimiter.size - k)) > 0) {
                                 #ifdef DEBUG_RKCLIENT
                                 RKLog("%s read() -> %d / %d / %d    readCount = %d / %d\n",
                                       C->name, r, C->netDelimiter.size - k,  C->netDelimiter.size, readCount, C->timeoutSeconds * 100);
@@ -358,11 +465,69 @@ void *theClient(void *in) {
                         }
                         printf("\n");
                         #endif
-                        // Add a NULL character to the end of payload
-                        cbuf[k] = '\0';
                         if (readCount >= C->timeoutSeconds * 1000) {
                             break;
                         }
+                        // Inflate so that the receive handler always sees the original payload
+                        if (dst == zbuf) {
+                            if (RKRawDataBlockDecode(buf, C->netDelimiter.decodedSize, zbuf, k, RKRawDataBlockFilterShuffle,
+                                                     C->netDelimiter.subtype & RKNetDelimiterSubtypeShuffleMask,
+                                                     zbuf + RKMaximumPacketSize) != RKResultSuccess) {
+                                RKLog("%s Error. Unable to decompress a payload of type %d.\n", C->name, C->netDelimiter.type);
+                                break;
+                            }
+                            k = C->netDelimiter.decodedSize;
+                            C->netDelimiter.size = k;
+                            C->netDelimiter.subtype = 0;
+                        }
+                        // Add a NULL character to the end of payload
+                        cbuf[k] = '\0';
+                        readOkay = true;
+                        break;
+
+                    case RKNetworkMessageFormatSequencedDatagram:
+
+                        // One datagram at a time, a packet is complete when all of its fragments arrive in sequence
+                        if ((r = (int)recv(C->sd, dbuf, RKNetworkMulticastDatagramSize, 0)) < (int)sizeof(RKNetDatagramHeader)) {
+                            if (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                                RKLog("%s Error. recv() returned %d   errno = %d (%s)\n", C->name, r, errno, RKErrnoString(errno));
+                                break;
+                            }
+                            continue;
+                        }
+                        datagramHeader = (RKNetDatagramHeader *)dbuf;
+                        if (C->datagramCount++ > 0 && datagramHeader->sequence != C->datagramSequence) {
+                            C->datagramLostCount += (uint32_t)(datagramHeader->sequence - C->datagramSequence);
+                            C->gapCount++;
+                            if (C->verbose > 1) {
+                                RKLog("%s Gap of %u datagram(s) before %u\n", C->name,
+                                      (uint32_t)(datagramHeader->sequence - C->datagramSequence), datagramHeader->sequence);
+                            }
+                        }
+                        C->datagramSequence = datagramHeader->sequence + 1;
+                        if (datagramHeader->offset == 0) {
+                            assembledSize = 0;
+                        }
+                        // Fragments of a packet that has lost some are ignored until the next packet
+                        if (datagramHeader->offset != assembledSize ||
+                            datagramHeader->size != r - sizeof(RKNetDatagramHeader) ||
+                            datagramHeader->packetSize < sizeof(RKNetDelimiter) ||
+                            datagramHeader->packetSize >= RKMaximumPacketSize ||
+                            datagramHeader->offset + datagramHeader->size > datagramHeader->packetSize) {
+                            assembledSize = 0;
+                            continue;
+                        }
+                        memcpy(dbuf + RKNetworkMulticastDatagramSize + assembledSize, dbuf + sizeof(RKNetDatagramHeader), datagramHeader->size);
+                        assembledSize += datagramHeader->size;
+                        if (assembledSize < datagramHeader->packetSize) {
+                            continue;
+                        }
+                        memcpy(delimiter, dbuf + RKNetworkMulticastDatagramSize, sizeof(RKNetDelimiter));
+                        k = assembledSize - sizeof(RKNetDelimiter);
+                        memcpy(buf, dbuf + RKNetworkMulticastDatagramSize + sizeof(RKNetDelimiter), k);
+                        cbuf[k] = '\0';
+                        C->netDelimiter.size = k;
+                        assembledSize = 0;
                         readOkay = true;
                         break;
 
@@ -411,7 +576,7 @@ void *theClient(void *in) {
                 // Send in a beacon signal
                 gettimeofday(&timeout, NULL);
                 timeout.tv_sec -= 2;
-                if (timercmp(&timeout, &previousBeaconTime, >=)) {
+                if (C->type != RKNetworkSocketTypeMulticast && timercmp(&timeout, &previousBeaconTime, >=)) {
                     FD_ZERO(&C->wfd);
                     FD_ZERO(&C->efd);
                     FD_SET(C->sd, &C->wfd);
@@ -455,6 +620,12 @@ void *theClient(void *in) {
         };
     } // Here comes ... will jump out if C->state >= RKClientStateDisconnecting
     free(buf);
+    if (zbuf) {
+        free(zbuf);
+    }
+    if (dbuf) {
+        free(dbuf);
+    }
 
     C->userPayload = NULL;
     C->state = RKClientStateDisconnected;
@@ -548,6 +719,13 @@ void RKClientSetCloseHandler(RKClient *C, int (*routine)(RKClient *)) {
     C->exit = routine;
 }
 
+// The handler is called after the delimiter of every packet of RKNetworkMessageFormatHeaderDefinedSize. It may return
+// up to RKClientMaximumScatterCount iovecs that add up to netDelimiter.size so that the payload is read straight into
+// them, or 0 to read into userPayload as usual. C->scattered tells the receive handler which one has happened
+void RKClientSetScatterHandler(RKClient *C, int (*routine)(RKClient *, struct iovec *, const int)) {
+    C->scatter = routine;
+}
+
 #pragma mark - Interactions
 
 void RKClientStart(RKClient *C, const bool waitForConnection) {
@@ -17,6 +17,628 @@ int socketTerminateHandler(RKOperator *);
 
 #pragma mark - Helper Functions
 
+// Encode a ray once for all the users of the same product / display streams, return through RKCommandCenterReleaseRayPacket()
+static RKRayPacket *RKCommandCenterAcquireRayPacket(RKCommandCenter *engine, const RKNetDelimiter *template, RKRay *ray, const uint32_t baseMomentList, const uint16_t downSamplingRatio) {
+    int i, j, k;
+    RKRayPacket *packet = NULL;
+
+    // Same order as it has always been on the wire
+    const RKBaseMomentIndex order[] = {
+        RKBaseMomentIndexZ, RKBaseMomentIndexV, RKBaseMomentIndexW, RKBaseMomentIndexD, RKBaseMomentIndexP,
+        RKBaseMomentIndexR, RKBaseMomentIndexK, RKBaseMomentIndexQ, RKBaseMomentIndexSh, RKBaseMomentIndexSv
+    };
+
+    pthread_mutex_lock(&engine->rayPacketMutex);
+
+    for (k = 0; k < RKCommandCenterRayPacketCount; k++) {
+        RKRayPacket *entry = &engine->rayPackets[k];
+        if (entry->ray == ray && entry->i == ray->header.i &&
+            entry->baseMomentList == baseMomentList && entry->downSamplingRatio == downSamplingRatio && entry->size) {
+            packet = entry;
+            break;
+        }
+    }
+    if (packet) {
+        packet->refCount++;
+        packet->tic = ++engine->rayPacketTic;
+        engine->rayPacketHitCount++;
+        pthread_mutex_unlock(&engine->rayPacketMutex);
+        return packet;
+    }
+
+    // Replace the least recently used one that nobody is sending
+    for (k = 0; k < RKCommandCenterRayPacketCount; k++) {
+        RKRayPacket *entry = &engine->rayPackets[k];
+        if (entry->refCount == 0 && (packet == NULL || entry->tic < packet->tic)) {
+            packet = entry;
+        }
+    }
+    if (packet == NULL) {
+        pthread_mutex_unlock(&engine->rayPacketMutex);
+        RKLog("%s Error. No vacant ray packet.\n", engine->name);
+        return NULL;
+    }
+
+    const bool display = baseMomentList & RKBaseMomentListDisplayAll;
+    const uint32_t momentList = baseMomentList & (display ? RKBaseMomentListDisplayAll : RKBaseMomentListProductAll);
+    const uint32_t gateCount = ray->header.gateCount / downSamplingRatio;
+    const uint32_t size = (uint32_t)(sizeof(RKNetDelimiter) + sizeof(RKRayHeader) +
+                                     __builtin_popcount(momentList) * gateCount * (display ? sizeof(uint8_t) : sizeof(float)));
+    if (packet->capacity < size) {
+        packet->buffer = realloc(packet->buffer, size);
+        if (packet->buffer == NULL) {
+            RKLog("%s Error. Unable to allocate a ray packet.\n", engine->name);
+            exit(EXIT_FAILURE);
+        }
+        engine->memoryUsage += size - packet->capacity;
+        packet->capacity = size;
+    }
+
+    // Delimiter and the header with only the selected products
+    RKNetDelimiter *delimiter = (RKNetDelimiter *)packet->buffer;
+    memcpy(delimiter, template, sizeof(RKNetDelimiter));
+    delimiter->type = RKNetworkPacketTypeRayDisplay;
+    delimiter->size = size - (uint32_t)sizeof(RKNetDelimiter);
+    RKRayHeader *header = (RKRayHeader *)(delimiter + 1);
+    memcpy(header, &ray->header, sizeof(RKRayHeader));
+    header->baseMomentList = baseMomentList;
+    header->gateCount = gateCount;
+    header->gateSizeMeters *= (float)downSamplingRatio;
+
+    // Down-sampled data
+    uint8_t *u8Data, *u8Packet = (uint8_t *)(header + 1);
+    float *f32Data, *f32Packet = (float *)(header + 1);
+    for (j = 0; j < sizeof(order) / sizeof(RKBaseMomentIndex); j++) {
+        if (!(momentList & (display ? (1 << order[j]) : (1 << (order[j] + 16))))) {
+            continue;
+        }
+        if (display) {
+            u8Data = RKGetUInt8DataFromRay(ray, order[j]);
+            for (i = 0, k = 0; i < gateCount; i++, k += downSamplingRatio) {
+                *u8Packet++ = u8Data[k];
+            }
+        } else {
+            f32Data = RKGetFloatDataFromRay(ray, order[j]);
+            for (i = 0, k = 0; i < gateCount; i++, k += downSamplingRatio) {
+                *f32Packet++ = f32Data[k];
+            }
+        }
+    }
+
+    packet->ray = ray;
+    packet->i = ray->header.i;
+    packet->baseMomentList = baseMomentList;
+    packet->downSamplingRatio = downSamplingRatio;
+    packet->size = size;
+    memset(packet->compressed, 0, sizeof(packet->compressed));
+    packet->refCount = 1;
+    packet->tic = ++engine->rayPacketTic;
+    engine->rayPacketMissCount++;
+
+    pthread_mutex_unlock(&engine->rayPacketMutex);
+
+    return packet;
+}
+
+static void RKCommandCenterReleaseRayPacket(RKCommandCenter *engine, RKRayPacket *packet) {
+    pthread_mutex_lock(&engine->rayPacketMutex);
+    packet->refCount--;
+    pthread_mutex_unlock(&engine->rayPacketMutex);
+}
+
+// Send an acquired ray packet, the payload is compressed once for each compression level and shared by all the users of that level
+static ssize_t RKCommandCenterSendRayPacket(RKCommandCenter *engine, RKOperator *O, RKRayPacket *packet, const uint8_t elementSize) {
+    const RKNetworkCompression compression = O->compression;
+    const void *payload = packet->buffer + sizeof(RKNetDelimiter);
+    const size_t size = packet->size - sizeof(RKNetDelimiter);
+
+    if (compression == RKNetworkCompressionNone || compression >= RKRayPacketCompressionCount || size < RKNetworkCompressionThreshold) {
+        return RKOperatorSendPackets(O, packet->buffer, (ssize_t)packet->size, NULL);
+    }
+
+    pthread_mutex_lock(&packet->lock);
+    if (!packet->compressed[compression]) {
+        const uint32_t capacity = (uint32_t)(RKRawDataBlockBound(size) + size);
+        if (packet->compressedCapacity[compression] < capacity) {
+            free(packet->compressedBuffer[compression]);
+            if ((packet->compressedBuffer[compression] = malloc(capacity)) == NULL) {
+                RKLog("%s Error. Unable to allocate a compressed ray packet.\n", engine->name);
+                exit(EXIT_FAILURE);
+            }
+            pthread_mutex_lock(&engine->rayPacketMutex);
+            engine->memoryUsage += capacity - packet->compressedCapacity[compression];
+            pthread_mutex_unlock(&engine->rayPacketMutex);
+            packet->compressedCapacity[compression] = capacity;
+        }
+        uint8_t *block = packet->compressedBuffer[compression];
+        packet->compressedSize[compression] = (uint32_t)RKServerCompressPayload(block, block + RKRawDataBlockBound(size), payload, size, elementSize, compression);
+        packet->compressed[compression] = true;
+    }
+    const uint32_t blockSize = packet->compressedSize[compression];
+    pthread_mutex_unlock(&packet->lock);
+
+    // The packet is held by the caller so the compressed form stays as it is until it is released
+    if (blockSize == 0) {
+        return RKOperatorSendPackets(O, packet->buffer, (ssize_t)packet->size, NULL);
+    }
+    return RKOperatorSendCompressedPacket(O, elementSize, packet->buffer, packet->compressedBuffer[compression], blockSize, size);
+}
+
+// Publish the display rays of the first radar to the multicast group, each one is encoded once for all viewers
+static void *RKCommandCenterMulticastRoutine(void *in) {
+    RKCommandCenter *engine = (RKCommandCenter *)in;
+
+    RKRay *ray;
+    RKRadar *radar = NULL;
+    RKRayPacket *packet;
+    RKNetDelimiter delimiter;
+    RKNetDatagramHeader header;
+    uint32_t index = 0, endIndex;
+    uint16_t downSamplingRatio = 1;
+
+    struct iovec iov[2];
+    struct msghdr msg;
+
+    memset(&delimiter, 0, sizeof(RKNetDelimiter));
+    delimiter.type = RKNetworkPacketTypeRayDisplay;
+    memset(&msg, 0, sizeof(struct msghdr));
+    msg.msg_name = &engine->multicastAddress;
+    msg.msg_namelen = sizeof(struct sockaddr_in);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(RKNetDatagramHeader);
+
+    RKLog("%s Multicast started.   %s:%d\n", engine->name, engine->multicastGroup, engine->multicastPort);
+
+    while (engine->multicastActive) {
+        if (engine->radarCount == 0 || engine->suspendHandler || !(engine->radars[0]->state & RKRadarStateLive)) {
+            radar = NULL;
+            usleep(100000);
+            continue;
+        }
+        // Same lag and down-sampling as the display streams of a user
+        if (engine->radars[0]->desc.initFlags & RKInitFlagSignalProcessor) {
+            endIndex = RKPreviousNModuloS(engine->radars[0]->rayIndex, 2 * engine->radars[0]->momentEngine->coreCount, engine->radars[0]->desc.rayBufferDepth);
+        } else {
+            endIndex = RKPreviousModuloS(engine->radars[0]->rayIndex, engine->radars[0]->desc.rayBufferDepth);
+        }
+        if (radar != engine->radars[0]) {
+            radar = engine->radars[0];
+            if (radar->desc.initFlags & RKInitFlagSignalProcessor) {
+                downSamplingRatio = (uint16_t)MAX(radar->desc.pulseCapacity / radar->desc.pulseToRayRatio / 500, 1);
+            } else {
+                downSamplingRatio = 1;
+            }
+            index = endIndex;
+        }
+        while (index != endIndex && engine->multicastActive) {
+            ray = RKGetRayFromBuffer(radar->rays, index);
+            index = RKNextModuloS(index, radar->desc.rayBufferDepth);
+            if (!(ray->header.s & RKRayStatusReady)) {
+                continue;
+            }
+            packet = RKCommandCenterAcquireRayPacket(engine, &delimiter, ray, engine->multicastMomentList, downSamplingRatio);
+            if (packet == NULL) {
+                continue;
+            }
+            header.packetSize = packet->size;
+            for (header.offset = 0; header.offset < packet->size; header.offset += header.size) {
+                header.size = MIN(RKNetworkMulticastFragmentSize, packet->size - header.offset);
+                header.sequence = engine->multicastSequence++;
+                iov[1].iov_base = packet->buffer + header.offset;
+                iov[1].iov_len = header.size;
+                if (sendmsg(engine->multicastSocket, &msg, 0) < 0 && engine->verbose > 1) {
+                    RKLog("%s Error. Unable to send a datagram.   errno = %d (%s)\n", engine->name, errno, RKErrnoString(errno));
+                }
+            }
+            RKCommandCenterReleaseRayPacket(engine, packet);
+            engine->multicastRayCount++;
+        }
+        usleep(10000);
+    }
+
+    RKLog("%s Multicast stopped.   rayCount = %s\n", engine->name, RKUIntegerToCommaStyleString(engine->multicastRayCount));
+
+    return NULL;
+}
+
+// Send the header and the moments of a ray in one packet, which may be compressed, moments[] is NULL terminated
+static ssize_t RKCommandCenterSendSweepRay(RKOperator *O, RKRayHeader *header, float **moments, const uint32_t gateCount) {
+    const ssize_t size = gateCount * sizeof(float);
+    O->delimTx.type = RKNetworkPacketTypeSweepRay;
+    return RKOperatorSendCompressiblePackets(O, sizeof(float), &O->delimTx, header, sizeof(RKRayHeader),
+                                             moments[0], size, moments[1], size, moments[2], size, moments[3], size, moments[4], size,
+                                             moments[5], size, moments[6], size, moments[7], size, moments[8], size, moments[9], size,
+                                             NULL);
+}
+
+// e 0 - none, e 1 - fast, e 2 - deflate
+static void setCompression(RKCommandCenter *engine, RKOperator *O, const char *commandString) {
+    RKUser *user = &engine->users[O->iid];
+    int k = atoi(commandString + 1);
+    if (k < RKNetworkCompressionNone || k > RKNetworkCompressionDeflate) {
+        sprintf(user->commandResponse, "NAK. Unknown compression %d." RKEOL, k);
+    } else {
+        RKOperatorSetCompression(O, (RKNetworkCompression)k);
+        RKLog("%s %s Compression set to %s.\n", engine->name, O->name,
+              k == RKNetworkCompressionDeflate ? "deflate" : (k == RKNetworkCompressionFast ? "fast" : "none"));
+        sprintf(user->commandResponse, "ACK. Compression set to %d." RKEOL, k);
+    }
+    RKOperatorSendCommandResponse(O, user->commandResponse);
+}
+
+static void setResume(RKCommandCenter *engine, RKOperator *O, const char *commandString) {
+    RKUser *user = &engine->users[O->iid];
+    RKIdentifier identifier = (RKIdentifier)strtoull(commandString + 1, NULL, 10);
+    pthread_mutex_lock(&user->mutex);
+    user->resumeIdentifier = identifier;
+    pthread_mutex_unlock(&user->mutex);
+    sprintf(user->commandResponse, "ACK. Resume after ray %" PRIu64 "." RKEOL, identifier);
+    RKOperatorSendCommandResponse(O, user->commandResponse);
+}
+
+// Most connections only send commands, the stream buffers are allocated when a user first subscribes to something
+static int RKCommandCenterAllocateStreamBuffers(RKCommandCenter *engine, RKOperator *O, RKUser *user) {
+    if (user->string == NULL) {
+        user->string = (char *)malloc(RKMaximumPacketSize);
+    }
+    if (user->scratch == NULL) {
+        user->scratch = (char *)malloc(RKMaximumPacketSize);
+    }
+    if (user->samples[0] == NULL) {
+        user->samples[0] = (RKInt16C *)malloc(2 * RKMaximumGateCount * sizeof(RKInt16C));
+        user->samples[1] = user->samples[0] ? user->samples[0] + RKMaximumGateCount : NULL;
+    }
+    if (user->string == NULL || user->scratch == NULL || user->samples[0] == NULL) {
+        RKLog("%s %s Error. Unable to allocate stream buffers.\n", engine->name, O->name);
+        return RKResultFailedToAllocateBuffer;
+    }
+    return RKResultSuccess;
+}
+
+static void RKCommandCenterFreeUserBuffers(RKUser *user) {
+    free(user->string);
+    free(user->scratch);
+    free(user->commandResponse);
+    free(user->samples[0]);
+    user->string = NULL;
+    user->scratch = NULL;
+    user->commandResponse = NULL;
+    user->samples[0] = NULL;
+    user->samples[1] = NULL;
+}
+
+static uint16_t RKCommandCenterRadarIndex(RKCommandCenter *engine, RKRadar *radar) {
+    uint16_t k;
+    for (k = 0; k < engine->radarCount; k++) {
+        if (engine->radars[k] == radar) {
+            return k;
+        }
+    }
+    return 0;
+}
+
+// The first ray after the one the user has resumed from, or endIndex if there is none. The rays are found by
+// identifiers, not by index, since a relay keeps the identifiers of its upstream
+static uint32_t RKCommandCenterResumeRayIndex(RKCommandCenter *engine, RKOperator *O, RKRadar *radar, const uint32_t endIndex) {
+    RKUser *user = &engine->users[O->iid];
+    const RKIdentifier identifier = user->resumeIdentifier;
+    if (identifier == 0) {
+        return endIndex;
+    }
+    user->resumeIdentifier = 0;
+    RKRay *ray;
+    uint32_t k = endIndex;
+    uint32_t index = endIndex;
+    uint32_t count = 0;
+    const uint32_t depth = radar->desc.rayBufferDepth;
+    while (count < depth - 1) {
+        k = RKPreviousModuloS(k, depth);
+        ray = RKGetRayFromBuffer(radar->rays, k);
+        if (!(ray->header.s & RKRayStatusReady) || ray->header.i <= identifier) {
+            break;
+        }
+        index = k;
+        count++;
+    }
+    ray = RKGetRayFromBuffer(radar->rays, index);
+    if (count == 0) {
+        RKLog("%s %s Resuming after ray %s, nothing to replay.\n", engine->name, O->name,
+              RKUIntegerToCommaStyleString(identifier));
+    } else if (ray->header.i == identifier + 1) {
+        RKLog("%s %s Resuming after ray %s, replaying %s rays.\n", engine->name, O->name,
+              RKUIntegerToCommaStyleString(identifier), RKIntegerToCommaStyleString(count));
+    } else {
+        RKLog("%s %s Resuming after ray %s, replaying %s rays, %s rays are no longer in the buffer.\n", engine->name, O->name,
+              RKUIntegerToCommaStyleString(identifier), RKIntegerToCommaStyleString(count),
+              RKUIntegerToCommaStyleString(ray->header.i - identifier - 1));
+    }
+    return index;
+}
+
+// Product or display rays of a radar up to the latest one, every packet is tagged with the radar index as the source.
+// When start is set, streaming begins at the latest ray, or after the ray the user has resumed from. Nothing waits for
+// the latest ray to be ready, false is returned and the stream starts or continues in the next pass of the handler
+static bool RKCommandCenterStreamRays(RKCommandCenter *engine, RKOperator *O, RKRadar *radar, uint32_t *rayIndex, const uint16_t source, const bool start) {
+    RKUser *user = &engine->users[O->iid];
+
+    uint32_t endIndex;
+    uint32_t count = 0;
+
+    RKRay *ray;
+    RKRayHeader rayHeader;
+    RKRayPacket *packet;
+
+    if (!(radar->state & RKRadarStateLive)) {
+        return false;
+    }
+
+    O->delimTx.source = source;
+
+    if (user->streams & user->access & RKStreamProductAll) {
+        #pragma mark Product Streams
+        RKOperatorSetSendPolicy(O, RKOperatorSendPolicyBlock);
+        // Product streams - assume no display as display data can be derived later
+        if (radar->desc.initFlags & RKInitFlagSignalProcessor) {
+            endIndex = RKPreviousNModuloS(radar->rayIndex, 2 * radar->momentEngine->coreCount, radar->desc.rayBufferDepth);
+        } else {
+            endIndex = RKPreviousModuloS(radar->rayIndex, radar->desc.rayBufferDepth);
+        }
+        ray = RKGetRayFromBuffer(radar->rays, endIndex);
+
+        if (start && user->combined) {
+            // Rays of all radars start together, each at its latest ray whether that is ready or not
+            *rayIndex = endIndex;
+            user->replaying = false;
+        }
+
+        if (!(ray->header.s & RKRayStatusReady) || engine->server->state != RKServerStateActive) {
+            if ((int)ray->header.i > 0 && engine->verbose > 1) {
+                RKLog("%s %s No product ray / deactivated.  streamsInProgress = 0x%08x\n",
+                      engine->name, O->name, user->streamsInProgress);
+            }
+            return false;
+        }
+
+        if (start && !user->combined) {
+            *rayIndex = RKCommandCenterResumeRayIndex(engine, O, radar, endIndex);
+            user->replaying = *rayIndex != endIndex;
+            if (engine->verbose) {
+                RKLog("%s %s Streaming RKRay products -> %d.\n", engine->name, O->name, endIndex);
+            }
+        }
+
+        // A replay goes out in chunks so that the send queue does not swell and other streams get their turn
+        while (*rayIndex != endIndex && !(user->replaying && count == RKCommandCenterReplayRayCount)) {
+            count++;
+            ray = RKGetRayFromBuffer(radar->rays, *rayIndex);
+            // Duplicate and send the header with only selected products
+            memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
+            // Gather the products to be sent
+            rayHeader.baseMomentList = RKBaseMomentListNone;
+            if (user->streams & RKStreamProductZ) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductZ;
+            }
+            if (user->streams & RKStreamProductV) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductV;
+            }
+            if (user->streams & RKStreamProductW) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductW;
+            }
+            if (user->streams & RKStreamProductD) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductD;
+            }
+            if (user->streams & RKStreamProductP) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductP;
+            }
+            if (user->streams & RKStreamProductR) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductR;
+            }
+            if (user->streams & RKStreamProductK) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductK;
+            }
+            if (user->streams & RKStreamProductQ) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductQ;
+            }
+            if (user->streams & RKStreamProductSh) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductSh;
+            }
+            if (user->streams & RKStreamProductSv) {
+                rayHeader.baseMomentList |= RKBaseMomentListProductSv;
+            }
+            // Encoded once and shared with every user of the same products
+            packet = RKCommandCenterAcquireRayPacket(engine, &O->delimTx, ray, rayHeader.baseMomentList, user->rayDownSamplingRatio);
+            if (packet) {
+                RKCommandCenterSendRayPacket(engine, O, packet, sizeof(float));
+                RKCommandCenterReleaseRayPacket(engine, packet);
+            }
+            ray->header.s |= RKRayStatusStreamed;
+            *rayIndex = RKNextModuloS(*rayIndex, radar->desc.rayBufferDepth);
+        }
+        if (*rayIndex == endIndex) {
+            user->replaying = false;
+        }
+    } else if (user->streams & user->access & RKStreamDisplayZVWDPRKS) {
+        #pragma mark Display Streams
+        RKOperatorSetSendPolicy(O, user->replaying ? RKOperatorSendPolicyBlock : RKOperatorSendPolicyDropOldest);
+        // Display streams - no skipping
+        if (radar->desc.initFlags & RKInitFlagSignalProcessor) {
+            endIndex = RKPreviousNModuloS(radar->rayIndex, 2 * radar->momentEngine->coreCount, radar->desc.rayBufferDepth);
+        } else {
+            endIndex = RKPreviousModuloS(radar->rayIndex, radar->desc.rayBufferDepth);
+        }
+        if (endIndex >= radar->desc.rayBufferDepth) {
+            RKLog("%s Error. endIndex = %s >= %s\n", engine->name, RKIntegerToCommaStyleString(endIndex), RKIntegerToCommaStyleString(radar->desc.rayBufferDepth));
+            RKLog("%s radar->rayIndex = %s / radar->desc.rayBufferDepth = %s", engine->name,
+                  RKIntegerToCommaStyleString(radar->rayIndex),
+                  RKIntegerToCommaStyleString(radar->desc.rayBufferDepth));
+            endIndex = 0;
+        }
+        ray = RKGetRayFromBuffer(radar->rays, endIndex);
+
+        if (start && user->combined) {
+            // Rays of all radars start together, each at its latest ray whether that is ready or not
+            *rayIndex = endIndex;
+            user->replaying = false;
+        }
+
+        if (!(ray->header.s & RKRayStatusReady) || engine->server->state != RKServerStateActive) {
+            if ((int)ray->header.i > 0 && engine->verbose > 1) {
+                RKLog("%s %s No display ray / deactivated.  *rayIndex = %d   endIndex = %d  %lld\n",
+                      engine->name, O->name, *rayIndex, endIndex, ray->header.i);
+            }
+            return false;
+        }
+
+        if (start && !user->combined) {
+            *rayIndex = RKCommandCenterResumeRayIndex(engine, O, radar, endIndex);
+            user->replaying = *rayIndex != endIndex;
+            if (user->replaying) {
+                // Rays of a replay are not to be dropped
+                RKOperatorSetSendPolicy(O, RKOperatorSendPolicyBlock);
+            }
+            if (engine->verbose) {
+                RKLog("%s %s Streaming RKRay displays -> %d.\n", engine->name, O->name, endIndex);
+            }
+        }
+
+        // A replay goes out in chunks so that the send queue does not swell and other streams get their turn
+        while (*rayIndex != endIndex && !(user->replaying && count == RKCommandCenterReplayRayCount)) {
+            count++;
+            ray = RKGetRayFromBuffer(radar->rays, *rayIndex);
+            // Duplicate and send the header with only selected products
+            memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
+            // Gather the products to be sent
+            rayHeader.baseMomentList = RKBaseMomentListNone;
+            if (user->streams & RKStreamDisplayZ) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayZ;
+            }
+            if (user->streams & RKStreamDisplayV) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayV;
+            }
+            if (user->streams & RKStreamDisplayW) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayW;
+            }
+            if (user->streams & RKStreamDisplayD) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayD;
+            }
+            if (user->streams & RKStreamDisplayP) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayP;
+            }
+            if (user->streams & RKStreamDisplayR) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayR;
+            }
+            if (user->streams & RKStreamDisplayK) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayK;
+            }
+            if (user->streams & RKStreamDisplayQ) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplayQ;
+            }
+            if (user->streams & RKStreamDisplaySh) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplaySh;
+            }
+            if (user->streams & RKStreamDisplaySv) {
+                rayHeader.baseMomentList |= RKBaseMomentListDisplaySv;
+            }
+            // Encoded once and shared with every user of the same displays
+            packet = RKCommandCenterAcquireRayPacket(engine, &O->delimTx, ray, rayHeader.baseMomentList, user->rayDownSamplingRatio);
+            if (packet) {
+                RKCommandCenterSendRayPacket(engine, O, packet, sizeof(uint8_t));
+                RKCommandCenterReleaseRayPacket(engine, packet);
+            }
+            ray->header.s |= RKRayStatusStreamed;
+            *rayIndex = RKNextModuloS(*rayIndex, radar->desc.rayBufferDepth);
+        } // while (*rayIndex != endIndex) ...
+        if (user->replaying && *rayIndex == endIndex) {
+            // Caught up, live displays may drop again
+            user->replaying = false;
+            RKOperatorSetSendPolicy(O, RKOperatorSendPolicyDropOldest);
+        }
+    } // else if (user->streams & user->access & RKStreamDisplayZVWDPRKS) ...
+    return true;
+}
+
+// User products of the latest sweep come back as a header and the data of each product. What has arrived is taken without
+// waiting, the rest in the next passes of the stream handler. The sweep is released once all of them are in
+static void RKCommandCenterReceiveUserProducts(RKCommandCenter *engine, RKOperator *O, RKUser *user) {
+    int k;
+    ssize_t size;
+    double deltaTx, deltaRx;
+    struct timeval timevalRx;
+
+    RKSweep *sweep = user->productSweep;
+    RKProduct *product;
+    RKProductId productId;
+    RKIdentifier identifier;
+
+    while (user->productPayloadIndex < 2 * user->productCount && O->state == RKOperatorStateActive) {
+        k = user->productPayloadIndex / 2;
+        if (user->productPayloadIndex % 2 == 0) {
+            size = RKOperatorReceivePayload(O, user->string, RKMaximumPacketSize);
+            if (size < 0) {
+                break;
+            }
+            RKLog(">%s %s Received return from algorithm key = %d for productId = %d ...\n",
+                  engine->name, O->name, user->productDescriptions[k].key, user->productIds[k]);
+            productId = RKProductIdFromString(RKGetValueOfKey(user->string, "productId"));
+            identifier = RKIdentifierFromString(RKGetValueOfKey(user->string, "configId"));
+            user->productInTransit = NULL;
+            if (user->productIds[k] != productId) {
+                RKLog("%s %s Warning. Inconsistent productId = %d (expected) != %d (reported)\n", engine->name, O->name, user->productIds[k], productId);
+            } else if (sweep->header.config.i != identifier) {
+                RKLog("%s %s Warning. Inconsistent configId = %lu (expected) != %lu (reported)\n", engine->name, O->name, sweep->header.config.i, identifier);
+            } else if ((product = RKSweepEngineGetVacantProduct(user->radar->sweepEngine, sweep, productId)) != NULL) {
+                // Transfer important meta data and prepare the necessary buffer size
+                RKProductInitFromSweep(product, sweep);
+                user->productInTransit = product;
+                if (user->radar->sweepEngine->verbose > 1) {
+                    RKLog("%s %s %s (%d) -> %u %zu\n",
+                          engine->name, O->name, user->string, strlen(user->string), productId, identifier);
+                }
+            } else {
+                // Still need to consume the data so it goes to a scratch space
+                RKLog("Warning. Unable to retrieve storage for incoming sweep.\n");
+            }
+        } else {
+            product = user->productInTransit;
+            if (product) {
+                size = RKOperatorReceivePayload(O, product->data, product->capacity * sizeof(RKFloat));
+            } else {
+                size = RKOperatorReceivePayload(O, user->scratch, RKMaximumPacketSize);
+            }
+            if (size < 0) {
+                break;
+            }
+            if (product) {
+                RKShowArray(product->data, product->desc.symbol, product->header.gateCount, product->header.rayCount);
+                RKSweepEngineSetProductComplete(user->radar->sweepEngine, sweep, product);
+                user->productInTransit = NULL;
+            }
+        }
+        user->productPayloadIndex++;
+    }
+
+    gettimeofday(&timevalRx, NULL);
+    if (user->productPayloadIndex < 2 * user->productCount) {
+        if (O->state == RKOperatorStateActive && RKTimevalDiff(timevalRx, user->productTimevalTx) < (double)O->timeoutSeconds) {
+            return;
+        }
+        RKLog("%s %s Error. Received %d of %d user product payloads.\n", engine->name, O->name,
+              user->productPayloadIndex, 2 * user->productCount);
+        RKOperatorExpectPayloads(O, 0);
+    } else {
+        deltaTx = 1.0e3 * RKTimevalDiff(user->productTimevalTx, user->productTimevalOrigin);
+        deltaRx = 1.0e3 * RKTimevalDiff(timevalRx, user->productTimevalTx);
+        RKLog("%s %s Round trip finished   %s ms   %s ms\n", engine->name, O->name,
+              RKVariableInString("tx", &deltaTx, RKValueTypeDouble),
+              RKVariableInString("rx", &deltaRx, RKValueTypeDouble));
+    }
+    RKSweepEngineReleaseSweep(user->radar->sweepEngine, sweep);
+    user->productSweep = NULL;
+    user->productInTransit = NULL;
+}
+
 static void consolidateStreams(RKCommandCenter *engine) {
 
     int j, k;
@@ -36,12 +658,63 @@ static void consolidateStreams(RKCommandCenter *engine) {
             RKUser *user = &engine->users[k];
             if (radar == user->radar) {
                 consolidatedStreams |= user->streams;
+            } else if (user->combined) {
+                consolidatedStreams |= user->streams & (RKStreamProductAll | RKStreamDisplayZVWDPRKS);
             }
         }
         RKRadarRelayUpdateStreams(radar->radarRelay, consolidatedStreams);
     }
 }
 
+// Select a radar by name for the streams and commands, or '*' for the product / display rays of all the radars
+static void selectRadar(RKCommandCenter *engine, RKOperator *O, const char *commandString) {
+    int k;
+    RKUser *user = &engine->users[O->iid];
+    char name[RKMaximumCommandLength];
+
+    if (sscanf(commandString + 1, "%s", name) != 1) {
+        sprintf(user->commandResponse, "NAK. Radar name is needed." RKEOL);
+        RKOperatorSendCommandResponse(O, user->commandResponse);
+        return;
+    }
+    if (!strcmp(name, "*")) {
+        pthread_mutex_lock(&user->mutex);
+        for (k = 0; k < engine->radarCount; k++) {
+            user->rayIndices[k] = RKPreviousModuloS(engine->radars[k]->rayIndex, engine->radars[k]->desc.rayBufferDepth);
+        }
+        user->combined = true;
+        user->streamsInProgress = RKStreamNull;
+        pthread_mutex_unlock(&user->mutex);
+        RKLog("%s %s Selected all %d radars.\n", engine->name, O->name, engine->radarCount);
+        snprintf(user->commandResponse, RKMaximumPacketSize - 1, "ACK. All %d radars selected." RKEOL, engine->radarCount);
+    } else {
+        for (k = 0; k < engine->radarCount; k++) {
+            if (!strcmp(engine->radars[k]->desc.name, name)) {
+                break;
+            }
+        }
+        if (k == engine->radarCount) {
+            snprintf(user->commandResponse, RKMaximumPacketSize - 1, "NAK. Radar %s not found." RKEOL, name);
+            RKOperatorSendCommandResponse(O, user->commandResponse);
+            return;
+        }
+        RKRadar *radar = engine->radars[k];
+        pthread_mutex_lock(&user->mutex);
+        user->radar = radar;
+        user->combined = false;
+        user->statusIndex = RKPreviousModuloS(radar->statusIndex, radar->desc.statusBufferDepth);
+        user->healthIndex = RKPreviousModuloS(radar->healthIndex, radar->desc.healthBufferDepth);
+        user->pulseIndex = RKPreviousModuloS(radar->pulseIndex, radar->desc.pulseBufferDepth);
+        user->rayIndex = RKPreviousModuloS(radar->rayIndex, radar->desc.rayBufferDepth);
+        user->streamsInProgress = RKStreamNull;
+        pthread_mutex_unlock(&user->mutex);
+        RKLog("%s %s Selected radar %s (%d / %d).\n", engine->name, O->name, name, k + 1, engine->radarCount);
+        snprintf(user->commandResponse, RKMaximumPacketSize - 1, "ACK. %s selected." RKEOL, name);
+    }
+    consolidateStreams(engine);
+    RKOperatorSendCommandResponse(O, user->commandResponse);
+}
+
 #pragma mark - Handlers
 
 int socketCommandHandler(RKOperator *O) {
@@ -177,12 +850,22 @@ int socketCommandHandler(RKOperator *O) {
                     RKOperatorSendCommandResponse(O, user->commandResponse);
                     break;
 
+                case 'e':
+                    // Compression of the streams
+                    setCompression(engine, O, commandString);
+                    break;
+
                 case 'i':
                     O->delimTx.type = RKNetworkPacketTypeRadarDescription;
                     O->delimTx.size = (uint32_t)sizeof(RKRadarDesc);
                     RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &user->radar->desc, sizeof(RKRadarDesc), NULL);
                     break;
 
+                case 'k':
+                    // Resume the ray streams after an identifier
+                    setResume(engine, O, commandString);
+                    break;
+
                 case 'q':
                     sprintf(user->commandResponse, "Bye." RKEOL);
                     RKOperatorSendCommandResponse(O, user->commandResponse);
@@ -230,6 +913,7 @@ int socketCommandHandler(RKOperator *O) {
                     user->streamsInProgress = RKStreamNull;
                     user->rayStatusIndex = RKPreviousModuloS(user->radar->momentEngine->rayStatusBufferIndex, RKBufferSSlotCount);
                     user->scratchSpaceIndex = user->radar->sweepEngine->scratchSpaceIndex;
+                    user->volumeId = 0;
                     user->ticForStatusStream = 0;
                     pthread_mutex_unlock(&user->mutex);
                     sprintf(user->commandResponse, "{\"type\": \"init\", \"access\": 0x%016lx, \"streams\": 0x%lx, \"indices\": [%d, %d]}" RKEOL,
@@ -279,13 +963,11 @@ int socketCommandHandler(RKOperator *O) {
                     O->delimTx.type = RKNetworkPacketTypeControls;
                     O->delimTx.size = (uint32_t)strlen(user->commandResponse);
                     RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), user->commandResponse, O->delimTx.size, NULL);
+                    break;
 
                 case 'r':
                     // Change radar
-                    sscanf("%s", commandString + 1, sval1);
-                    RKLog(">%s %s Selected radar %s\n", engine->name, O->name, sval1);
-                    snprintf(user->commandResponse, RKMaximumPacketSize - 1, "ACK. %s selected." RKEOL, sval1);
-                    RKOperatorSendCommandResponse(O, user->commandResponse);
+                    selectRadar(engine, O, commandString);
                     break;
                     
                 case 's':
@@ -303,6 +985,16 @@ int socketCommandHandler(RKOperator *O) {
                             (unsigned long)user->access, (unsigned long)user->streams, k, user->rayIndex);
                     RKOperatorSendCommandResponse(O, user->commandResponse);
                     break;
+
+                case 'e':
+                    // Compression of the streams from here, not the upstream
+                    setCompression(engine, O, commandString);
+                    break;
+
+                case 'k':
+                    // Resume from the ray buffer here, not the upstream
+                    setResume(engine, O, commandString);
+                    break;
                     
                 default:
                     // Just forward to the right radar
@@ -340,7 +1032,7 @@ int socketStreamHandler(RKOperator *O) {
     RKCommandCenter *engine = O->userResource;
     RKUser *user = &engine->users[O->iid];
     
-    int i, j, k, s;
+    int i, j, k, m, s;
     char *c;
     static struct timeval t0;
 
@@ -359,22 +1051,20 @@ int socketStreamHandler(RKOperator *O) {
     
     RKSweep *sweep;
     RKSweepHeader sweepHeader;
-    
-    RKProduct *product;
+
+    RKVolume *volume;
 
     uint8_t *u8Data = NULL;
     float *f32Data = NULL;
+    float *moments[RKBaseMomentCount + 1];
 
     RKInt16C *c16DataH = NULL;
     RKInt16C *c16DataV = NULL;
     RKInt16C *userDataH = NULL;
     RKInt16C *userDataV = NULL;
 
-    RKIdentifier identifier;
-    RKProductId productId;
-    
-    struct timeval timevalOrigin, timevalTx, timevalRx;
-    double deltaTx, deltaRx;
+    struct timeval timevalOrigin, timevalTx;
+    double deltaTx;
 
     if (engine->radarCount < 1) {
         return 0;
@@ -392,6 +1082,13 @@ int socketStreamHandler(RKOperator *O) {
         return 0;
     }
 
+    if (user->string == NULL && (user->streams & user->access || user->access & RKStreamControl) &&
+        RKCommandCenterAllocateStreamBuffers(engine, O, user) != RKResultSuccess) {
+        pthread_mutex_unlock(&user->mutex);
+        RKOperatorHangUp(O);
+        return 0;
+    }
+
     const char colormap[16][16] = {
         {"\033[48;5;233m"},
         {"\033[48;5;243m"},
@@ -410,6 +1107,9 @@ int socketStreamHandler(RKOperator *O) {
         {"\033[48;5;201m"},
         {"\033[48;5;93m"}
     };
+    // Text, status and displays are only good when they are fresh, drop the old ones when the client falls behind
+    RKOperatorSetSendPolicy(O, RKOperatorSendPolicyDropOldest);
+
     if (user->radar->desc.initFlags & RKInitFlagSignalProcessor && time - user->timeLastOut >= 0.05) {
         // Signal processor only - showing the latest summary text view
         #pragma mark Summary Text
@@ -666,13 +1366,7 @@ int socketStreamHandler(RKOperator *O) {
             }
             user->statusIndex = endIndex;
         }
-        s = 0;
-        while (user->radar->status[user->statusIndex].flag != RKStatusFlagReady && engine->server->state == RKServerStateActive && s++ < 20) {
-            if (s % 10 == 0 && engine->verbose > 1) {
-                RKLog("%s %s sleep 0/%.1f s  RKStatus\n", engine->name, O->name, s * 0.1f);
-            }
-            usleep(50000);
-        }
+        // Not waiting here, a status that is not ready is simply tried again in the next pass
         if (user->radar->status[user->statusIndex].flag == RKStatusFlagReady && engine->server->state == RKServerStateActive) {
             while (user->statusIndex != endIndex) {
                 O->delimTx.type = RKNetworkPacketTypeProcessorStatus;
@@ -680,7 +1374,7 @@ int socketStreamHandler(RKOperator *O) {
                 RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &user->radar->status[user->statusIndex], sizeof(RKStatus), NULL);
                 user->statusIndex = RKNextModuloS(user->statusIndex, user->radar->desc.statusBufferDepth);
             }
-        } else {
+        } else if (engine->verbose > 1) {
             RKLog("%s %s No Status / Deactivated.   statusIndex = %d\n", engine->name, O->name, user->statusIndex);
         }
     }
@@ -698,18 +1392,16 @@ int socketStreamHandler(RKOperator *O) {
             }
             user->healthIndex = endIndex;
         }
-        s = 0;
-        while (user->radar->healths[user->healthIndex].flag != RKHealthFlagReady && engine->server->state == RKServerStateActive && s++ < 20) {
-            if (s % 10 == 0 && engine->verbose > 1) {
-                RKLog("%s %s sleep 0/%.1f s  RKHealth\n", engine->name, O->name, s * 0.1f);
-            }
-            usleep(50000);
-        }
-        if (user->radar->healths[user->healthIndex].flag == RKHealthFlagReady && engine->server->state == RKServerStateActive) {
+        // Same as the status, a health that is not ready is tried again in the next pass
+        if ((user->radar->healths[user->healthIndex].flag & RKHealthFlagReady) && engine->server->state == RKServerStateActive) {
             j = 0;
             k = 0;
             while (user->healthIndex != endIndex && k < RKMaximumStringLength - 200) {
-                c = user->radar->healths[user->healthIndex].string;
+                if (user->radar->healthEngine) {
+                    c = RKHealthEngineHealthString(user->radar->healthEngine, &user->radar->healths[user->healthIndex]);
+                } else {
+                    c = user->radar->healths[user->healthIndex].string;
+                }
                 k += sprintf(user->string + k, "%s\n", c);
                 user->healthIndex = RKNextModuloS(user->healthIndex, user->radar->desc.healthBufferDepth);
                 j++;
@@ -721,280 +1413,41 @@ int socketStreamHandler(RKOperator *O) {
                 O->delimTx.size = k;
                 RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), user->string, O->delimTx.size, NULL);
             }
-        } else {
+        } else if (engine->verbose > 1) {
             RKLog("%s %s No Health / Deactivated.   healthIndex = %d / %d\n", engine->name, O->name, user->healthIndex, user->radar->healthIndex);
         }
     }
 
     // Product or display streams - no skipping
-    if (user->streams & user->access & RKStreamProductAll) {
-        #pragma mark Product Streams
-        // Product streams - assume no display as display data can be derived later
-        if (user->radar->desc.initFlags & RKInitFlagSignalProcessor) {
-            endIndex = RKPreviousNModuloS(user->radar->rayIndex, 2 * user->radar->momentEngine->coreCount, user->radar->desc.rayBufferDepth);
-        } else {
-            endIndex = RKPreviousModuloS(user->radar->rayIndex, user->radar->desc.rayBufferDepth);
-        }
-        ray = RKGetRayFromBuffer(user->radar->rays, endIndex);
-
-        if (!(user->streamsInProgress & RKStreamProductAll)) {
-            user->streamsInProgress |= (user->streams & RKStreamProductAll);
-            user->rayIndex = endIndex;
-            s = 0;
-            while (!(ray->header.s & RKRayStatusReady) && engine->server->state == RKServerStateActive && s++ < 20) {
-                if (s % 10 == 0 && engine->verbose > 1) {
-                    RKLog("%s %s sleep 0/%.1f s  RKRay\n", engine->name, O->name, s * 0.1f);
-                }
-                usleep(50000);
-            }
-            if (engine->verbose) {
-                RKLog("%s %s Streaming RKRay products -> %d (%s).\n", engine->name, O->name, endIndex,
-                      ray->header.s & RKRayStatusReady ? "ready" : "not ready");
-            }
-        }
-
-        if (ray->header.s & RKRayStatusReady && engine->server->state == RKServerStateActive) {
-            while (user->rayIndex != endIndex) {
-                ray = RKGetRayFromBuffer(user->radar->rays, user->rayIndex);
-                // Duplicate and send the header with only selected products
-                memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
-                // Gather the products to be sent
-                rayHeader.baseMomentList = RKBaseMomentListNone;
-                if (user->streams & RKStreamProductZ) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductZ;
-                }
-                if (user->streams & RKStreamProductV) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductV;
-                }
-                if (user->streams & RKStreamProductW) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductW;
-                }
-                if (user->streams & RKStreamProductD) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductD;
-                }
-                if (user->streams & RKStreamProductP) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductP;
-                }
-                if (user->streams & RKStreamProductR) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductR;
-                }
-                if (user->streams & RKStreamProductK) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductK;
-                }
-                if (user->streams & RKStreamProductQ) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductQ;
-                }
-                if (user->streams & RKStreamProductSh) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductSh;
-                }
-                if (user->streams & RKStreamProductSv) {
-                    rayHeader.baseMomentList |= RKBaseMomentListProductSv;
-                }
-                uint32_t productList = rayHeader.baseMomentList & RKBaseMomentListProductZVWDPRKSQ;
-                uint32_t productCount = __builtin_popcount(productList);
-                //RKLog("ProductCount = %d / %x\n", productCount, productList);
-                
-                rayHeader.gateCount /= user->rayDownSamplingRatio;
-                rayHeader.gateSizeMeters *= (float)user->rayDownSamplingRatio;
-                
-                O->delimTx.type = RKNetworkPacketTypeRayDisplay;
-                O->delimTx.size = (uint32_t)(sizeof(RKRayHeader) + productCount * rayHeader.gateCount * sizeof(float));
-                RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &rayHeader, sizeof(RKRayHeader), NULL);
-                
-                for (j = 0; j < productCount; j++) {
-                    if (productList & RKBaseMomentListProductZ) {
-                        productList ^= RKBaseMomentListProductZ;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexZ);
-                    } else if (productList & RKBaseMomentListProductV) {
-                        productList ^= RKBaseMomentListProductV;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexV);
-                    } else if (productList & RKBaseMomentListProductW) {
-                        productList ^= RKBaseMomentListProductW;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexW);
-                    } else if (productList & RKBaseMomentListProductD) {
-                        productList ^= RKBaseMomentListProductD;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexD);
-                    } else if (productList & RKBaseMomentListProductP) {
-                        productList ^= RKBaseMomentListProductP;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexP);
-                    } else if (productList & RKBaseMomentListProductR) {
-                        productList ^= RKBaseMomentListProductR;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexR);
-                    } else if (productList & RKBaseMomentListProductK) {
-                        productList ^= RKBaseMomentListProductK;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexK);
-                    } else if (productList & RKBaseMomentListProductQ) {
-                        productList ^= RKBaseMomentListProductK;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexQ);
-                    } else if (productList & RKBaseMomentListProductSh) {
-                        productList ^= RKBaseMomentListProductSh;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexSh);
-                    } else if (productList & RKBaseMomentListProductSv) {
-                        productList ^= RKBaseMomentListProductSv;
-                        f32Data = RKGetFloatDataFromRay(ray, RKBaseMomentIndexSv);
-                    } else {
-                        f32Data = NULL;
-                    }
-                    if (f32Data) {
-                        float *lowRateData = (float *)user->string;
-                        for (i = 0, k = 0; i < rayHeader.gateCount; i++, k += user->rayDownSamplingRatio) {
-                            lowRateData[i] = f32Data[k];
-                        }
-                        RKOperatorSendPackets(O, lowRateData, rayHeader.gateCount * sizeof(float), NULL);
-                    }
-                }
-                ray->header.s |= RKRayStatusStreamed;
-                user->rayIndex = RKNextModuloS(user->rayIndex, user->radar->desc.rayBufferDepth);
-            }
-        } else {
-            if ((int)ray->header.i > 0 && engine->verbose > 1) {
-                RKLog("%s %s No product ray / deactivated.  streamsInProgress = 0x%08x\n",
-                      engine->name, O->name, user->streamsInProgress);
-            }
-        }
-    } else if (user->streams & user->access & RKStreamDisplayZVWDPRKS) {
-        #pragma mark Display Streams
-        // Display streams - no skipping
-        if (user->radar->desc.initFlags & RKInitFlagSignalProcessor) {
-            endIndex = RKPreviousNModuloS(user->radar->rayIndex, 2 * user->radar->momentEngine->coreCount, user->radar->desc.rayBufferDepth);
-        } else {
-            endIndex = RKPreviousModuloS(user->radar->rayIndex, user->radar->desc.rayBufferDepth);
-        }
-        if (endIndex >= user->radar->desc.rayBufferDepth) {
-            RKLog("%s Error. endIndex = %s >= %s\n", engine->name, RKIntegerToCommaStyleString(endIndex), RKIntegerToCommaStyleString(user->radar->desc.rayBufferDepth));
-            RKLog("%s user->radar->rayIndex = %s / user->radar->desc.rayBufferDepth = %s", engine->name,
-                  RKIntegerToCommaStyleString(user->radar->rayIndex),
-                  RKIntegerToCommaStyleString(user->radar->desc.rayBufferDepth));
-            endIndex = 0;
-        }
-        ray = RKGetRayFromBuffer(user->radar->rays, endIndex);
-
-        if (!(user->streamsInProgress & RKStreamDisplayZVWDPRKS)) {
-            user->streamsInProgress |= (user->streams & RKStreamDisplayZVWDPRKS);
-            user->rayIndex = endIndex;
-            s = 0;
-            while (!(ray->header.s & RKRayStatusReady) && engine->server->state == RKServerStateActive && s++ < 20) {
-                if (s % 10 == 0 && engine->verbose) {
-                    RKLog("%s %s sleep 0/%.1f s  RKRay\n", engine->name, O->name, s * 0.1f);
-                }
-                usleep(50000);
-            }
-            if (engine->verbose) {
-                RKLog("%s %s Streaming RKRay displays -> %d (0x%02x %s).\n", engine->name, O->name, endIndex,
-                      ray->header.s, ray->header.s & RKRayStatusReady ? "ready" : "not ready");
+    if (user->streams & user->access & (RKStreamProductAll | RKStreamDisplayZVWDPRKS)) {
+        const RKStream rayStreams = user->streams & user->access & RKStreamProductAll ? RKStreamProductAll : RKStreamDisplayZVWDPRKS;
+        const bool start = !(user->streamsInProgress & rayStreams);
+        if (user->combined) {
+            for (k = 0; k < engine->radarCount; k++) {
+                RKCommandCenterStreamRays(engine, O, engine->radars[k], &user->rayIndices[k], k, start);
             }
+            O->delimTx.source = RKCommandCenterRadarIndex(engine, user->radar);
+            user->streamsInProgress |= (user->streams & rayStreams);
+        } else if (RKCommandCenterStreamRays(engine, O, user->radar, &user->rayIndex, RKCommandCenterRadarIndex(engine, user->radar), start)) {
+            // Until the latest ray is ready, the stream is started again in the next pass
+            user->streamsInProgress |= (user->streams & rayStreams);
         }
-
-        if (ray->header.s & RKRayStatusReady && engine->server->state == RKServerStateActive) {
-            while (user->rayIndex != endIndex) {
-                ray = RKGetRayFromBuffer(user->radar->rays, user->rayIndex);
-                // Duplicate and send the header with only selected products
-                memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
-                // Gather the products to be sent
-                rayHeader.baseMomentList = RKBaseMomentListNone;
-                if (user->streams & RKStreamDisplayZ) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayZ;
-                }
-                if (user->streams & RKStreamDisplayV) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayV;
-                }
-                if (user->streams & RKStreamDisplayW) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayW;
-                }
-                if (user->streams & RKStreamDisplayD) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayD;
-                }
-                if (user->streams & RKStreamDisplayP) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayP;
-                }
-                if (user->streams & RKStreamDisplayR) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayR;
-                }
-                if (user->streams & RKStreamDisplayK) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayK;
-                }
-                if (user->streams & RKStreamDisplayQ) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplayQ;
-                }
-                if (user->streams & RKStreamDisplaySh) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplaySh;
-                }
-                if (user->streams & RKStreamDisplaySv) {
-                    rayHeader.baseMomentList |= RKBaseMomentListDisplaySv;
-                }
-                uint32_t displayList = rayHeader.baseMomentList & RKBaseMomentListDisplayAll;
-                uint32_t displayCount = __builtin_popcount(displayList);
-                //RKLog("displayCount = %d / %x\n", productCount, productList);
-
-                rayHeader.gateCount /= user->rayDownSamplingRatio;
-                rayHeader.gateSizeMeters *= (float)user->rayDownSamplingRatio;
-
-                O->delimTx.type = RKNetworkPacketTypeRayDisplay;
-                O->delimTx.size = (uint32_t)(sizeof(RKRayHeader) + displayCount * rayHeader.gateCount * sizeof(uint8_t));
-                RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &rayHeader, sizeof(RKRayHeader), NULL);
-
-                for (j = 0; j < displayCount; j++) {
-                    if (displayList & RKBaseMomentListDisplayZ) {
-                        displayList ^= RKBaseMomentListDisplayZ;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexZ);
-                    } else if (displayList & RKBaseMomentListDisplayV) {
-                        displayList ^= RKBaseMomentListDisplayV;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexV);
-                    } else if (displayList & RKBaseMomentListDisplayW) {
-                        displayList ^= RKBaseMomentListDisplayW;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexW);
-                    } else if (displayList & RKBaseMomentListDisplayD) {
-                        displayList ^= RKBaseMomentListDisplayD;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexD);
-                    } else if (displayList & RKBaseMomentListDisplayP) {
-                        displayList ^= RKBaseMomentListDisplayP;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexP);
-                    } else if (displayList & RKBaseMomentListDisplayR) {
-                        displayList ^= RKBaseMomentListDisplayR;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexR);
-                    } else if (displayList & RKBaseMomentListDisplayK) {
-                        displayList ^= RKBaseMomentListDisplayK;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexK);
-                    } else if (displayList & RKBaseMomentListDisplayQ) {
-                        displayList ^= RKBaseMomentListDisplayQ;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexQ);
-                    } else if (displayList & RKBaseMomentListDisplaySh) {
-                        displayList ^= RKBaseMomentListDisplaySh;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexSh);
-                    } else if (displayList & RKBaseMomentListDisplaySv) {
-                        displayList ^= RKBaseMomentListDisplaySv;
-                        u8Data = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexSv);
-                    } else {
-                        u8Data = NULL;
-                    }
-                    if (u8Data) {
-                        uint8_t *lowRateData = (uint8_t *)user->string;
-                        for (i = 0, k = 0; i < rayHeader.gateCount; i++, k += user->rayDownSamplingRatio) {
-                            lowRateData[i] = u8Data[k];
-                        }
-                        RKOperatorSendPackets(O, lowRateData, rayHeader.gateCount * sizeof(uint8_t), NULL);
-                    }
-                }
-                ray->header.s |= RKRayStatusStreamed;
-                user->rayIndex = RKNextModuloS(user->rayIndex, user->radar->desc.rayBufferDepth);
-            } // while (user->rayIndex != endIndex) ...
-        } else {
-            if ((int)ray->header.i > 0 && engine->verbose > 1) {
-                RKLog("%s %s No display ray / deactivated.  user->rayIndex = %d   endIndex = %d  %lld\n",
-                      engine->name, O->name, user->rayIndex, endIndex, ray->header.i);
-            }
-        } // if (ray->header.s & RKRayStatusReady && engine->server->state == RKServerStateActive) ...
-    } // else if if (user->streams & user->access & RKStreamDisplayZVWDPRKS) ...
+    }
 
     // Sweep
     #pragma mark Sweep
-    if (user->streams & user->access & RKStreamSweepAll) {
+    // Sweeps and volumes are usually for archival, make the client take every one of them
+    RKOperatorSetSendPolicy(O, RKOperatorSendPolicyBlock);
+    if (user->productSweep) {
+        // The next sweep goes out once the user products of this one are in
+        RKCommandCenterReceiveUserProducts(engine, O, user);
+    } else if (user->streams & user->access & RKStreamSweepAll) {
         // Sweep streams - no skipping
         if (user->scratchSpaceIndex != user->radar->sweepEngine->scratchSpaceIndex) {
             if (user->radar->sweepEngine->verbose > 1) {
-                RKLog("%s RKSweepCollect()   anchorsIndex = %d / %d\n", engine->name, user->scratchSpaceIndex, user->radar->sweepEngine->scratchSpaceIndex);
+                RKLog("%s RKSweepEngineAcquireSweep()   anchorsIndex = %d / %d\n", engine->name, user->scratchSpaceIndex, user->radar->sweepEngine->scratchSpaceIndex);
             }
-            sweep = RKSweepCollect(user->radar->sweepEngine, user->scratchSpaceIndex);
+            sweep = RKSweepEngineAcquireSweep(user->radar->sweepEngine, user->scratchSpaceIndex);
             if (sweep) {
                 // Make a local copy of the sweepHeader and mutate it for this client while keeping the original intact
                 memcpy(&sweepHeader, &sweep->header, sizeof(RKSweepHeader));
@@ -1107,14 +1560,11 @@ int socketStreamHandler(RKOperator *O) {
                     O->delimTx.size = (uint32_t)sizeof(RKSweepHeader);
                     size += RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &sweepHeader, sizeof(RKSweepHeader), NULL);
 
-                    O->delimTx.type = RKNetworkPacketTypeSweepRay;
-                    O->delimTx.size = (uint32_t)(sizeof(RKRayHeader) + baseMomentCount * sweepHeader.gateCount * sizeof(RKFloat));
-
                     for (k = 0; k < sweepHeader.rayCount; k++) {
                         ray = sweep->rays[k];
                         memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
                         rayHeader.baseMomentList = sweepHeader.baseMomentList;
-                        size += RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &rayHeader, sizeof(RKRayHeader), NULL);
+                        memset(moments, 0, sizeof(moments));
                         productList = sweepHeader.baseMomentList;
                         if (engine->verbose > 1 && (k < 3 || k == sweepHeader.rayCount - 1)) {
                             RKLog(">%s %s k = %d   moments = %s   (%x)\n", engine->name, O->name, k, user->scratch + 1, productList);
@@ -1154,12 +1604,13 @@ int socketStreamHandler(RKOperator *O) {
                                 f32Data = NULL;
                             }
                             if (f32Data) {
-                                size += RKOperatorSendPackets(O, f32Data, sweep->header.gateCount * sizeof(float), NULL);
-                                user->timeLastOut = time;
+                                moments[j] = f32Data;
                             } else if (k == 0) {
                                 RKLog("No data found %04Xh", productList);
                             }
                         } // for (j = 0; ...
+                        size += RKCommandCenterSendSweepRay(O, &rayHeader, moments, sweepHeader.gateCount);
+                        user->timeLastOut = time;
                     } // for (k = 0; ...
 
                     gettimeofday(&timevalTx, NULL);
@@ -1172,54 +1623,19 @@ int socketStreamHandler(RKOperator *O) {
                         RKLog(">%s %s Sent a sweep of size %s B (%d moments)\n", engine->name, O->name, RKIntegerToCommaStyleString(size), baseMomentCount);
                     }
 
-                    for (k = 0; k < user->productCount; k++) {
-                        RKLog(">%s %s Expecting return from algorithm key = %d for productId = %d ...\n",
-                              engine->name, O->name, user->productDescriptions[k].key, user->productIds[k]);
-                        size = RKServerReceiveUserPayload(O, user->string, RKNetworkMessageFormatHeaderDefinedSize);
-                        if (size < 0) {
-                            RKLog("%s %s Error. Failed receiving user product header ...\n", engine->name, O->name);
-                            continue;
-                        }
-                        productId = RKProductIdFromString(RKGetValueOfKey(user->string, "productId"));
-                        identifier = RKIdentifierFromString(RKGetValueOfKey(user->string, "configId"));
-                        if (user->productIds[k] != productId) {
-                            RKLog("%s %s Warning. Inconsistent productId = %d (expected) != %d (reported)\n", engine->name, O->name, user->productIds[k], productId);
-                        } else if (sweep->header.config.i != identifier) {
-                            RKLog("%s %s Warning. Inconsistent configId = %lu (expected) != %lu (reported)\n", engine->name, O->name, sweep->header.config.i, identifier);
-                        } else {
-                            product = RKSweepEngineGetVacantProduct(user->radar->sweepEngine, sweep, productId);
-                            if (product) {
-                                // Transfer important meta data and prepare the necessary buffer size
-                                RKProductInitFromSweep(product, sweep);
-                                size = RKServerReceiveUserPayload(O, product->data, RKNetworkMessageFormatHeaderDefinedSize);
-                                if (user->radar->sweepEngine->verbose > 1) {
-                                    RKLog("%s %s %s (%d) -> %u %zu\n",
-                                          engine->name, O->name, user->string, strlen(user->string), productId, identifier);
-                                }
-                                RKShowArray(product->data, product->desc.symbol, product->header.gateCount, product->header.rayCount);
-                                RKSweepEngineSetProductComplete(user->radar->sweepEngine, sweep, product);
-                            } else {
-                                // Still need to consume this packet so we dump it to a scratch space
-                                RKLog("Warning. Unable to retrieve storage for incoming sweep.\n");
-                                size = RKServerReceiveUserPayload(O, user->scratch, RKNetworkMessageFormatHeaderDefinedSize);
-                            }
-                            if (size < 0) {
-                                RKLog("%s %s Error. Failed receiving user product data ...\n", engine->name, O->name);
-                                continue;
-                            }
-                        } // else (user->productIds[k] == productId && sweep->header.config.i == identifier)
-                    } // for (k = 0; k < user->productCount; k++) ...
-
-                    gettimeofday(&timevalRx, NULL);
-
-                    deltaTx = 1.0e3 * RKTimevalDiff(timevalTx, timevalOrigin);
-                    deltaRx = 1.0e3 * RKTimevalDiff(timevalRx, timevalTx);
-                    RKLog("%s %s Round trip finished   %s ms   %s ms\n", engine->name, O->name,
-                          RKVariableInString("tx", &deltaTx, RKValueTypeDouble),
-                          RKVariableInString("rx", &deltaRx, RKValueTypeDouble));
-
+                    if (user->productCount) {
+                        // Hold on to the sweep, the user products come back in the coming passes
+                        user->productSweep = sweep;
+                        user->productInTransit = NULL;
+                        user->productPayloadIndex = 0;
+                        user->productTimevalOrigin = timevalOrigin;
+                        user->productTimevalTx = timevalTx;
+                        RKOperatorExpectPayloads(O, 2 * user->productCount);
+                    }
                 } // if (baseMomentCount) ...
-                RKSweepFree(sweep);
+                if (sweep != user->productSweep) {
+                    RKSweepEngineReleaseSweep(user->radar->sweepEngine, sweep);
+                }
             } else if (engine->verbose > 1) {
                 RKLog("%s %s Empty sweep   anchorIndex = %d.\n", engine->name, O->name, user->scratchSpaceIndex);
             } // if (sweep) ...
@@ -1228,6 +1644,79 @@ int socketStreamHandler(RKOperator *O) {
         } // if (user->scratchSpaceIndex != user->radar->sweepEngine->scratchSpaceIndex) ...
     } // if (user->streams & user->access & RKStreamSweepZVWDPRKS) ...
 
+    // Volume
+    #pragma mark Volume
+    if (user->streams & user->access & RKStreamVolume) {
+        // The latest complete volume, all sweeps and all moments, once per volume. It goes out a few rays at a time while
+        // the send queue has room and the volume is held until its last ray is out
+        if (user->volume == NULL && RKOperatorHasRoom(O)) {
+            volume = RKVolumeEngineAcquireCompleteVolume(user->radar->volumeEngine);
+            if (volume && volume->header.i != user->volumeId) {
+                user->volumeId = volume->header.i;
+                user->volume = volume;
+                user->volumeSweepIndex = 0;
+                user->volumeRayIndex = 0;
+                gettimeofday(&user->volumeTimevalOrigin, NULL);
+
+                O->delimTx.type = RKNetworkPacketTypeVolumeHeader;
+                O->delimTx.size = (uint32_t)sizeof(RKVolumeHeader);
+                user->volumeSize = RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &volume->header, sizeof(RKVolumeHeader), NULL);
+            } else {
+                RKVolumeEngineReleaseVolume(user->radar->volumeEngine, volume);
+            }
+        }
+        volume = user->volume;
+        k = 0;
+        while (volume && user->volumeSweepIndex < volume->header.sweepCount && k < RKCommandCenterVolumeRayCount &&
+               O->state == RKOperatorStateActive && RKOperatorHasRoom(O)) {
+            sweep = volume->sweeps[user->volumeSweepIndex];
+            memcpy(&sweepHeader, &sweep->header, sizeof(RKSweepHeader));
+            sweepHeader.baseMomentList &= RKBaseMomentListProductAll;
+
+            if (user->volumeRayIndex == 0) {
+                O->delimTx.type = RKNetworkPacketTypeSweepHeader;
+                O->delimTx.size = (uint32_t)sizeof(RKSweepHeader);
+                user->volumeSize += RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &sweepHeader, sizeof(RKSweepHeader), NULL);
+            }
+
+            if (user->volumeRayIndex < sweepHeader.rayCount) {
+                ray = sweep->rays[user->volumeRayIndex];
+                memcpy(&rayHeader, &ray->header, sizeof(RKRayHeader));
+                rayHeader.baseMomentList = sweepHeader.baseMomentList;
+                memset(moments, 0, sizeof(moments));
+                // Same order as the sweep stream: Z, V, W, D, P, R, K, Sh, Sv, Q
+                for (m = 0, j = 0; j < RKBaseMomentCount; j++) {
+                    if (sweepHeader.baseMomentList & (RKBaseMomentListProductZ << j)) {
+                        moments[m++] = RKGetFloatDataFromRay(ray, j);
+                    }
+                }
+                user->volumeSize += RKCommandCenterSendSweepRay(O, &rayHeader, moments, sweepHeader.gateCount);
+                user->volumeRayIndex++;
+                k++;
+            }
+            if (user->volumeRayIndex >= sweepHeader.rayCount) {
+                user->volumeSweepIndex++;
+                user->volumeRayIndex = 0;
+            }
+            user->timeLastOut = time;
+        }
+        if (volume && user->volumeSweepIndex == volume->header.sweepCount) {
+            gettimeofday(&timevalTx, NULL);
+            deltaTx = 1.0e3 * RKTimevalDiff(timevalTx, user->volumeTimevalOrigin);
+            size = user->volumeSize;
+            RKLog("%s %s Volume V%lu sent   %s   %s B   %s ms\n", engine->name, O->name, volume->header.i,
+                  RKVariableInString("sweepCount", &volume->header.sweepCount, RKValueTypeUInt32),
+                  RKIntegerToCommaStyleString(size),
+                  RKVariableInString("tx", &deltaTx, RKValueTypeDouble));
+            RKVolumeEngineReleaseVolume(user->radar->volumeEngine, volume);
+            user->volume = NULL;
+        }
+    } else if (user->volume) {
+        // Unsubscribed in the middle of a volume
+        RKVolumeEngineReleaseVolume(user->radar->volumeEngine, user->volume);
+        user->volume = NULL;
+    } // if (user->streams & user->access & RKStreamVolume) ...
+
     // IQ
     #pragma mark IQ
     if (user->streams & user->access & RKStreamProductIQ) {
@@ -1238,6 +1727,7 @@ int socketStreamHandler(RKOperator *O) {
         }
         user->timeLastDisplayIQOut = time;
     } else if (user->streams & user->access & RKStreamDisplayIQ && time - user->timeLastDisplayIQOut >= 0.05) {
+        RKOperatorSetSendPolicy(O, RKOperatorSendPolicyDropOldest);
         if (user->radar->desc.initFlags & RKInitFlagSignalProcessor) {
             endIndex = RKPreviousNModuloS(user->radar->pulseIndex, 2 * user->radar->pulseEngine->coreCount, user->radar->desc.pulseBufferDepth);
         } else {
@@ -1251,22 +1741,10 @@ int socketStreamHandler(RKOperator *O) {
             pulse = RKGetPulseFromBuffer(user->radar->pulses, endIndex);
         }
         //printf("wi = %d  %d\n", user->transmitWaveIndex, (int)pulse->header.i % user->radar->pulseEngine->filterGroupCount);
-        user->transmitWaveIndex = RKNextModuloS(user->transmitWaveIndex, user->radar->pulseEngine->filterGroupCount);
         //pulse = RKGetPulseFromBuffer(user->radar->pulses, endIndex);
-        s = 0;
-        while (!(pulse->header.s & RKPulseStatusProcessed) && s++ < 100) {
-            usleep(1000);
-        }
-
+        // Not waiting for the pulse to be processed, it is tried again in the next pass with the same waveIndex
         if (!(user->streamsInProgress & RKPulseStatusProcessed)) {
             user->pulseIndex = endIndex;
-            s = 0;
-            while (!(pulse->header.s & RKPulseStatusHasIQData) && engine->server->state == RKServerStateActive && s++ < 20) {
-                if (s % 10 == 0) {
-                    RKLog("%s %s sleep 0/%.1f s  RKPulse\n", engine->name, O->name, s * 0.1f);
-                }
-                usleep(100000);
-            }
         }
 
         if (pulse->header.s & RKPulseStatusProcessed && engine->server->state == RKServerStateActive) {
@@ -1383,13 +1861,13 @@ int socketStreamHandler(RKOperator *O) {
             //RKLog("%s %s %d vs %d / %d\n", engine->name, O->name, pulseHeader.gateCount, i, user->pulseDownSamplingRatio);
             
             O->delimTx.type = RKNetworkPacketTypePulseData;
-            O->delimTx.size = (uint32_t)(sizeof(RKPulseHeader) + 2 * size);
-            RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &pulseHeader, sizeof(RKPulseHeader), user->samples[0], size, user->samples[1], size, NULL);
+            RKOperatorSendCompressiblePackets(O, sizeof(int16_t), &O->delimTx, &pulseHeader, sizeof(RKPulseHeader), user->samples[0], size, user->samples[1], size, NULL);
             
+            user->transmitWaveIndex = RKNextModuloS(user->transmitWaveIndex, user->radar->pulseEngine->filterGroupCount);
             user->timeLastDisplayIQOut = time;
             user->timeLastOut = time;
         } else {
-            if ((int)pulse->header.i > 0) {
+            if ((int)pulse->header.i > 0 && engine->verbose > 1) {
                 RKLog("%s %s No IQ / Deactivated.  streamsInProgress = 0x%08x  header.s = %x\n",
                        engine->name, O->name, user->streamsInProgress, pulse->header.s);
             }
@@ -1400,6 +1878,9 @@ int socketStreamHandler(RKOperator *O) {
 
     pthread_mutex_unlock(&user->mutex);
 
+    // Command responses are never dropped
+    RKOperatorSetSendPolicy(O, RKOperatorSendPolicyBlock);
+
     // Re-evaluate td = time - user->timeLastOut; send a beacon if nothing has been sent for a while
     if (time - user->timeLastOut >= 1.0) {
         if (O->beacon.type != RKNetworkPacketTypeBeacon) {
@@ -1434,10 +1915,17 @@ int socketInitialHandler(RKOperator *O) {
         RKLog("%s %s Warning. Unexpected user state.   user->streams = %x", engine->name, O->name, user->streams);
     }
     memset(user, 0, sizeof(RKUser));
+    if ((user->commandResponse = (char *)malloc(RKMaximumPacketSize)) == NULL) {
+        RKLog("%s %s Error. Unable to allocate a command response buffer.\n", engine->name, O->name);
+        pthread_mutex_unlock(&engine->mutex);
+        RKOperatorHangUp(O);
+        return RKResultFailedToAllocateBuffer;
+    }
     user->access = RKStreamStatusAll;
     user->access |= RKStreamDisplayAll;
     user->access |= RKStreamProductAll;
     user->access |= RKStreamSweepAll;
+    user->access |= RKStreamVolume;
     user->access |= RKStreamDisplayIQ | RKStreamProductIQ;
     user->textPreferences = RKTextPreferencesShowColor | RKTextPreferencesWindowSize80x40;
     user->terminalSize.ws_col = 120;
@@ -1470,14 +1958,25 @@ int socketTerminateHandler(RKOperator *O) {
     RKUser *user = &engine->users[O->iid];
     user->access = RKStreamNull;
     user->streams = RKStreamNull;
-    RKLog(">%s %s Disconnected.\n", engine->name, O->name);
+    RKLog(">%s %s Disconnected.   %s   %s\n", engine->name, O->name,
+          RKVariableInString("dropCount", &O->dropCount, RKValueTypeUInt64),
+          RKVariableInString("queuePeakCount", &O->queuePeakCount, RKValueTypeUInt32));
     for (k = 0; k < user->productCount; k++) {
         if (user->productIds[k]) {
             RKSweepEngineUnregisterProduct(user->radar->sweepEngine, user->productIds[k]);
             user->productIds[k] = 0;
         }
     }
+    if (user->volume) {
+        RKVolumeEngineReleaseVolume(user->radar->volumeEngine, user->volume);
+        user->volume = NULL;
+    }
+    if (user->productSweep) {
+        RKSweepEngineReleaseSweep(user->radar->sweepEngine, user->productSweep);
+        user->productSweep = NULL;
+    }
     pthread_mutex_destroy(&user->mutex);
+    RKCommandCenterFreeUserBuffers(user);
     user->radar = NULL;
     consolidateStreams(engine);
     return RKResultSuccess;
@@ -1486,6 +1985,7 @@ int socketTerminateHandler(RKOperator *O) {
 #pragma mark - Life Cycle
 
 RKCommandCenter *RKCommandCenterInit(void) {
+    int k;
     RKCommandCenter *engine = (RKCommandCenter *)malloc(sizeof(RKCommandCenter));
     if (engine == NULL) {
         RKLog("Error. Unable to allocate local command center.\n");
@@ -1498,7 +1998,12 @@ RKCommandCenter *RKCommandCenterInit(void) {
     engine->verbose = 3;
     engine->memoryUsage = sizeof(RKCommandCenter);
     engine->server = RKServerInit();
+    RKServerSetMaximumClientCount(engine->server, RKCommandCenterMaxConnections);
     pthread_mutex_init(&engine->mutex, NULL);
+    pthread_mutex_init(&engine->rayPacketMutex, NULL);
+    for (k = 0; k < RKCommandCenterRayPacketCount; k++) {
+        pthread_mutex_init(&engine->rayPackets[k].lock, NULL);
+    }
     RKServerSetName(engine->server, engine->name);
     RKServerSetWelcomeHandler(engine->server, &socketInitialHandler);
     RKServerSetCommandHandler(engine->server, &socketCommandHandler);
@@ -1509,8 +2014,17 @@ RKCommandCenter *RKCommandCenterInit(void) {
 }
 
 void RKCommandCenterFree(RKCommandCenter *engine) {
+    int j, k;
     pthread_mutex_destroy(&engine->mutex);
     RKServerFree(engine->server);
+    for (k = 0; k < RKCommandCenterRayPacketCount; k++) {
+        for (j = 0; j < RKRayPacketCompressionCount; j++) {
+            free(engine->rayPackets[k].compressedBuffer[j]);
+        }
+        pthread_mutex_destroy(&engine->rayPackets[k].lock);
+        free(engine->rayPackets[k].buffer);
+    }
+    pthread_mutex_destroy(&engine->rayPacketMutex);
     free(engine);
     return;
 }
@@ -1528,13 +2042,29 @@ void RKCommandCenterSetPort(RKCommandCenter *engine, const int port) {
 }
 
 void RKCommandCenterAddRadar(RKCommandCenter *engine, RKRadar *radar) {
-    if (engine->radarCount >= 4) {
-        RKLog("%s unable to add another radar.\n", engine->name);
+    if (engine->radarCount >= RKCommandCenterMaxRadars) {
+        RKLog("%s Error. Unable to add another radar.\n", engine->name);
+        return;
     }
     engine->radars[engine->radarCount] = radar;
     engine->radarCount++;
 }
 
+// Publish the display rays to a multicast group, e.g., RKNetworkMulticastDefaultGroup, a NULL group disables it
+void RKCommandCenterSetMulticast(RKCommandCenter *engine, const char *group, const int port, const uint32_t baseMomentList) {
+    if (engine->multicastActive) {
+        RKLog("%s Error. Multicast cannot be changed while it is active.\n", engine->name);
+        return;
+    }
+    if (group == NULL) {
+        engine->multicastGroup[0] = '\0';
+        return;
+    }
+    strncpy(engine->multicastGroup, group, RKNameLength - 1);
+    engine->multicastPort = port;
+    engine->multicastMomentList = baseMomentList & RKBaseMomentListDisplayAll ? baseMomentList & RKBaseMomentListDisplayAll : RKBaseMomentListDisplayZVWDPRK;
+}
+
 void RKCommandCenterRemoveRadar(RKCommandCenter *engine, RKRadar *radar) {
     int i, j, k;
     if (engine->suspendHandler) {
@@ -1552,10 +2082,15 @@ void RKCommandCenterRemoveRadar(RKCommandCenter *engine, RKRadar *radar) {
     for (i = 0; i < engine->radarCount; i++) {
         if (engine->radars[i] == radar) {
             RKLog("%s Removing '%s' ...\n", engine->name, radar->desc.name);
-            while (i < engine->radarCount - 1) {
-                engine->radars[i] = engine->radars[i + 1];
+            for (j = i; j < engine->radarCount - 1; j++) {
+                engine->radars[j] = engine->radars[j + 1];
+                for (k = 0; k < RKCommandCenterMaxConnections; k++) {
+                    engine->users[k].rayIndices[j] = engine->users[k].rayIndices[j + 1];
+                }
             }
+            engine->radars[j] = NULL;
             engine->radarCount--;
+            break;
         }
     }
     for (i = 0; i < engine->server->maxClient; i++) {
@@ -1581,6 +2116,26 @@ void RKCommandCenterRemoveRadar(RKCommandCenter *engine, RKRadar *radar) {
 void RKCommandCenterStart(RKCommandCenter *center) {
     RKLog("%s Starting ...\n", center->name);
     RKServerStart(center->server);
+    if (strlen(center->multicastGroup)) {
+        unsigned char ttl = 1;
+        unsigned char loop = 1;
+        center->multicastAddress.sin_family = AF_INET;
+        center->multicastAddress.sin_port = htons(center->multicastPort);
+        center->multicastAddress.sin_addr.s_addr = inet_addr(center->multicastGroup);
+        if ((center->multicastSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) < 0) {
+            RKLog("%s Error. Unable to create a UDP socket for multicast.\n", center->name);
+        } else {
+            // Stay within the local network, loop back for viewers on the same host
+            setsockopt(center->multicastSocket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            setsockopt(center->multicastSocket, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+            center->multicastActive = true;
+            if (pthread_create(&center->tidMulticast, NULL, RKCommandCenterMulticastRoutine, center)) {
+                RKLog("%s Error. Unable to start multicast.\n", center->name);
+                center->multicastActive = false;
+                close(center->multicastSocket);
+            }
+        }
+    }
     RKLog("%s Started.   mem = %s B   radarCount = %s\n", center->name, RKUIntegerToCommaStyleString(center->memoryUsage), RKIntegerToCommaStyleString(center->radarCount));
 }
 
@@ -1588,6 +2143,11 @@ void RKCommandCenterStop(RKCommandCenter *center) {
     if (center->verbose > 1) {
         RKLog("%s Stopping ...\n", center->name);
     }
+    if (center->multicastActive) {
+        center->multicastActive = false;
+        pthread_join(center->tidMulticast, NULL);
+        close(center->multicastSocket);
+    }
     RKServerStop(center->server);
     RKLog("%s Stopped.\n", center->name);
 }
@@ -0,0 +1,515 @@
+//
+//  RKCompositeEngine.c
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#include <RadarKit/RKCompositeEngine.h>
+
+// Effective earth radius of the 4/3 earth model (km)
+#define RKCompositeEngineEffectiveEarthRadius      (4.0f / 3.0f * 6371.0f)
+
+#pragma mark - Helper Functions
+
+static size_t RKCompositeEngineAllocate(RKCompositeEngine *engine) {
+    int k;
+    size_t bytes = engine->capacity * sizeof(RKFloat);
+    void **gateArrays[] = {
+        (void **)&engine->range, (void **)&engine->height, (void **)&engine->liquid,
+        (void **)&engine->gateCell, (void **)&engine->cellGate, (void **)&engine->extraGate, (void **)&engine->extraCell,
+        (void **)&engine->cellZ, (void **)&engine->cellHeight, (void **)&engine->cellLiquid
+    };
+    RKFloat **binArrays[] = {&engine->maxZ, &engine->echoTop, &engine->vil, &engine->liquidBelow, &engine->heightBelow};
+    for (k = 0; k < sizeof(gateArrays) / sizeof(void **); k++) {
+        if (posix_memalign(gateArrays[k], RKSIMDAlignSize, bytes)) {
+            RKLog("%s Error. Unable to allocate resources.\n", engine->name);
+            exit(EXIT_FAILURE);
+        }
+        memset(*gateArrays[k], 0, bytes);
+    }
+    bytes *= RKCompositeEngineAzimuthBinCount;
+    for (k = 0; k < sizeof(binArrays) / sizeof(RKFloat **); k++) {
+        if (posix_memalign((void **)binArrays[k], RKSIMDAlignSize, bytes)) {
+            RKLog("%s Error. Unable to allocate resources.\n", engine->name);
+            exit(EXIT_FAILURE);
+        }
+        memset(*binArrays[k], 0, bytes);
+    }
+    return (sizeof(gateArrays) / sizeof(void **) + 5 * RKCompositeEngineAzimuthBinCount) * engine->capacity * sizeof(RKFloat);
+}
+
+// Ground-range cell of each gate with the 4/3 earth model, the beam height is h = sqrt(r^2 + R^2 + 2 r R sin(e)) - R and
+// the ground range is s = R asin(r cos(e) / (R + h)). Going out in range, the cell goes up by one at most so every cell
+// has a first gate, the other gates that fall in the same cell are listed in the order of range.
+static void RKCompositeEngineUpdateMap(RKCompositeEngine *engine, const float elevation) {
+    int c, k;
+    double r, h;
+    const double R = RKCompositeEngineEffectiveEarthRadius;
+    const double sine = sin(elevation * M_PI / 180.0);
+    const double cosine = cos(elevation * M_PI / 180.0);
+    const double cellSize = 1.0e-3 * engine->gateSizeMeters;
+    engine->cellCount = 0;
+    engine->extraCount = 0;
+    for (k = 0; k < engine->capacity; k++) {
+        r = engine->range[k];
+        h = sqrt(r * r + R * R + 2.0 * r * R * sine) - R;
+        c = MIN((int)floor(R * asin(r * cosine / (R + h)) / cellSize + 0.5), (int)engine->cellCount);
+        if (c == engine->cellCount) {
+            engine->cellGate[engine->cellCount++] = k;
+        } else {
+            engine->extraGate[engine->extraCount] = k;
+            engine->extraCell[engine->extraCount++] = c;
+        }
+        engine->gateCell[k] = c;
+        engine->height[k] = (RKFloat)h;
+    }
+    engine->mapElevation = elevation;
+}
+
+// Azimuth bin that contains the center of a ray
+static int RKCompositeEngineAzimuthBin(const float startAzimuth, const float endAzimuth) {
+    float delta = endAzimuth - startAzimuth;
+    if (delta < -180.0f) {
+        delta += 360.0f;
+    } else if (delta > 180.0f) {
+        delta -= 360.0f;
+    }
+    float center = fmodf(startAzimuth + 0.5f * delta + 360.0f, 360.0f);
+    return (int)floorf(center * RKCompositeEngineAzimuthBinCount / 360.0f) % RKCompositeEngineAzimuthBinCount;
+}
+
+static void RKCompositeEngineFreeResources(RKCompositeEngine *engine) {
+    free(engine->range);
+    free(engine->height);
+    free(engine->liquid);
+    free(engine->gateCell);
+    free(engine->cellGate);
+    free(engine->extraGate);
+    free(engine->extraCell);
+    free(engine->cellZ);
+    free(engine->cellHeight);
+    free(engine->cellLiquid);
+    free(engine->maxZ);
+    free(engine->echoTop);
+    free(engine->vil);
+    free(engine->liquidBelow);
+    free(engine->heightBelow);
+    engine->range = NULL;
+    engine->height = NULL;
+    engine->liquid = NULL;
+    engine->gateCell = NULL;
+    engine->cellGate = NULL;
+    engine->extraGate = NULL;
+    engine->extraCell = NULL;
+    engine->cellZ = NULL;
+    engine->cellHeight = NULL;
+    engine->cellLiquid = NULL;
+    engine->maxZ = NULL;
+    engine->echoTop = NULL;
+    engine->vil = NULL;
+    engine->liquidBelow = NULL;
+    engine->heightBelow = NULL;
+    engine->memoryUsage = sizeof(RKCompositeEngine);
+}
+
+// Start over the accumulation of a volume
+static void RKCompositeEngineResetVolume(RKCompositeEngine *engine, const RKRay *ray) {
+    int k;
+    const uint32_t count = RKCompositeEngineAzimuthBinCount * engine->capacity;
+    for (k = 0; k < count; k++) {
+        engine->maxZ[k] = -INFINITY;
+        engine->echoTop[k] = -INFINITY;
+        engine->vil[k] = 0.0f;
+        engine->liquidBelow[k] = 0.0f;
+        engine->heightBelow[k] = NAN;
+    }
+    if (engine->gateSizeMeters != ray->header.gateSizeMeters) {
+        engine->gateSizeMeters = ray->header.gateSizeMeters;
+        for (k = 0; k < engine->capacity; k++) {
+            engine->range[k] = 1.0e-3f * (RKFloat)k * engine->gateSizeMeters;
+        }
+        engine->mapElevation = NAN;
+    }
+    engine->gateCount = 0;
+    engine->volumeCount++;
+    if (engine->verbose) {
+        RKLog("%s New volume   E%.2f   %s\n", engine->name, ray->header.sweepElevation,
+              RKVariableInString("volumeCount", &engine->volumeCount, RKValueTypeUInt32));
+    }
+}
+
+// Fold a ray into the azimuth bins that it covers, gate by gate into the ground-range cells
+static void RKCompositeEngineUpdate(RKCompositeEngine *engine, RKRay *ray) {
+    int b, c, g, i, k;
+    RKConfig *config = &engine->configBuffer[ray->header.configIndex];
+
+    if ((config->startMarker & RKMarkerScanTypeMask) != RKMarkerScanTypePPI || !(ray->header.baseMomentList & RKBaseMomentListProductZ)) {
+        return;
+    }
+    // A new volume starts at a volume marker, or when the antenna comes back down
+    if (ray->header.marker & RKMarkerVolumeBegin ||
+        ray->header.sweepElevation < engine->sweepElevation - 0.05f ||
+        ray->header.gateSizeMeters != engine->gateSizeMeters) {
+        RKCompositeEngineResetVolume(engine, ray);
+    }
+    engine->sweepElevation = ray->header.sweepElevation;
+
+    const uint32_t gateCount = MIN(ray->header.gateCount, engine->capacity);
+    if (gateCount == 0) {
+        return;
+    }
+
+    // The map is only rebuilt when the elevation has moved more than the pointing jitter
+    const float elevation = 0.5f * (ray->header.startElevation + ray->header.endElevation);
+    if (!(fabsf(elevation - engine->mapElevation) < 0.02f)) {
+        RKCompositeEngineUpdateMap(engine, elevation);
+    }
+    const uint32_t cellCount = engine->gateCell[gateCount - 1] + 1;
+    engine->gateCount = MAX(engine->gateCount, cellCount);
+
+    // Liquid water content (kg / m^3 over km of height) of each gate
+    const RKFloat *z = RKGetFloatDataFromRay(ray, RKBaseMomentIndexZ);
+    for (k = 0; k < gateCount; k++) {
+        engine->liquid[k] = isfinite(z[k]) ? 3.44e-3f * powf(10.0f, (0.4f / 7.0f) * MIN(z[k], RKCompositeEngineHailCap)) : 0.0f;
+    }
+
+    // The first gate of every cell, the other gates are higher up and are folded in after
+    for (c = 0; c < cellCount; c++) {
+        g = engine->cellGate[c];
+        engine->cellZ[c] = z[g];
+        engine->cellHeight[c] = engine->height[g];
+        engine->cellLiquid[c] = engine->liquid[g];
+    }
+
+    // Azimuth bins with a center within the ray, or the one that contains the ray center
+    const float width = 360.0f / RKCompositeEngineAzimuthBinCount;
+    float delta = ray->header.endAzimuth - ray->header.startAzimuth;
+    if (delta < -180.0f) {
+        delta += 360.0f;
+    } else if (delta > 180.0f) {
+        delta -= 360.0f;
+    }
+    float origin = delta >= 0.0f ? ray->header.startAzimuth : ray->header.startAzimuth + delta;
+    if (origin < 0.0f) {
+        origin += 360.0f;
+    }
+    int b0 = (int)floorf(origin / width - 0.5f) + 1;
+    int b1 = (int)floorf((origin + fabsf(delta)) / width - 0.5f) + 1;
+    if (b1 <= b0) {
+        b0 = RKCompositeEngineAzimuthBin(ray->header.startAzimuth, ray->header.endAzimuth);
+        b1 = b0 + 1;
+    }
+    for (b = b0; b < b1; b++) {
+        k = (b % RKCompositeEngineAzimuthBinCount) * engine->capacity;
+        RKSIMD_imax(engine->cellZ, engine->maxZ + k, cellCount);
+        RKSIMD_EchoTop(engine->cellZ, engine->cellHeight, engine->echoTopThreshold, engine->echoTop + k, cellCount);
+        RKSIMD_VILLayer(engine->cellLiquid, engine->cellHeight, engine->liquidBelow + k, engine->heightBelow + k, engine->vil + k, cellCount);
+        for (i = 0; i < engine->extraCount && engine->extraGate[i] < gateCount; i++) {
+            g = engine->extraGate[i];
+            c = k + engine->extraCell[i];
+            RKSIMD_imax(z + g, engine->maxZ + c, 1);
+            RKSIMD_EchoTop(z + g, engine->height + g, engine->echoTopThreshold, engine->echoTop + c, 1);
+            RKSIMD_VILLayer(engine->liquid + g, engine->height + g, engine->liquidBelow + c, engine->heightBelow + c, engine->vil + c, 1);
+        }
+    }
+}
+
+// The fields so far, one row for each ray of the sweep
+static void RKCompositeEngineFillProducts(RKCompositeEngine *engine, RKSweep *sweep) {
+    int b, g, k, p;
+    RKFloat *x, *y;
+    RKProduct *product;
+    RKFloat *fields[RKCompositeEngineProductCount] = {engine->maxZ, engine->vil, engine->echoTop};
+
+    const bool usable = sweep->header.isPPI && sweep->header.gateSizeMeters == engine->gateSizeMeters;
+    const uint32_t gateCount = usable ? MIN(sweep->header.gateCount, engine->gateCount) : 0;
+
+    for (p = 0; p < RKCompositeEngineProductCount; p++) {
+        if (engine->productIds[p] == 0) {
+            continue;
+        }
+        product = RKSweepEngineGetVacantProduct(engine->sweepEngine, sweep, engine->productIds[p]);
+        if (product == NULL) {
+            RKLog("%s Error. Unable to get a product slot   pid = %d.\n", engine->name, engine->productIds[p]);
+            continue;
+        }
+        RKProductInitFromSweep(product, sweep);
+        for (k = 0; k < product->header.rayCount; k++) {
+            y = product->data + k * product->header.gateCount;
+            b = RKCompositeEngineAzimuthBin(product->startAzimuth[k], product->endAzimuth[k]);
+            x = fields[p] + b * engine->capacity;
+            for (g = 0; g < gateCount; g++) {
+                y[g] = isinf(x[g]) ? NAN : x[g];
+            }
+            for (; g < product->header.gateCount; g++) {
+                y[g] = NAN;
+            }
+        }
+        RKSweepEngineSetProductComplete(engine->sweepEngine, sweep, product);
+    }
+    engine->sweepCount++;
+}
+
+// Publish the products of the sweeps that the sweep engine has concluded and all of their rays have been folded in
+static void RKCompositeEnginePublish(RKCompositeEngine *engine) {
+    RKSweep *sweep;
+    while (engine->scratchSpaceIndex != engine->sweepEngine->scratchSpaceIndex) {
+        sweep = RKSweepEngineAcquireSweep(engine->sweepEngine, engine->scratchSpaceIndex);
+        if (sweep) {
+            if (sweep->rays[sweep->header.rayCount - 1]->header.i > engine->rayId) {
+                RKSweepEngineReleaseSweep(engine->sweepEngine, sweep);
+                return;
+            }
+            RKCompositeEngineFillProducts(engine, sweep);
+            RKSweepEngineReleaseSweep(engine->sweepEngine, sweep);
+        }
+        engine->scratchSpaceIndex = RKNextModuloS(engine->scratchSpaceIndex, RKSweepScratchSpaceDepth);
+    }
+}
+
+#pragma mark - Delegate Workers
+
+static void *rayWatcher(void *in) {
+    RKCompositeEngine *engine = (RKCompositeEngine *)in;
+
+    int s;
+    RKRay *ray;
+
+    uint32_t j = *engine->rayIndex;
+    engine->scratchSpaceIndex = engine->sweepEngine->scratchSpaceIndex;
+    engine->sweepElevation = -INFINITY;
+    engine->gateSizeMeters = 0.0f;
+
+    // Update the engine state
+    engine->state |= RKEngineStateWantActive;
+    engine->state ^= RKEngineStateActivating;
+
+    RKLog("%s Started.   mem = %s B   rayIndex = %d\n", engine->name, RKUIntegerToCommaStyleString(engine->memoryUsage), j);
+
+    // Increase the tic once to indicate the engine is ready
+    engine->tic = 1;
+
+    // Update the engine state
+    engine->state |= RKEngineStateActive;
+
+    while (engine->state & RKEngineStateWantActive) {
+        // The ray
+        ray = RKGetRayFromBuffer(engine->rayBuffer, j);
+
+        // Wait until the buffer is advanced, publish whatever is due in the meantime
+        engine->state |= RKEngineStateSleep1;
+        s = 0;
+        while (j == *engine->rayIndex && engine->state & RKEngineStateWantActive) {
+            usleep(10000);
+            RKCompositeEnginePublish(engine);
+            if (++s % 100 == 0 && engine->verbose > 1) {
+                RKLog("%s sleep 1/%.1f s   j = %d   rayIndex = %d   header.s = 0x%02x\n",
+                      engine->name, (float)s * 0.01f, j, *engine->rayIndex, ray->header.s);
+            }
+        }
+        engine->state ^= RKEngineStateSleep1;
+        engine->state |= RKEngineStateSleep2;
+        s = 0;
+        while (!(ray->header.s & RKRayStatusReady) && engine->state & RKEngineStateWantActive) {
+            usleep(10000);
+            if (++s % 100 == 0 && engine->verbose > 1) {
+                RKLog("%s sleep 2/%.1f s   j = %d   rayIndex = %d   header.s = 0x%02x\n",
+                      engine->name, (float)s * 0.01f, j, *engine->rayIndex, ray->header.s);
+            }
+        }
+        engine->state ^= RKEngineStateSleep2;
+
+        if (!(engine->state & RKEngineStateWantActive)) {
+            break;
+        }
+
+        // Lag of the engine
+        engine->lag = fmodf(((float)*engine->rayIndex + engine->radarDescription->rayBufferDepth - j) / engine->radarDescription->rayBufferDepth, 1.0f);
+
+        RKCompositeEngineUpdate(engine, ray);
+        engine->rayId = ray->header.i;
+
+        // The products of this sweep must go out before the rays of a next volume come in
+        if (ray->header.marker & RKMarkerSweepEnd) {
+            engine->state |= RKEngineStateSleep3;
+            s = 0;
+            while (engine->scratchSpaceIndex == engine->sweepEngine->scratchSpaceIndex && ++s < 200 && engine->state & RKEngineStateWantActive) {
+                usleep(10000);
+            }
+            engine->state ^= RKEngineStateSleep3;
+        }
+        RKCompositeEnginePublish(engine);
+
+        engine->tic++;
+
+        j = RKNextModuloS(j, engine->radarDescription->rayBufferDepth);
+    }
+    engine->state ^= RKEngineStateActive;
+    return NULL;
+}
+
+#pragma mark - Life Cycle
+
+RKCompositeEngine *RKCompositeEngineInit(void) {
+    RKCompositeEngine *engine = (RKCompositeEngine *)malloc(sizeof(RKCompositeEngine));
+    if (engine == NULL) {
+        RKLog("Error. Unable to allocate a composite engine.\n");
+        return NULL;
+    }
+    memset(engine, 0, sizeof(RKCompositeEngine));
+    sprintf(engine->name, "%s<CompositeEngine>%s",
+            rkGlobalParameters.showColor ? RKGetBackgroundColorOfIndex(RKEngineColorCompositeEngine) : "",
+            rkGlobalParameters.showColor ? RKNoColor : "");
+    engine->state = RKEngineStateAllocated;
+    engine->echoTopThreshold = RKCompositeEngineDefaultEchoTopThreshold;
+    engine->memoryUsage = sizeof(RKCompositeEngine);
+    return engine;
+}
+
+void RKCompositeEngineFree(RKCompositeEngine *engine) {
+    if (engine->state & RKEngineStateWantActive) {
+        RKCompositeEngineStop(engine);
+    }
+    RKCompositeEngineFreeResources(engine);
+    free(engine);
+}
+
+#pragma mark - Properties
+
+void RKCompositeEngineSetVerbose(RKCompositeEngine *engine, const int verbose) {
+    engine->verbose = verbose;
+}
+
+void RKCompositeEngineSetInputOutputBuffers(RKCompositeEngine *engine, RKRadarDesc *desc,
+                                            RKConfig *configBuffer, uint32_t *configIndex,
+                                            RKBuffer rayBuffer,     uint32_t *rayIndex,
+                                            RKSweepEngine *sweepEngine) {
+    engine->radarDescription  = desc;
+    engine->configBuffer      = configBuffer;
+    engine->configIndex       = configIndex;
+    engine->rayBuffer         = rayBuffer;
+    engine->rayIndex          = rayIndex;
+    engine->sweepEngine       = sweepEngine;
+    engine->state |= RKEngineStateProperlyWired;
+}
+
+void RKCompositeEngineSetProductList(RKCompositeEngine *engine, const RKCompositeProductList list) {
+    if (engine->state & RKEngineStateActive) {
+        RKLog("%s Error. Product list cannot be changed while the engine is active.\n", engine->name);
+        return;
+    }
+    engine->productList = list & RKCompositeProductListAll;
+}
+
+void RKCompositeEngineSetEchoTopThreshold(RKCompositeEngine *engine, const float threshold) {
+    engine->echoTopThreshold = threshold;
+}
+
+#pragma mark - Interactions
+
+int RKCompositeEngineStart(RKCompositeEngine *engine) {
+    int p;
+    RKFloat lhma[4];
+    RKProductDesc desc;
+    if (!(engine->state & RKEngineStateProperlyWired)) {
+        RKLog("%s Error. Not properly wired.\n", engine->name);
+        return RKResultEngineNotWired;
+    }
+    if (engine->productList == RKCompositeProductListNone) {
+        RKLog("%s No products to generate.\n", engine->name);
+        return RKResultSuccess;
+    }
+    RKLog("%s Starting ...\n", engine->name);
+
+    // Gates of an azimuth bin are the same as the rays, the SIMD routines see the same alignment
+    engine->capacity = RKGetRayFromBuffer(engine->rayBuffer, 0)->header.capacity;
+    engine->memoryUsage = sizeof(RKCompositeEngine) + RKCompositeEngineAllocate(engine);
+
+    // Products are registered with the sweep engine, which concludes them along with the sweeps
+    for (p = 0; p < RKCompositeEngineProductCount; p++) {
+        engine->productIds[p] = 0;
+        if (!(engine->productList & (1 << p))) {
+            continue;
+        }
+        memset(&desc, 0, sizeof(RKProductDesc));
+        switch (p) {
+            case 0:
+                sprintf(desc.name, "Composite_Reflectivity");
+                sprintf(desc.unit, "dBZ");
+                sprintf(desc.colormap, "Reflectivity");
+                sprintf(desc.symbol, "CR");
+                RKZLHMAC
+                break;
+            case 1:
+                sprintf(desc.name, "Vertically_Integrated_Liquid");
+                sprintf(desc.unit, "KilogramsPerSquareMeter");
+                sprintf(desc.colormap, "VIL");
+                sprintf(desc.symbol, "VIL");
+                lhma[0] = 0.0f; lhma[1] = 85.0f; lhma[2] = 3.0f; lhma[3] = 0.0f;
+                break;
+            default:
+                sprintf(desc.name, "Echo_Top");
+                sprintf(desc.unit, "Kilometers");
+                sprintf(desc.colormap, "EchoTop");
+                sprintf(desc.symbol, "ET");
+                lhma[0] = 0.0f; lhma[1] = 25.5f; lhma[2] = 10.0f; lhma[3] = 0.0f;
+                break;
+        }
+        desc.index = RKBaseMomentIndexCount;
+        desc.pieceCount = 1;
+        desc.mininimumValue = lhma[0];
+        desc.maximumValue = lhma[1];
+        desc.w[0] = lhma[2];
+        desc.b[0] = lhma[3];
+        engine->productIds[p] = RKSweepEngineRegisterProduct(engine->sweepEngine, desc);
+    }
+
+    engine->tic = 0;
+    engine->state |= RKEngineStateActivating;
+    if (pthread_create(&engine->tidRayWatcher, NULL, rayWatcher, engine) != 0) {
+        RKLog("%s Error. Failed to start a ray watcher.\n", engine->name);
+        return RKResultFailedToStartRayWatcher;
+    }
+    while (engine->tic == 0) {
+        usleep(10000);
+    }
+    return RKResultSuccess;
+}
+
+int RKCompositeEngineStop(RKCompositeEngine *engine) {
+    int p;
+    if (engine->state & RKEngineStateDeactivating) {
+        if (engine->verbose > 1) {
+            RKLog("%s Info. Engine is being or has been deactivated.\n", engine->name);
+        }
+        return RKResultEngineDeactivatedMultipleTimes;
+    }
+    if (!(engine->state & RKEngineStateWantActive)) {
+        RKLog("%s Not active.\n", engine->name);
+        return RKResultEngineDeactivatedMultipleTimes;
+    }
+    RKLog("%s Stopping ...\n", engine->name);
+    engine->state |= RKEngineStateDeactivating;
+    engine->state ^= RKEngineStateWantActive;
+    if (engine->tidRayWatcher) {
+        pthread_join(engine->tidRayWatcher, NULL);
+        engine->tidRayWatcher = (pthread_t)0;
+    } else {
+        RKLog("%s Invalid thread ID.\n", engine->name);
+    }
+    for (p = 0; p < RKCompositeEngineProductCount; p++) {
+        if (engine->productIds[p]) {
+            RKSweepEngineUnregisterProduct(engine->sweepEngine, engine->productIds[p]);
+            engine->productIds[p] = 0;
+        }
+    }
+    RKCompositeEngineFreeResources(engine);
+    engine->state ^= RKEngineStateDeactivating;
+    RKLog("%s Stopped.\n", engine->name);
+    if (engine->state != (RKEngineStateAllocated | RKEngineStateProperlyWired)) {
+        RKLog("%s Inconsistent state 0x%04x\n", engine->name, engine->state);
+    }
+    return RKResultSuccess;
+}
@@ -847,11 +847,73 @@ int RKClearPulseBuffer(RKBuffer buffer, const uint32_t slots) {
     return RKResultSuccess;
 }
 
+// Size of a sample as recorded for the raw data type, 0 if the type is undefined
+size_t RKRawDataSampleSize(const RKRawDataType type) {
+    switch (type) {
+        case RKRawDataTypeFromTransceiver:
+        case RKRawDataTypeAfterMatchedFilterInt16:
+            return sizeof(RKInt16C);
+        case RKRawDataTypeAfterMatchedFilterFloat16:
+            return sizeof(RKFloat16C);
+        case RKRawDataTypeAfterMatchedFilter:
+            return sizeof(RKComplex);
+        default:
+            return 0;
+    }
+}
+
+// Number of gates as recorded, data from the transceiver are before down-sampling
+uint32_t RKRawDataGateCount(const RKPulseHeader *header, const RKRawDataType type) {
+    return type == RKRawDataTypeFromTransceiver ? header->gateCount : header->downSampledGateCount;
+}
+
+//
+// Encode a channel of samples after pulse compression into the raw data type. Only RKRawDataTypeAfterMatchedFilterInt16
+// sets the scale, which is a power of two so that the largest sample just fits in int16.
+//
+void RKRawDataEncodeSamples(void *dst, float *scale, const RKComplex *src, const uint32_t gateCount, const RKRawDataType type) {
+    int e;
+    RKFloat m;
+    const RKFloat *x = &src->i;
+    switch (type) {
+        case RKRawDataTypeAfterMatchedFilterInt16:
+            m = RKSIMD_amax(x, 2 * gateCount);
+            if (m > 0.0f && isfinite(m)) {
+                frexpf(m / 32767.0f, &e);
+                *scale = ldexpf(1.0f, e);
+            } else {
+                *scale = 1.0f;
+            }
+            RKSIMD_Float2Int16(x, (int16_t *)dst, 1.0f / *scale, 2 * gateCount);
+            break;
+        case RKRawDataTypeAfterMatchedFilterFloat16:
+            RKSIMD_Float2Half(x, (uint16_t *)dst, 2 * gateCount);
+            break;
+        default:
+            memcpy(dst, src, gateCount * sizeof(RKComplex));
+            break;
+    }
+}
+
+void RKRawDataDecodeSamples(RKComplex *dst, const void *src, const float scale, const uint32_t gateCount, const RKRawDataType type) {
+    switch (type) {
+        case RKRawDataTypeAfterMatchedFilterInt16:
+            RKSIMD_Int162Float((const int16_t *)src, &dst->i, scale, 2 * gateCount);
+            break;
+        case RKRawDataTypeAfterMatchedFilterFloat16:
+            RKSIMD_Half2Float((const uint16_t *)src, &dst->i, 2 * gateCount);
+            break;
+        default:
+            memcpy(dst, src, gateCount * sizeof(RKComplex));
+            break;
+    }
+}
+
 // Read pulse from a file reference
 int RKReadPulseFromFileReference(RKPulse *pulse, RKRawDataType type, FILE *fid) {
-    int i, j;
+    int j;
     size_t readsize;
-    uint32_t gateCount = 0;
+    RKRawDataPulseScale scale = {{1.0f, 1.0f}};
     const uint32_t capacity = pulse->header.capacity;
     // Pulse header
     readsize = fread(pulse, sizeof(RKPulseHeader), 1, fid);
@@ -859,18 +921,42 @@ int RKReadPulseFromFileReference(RKPulse *pulse, RKRawDataType type, FILE *fid)
         return RKResultNothingToRead;
     }
     pulse->header.capacity = capacity;
-    // Pulse payload: H and V data into channels 0 and 1, respectively. Duplicate to split-complex storage
+    if (RKRawDataSampleSize(type) == 0) {
+        return RKResultRawDataTypeUndefined;
+    }
+    const uint32_t gateCount = RKRawDataGateCount(&pulse->header, type);
+    if (gateCount > capacity) {
+        RKLog("Error in RKReadPulseFromFileReference() gateCount = %s > %s\n",
+              RKIntegerToCommaStyleString(gateCount),
+              RKIntegerToCommaStyleString(capacity));
+        return RKResultTooBig;
+    }
+    if (type == RKRawDataTypeAfterMatchedFilterInt16 && fread(&scale, sizeof(RKRawDataPulseScale), 1, fid) != 1) {
+        return RKResultNothingToRead;
+    }
+    // Raw data from the transceiver: H and V data into the 16-bit storage of channels 0 and 1, respectively
+    if (type == RKRawDataTypeFromTransceiver) {
+        for (j = 0; j < 2; j++) {
+            readsize = fread(RKGetInt16CDataFromPulse(pulse, j), sizeof(RKInt16C), gateCount, fid);
+            if (readsize != gateCount) {
+                RKLog("Error in RKReadPulseFromFileReference() readsize = %s != %s\n",
+                      RKIntegerToCommaStyleString(readsize),
+                      RKIntegerToCommaStyleString(gateCount));
+                return RKResultNothingToRead;
+            }
+        }
+        return RKResultSuccess;
+    }
+    // Pulse payload: H and V data into channels 0 and 1, respectively. Reduced precision samples go through the
+    // 16-bit storage, which has the same size. Duplicate to split-complex storage
     for (j = 0; j < 2; j++) {
         RKComplex *x = RKGetComplexDataFromPulse(pulse, j);
         RKIQZ z = RKGetSplitComplexDataFromPulse(pulse, j);
-        if (type == RKRawDataTypeFromTransceiver) {
-            gateCount = pulse->header.gateCount;
-        } else if (type == RKRawDataTypeAfterMatchedFilter) {
-            gateCount = pulse->header.downSampledGateCount;
+        if (type == RKRawDataTypeAfterMatchedFilter) {
+            readsize = fread(x, sizeof(RKComplex), gateCount, fid);
         } else {
-            return RKResultRawDataTypeUndefined;
+            readsize = fread(RKGetInt16CDataFromPulse(pulse, j), sizeof(RKInt16C), gateCount, fid);
         }
-        readsize = fread(x, sizeof(RKComplex), gateCount, fid);
         if (readsize != gateCount) {
             RKLog("Error in RKReadPulseFromFileReference() readsize = %s != %s || > %s\n",
                   RKIntegerToCommaStyleString(readsize),
@@ -878,10 +964,10 @@ int RKReadPulseFromFileReference(RKPulse *pulse, RKRawDataType type, FILE *fid)
                   RKIntegerToCommaStyleString(capacity));
             return RKResultTooBig;
         }
-        for (i = 0; i < gateCount; i++) {
-            z.i[i] = x[i].i;
-            z.q[i] = x[i].q;
+        if (type != RKRawDataTypeAfterMatchedFilter) {
+            RKRawDataDecodeSamples(x, RKGetInt16CDataFromPulse(pulse, j), scale.scale[j], gateCount, type);
         }
+        RKSIMD_Complex2IQZ(x, &z, gateCount);
     }
     return RKResultSuccess;
 }
@@ -1166,13 +1252,16 @@ RKStream RKStreamFromString(const char * string) {
             case 'B':
                 flag |= RKStreamSweepSv;
                 break;
+            case 'M':
+                flag |= RKStreamVolume;
+                break;
             default:
                 break;
                 //    abcdefghijklmnopqrstuvwxyz
                 //    ABCDEFGHIJKLMNOPQRSTUVWXYZ
                 //
                 //    abc efg  j lmno q  tu   y
-                //        EFG    LMN     T
+                //        EFG    L N     T
         }
         c++;
     }
@@ -1227,6 +1316,7 @@ int RKStringFromStream(char *string, RKStream stream) {
     if (stream & RKStreamSweepQ)                { j += sprintf(string + j, "H"); }
     if (stream & RKStreamSweepSh)               { j += sprintf(string + j, "A"); }
     if (stream & RKStreamSweepSv)               { j += sprintf(string + j, "B"); }
+    if (stream & RKStreamVolume)                { j += sprintf(string + j, "M"); }
     string[j] = '\0';
     return j;
 }
@@ -0,0 +1,439 @@
+//
+//  RKGridEngine.c
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#include <RadarKit/RKGridEngine.h>
+
+#pragma mark - Helper Functions
+
+// The slice of cells for a worker, multiples of 8 so that the SIMD gathers do not straddle two workers
+static void RKGridEngineWorkerSlice(RKGridEngine *engine, const int id, uint32_t *origin, uint32_t *count) {
+    uint32_t size = ((engine->cellCount + engine->workerCount - 1) / engine->workerCount + 7) & ~7;
+    *origin = MIN(engine->cellCount, id * size);
+    *count = MIN(engine->cellCount - *origin, size);
+}
+
+// Ranges are slant ranges, cells are laid out row by row from the north-west corner
+static void RKGridEngineBuildTableSlice(RKGridEngine *engine, RKGridTable *table, const uint32_t origin, const uint32_t count) {
+    int i, j, k, g, b;
+    float x, y, f;
+    const float binWidth = 360.0f / (float)table->rayCount;
+    const float cx = 0.5f * (float)(engine->width - 1);
+    const float cy = 0.5f * (float)(engine->height - 1);
+    for (k = origin; k < origin + count; k++) {
+        i = k % engine->width;
+        j = k / engine->width;
+        x = ((float)i - cx) * engine->cellSizeMeters;
+        y = (cy - (float)j) * engine->cellSizeMeters;
+        f = sqrtf(x * x + y * y) / table->gateSizeMeters;
+        if (table->gateCount < 2 || f > (float)(table->gateCount - 1)) {
+            table->gate[k] = -1;
+            table->bin[k] = 0;
+            table->gateWeight[k] = 0.0f;
+            table->binWeight[k] = 0.0f;
+            continue;
+        }
+        g = MIN((int)f, (int)table->gateCount - 2);
+        table->gate[k] = g;
+        table->gateWeight[k] = f - (float)g;
+        f = atan2f(x, y) * (180.0f / M_PI);
+        if (f < 0.0f) {
+            f += 360.0f;
+        }
+        f = f / binWidth - 0.5f;
+        b = (int)floorf(f);
+        table->binWeight[k] = f - (float)b;
+        if (b < 0) {
+            b += table->rayCount;
+        }
+        table->bin[k] = MIN(b, (int)table->rayCount - 1);
+    }
+}
+
+static void RKGridEngineGridSweepSlice(RKGridEngine *engine, const uint32_t origin, const uint32_t count) {
+    int k, m, b, o0, o1;
+    const RKGridTable *table = engine->jobTable;
+    const RKSweep *sweep = engine->jobSweep;
+    RKRay *ray = sweep->rays[engine->baseRayIndex];
+    int32_t *near = engine->nearIndices;
+    int32_t *far = engine->farIndices;
+    uint8_t *covered = engine->coverage;
+
+    // Gather indices of this sweep, bins without a ray borrow the ray of the other bin
+    for (k = origin; k < origin + count; k++) {
+        b = table->bin[k];
+        o0 = engine->binOffsets[b];
+        o1 = engine->binOffsets[b == table->rayCount - 1 ? 0 : b + 1];
+        if (table->gate[k] < 0 || (o0 < 0 && o1 < 0)) {
+            near[k] = 0;
+            far[k] = 0;
+            covered[k] = false;
+            continue;
+        }
+        if (o0 < 0) {
+            o0 = o1;
+        } else if (o1 < 0) {
+            o1 = o0;
+        }
+        near[k] = o0 + table->gate[k];
+        far[k] = o1 + table->gate[k];
+        covered[k] = true;
+    }
+
+    // Offsets between the rays are the same for all moments
+    for (m = 0; m < RKBaseMomentCount; m++) {
+        if (!(engine->jobMomentList & (RKBaseMomentListProductZ << m))) {
+            continue;
+        }
+        RKFloat *dst = engine->data[m];
+        RKSIMD_BilinearGather(RKGetFloatDataFromRay(ray, m), near + origin, far + origin,
+                              table->binWeight + origin, table->gateWeight + origin, dst + origin, count);
+        for (k = origin; k < origin + count; k++) {
+            if (!covered[k]) {
+                dst[k] = NAN;
+            }
+        }
+    }
+}
+
+// Post a job to all workers and wait until all of them have done their slices
+static void RKGridEngineRunJob(RKGridEngine *engine, const RKGridJobType type) {
+    pthread_mutex_lock(&engine->jobMutex);
+    engine->jobType = type;
+    engine->jobRemaining = engine->workerCount;
+    engine->jobId++;
+    pthread_cond_broadcast(&engine->jobPosted);
+    while (engine->jobRemaining) {
+        pthread_cond_wait(&engine->jobDone, &engine->jobMutex);
+    }
+    engine->jobType = RKGridJobTypeNull;
+    pthread_mutex_unlock(&engine->jobMutex);
+}
+
+static void RKGridEngineFreeTable(RKGridEngine *engine, RKGridTable *table) {
+    free(table->gate);
+    free(table->bin);
+    free(table->gateWeight);
+    free(table->binWeight);
+    if (table->gate) {
+        engine->memoryUsage -= engine->cellCount * (2 * sizeof(int32_t) + 2 * sizeof(RKFloat));
+    }
+    memset(table, 0, sizeof(RKGridTable));
+}
+
+static void RKGridEngineFreeGrid(RKGridEngine *engine) {
+    int k;
+    for (k = 0; k < RKGridEngineTableSlotCount; k++) {
+        RKGridEngineFreeTable(engine, &engine->tables[k]);
+    }
+    for (k = 0; k < RKBaseMomentCount; k++) {
+        if (engine->data[k]) {
+            free(engine->data[k]);
+            engine->data[k] = NULL;
+            engine->memoryUsage -= engine->cellCount * sizeof(RKFloat);
+        }
+    }
+    if (engine->nearIndices) {
+        free(engine->nearIndices);
+        free(engine->farIndices);
+        free(engine->coverage);
+        engine->nearIndices = NULL;
+        engine->farIndices = NULL;
+        engine->coverage = NULL;
+        engine->memoryUsage -= engine->cellCount * (2 * sizeof(int32_t) + sizeof(uint8_t));
+    }
+}
+
+// A table of the sweep geometry, from the cache or built by the workers, evicting the least recently used
+static RKGridTable *RKGridEngineGetTable(RKGridEngine *engine, const RKSweep *sweep) {
+    int k;
+    RKGridTable *table = NULL;
+    for (k = 0; k < RKGridEngineTableSlotCount; k++) {
+        if (engine->tables[k].gate == NULL) {
+            continue;
+        }
+        if (engine->tables[k].gateSizeMeters == sweep->header.gateSizeMeters &&
+            engine->tables[k].gateCount == sweep->header.gateCount &&
+            engine->tables[k].rayCount == sweep->header.rayCount) {
+            table = &engine->tables[k];
+            table->tic = ++engine->tic;
+            return table;
+        }
+    }
+    for (k = 0; k < RKGridEngineTableSlotCount; k++) {
+        if (table == NULL || engine->tables[k].gate == NULL || engine->tables[k].tic < table->tic) {
+            table = &engine->tables[k];
+            if (table->gate == NULL) {
+                break;
+            }
+        }
+    }
+    if (table->gate == NULL) {
+        POSIX_MEMALIGN_CHECK(posix_memalign((void **)&table->gate, RKSIMDAlignSize, engine->cellCount * sizeof(int32_t)))
+        POSIX_MEMALIGN_CHECK(posix_memalign((void **)&table->bin, RKSIMDAlignSize, engine->cellCount * sizeof(int32_t)))
+        POSIX_MEMALIGN_CHECK(posix_memalign((void **)&table->gateWeight, RKSIMDAlignSize, engine->cellCount * sizeof(RKFloat)))
+        POSIX_MEMALIGN_CHECK(posix_memalign((void **)&table->binWeight, RKSIMDAlignSize, engine->cellCount * sizeof(RKFloat)))
+        engine->memoryUsage += engine->cellCount * (2 * sizeof(int32_t) + 2 * sizeof(RKFloat));
+    } else if (engine->verbose > 1) {
+        RKLog("%s Evicting table %.1f m x %u x %u\n", engine->name, table->gateSizeMeters, table->gateCount, table->rayCount);
+    }
+    table->gateSizeMeters = sweep->header.gateSizeMeters;
+    table->gateCount = sweep->header.gateCount;
+    table->rayCount = sweep->header.rayCount;
+    table->tic = ++engine->tic;
+    if (engine->verbose) {
+        RKLog("%s Building table %.1f m x %u x %u ...\n", engine->name, table->gateSizeMeters, table->gateCount, table->rayCount);
+    }
+    engine->jobTable = table;
+    RKGridEngineRunJob(engine, RKGridJobTypeBuildTable);
+    return table;
+}
+
+#pragma mark - Delegate Workers
+
+static void *gridWorker(void *in) {
+    RKGridWorker *me = (RKGridWorker *)in;
+    RKGridEngine *engine = me->parent;
+
+    uint32_t jobId = 0;
+    uint32_t origin, count;
+
+    pthread_mutex_lock(&engine->jobMutex);
+    while (engine->state & RKEngineStateWantActive) {
+        if (engine->jobId == jobId) {
+            pthread_cond_wait(&engine->jobPosted, &engine->jobMutex);
+            continue;
+        }
+        jobId = engine->jobId;
+        pthread_mutex_unlock(&engine->jobMutex);
+
+        RKGridEngineWorkerSlice(engine, me->id, &origin, &count);
+        if (count) {
+            if (engine->jobType == RKGridJobTypeBuildTable) {
+                RKGridEngineBuildTableSlice(engine, engine->jobTable, origin, count);
+            } else if (engine->jobType == RKGridJobTypeGridSweep) {
+                RKGridEngineGridSweepSlice(engine, origin, count);
+            }
+        }
+
+        pthread_mutex_lock(&engine->jobMutex);
+        if (--engine->jobRemaining == 0) {
+            pthread_cond_signal(&engine->jobDone);
+        }
+    }
+    pthread_mutex_unlock(&engine->jobMutex);
+    return NULL;
+}
+
+#pragma mark - Life Cycle
+
+RKGridEngine *RKGridEngineInit(void) {
+    RKGridEngine *engine = (RKGridEngine *)malloc(sizeof(RKGridEngine));
+    if (engine == NULL) {
+        RKLog("Error. Unable to allocate a grid engine.\n");
+        return NULL;
+    }
+    memset(engine, 0, sizeof(RKGridEngine));
+    sprintf(engine->name, "%s<GridEngine>%s",
+            rkGlobalParameters.showColor ? RKGetBackgroundColorOfIndex(RKEngineColorGridEngine) : "",
+            rkGlobalParameters.showColor ? RKNoColor : "");
+    engine->state = RKEngineStateAllocated;
+    engine->memoryUsage = sizeof(RKGridEngine);
+    engine->workerCount = RKGridEngineDefaultWorkerCount;
+    pthread_mutex_init(&engine->mutex, NULL);
+    pthread_mutex_init(&engine->jobMutex, NULL);
+    pthread_cond_init(&engine->jobPosted, NULL);
+    pthread_cond_init(&engine->jobDone, NULL);
+    return engine;
+}
+
+void RKGridEngineFree(RKGridEngine *engine) {
+    if (engine->state & RKEngineStateWantActive) {
+        RKGridEngineStop(engine);
+    }
+    RKGridEngineFreeGrid(engine);
+    free(engine->binOffsets);
+    pthread_cond_destroy(&engine->jobPosted);
+    pthread_cond_destroy(&engine->jobDone);
+    pthread_mutex_destroy(&engine->jobMutex);
+    pthread_mutex_destroy(&engine->mutex);
+    free(engine);
+}
+
+#pragma mark - Properties
+
+void RKGridEngineSetVerbose(RKGridEngine *engine, const int verbose) {
+    engine->verbose = verbose;
+}
+
+void RKGridEngineSetWorkerCount(RKGridEngine *engine, const uint8_t count) {
+    if (engine->state & RKEngineStateActive) {
+        RKLog("%s Error. Worker count cannot be changed while the engine is active.\n", engine->name);
+        return;
+    }
+    engine->workerCount = MAX(1, MIN(RKGridEngineMaximumWorkerCount, count));
+}
+
+// Cached tables and gridded data of the previous grid are discarded
+int RKGridEngineSetGrid(RKGridEngine *engine, const uint32_t width, const uint32_t height, const float cellSizeMeters) {
+    if (width == 0 || height == 0 || cellSizeMeters <= 0.0f) {
+        RKLog("%s Error. Invalid grid %u x %u @ %.1f m\n", engine->name, width, height, cellSizeMeters);
+        return RKResultNullInput;
+    }
+    pthread_mutex_lock(&engine->mutex);
+    RKGridEngineFreeGrid(engine);
+    engine->width = width;
+    engine->height = height;
+    engine->cellSizeMeters = cellSizeMeters;
+    engine->cellCount = width * height;
+    POSIX_MEMALIGN_CHECK(posix_memalign((void **)&engine->nearIndices, RKSIMDAlignSize, engine->cellCount * sizeof(int32_t)))
+    POSIX_MEMALIGN_CHECK(posix_memalign((void **)&engine->farIndices, RKSIMDAlignSize, engine->cellCount * sizeof(int32_t)))
+    POSIX_MEMALIGN_CHECK(posix_memalign((void **)&engine->coverage, RKSIMDAlignSize, engine->cellCount * sizeof(uint8_t)))
+    engine->memoryUsage += engine->cellCount * (2 * sizeof(int32_t) + sizeof(uint8_t));
+    engine->state |= RKEngineStateProperlyWired;
+    pthread_mutex_unlock(&engine->mutex);
+    if (engine->verbose) {
+        RKLog("%s Grid %u x %u @ %.1f m\n", engine->name, width, height, cellSizeMeters);
+    }
+    return RKResultSuccess;
+}
+
+#pragma mark - Interactions
+
+int RKGridEngineStart(RKGridEngine *engine) {
+    int k;
+    if (engine->verbose) {
+        RKLog("%s Starting ...\n", engine->name);
+    }
+    engine->state |= RKEngineStateActivating | RKEngineStateWantActive;
+    for (k = 0; k < engine->workerCount; k++) {
+        engine->workers[k].id = k;
+        engine->workers[k].parent = engine;
+        if (pthread_create(&engine->workers[k].tid, NULL, gridWorker, &engine->workers[k]) != 0) {
+            RKLog("%s Error. Failed to start a grid worker.\n", engine->name);
+            engine->workerCount = k;
+            RKGridEngineStop(engine);
+            return RKResultFailedToStartGridWorker;
+        }
+    }
+    engine->state ^= RKEngineStateActivating;
+    engine->state |= RKEngineStateActive;
+    return RKResultSuccess;
+}
+
+int RKGridEngineStop(RKGridEngine *engine) {
+    int k;
+    if (!(engine->state & RKEngineStateWantActive)) {
+        RKLog("%s Not active.\n", engine->name);
+        return RKResultEngineDeactivatedMultipleTimes;
+    }
+    if (engine->verbose) {
+        RKLog("%s Stopping ...\n", engine->name);
+    }
+    pthread_mutex_lock(&engine->jobMutex);
+    engine->state |= RKEngineStateDeactivating;
+    engine->state &= ~(RKEngineStateWantActive | RKEngineStateActive | RKEngineStateActivating);
+    pthread_cond_broadcast(&engine->jobPosted);
+    pthread_mutex_unlock(&engine->jobMutex);
+    for (k = 0; k < engine->workerCount; k++) {
+        pthread_join(engine->workers[k].tid, NULL);
+        engine->workers[k].tid = (pthread_t)0;
+    }
+    engine->state ^= RKEngineStateDeactivating;
+    if (engine->verbose) {
+        RKLog("%s Stopped.\n", engine->name);
+    }
+    return RKResultSuccess;
+}
+
+// Grid all the base moments of a sweep. The first sweep of a geometry builds the table, later ones only apply it.
+int RKGridEngineGridSweep(RKGridEngine *engine, const RKSweep *sweep) {
+    int j, m;
+    float c, d;
+    ptrdiff_t o;
+    RKRay *ray;
+    RKGridTable *table;
+
+    if (!(engine->state & RKEngineStateActive)) {
+        RKLog("%s Error. Not active.\n", engine->name);
+        return RKResultEngineNotActive;
+    }
+    if (!(engine->state & RKEngineStateProperlyWired)) {
+        RKLog("%s Error. Grid has not been set.\n", engine->name);
+        return RKResultEngineNotWired;
+    }
+    if (sweep == NULL || sweep->header.rayCount == 0 || sweep->header.gateCount < 2 || sweep->header.gateSizeMeters <= 0.0f) {
+        RKLog("%s Error. Sweep cannot be gridded.\n", engine->name);
+        return RKResultNullInput;
+    }
+    if (!sweep->header.isPPI) {
+        RKLog("%s Error. Only PPI sweeps can be gridded.\n", engine->name);
+        return RKResultNullInput;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+
+    table = RKGridEngineGetTable(engine, sweep);
+
+    // Gathers are relative to the ray at the lowest address so that all offsets are positive
+    engine->baseRayIndex = 0;
+    for (j = 1; j < sweep->header.rayCount; j++) {
+        if (sweep->rays[j] < sweep->rays[engine->baseRayIndex]) {
+            engine->baseRayIndex = j;
+        }
+    }
+    engine->binOffsets = (int32_t *)realloc(engine->binOffsets, sweep->header.rayCount * sizeof(int32_t));
+    for (j = 0; j < sweep->header.rayCount; j++) {
+        engine->binOffsets[j] = -1;
+    }
+    const float binWidth = 360.0f / (float)sweep->header.rayCount;
+    const RKFloat *origin = RKGetFloatDataFromRay(sweep->rays[engine->baseRayIndex], 0);
+    for (j = 0; j < sweep->header.rayCount; j++) {
+        ray = sweep->rays[j];
+        o = RKGetFloatDataFromRay(ray, 0) - origin;
+        if (o > INT32_MAX - RKMaximumGateCount) {
+            RKLog("%s Error. Rays are too far apart to be gathered.\n", engine->name);
+            pthread_mutex_unlock(&engine->mutex);
+            return RKResultNullInput;
+        }
+        d = ray->header.endAzimuth - ray->header.startAzimuth;
+        if (d < -180.0f) {
+            d += 360.0f;
+        } else if (d > 180.0f) {
+            d -= 360.0f;
+        }
+        c = fmodf(ray->header.startAzimuth + 0.5f * d + 360.0f, 360.0f);
+        engine->binOffsets[MIN((int)(c / binWidth), (int)sweep->header.rayCount - 1)] = (int32_t)o;
+    }
+
+    // Output arrays are allocated when a moment is first gridded
+    for (m = 0; m < RKBaseMomentCount; m++) {
+        if (!(sweep->header.baseMomentList & (RKBaseMomentListProductZ << m)) || engine->data[m]) {
+            continue;
+        }
+        POSIX_MEMALIGN_CHECK(posix_memalign((void **)&engine->data[m], RKSIMDAlignSize, engine->cellCount * sizeof(RKFloat)))
+        engine->memoryUsage += engine->cellCount * sizeof(RKFloat);
+    }
+
+    engine->jobTable = table;
+    engine->jobSweep = sweep;
+    engine->jobMomentList = sweep->header.baseMomentList;
+    RKGridEngineRunJob(engine, RKGridJobTypeGridSweep);
+    engine->jobSweep = NULL;
+
+    pthread_mutex_unlock(&engine->mutex);
+
+    return RKResultSuccess;
+}
+
+// The gridded moment of the last sweep, NULL if it has not been gridded
+RKFloat *RKGridEngineGetData(RKGridEngine *engine, const RKBaseMomentIndex index) {
+    if (index >= RKBaseMomentCount || !(engine->jobMomentList & (RKBaseMomentListProductZ << index))) {
+        return NULL;
+    }
+    return engine->data[index];
+}
@@ -8,8 +8,256 @@
 
 #include <RadarKit/RKHealth.h>
 
+#define RKHealthEngineOverrideLength     512                               // Space for the overrides and the log time
+
 #pragma mark - Helper Functions
 
+static uint32_t RKHealthKeyHash(const char *name) {
+    uint8_t c;
+    uint32_t h = 2166136261u;
+    while ((c = (uint8_t)*name++) != '\0') {
+        h = (h ^ (c >= 'A' && c <= 'Z' ? c + 32 : c)) * 16777619u;
+    }
+    return h;
+}
+
+// Slot of the name in the key table, or the vacancy where it would go
+static uint32_t RKHealthEngineKeySlot(RKHealthEngine *engine, const char *name) {
+    uint32_t k = RKHealthKeyHash(name) & (RKHealthStoreHashSize - 1);
+    while (engine->keyTable[k] != RKHealthKeyInvalid && strcasecmp(engine->records[engine->keyTable[k]].name, name)) {
+        k = (k + 1) & (RKHealthStoreHashSize - 1);
+    }
+    return k;
+}
+
+static RKHealthKey RKHealthEngineInternKeyLocked(RKHealthEngine *engine, const char *name) {
+    uint32_t k = RKHealthEngineKeySlot(engine, name);
+    if (engine->keyTable[k] != RKHealthKeyInvalid) {
+        return engine->keyTable[k];
+    }
+    if (engine->recordCount == RKHealthStoreCapacity) {
+        if (engine->verbose) {
+            RKLog("%s Error. No room for key '%s'.\n", engine->name, name);
+        }
+        return RKHealthKeyInvalid;
+    }
+    RKHealthKey key = engine->recordCount++;
+    RKHealthRecord *record = &engine->records[key];
+    memset(record, 0, sizeof(RKHealthRecord));
+    strncpy(record->name, name, RKNameLength - 1);
+    if (strcasestr(name, "heading")) {
+        record->role = RKHealthKeyRoleHeading;
+    } else if (strcasestr(name, "latitude")) {
+        record->role = RKHealthKeyRoleLatitude;
+    } else if (strcasestr(name, "longitude")) {
+        record->role = RKHealthKeyRoleLongitude;
+    }
+    engine->keyTable[k] = key;
+    return key;
+}
+
+// Add (+1) or remove (-1) the enum of a record from the counts of its node
+static void RKHealthEngineCountEnum(RKHealthEngine *engine, const RKHealthRecord *record, const int delta) {
+    int e = (int)record->statusEnum - (int)RKStatusEnumOld;
+    if (record->type != RKHealthValueTypeNull && record->hasEnum && e >= 0 && e < RKHealthStoreEnumCount) {
+        engine->enumCounts[record->node][e] += delta;
+    }
+}
+
+static void RKHealthEngineReplaceEnum(RKHealthEngine *engine, RKHealthRecord *record, const RKStatusEnum value) {
+    if (!record->hasEnum || record->statusEnum == value) {
+        return;
+    }
+    RKHealthEngineCountEnum(engine, record, -1);
+    record->statusEnum = value;
+    RKReplaceAllValuesOfKey(record->text, "Enum", value);
+    RKHealthEngineCountEnum(engine, record, +1);
+}
+
+// Type and number of a JSON value, e.g., "69.3degC" -> String 69.3, true -> Bool 1
+static void RKHealthRecordSetValue(RKHealthRecord *record, const uint8_t type, char *value) {
+    size_t len;
+    switch (type) {
+        case RKJSONObjectTypeString:
+            len = strlen(value);
+            if (len >= 2 && *value == '"' && value[len - 1] == '"') {
+                value[len - 1] = '\0';
+                value++;
+            }
+            if (!strcasecmp(value, "true") || !strcasecmp(value, "false")) {
+                record->type = RKHealthValueTypeBool;
+                record->number = *value == 't' || *value == 'T' ? 1.0 : 0.0;
+            } else {
+                record->type = RKHealthValueTypeString;
+                record->number = atof(value);
+            }
+            break;
+        case RKJSONObjectTypePlain:
+            if (!strncasecmp(value, "true", 4) || !strncasecmp(value, "false", 5)) {
+                record->type = RKHealthValueTypeBool;
+                record->number = *value == 't' || *value == 'T' ? 1.0 : 0.0;
+            } else {
+                record->type = RKHealthValueTypeNumber;
+                record->number = atof(value);
+            }
+            break;
+        case RKJSONObjectTypeArray:
+            record->type = RKHealthValueTypeArray;
+            record->number = NAN;
+            break;
+        default:
+            record->type = RKHealthValueTypeObject;
+            record->number = NAN;
+            break;
+    }
+}
+
+static int RKHealthEngineIngestLocked(RKHealthEngine *engine, const RKHealthNode node, const char *string) {
+    int k;
+    char *ks, *sks;
+    uint8_t type, subType, valueType;
+    RKHealthRecord *record;
+
+    char *key = engine->scratch;
+    char *obj = key + RKMaximumStringLength;
+    char *subKey = obj + RKMaximumStringLength;
+    char *subObj = subKey + RKMaximumStringLength;
+    char *value = subObj + RKMaximumStringLength;
+
+    if (*string != '{' || strlen(string) >= RKMaximumStringLength) {
+        return RKResultNullInput;
+    }
+    const uint32_t revision = ++engine->nodeRevisions[node];
+
+    ks = (char *)string + 1;
+    while (ks != NULL && *ks != '\0' && *ks != '}') {
+        if ((ks = RKExtractJSON(ks, &type, key, obj)) == NULL) {
+            break;
+        }
+        if ((k = RKHealthEngineInternKeyLocked(engine, key)) == RKHealthKeyInvalid) {
+            continue;
+        }
+        record = &engine->records[k];
+        RKHealthEngineCountEnum(engine, record, -1);
+        record->node = node;
+        record->revision = revision;
+        record->hasEnum = false;
+        // An object may carry a value and an enum, e.g., {"Value":true,"Enum":0}
+        valueType = type;
+        strcpy(value, obj);
+        if (type == RKJSONObjectTypeObject) {
+            sks = obj + 1;
+            while (sks != NULL && *sks != '\0' && *sks != '}') {
+                if ((sks = RKExtractJSON(sks, &subType, subKey, subObj)) == NULL) {
+                    break;
+                }
+                if (!strcasecmp(subKey, "Enum")) {
+                    record->hasEnum = true;
+                    record->statusEnum = (RKStatusEnum)atoi(subObj);
+                } else if (!strcasecmp(subKey, "Value")) {
+                    valueType = subType;
+                    strcpy(value, subObj);
+                }
+            }
+        }
+        RKStripTail(value);
+        RKHealthRecordSetValue(record, valueType, value);
+        RKStripTail(obj);
+        if (strlen(obj) >= RKHealthRecordValueLength - 1) {
+            RKLog("%s Error. Value of '%s' is too long (%zu).\n", engine->name, key, strlen(obj));
+            record->type = RKHealthValueTypeNull;
+            continue;
+        }
+        strcpy(record->text, obj);
+        RKReviseLogicalValues(record->text);
+        RKHealthEngineCountEnum(engine, record, +1);
+        if (record->role != RKHealthKeyRoleNone) {
+            engine->roleKeys[record->role] = k;
+        }
+    }
+
+    // Keys that are no longer reported by this node
+    for (k = 0; k < engine->recordCount; k++) {
+        record = &engine->records[k];
+        if (record->node == node && record->revision != revision && record->type != RKHealthValueTypeNull) {
+            RKHealthEngineCountEnum(engine, record, -1);
+            record->type = RKHealthValueTypeNull;
+        }
+    }
+    return RKResultSuccess;
+}
+
+// Keys of the active nodes as "key":value, ... in the order of the nodes
+static size_t RKHealthEngineWriteRecords(RKHealthEngine *engine, char *string, const size_t capacity) {
+    int j, k;
+    size_t i = 0, len;
+    RKHealthRecord *record;
+    const int count = engine->radarDescription ? engine->radarDescription->healthNodeCount : RKHealthNodeCount;
+    for (j = 0; j < count; j++) {
+        for (k = 0; k < engine->recordCount; k++) {
+            record = &engine->records[k];
+            if (record->node != j || record->type == RKHealthValueTypeNull) {
+                continue;
+            }
+            len = strlen(record->name) + strlen(record->text) + 5;
+            if (i + len >= capacity) {
+                RKLog("%s Error. Not enough space for '%s'.\n", engine->name, record->name);
+                return i;
+            }
+            i += sprintf(string + i, "\"%s\":%s, ", record->name, record->text);
+        }
+    }
+    return i;
+}
+
+static RKHealthRecord *RKHealthEngineRoleRecord(RKHealthEngine *engine, const RKHealthKeyRole role) {
+    RKHealthKey key = engine->roleKeys[role];
+    if (key == RKHealthKeyInvalid || engine->records[key].type == RKHealthValueTypeNull) {
+        return NULL;
+    }
+    return &engine->records[key];
+}
+
+// The JSON of all the records, the overrides and the log time
+static size_t RKHealthEngineWriteJSONLocked(RKHealthEngine *engine, char *string, const size_t capacity, const time_t logTime) {
+    RKRadarDesc *desc = engine->radarDescription;
+    size_t i = sprintf(string, "{");
+    i += RKHealthEngineWriteRecords(engine, string + i, capacity - RKHealthEngineOverrideLength);
+    if (engine->headingOverride && desc) {
+        // Concatenate with heading values if GPS values are not reported
+        i += sprintf(string + i,
+                     "\"Heading Override\":{\"Value\":true,\"Enum\":0}, "
+                     "\"Sys Heading\":{\"Value\":\"%.2f deg\",\"Enum\":0}, ",
+                     desc->heading);
+    }
+    if (engine->locationOverride && desc) {
+        // Concatenate with latitude, longitude and heading values if GPS values are not reported
+        i += sprintf(string + i,
+                     "\"GPS Override\":{\"Value\":true,\"Enum\":0}, "
+                     "\"Sys Latitude\":{\"Value\":\"%.7f\",\"Enum\":0}, "
+                     "\"Sys Longitude\":{\"Value\":\"%.7f\",\"Enum\":0}, "
+                     "\"LocationFromDescriptor\":true, ",
+                     desc->latitude,
+                     desc->longitude);
+    }
+    i += sprintf(string + i, "\"Log Time\":%zu}", logTime);                                          // Add the log time as the last object
+    return i;
+}
+
+static void RKHealthEngineClearRecords(RKHealthEngine *engine) {
+    int k;
+    for (k = 0; k < engine->recordCount; k++) {
+        engine->records[k].type = RKHealthValueTypeNull;
+    }
+    for (k = 0; k < RKHealthKeyRoleCount; k++) {
+        engine->roleKeys[k] = RKHealthKeyInvalid;
+    }
+    for (k = 0; k < RKHealthNodeCount; k++) {
+        engine->nodeIdentifiers[k] = (RKIdentifier)-1;
+    }
+    memset(engine->enumCounts, 0, sizeof(engine->enumCounts));
+}
+
 #pragma mark - Delegate Workers
 
 static void *healthConsolidator(void *_in) {
@@ -20,13 +268,13 @@ static void *healthConsolidator(void *_in) {
 	struct timeval t0, t1;
 
     RKHealth *health;
+    RKHealthRecord *record;
 
 	bool allTrue;
 	char *string;
     double latitude;
     double longitude;
     float heading;
-    char *stringValue, *stringEnum, *stringObject;
     int headingChangeCount = 0;
     int locationChangeCount = 0;
 
@@ -151,15 +399,16 @@ static void *healthConsolidator(void *_in) {
             RKLog("%s %s   k = %d   s = %d\n", engine->name, string, k, s);
         }
 
-        // Combine all the active JSON strings
-        i = sprintf(string, "{");
+        // Only the nodes that have reported since the last time need to be parsed, all of them into the records
+        pthread_mutex_lock(&engine->mutex);
         for (j = 0; j < desc->healthNodeCount; j++) {
             n = indices[j];
-            if (engine->healthNodes[j].active && strlen(engine->healthNodes[j].healths[n].string) > 6) {   // {"k":0} is at least 7 chars
-                i += sprintf(string + i, "%s", engine->healthNodes[j].healths[n].string + 1);              // Ignore the first "{"
-                i -= RKStripTail(string);                                                                  // Strip away white spaces
-                i--;                                                                                       // Ignore the last "}"
-                i += sprintf(string + i, ", ");                                                            // Get ready to concatenante
+            if (!engine->healthNodes[j].active || engine->nodeIdentifiers[j] == engine->healthNodes[j].healths[n].i) {
+                continue;
+            }
+            engine->nodeIdentifiers[j] = engine->healthNodes[j].healths[n].i;
+            if (strlen(engine->healthNodes[j].healths[n].string) > 6) {                                    // {"k":0} is at least 7 chars
+                RKHealthEngineIngestLocked(engine, j, engine->healthNodes[j].healths[n].string);
                 engine->healthNodes[j].healths[n].flag |= RKHealthFlagUsed;
             }
         }
@@ -168,37 +417,39 @@ static void *healthConsolidator(void *_in) {
         heading = NAN;
         latitude = NAN;
         longitude = NAN;
-        if ((stringObject = RKGetValueOfKey(string, "heading")) != NULL) {
-            stringValue = RKGetValueOfKey(stringObject, "value");
-            stringEnum = RKGetValueOfKey(stringObject, "enum");
-            if (stringValue != NULL && stringEnum != NULL && atoi(stringEnum) == RKStatusEnumNormal) {
-                heading = (float)atof(stringValue);
-            }
+        if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleHeading)) != NULL &&
+            record->hasEnum && record->statusEnum == RKStatusEnumNormal) {
+            heading = (float)record->number;
         }
-        if ((stringObject = RKGetValueOfKey(string, "latitude")) != NULL) {
-            stringValue = RKGetValueOfKey(stringObject, "value");
-            stringEnum = RKGetValueOfKey(stringObject, "enum");
-            if (stringValue != NULL && stringEnum != NULL && atoi(stringEnum) == RKStatusEnumNormal) {
-                latitude = atof(stringValue);
-            }
+        if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleLatitude)) != NULL &&
+            record->hasEnum && record->statusEnum == RKStatusEnumNormal) {
+            latitude = record->number;
         }
-        if ((stringObject = RKGetValueOfKey(string, "longitude")) != NULL) {
-            stringValue = RKGetValueOfKey(stringObject, "value");
-            stringEnum = RKGetValueOfKey(stringObject, "enum");
-            if (stringValue != NULL && stringEnum != NULL && atoi(stringEnum) == RKStatusEnumNormal) {
-                longitude = atof(stringValue);
-            }
+        if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleLongitude)) != NULL &&
+            record->hasEnum && record->statusEnum == RKStatusEnumNormal) {
+            longitude = record->number;
         }
         if (isnan(heading) || (desc->initFlags & RKInitFlagIgnoreHeading)) {
             // If there is also supplied GPS, replace the enum of the GPS readings to not wired
-            RKReplaceEnumOfKey(string, "heading", RKStatusEnumNotWired);
-            // Concatenate with heading values if GPS values are not reported
-            i += sprintf(string + i,
-                         "\"Heading Override\":{\"Value\":true,\"Enum\":0}, "
-                         "\"Sys Heading\":{\"Value\":\"%.2f deg\",\"Enum\":0}, ",
-                         desc->heading);
-            
-        } else {
+            if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleHeading)) != NULL) {
+                RKHealthEngineReplaceEnum(engine, record, RKStatusEnumNotWired);
+            }
+        }
+        if (isnan(latitude) || isnan(longitude) || (desc->initFlags & RKInitFlagIgnoreGPS)) {
+            if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleLatitude)) != NULL) {
+                RKHealthEngineReplaceEnum(engine, record, RKStatusEnumNotWired);
+            }
+            if ((record = RKHealthEngineRoleRecord(engine, RKHealthKeyRoleLongitude)) != NULL) {
+                RKHealthEngineReplaceEnum(engine, record, RKStatusEnumNotWired);
+            }
+        }
+
+        // The JSON is only produced when the health is read, see RKHealthEngineHealthString()
+        engine->headingOverride = isnan(heading) || (desc->initFlags & RKInitFlagIgnoreHeading);
+        engine->locationOverride = isnan(latitude) || isnan(longitude) || (desc->initFlags & RKInitFlagIgnoreGPS);
+        pthread_mutex_unlock(&engine->mutex);
+
+        if (!engine->headingOverride) {
             if (engine->verbose > 1) {
                 RKLog("%s MAG:  heading = %.2f\n", engine->name, heading);
             }
@@ -213,19 +464,7 @@ static void *healthConsolidator(void *_in) {
                 headingChangeCount = 0;
             }
         }
-        if (isnan(latitude) || isnan(longitude) || (desc->initFlags & RKInitFlagIgnoreGPS)) {
-            // If there is also supplied GPS, replace the enum of the GPS readings to not wired
-            RKReplaceEnumOfKey(string, "latitude", RKStatusEnumNotWired);
-            RKReplaceEnumOfKey(string, "longitude", RKStatusEnumNotWired);
-            // Concatenate with latitude, longitude and heading values if GPS values are not reported
-            i += sprintf(string + i,
-                         "\"GPS Override\":{\"Value\":true,\"Enum\":0}, "
-                         "\"Sys Latitude\":{\"Value\":\"%.7f\",\"Enum\":0}, "
-                         "\"Sys Longitude\":{\"Value\":\"%.7f\",\"Enum\":0}, "
-                         "\"LocationFromDescriptor\":true, ",
-                         desc->latitude,
-                         desc->longitude);
-        } else {
+        if (!engine->locationOverride) {
             if (engine->verbose > 1) {
                 RKLog("%s GPS:  latitude = %.7f   longitude = %.7f\n", engine->name, latitude, longitude);
             }
@@ -241,15 +480,13 @@ static void *healthConsolidator(void *_in) {
                 locationChangeCount = 0;
             }
         }
-        sprintf(string + i, "\"Log Time\":%zu}", t0.tv_sec);                                               // Add the log time as the last object
-
-        // Replace some quoted logical values, e.g., "TRUE", "True", "true", etc. -> true
-        RKReviseLogicalValues(string);
-
-        health->flag = RKHealthFlagReady;
+        string[0] = '\0';
+        health->time = t0;
+        health->timeDouble = (double)t0.tv_sec + 1.0e-6 * (double)t0.tv_usec;
+        health->flag = RKHealthFlagReady | RKHealthFlagDeferred;
 
         if (engine->verbose > 2) {
-            RKLog("%s", string);
+            RKLog("%s", RKHealthEngineHealthString(engine, health));
         }
 
 		engine->tic++;
@@ -276,12 +513,25 @@ RKHealthEngine *RKHealthEngineInit() {
     sprintf(engine->name, "%s<HealthCollector>%s",
             rkGlobalParameters.showColor ? RKGetBackgroundColorOfIndex(RKEngineColorHealthEngine) : "",
             rkGlobalParameters.showColor ? RKNoColor : "");
-    engine->memoryUsage = sizeof(RKHealthEngine);
+    engine->records = (RKHealthRecord *)malloc(RKHealthStoreCapacity * sizeof(RKHealthRecord));
+    engine->scratch = (char *)malloc(5 * RKMaximumStringLength);
+    if (engine->records == NULL || engine->scratch == NULL) {
+        RKLog("%s Error. Unable to allocate the health records.\n", engine->name);
+        exit(EXIT_FAILURE);
+    }
+    memset(engine->records, 0, RKHealthStoreCapacity * sizeof(RKHealthRecord));
+    memset(engine->keyTable, 0xFF, sizeof(engine->keyTable));
+    RKHealthEngineClearRecords(engine);
+    pthread_mutex_init(&engine->mutex, NULL);
+    engine->memoryUsage = sizeof(RKHealthEngine) + RKHealthStoreCapacity * sizeof(RKHealthRecord) + 5 * RKMaximumStringLength;
     engine->state = RKEngineStateAllocated;
     return engine;
 }
 
 void RKHealthEngineFree(RKHealthEngine *engine) {
+    pthread_mutex_destroy(&engine->mutex);
+    free(engine->records);
+    free(engine->scratch);
     free(engine);
 }
 
@@ -309,6 +559,9 @@ int RKHealthEngineStart(RKHealthEngine *engine) {
         return RKResultEngineNotWired;
     }
     RKLog("%s Starting ...\n", engine->name);
+    pthread_mutex_lock(&engine->mutex);
+    RKHealthEngineClearRecords(engine);
+    pthread_mutex_unlock(&engine->mutex);
     engine->tic = 0;
     engine->state |= RKEngineStateActivating;
     if (pthread_create(&engine->tidHealthConsolidator, NULL, healthConsolidator, engine)) {
@@ -352,3 +605,127 @@ int RKHealthEngineStop(RKHealthEngine *engine) {
 char *RKHealthEngineStatusString(RKHealthEngine *engine) {
     return engine->statusBuffer[RKPreviousModuloS(engine->statusBufferIndex, engine->radarDescription->healthBufferDepth)];
 }
+
+#pragma mark - Records
+
+//
+// The store keeps the latest value and enum of every key reported by the nodes. Keys are interned once so that
+// a lookup is a table access rather than a scan of the JSON strings
+//
+
+RKHealthKey RKHealthEngineInternKey(RKHealthEngine *engine, const char *name) {
+    pthread_mutex_lock(&engine->mutex);
+    RKHealthKey key = RKHealthEngineInternKeyLocked(engine, name);
+    pthread_mutex_unlock(&engine->mutex);
+    return key;
+}
+
+RKHealthKey RKHealthEngineFindKey(RKHealthEngine *engine, const char *name) {
+    pthread_mutex_lock(&engine->mutex);
+    RKHealthKey key = engine->keyTable[RKHealthEngineKeySlot(engine, name)];
+    pthread_mutex_unlock(&engine->mutex);
+    return key;
+}
+
+// Replace all the keys of a node with the ones in a JSON string, which is usually done by the consolidator
+int RKHealthEngineIngest(RKHealthEngine *engine, const RKHealthNode node, const char *string) {
+    if (string == NULL || node >= RKHealthNodeCount) {
+        return RKResultNullInput;
+    }
+    pthread_mutex_lock(&engine->mutex);
+    int r = RKHealthEngineIngestLocked(engine, node, string);
+    pthread_mutex_unlock(&engine->mutex);
+    return r;
+}
+
+bool RKHealthEngineGetRecord(RKHealthEngine *engine, const RKHealthKey key, RKHealthRecord *record) {
+    bool found = false;
+    pthread_mutex_lock(&engine->mutex);
+    if (key < engine->recordCount && engine->records[key].type != RKHealthValueTypeNull) {
+        memcpy(record, &engine->records[key], sizeof(RKHealthRecord));
+        found = true;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return found;
+}
+
+RKStatusEnum RKHealthEngineGetEnum(RKHealthEngine *engine, const RKHealthKey key) {
+    RKStatusEnum value = RKStatusEnumInvalid;
+    pthread_mutex_lock(&engine->mutex);
+    if (key < engine->recordCount && engine->records[key].type != RKHealthValueTypeNull && engine->records[key].hasEnum) {
+        value = engine->records[key].statusEnum;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return value;
+}
+
+//
+// Examine if any key of a node, or of all nodes when node = RKHealthNodeInvalid, is (target)
+// Input:
+//     const RKHealthNode node    - The node
+//     const RKStatusEnum target  - The target RKStatusEnum
+// Output:
+//     char *firstKey             - (nullable) the first key with the target enum, an RKName
+//     char *firstValue           - (nullable) the value of the first key, up to RKNameLength
+//
+bool RKHealthEngineFindCondition(RKHealthEngine *engine, const RKHealthNode node, const RKStatusEnum target, char *firstKey, char *firstValue) {
+    int j, k;
+    RKHealthRecord *record;
+    const int e = (int)target - (int)RKStatusEnumOld;
+    if (e < 0 || e >= RKHealthStoreEnumCount) {
+        return false;
+    }
+    bool found = false;
+    pthread_mutex_lock(&engine->mutex);
+    for (j = 0; j < RKHealthNodeCount; j++) {
+        if ((node == RKHealthNodeInvalid || node == j) && engine->enumCounts[j][e]) {
+            found = true;
+            break;
+        }
+    }
+    // Only need to go through the records to report the first key
+    if (found && (firstKey || firstValue)) {
+        for (k = 0; k < engine->recordCount; k++) {
+            record = &engine->records[k];
+            if ((node == RKHealthNodeInvalid || node == record->node) && record->type != RKHealthValueTypeNull &&
+                record->hasEnum && record->statusEnum == target) {
+                if (firstKey) {
+                    strcpy(firstKey, record->name);
+                }
+                if (firstValue) {
+                    strncpy(firstValue, record->text, RKNameLength - 1);
+                    firstValue[RKNameLength - 1] = '\0';
+                }
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return found;
+}
+
+// The consolidated JSON of the records as they are now, produced on demand
+size_t RKHealthEngineJSONString(RKHealthEngine *engine, char *string, const size_t capacity) {
+    size_t i;
+    if (capacity < RKHealthEngineOverrideLength + 2) {
+        return 0;
+    }
+    pthread_mutex_lock(&engine->mutex);
+    i = RKHealthEngineWriteJSONLocked(engine, string, capacity, time(NULL));
+    pthread_mutex_unlock(&engine->mutex);
+    return i;
+}
+
+// The string of a consolidated health, which is produced from the records when it is first read
+char *RKHealthEngineHealthString(RKHealthEngine *engine, RKHealth *health) {
+    if (!(health->flag & RKHealthFlagDeferred)) {
+        return health->string;
+    }
+    pthread_mutex_lock(&engine->mutex);
+    if (health->flag & RKHealthFlagDeferred) {
+        RKHealthEngineWriteJSONLocked(engine, health->string, RKMaximumStringLength, health->time.tv_sec);
+        health->flag &= ~RKHealthFlagDeferred;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return health->string;
+}
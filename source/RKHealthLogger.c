@@ -77,9 +77,11 @@ static void *healthLogger(void *in) {
             break;
         }
 
-        // Log a copy
-        char *keyValue = RKGetValueOfKey(health->string, "Log Time");
-        if (keyValue == NULL) {
+        // Log a copy, the consolidated string is only produced if it is recorded
+        char *keyValue = NULL;
+        if (health->time.tv_sec) {
+            unixTime = (time_t)health->time.tv_sec;
+        } else if ((keyValue = RKGetValueOfKey(health->string, "Log Time")) == NULL) {
             RKLog("%s Error. No log time found.\n", engine->name);
             unixTime = (time_t)t0.tv_sec;
         } else {
@@ -117,7 +119,7 @@ static void *healthLogger(void *in) {
             }
         }
         if (engine->fid) {
-            fprintf(engine->fid, "%s\n", health->string);
+            fprintf(engine->fid, "%s\n", engine->healthEngine ? RKHealthEngineHealthString(engine->healthEngine, health) : health->string);
         }
 
 //        RKProcessHealthKeywords(engine, health->string);
@@ -177,6 +179,10 @@ void RKHealthLoggerSetInputOutputBuffers(RKHealthLogger *engine, RKRadarDesc *de
     engine->state |= RKEngineStateProperlyWired;
 }
 
+void RKHealthLoggerSetHealthEngine(RKHealthLogger *engine, RKHealthEngine *healthEngine) {
+    engine->healthEngine = healthEngine;
+}
+
 void RKHealthLoggerSetRecord(RKHealthLogger *engine, const bool value) {
     engine->record = value;
 }
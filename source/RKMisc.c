@@ -624,6 +624,65 @@ void RKReplaceFileExtension(char *filename, const char *pattern, const char *rep
     }
 }
 
+//
+// Reserve disk space for a file that is about to grow so that it is laid out contiguously. The file size is not
+// changed, readers still see the end of what has been written. Returns true if the space has been reserved.
+//
+bool RKFilePreallocate(const int fd, const size_t size) {
+#if defined(_GNU_SOURCE)
+    return fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)size) == 0;
+#else
+    return false;
+#endif
+}
+
+// Release the reserved space that has not been used, i.e., beyond size up to reserved. A truncate at the file size
+// does it, punching a hole beyond the end of the file is ignored by some file systems
+void RKFileReleasePreallocation(const int fd, const size_t size, const size_t reserved) {
+    if (reserved > size && ftruncate(fd, (off_t)size)) {
+        fprintf(stderr, "Error in ftruncate()   errno = %d\n", errno);
+    }
+}
+
+//
+// Bound the dirty pages of a file that is written sequentially. Once more than window bytes have been written
+// since synced, write-back of those is started. The write-back that was started in the previous call, from waited
+// to synced, is waited for and those pages are dropped from the page cache, waited is then moved up to synced.
+// Returns the new synced offset, which should be passed in the next call along with waited.
+//
+size_t RKFileWriteBehind(const int fd, size_t *waited, const size_t synced, const size_t written, const size_t window) {
+    if (window == 0 || written < synced + window) {
+        return synced;
+    }
+#if defined(_GNU_SOURCE)
+    sync_file_range(fd, (off_t)synced, (off_t)(written - synced), SYNC_FILE_RANGE_WRITE);
+    if (synced > *waited) {
+        sync_file_range(fd, (off_t)*waited, (off_t)(synced - *waited), SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(fd, (off_t)*waited, (off_t)(synced - *waited), POSIX_FADV_DONTNEED);
+    }
+#endif
+    *waited = synced;
+    return written;
+}
+
+// Let the pages of a file go from the page cache, dirty pages are scheduled for write-back
+void RKFileDropCache(const int fd) {
+#if defined(_GNU_SOURCE)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+}
+
+void RKFileDropCacheOfFilename(const char *filename) {
+#if defined(_GNU_SOURCE)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    RKFileDropCache(fd);
+    close(fd);
+#endif
+}
+
 #pragma mark - Enum to String
 
 char *RKSignalString(const int signal) {
@@ -1091,6 +1091,22 @@ static void *pulseGatherer(void *_in) {
                     // New origin for the next ray
                     engine->momentSource[j].origin = k;
                     ray = RKGetRayFromBuffer(engine->rayBuffer, j);
+                    // Products may still refer to this ray in place, give them a moment to let go, then make them
+                    engine->state |= RKEngineStateSleep3;
+                    s = 0;
+                    while (ray->header.s & RKRayStatusBeingConsumed && s < RKMomentEngineRayPinTimeoutMs && engine->state & RKEngineStateWantActive) {
+                        usleep(1000);
+                        s++;
+                    }
+                    if (ray->header.s & RKRayStatusBeingConsumed) {
+                        if (engine->verbose > 1) {
+                            RKLog("%s sleep 3/%.1f s   j = %d   header.s = 0x%02x   Evicting ...\n", engine->name, (float)s * 0.001f, j, ray->header.s);
+                        }
+                        if (engine->rayEvictor) {
+                            engine->rayEvictor(engine->rayHolder, ray);
+                        }
+                    }
+                    engine->state ^= RKEngineStateSleep3;
                     ray->header.s = RKRayStatusVacant;
                     count = 0;
                 } else {
@@ -1234,6 +1250,12 @@ void RKMomentEngineSetCoreOrigin(RKMomentEngine *engine, const uint8_t origin) {
     engine->coreOrigin = origin;
 }
 
+// A holder that refers to the rays in place, the evictor is called when the holder has not let go of a ray in time
+void RKMomentEngineSetRayEvictor(RKMomentEngine *engine, void *holder, void (*evictor)(void *, RKRay *)) {
+    engine->rayHolder = holder;
+    engine->rayEvictor = evictor;
+}
+
 #pragma mark - Interactions
 
 int RKMomentEngineStart(RKMomentEngine *engine) {
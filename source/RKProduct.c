@@ -32,12 +32,14 @@ size_t RKProductBufferAlloc(RKProduct **buffer, const uint32_t depth, const uint
         product->startElevation = (RKFloat *)malloc(headSize);
         product->endElevation = (RKFloat *)malloc(headSize);
         product->data = (RKFloat *)malloc(dataSize);
+        product->rayData = (RKFloat **)malloc(rayCount * sizeof(RKFloat *));
         product->capacity = capacity;
         memset(product->startAzimuth, 0, headSize);
         memset(product->endAzimuth, 0, headSize);
         memset(product->startElevation, 0, headSize);
         memset(product->endElevation, 0, headSize);
         memset(product->data, 0, dataSize);
+        memset(product->rayData, 0, rayCount * sizeof(RKFloat *));
         product->totalBufferSize = (uint32_t)sizeof(RKProduct) + 4 * headSize + dataSize;
         size += product->totalBufferSize;
     }
@@ -54,15 +56,36 @@ void RKProductBufferFree(RKProduct *buffer, const int depth) {
         free(product->startElevation);
         free(product->endElevation);
         free(product->data);
+        free(product->rayData);
     }
     free(buffer);
 }
 
-int RKProductInitFromSweep(RKProduct *product, const RKSweep *sweep) {
+// Moment of the rays that a product carries, RKBaseMomentIndexCount if it is not one of the base moments
+static RKBaseMomentIndex productBaseMomentIndex(const RKProduct *product) {
+    if (!strcmp(product->desc.symbol, "Z")) {
+        return RKBaseMomentIndexZ;
+    } else if (!strcmp(product->desc.symbol, "V")) {
+        return RKBaseMomentIndexV;
+    } else if (!strcmp(product->desc.symbol, "W")) {
+        return RKBaseMomentIndexW;
+    } else if (!strcmp(product->desc.symbol, "D")) {
+        return RKBaseMomentIndexD;
+    } else if (!strcmp(product->desc.symbol, "P")) {
+        return RKBaseMomentIndexP;
+    } else if (!strcmp(product->desc.symbol, "R")) {
+        return RKBaseMomentIndexR;
+    } else if (!strcmp(product->desc.symbol, "K")) {
+        return RKBaseMomentIndexK;
+    } else if (!strcmp(product->desc.symbol, "Sh")) {
+        return RKBaseMomentIndexSh;
+    }
+    return RKBaseMomentIndexCount;
+}
+
+// Header and ray angles of a product from a sweep
+static void productHeaderFromSweep(RKProduct *product, const RKSweep *sweep) {
     int k;
-    
-    // Required capacity
-    const uint32_t requiredCapacity = (uint32_t)ceilf(sweep->header.rayCount / 90.0f) * 90 * (uint32_t)ceilf(sweep->header.gateCount / 100.0f) * 100;
 
     // Sweep header
     memcpy(product->header.radarName, sweep->header.desc.name, sizeof(RKName));
@@ -104,7 +127,17 @@ int RKProductInitFromSweep(RKProduct *product, const RKSweep *sweep) {
     memcpy(product->header.waveformName, sweep->header.config.waveformName, sizeof(RKName));
     memcpy(product->header.vcpDefinition, sweep->header.config.vcpDefinition, sizeof(RKMaximumCommandLength));
     
-    // Expand if the current capacity is not sufficient
+    for (k = 0; k < product->header.rayCount; k++) {
+        product->startAzimuth[k]   = sweep->rays[k]->header.startAzimuth;
+        product->endAzimuth[k]     = sweep->rays[k]->header.endAzimuth;
+        product->startElevation[k] = sweep->rays[k]->header.startElevation;
+        product->endElevation[k]   = sweep->rays[k]->header.endElevation;
+    }
+}
+
+// Expand the data if the current capacity is not sufficient
+static void productReserve(RKProduct *product, const uint32_t rayCount, const uint32_t gateCount) {
+    const uint32_t requiredCapacity = (uint32_t)ceilf(rayCount / 90.0f) * 90 * (uint32_t)ceilf(gateCount / 100.0f) * 100;
     if (product->capacity < requiredCapacity) {
         product->data = (RKFloat *)realloc(product->data, requiredCapacity * sizeof(RKFloat));
         if (product->data == NULL) {
@@ -114,32 +147,18 @@ int RKProductInitFromSweep(RKProduct *product, const RKSweep *sweep) {
         product->capacity = requiredCapacity;
         product->totalBufferSize = sizeof(RKProduct) + (4 * RKMaximumRaysPerSweep + product->capacity) * sizeof(RKFloat);
     }
-    for (k = 0; k < product->header.rayCount; k++) {
-        product->startAzimuth[k]   = sweep->rays[k]->header.startAzimuth;
-        product->endAzimuth[k]     = sweep->rays[k]->header.endAzimuth;
-        product->startElevation[k] = sweep->rays[k]->header.startElevation;
-        product->endElevation[k]   = sweep->rays[k]->header.endElevation;
-    }
-    
+}
+
+int RKProductInitFromSweep(RKProduct *product, const RKSweep *sweep) {
+    int k;
+
+    productHeaderFromSweep(product, sweep);
+    product->flag &= ~RKProductStatusView;
+
+    productReserve(product, sweep->header.rayCount, sweep->header.gateCount);
+
     // Copy over the data if this is one of the base moments
-    RKBaseMomentIndex momentIndex = RKBaseMomentIndexCount;
-    if (!strcmp(product->desc.symbol, "Z")) {
-        momentIndex = RKBaseMomentIndexZ;
-    } else if (!strcmp(product->desc.symbol, "V")) {
-        momentIndex = RKBaseMomentIndexV;
-    } else if (!strcmp(product->desc.symbol, "W")) {
-        momentIndex = RKBaseMomentIndexW;
-    } else if (!strcmp(product->desc.symbol, "D")) {
-        momentIndex = RKBaseMomentIndexD;
-    } else if (!strcmp(product->desc.symbol, "P")) {
-        momentIndex = RKBaseMomentIndexP;
-    } else if (!strcmp(product->desc.symbol, "R")) {
-        momentIndex = RKBaseMomentIndexR;
-    } else if (!strcmp(product->desc.symbol, "K")) {
-        momentIndex = RKBaseMomentIndexK;
-    } else if (!strcmp(product->desc.symbol, "Sh")) {
-        momentIndex = RKBaseMomentIndexSh;
-    }
+    RKBaseMomentIndex momentIndex = productBaseMomentIndex(product);
     if (momentIndex < RKBaseMomentIndexCount) {
         RKFloat *x, *y = product->data;
         for (k = 0; k < product->header.rayCount; k++) {
@@ -159,6 +178,50 @@ int RKProductInitFromSweep(RKProduct *product, const RKSweep *sweep) {
     return RKResultSuccess;
 }
 
+//
+// Same as RKProductInitFromSweep() but a base moment is not copied, the product refers to the data in the rays,
+// which must stay in the ray buffer until the product is consumed. Use RKProductGetRayData() to access the data.
+// Products that are not base moments are initialized with their own data.
+//
+int RKProductInitViewFromSweep(RKProduct *product, const RKSweep *sweep) {
+    int k;
+
+    RKBaseMomentIndex momentIndex = productBaseMomentIndex(product);
+    if (momentIndex == RKBaseMomentIndexCount || product->rayData == NULL) {
+        return RKProductInitFromSweep(product, sweep);
+    }
+
+    productHeaderFromSweep(product, sweep);
+    for (k = 0; k < product->header.rayCount; k++) {
+        product->rayData[k] = RKGetFloatDataFromRay(sweep->rays[k], momentIndex);
+    }
+    product->flag |= RKProductStatusView;
+
+    return RKResultSuccess;
+}
+
+// Copy the rays that a view refers to into the product, after which the rays in the ray buffer may be reused
+int RKProductDetachView(RKProduct *product) {
+    int k;
+    if (!(product->flag & RKProductStatusView)) {
+        return RKResultSuccess;
+    }
+    productReserve(product, product->header.rayCount, product->header.gateCount);
+    for (k = 0; k < product->header.rayCount; k++) {
+        memcpy(product->data + k * product->header.gateCount, product->rayData[k], product->header.gateCount * sizeof(RKFloat));
+    }
+    product->flag &= ~RKProductStatusView;
+    return RKResultSuccess;
+}
+
+// Data of a ray of a product, in place if the product is a view
+RKFloat *RKProductGetRayData(const RKProduct *product, const uint32_t k) {
+    if (product->flag & RKProductStatusView) {
+        return product->rayData[k];
+    }
+    return product->data + k * product->header.gateCount;
+}
+
 void RKProductFree(RKProduct *product) {
     free(product);
 }
@@ -10,10 +10,32 @@
 
 #if RKFloat == float
 #define rk_nc_get_var_float   nc_get_var_float
+#define rk_nc_get_vara_float  nc_get_vara_float
 #else
 #define rk_nc_get_var_float   nc_get_var_double
+#define rk_nc_get_vara_float  nc_get_vara_double
 #endif
 
+// NetCDF keeps global states without locks, calls from different threads must be serialized
+static pthread_mutex_t productFileMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Write a file image that the library has built in memory, no lock is needed from here on
+static int writeMemoryImage(const char *filename, const NC_memio *image) {
+    FILE *fid = fopen(filename, "wb");
+    if (fid == NULL) {
+        RKLog("Error. Unable to create %s\n", filename);
+        return RKResultFailedToOpenFileForProduct;
+    }
+    size_t size = fwrite(image->memory, 1, image->size, fid);
+    fclose(fid);
+    if (size != image->size) {
+        RKLog("Error. Only %s of %s B written to %s\n",
+              RKUIntegerToCommaStyleString(size), RKUIntegerToCommaStyleString(image->size), filename);
+        return RKResultFailedToOpenFileForProduct;
+    }
+    return RKResultSuccess;
+}
+
 static void getGlobalTextAttribute(char *dst, const char *name, const int ncid) {
     size_t n = 0;
     nc_get_att_text(ncid, NC_GLOBAL, name, dst);
@@ -32,78 +54,28 @@ static int get_global_float_att(const int ncid, const nc_type type, const char *
     return nc_get_att_double(ncid, NC_GLOBAL, att, (double *)dest);
 }
 
-int RKProductFileWriterNC(RKProduct *product, const char *filename) {
-    int j;
-    int ncid;
-    int dimensionIds[2];
-    int variableIdAzimuth;
-    int variableIdElevation;
-    int variableIdBeamwidth;
-    int variableIdGateWidth;
-    int variableIdData;
-    
+//
+// Global attributes shared by the product files and the sweep files, some are WDSS-II required. A sweep file
+// lists its moments, which carry their own unit and colormap, a product file puts them here.
+//
+void RKProductFilePutGlobalAttributes(const int ncid, const RKProduct *product, const char *moments) {
     int tmpi;
     float tmpf;
-    float *x;
-
-    // Open a file
-    //if ((j = nc_create(product->header.suggestedFilename, NC_MODE, &ncid)) > 0) {
-    if ((j = nc_create(filename, NC_MODE, &ncid)) > 0) {
-        RKLog("Error. Unable to create %s", filename);
-        return RKResultFailedToOpenFileForProduct;
-    }
-   
-    // Some global attributes
     const float zf = 0.0f;
     const float va = 0.25f * product->header.wavelength / product->header.prt[0];
     const nc_type floatType = sizeof(RKFloat) == sizeof(double) ? NC_DOUBLE : NC_FLOAT;
 
-    // Local memory
-    RKFloat *array1D = (RKFloat *)malloc(MAX(product->header.rayCount, product->header.gateCount) * sizeof(RKFloat));
-
-    // Scan type
-    if (product->header.isPPI) {
-        nc_def_dim(ncid, "Azimuth", product->header.rayCount, &dimensionIds[0]);
-    } else if (product->header.isRHI) {
-        nc_def_dim(ncid, "Elevation", product->header.rayCount, &dimensionIds[0]);
-    } else {
-        nc_def_dim(ncid, "Beam", product->header.rayCount, &dimensionIds[0]);
+    put_global_text_att(ncid, "TypeName", moments ? "Sweep" : product->desc.name);
+    put_global_text_att(ncid, "DataType", "RadialSet");
+    if (moments) {
+        put_global_text_att(ncid, "Moments", moments);
     }
-    nc_def_dim(ncid, "Gate", product->header.gateCount, &dimensionIds[1]);
-    
-    // Define variables
-    nc_def_var(ncid, "Azimuth", NC_FLOAT, 1, dimensionIds, &variableIdAzimuth);
-    nc_def_var(ncid, "Elevation", NC_FLOAT, 1, dimensionIds, &variableIdElevation);
-    nc_def_var(ncid, "Beamwidth", NC_FLOAT, 1, dimensionIds, &variableIdBeamwidth);
-    nc_def_var(ncid, "GateWidth", NC_FLOAT, 1, dimensionIds, &variableIdGateWidth);
-    nc_def_var(ncid, product->desc.name, NC_FLOAT, 2, dimensionIds, &variableIdData);
-
-    nc_put_att_text(ncid, variableIdAzimuth, "Units", 7, "Degrees");
-    nc_put_att_text(ncid, variableIdElevation, "Units", 7, "Degrees");
-    nc_put_att_text(ncid, variableIdBeamwidth, "Units", 7, "Degrees");
-    nc_put_att_text(ncid, variableIdGateWidth, "Units", 6, "Meters");
-    nc_put_att_text(ncid, variableIdData, "Units", strlen(product->desc.unit), product->desc.unit);
-
-#if defined (COMPRESSED_NETCDF)
-
-    RKLog("Warning. Using NetCDF compression.\n");
-    nc_def_var_deflate(ncid, variableIdAzimuth, 1, 1, 3);
-    nc_def_var_deflate(ncid, variableIdElevation, 1, 1, 3);
-    nc_def_var_deflate(ncid, variableIdBeamwidth, 1, 1, 3);
-    nc_def_var_deflate(ncid, variableIdGateWidth, 1, 1, 3);
-    nc_def_var_deflate(ncid, variableIdData, 1, 1, 3);
-
-#endif
-    
-    // Global attributes - some are WDSS-II required
-    nc_put_att_text(ncid, NC_GLOBAL, "TypeName", strlen(product->desc.name), product->desc.name);
-    nc_put_att_text(ncid, NC_GLOBAL, "DataType", 9, "RadialSet");
     if (product->header.isPPI) {
-        nc_put_att_text(ncid, NC_GLOBAL, "ScanType", 3, "PPI");
+        put_global_text_att(ncid, "ScanType", "PPI");
     } else if (product->header.isRHI) {
-        nc_put_att_text(ncid, NC_GLOBAL, "ScanType", 3, "RHI");
+        put_global_text_att(ncid, "ScanType", "RHI");
     } else {
-        nc_put_att_text(ncid, NC_GLOBAL, "ScanType", 7, "Unknown");
+        put_global_text_att(ncid, "ScanType", "Unknown");
     }
     tmpf = product->header.latitude;
     nc_put_att_float(ncid, NC_GLOBAL, "Latitude", NC_FLOAT, 1, &tmpf);
@@ -115,19 +87,27 @@ int RKProductFileWriterNC(RKProduct *product, const char *filename) {
     nc_put_att_float(ncid, NC_GLOBAL, "Height", NC_FLOAT, 1, &product->header.radarHeight);
     nc_put_att_long(ncid, NC_GLOBAL, "Time", NC_LONG, 1, &product->header.startTime);
     nc_put_att_float(ncid, NC_GLOBAL, "FractionalTime", NC_FLOAT, 1, &zf);
-    put_global_text_att(ncid, "attributes", "Wavelength Nyquist_Vel Unit radarName vcp ColorMap");
+    if (moments) {
+        put_global_text_att(ncid, "attributes", "Wavelength Nyquist_Vel radarName vcp");
+    } else {
+        put_global_text_att(ncid, "attributes", "Wavelength Nyquist_Vel Unit radarName vcp ColorMap");
+    }
     put_global_text_att(ncid, "Wavelength-unit", "Meters");
     nc_put_att_float(ncid, NC_GLOBAL, "Wavelength-value", NC_FLOAT, 1, &product->header.wavelength);
     put_global_text_att(ncid, "Nyquist_Vel-unit", "MetersPerSecond");
     nc_put_att_float(ncid, NC_GLOBAL, "Nyquist_Vel-value", NC_FLOAT, 1, &va);
-    put_global_text_att(ncid, "Unit-unit", "dimensionless");
-    put_global_text_att(ncid, "Unit-value", product->desc.unit);
+    if (moments == NULL) {
+        put_global_text_att(ncid, "Unit-unit", "dimensionless");
+        put_global_text_att(ncid, "Unit-value", product->desc.unit);
+    }
     put_global_text_att(ncid, "radarName-unit", "dimensionless");
     put_global_text_att(ncid, "radarName-value", product->header.radarName);
     put_global_text_att(ncid, "vcp-unit", "dimensionless");
     put_global_text_att(ncid, "vcp-value", "1");
-    put_global_text_att(ncid, "ColorMap-unit", "dimensionless");
-    put_global_text_att(ncid, "ColorMap-value", product->desc.colormap);
+    if (moments == NULL) {
+        put_global_text_att(ncid, "ColorMap-unit", "dimensionless");
+        put_global_text_att(ncid, "ColorMap-value", product->desc.colormap);
+    }
 
     // Other housekeeping attributes
     if (product->header.isPPI) {
@@ -183,6 +163,161 @@ int RKProductFileWriterNC(RKProduct *product, const char *filename) {
     put_global_text_att(ncid, "Waveform", product->header.waveformName);
     put_global_text_att(ncid, "CreatedBy", "RadarKit v" _RKVersionString);
     put_global_text_att(ncid, "ContactInformation", "https://arrc.ou.edu");
+}
+
+// Scale and offset to pack a product into integers, from the range in the description or the data if there is none
+static void productPacking(const RKProduct *product, const nc_type storage, float *scale, float *offset) {
+    int j, k;
+    const RKFloat *x;
+    float lo = product->desc.mininimumValue;
+    float hi = product->desc.maximumValue;
+    if (!(hi > lo)) {
+        lo = INFINITY;
+        hi = -INFINITY;
+        for (k = 0; k < product->header.rayCount; k++) {
+            x = RKProductGetRayData(product, k);
+            for (j = 0; j < product->header.gateCount; j++) {
+                if (isfinite(x[j])) {
+                    lo = MIN(lo, x[j]);
+                    hi = MAX(hi, x[j]);
+                }
+            }
+        }
+        if (!isfinite(lo)) {
+            lo = 0.0f;
+            hi = 1.0f;
+        } else if (!(hi > lo)) {
+            hi = lo + 1.0f;
+        }
+    }
+    if (storage == NC_SHORT) {
+        // Codes -32767 to 32767, -32768 is the fill value
+        *scale = (hi - lo) / 65534.0f;
+        *offset = 0.5f * (lo + hi);
+    } else {
+        // Codes 0 to 254, 255 is the fill value
+        *scale = (hi - lo) / 254.0f;
+        *offset = lo;
+    }
+}
+
+static int productFileWriterNC(RKProduct *product, const char *filename, const nc_type storage) {
+    int j;
+    int ncid;
+    int dimensionIds[2];
+    int variableIdAzimuth;
+    int variableIdElevation;
+    int variableIdBeamwidth;
+    int variableIdGateWidth;
+    int variableIdData;
+    
+    float *x;
+    float scale = 1.0f;
+    float offset = 0.0f;
+    void *packed = NULL;
+
+    // Local memory, everything that does not involve the library is prepared before taking the lock
+    RKFloat *beamWidth = (RKFloat *)malloc(product->header.rayCount * sizeof(RKFloat));
+    RKFloat *gateWidth = (RKFloat *)malloc(product->header.rayCount * sizeof(RKFloat));
+    for (j = 0; j < product->header.rayCount; j++) {
+        beamWidth[j] = RKUMinDiff(product->endAzimuth[j], product->startAzimuth[j]);
+        gateWidth[j] = product->header.gateSizeMeters;
+    }
+    const int16_t fill16 = RKProductFilePackedFillInt16;
+    const uint8_t fill8 = RKProductFilePackedFillUInt8;
+    const int count = product->header.rayCount * product->header.gateCount;
+    if (storage == NC_SHORT) {
+        productPacking(product, storage, &scale, &offset);
+        packed = malloc(count * sizeof(int16_t));
+        for (j = 0; j < product->header.rayCount; j++) {
+            RKSIMD_Quantize16(RKProductGetRayData(product, j), (int16_t *)packed + j * product->header.gateCount,
+                              scale, offset, fill16, product->header.gateCount);
+        }
+    } else if (storage == NC_UBYTE) {
+        productPacking(product, storage, &scale, &offset);
+        packed = malloc(count * sizeof(uint8_t));
+        for (j = 0; j < product->header.rayCount; j++) {
+            RKSIMD_Quantize8(RKProductGetRayData(product, j), (uint8_t *)packed + j * product->header.gateCount,
+                             scale, offset, fill8, product->header.gateCount);
+        }
+    } else if (!(product->flag & RKProductStatusView)) {
+        x = product->data;
+        for (j = 0; j < count; j++) {
+            if (!isfinite(*x)) {
+                *x = W2_MISSING_DATA;
+            }
+            x++;
+        }
+    }
+
+    // The file is built in memory and written to the disk after the lock is released, so that the writers only
+    // take turns through the library, not the file system
+    NC_memio image;
+    const size_t initialSize = product->header.rayCount * (4 * sizeof(float) + product->header.gateCount * sizeof(float)) + 65536;
+
+    pthread_mutex_lock(&productFileMutex);
+
+    // Open a file, packed integers need the NetCDF-4 format for unsigned bytes and deflate
+    if ((j = nc_create_mem(filename, packed ? NC_NETCDF4 : NC_MODE, initialSize, &ncid)) != NC_NOERR) {
+        pthread_mutex_unlock(&productFileMutex);
+        RKLog("Error. Unable to create %s", filename);
+        free(beamWidth);
+        free(gateWidth);
+        free(packed);
+        return RKResultFailedToOpenFileForProduct;
+    }
+
+    // Scan type
+    if (product->header.isPPI) {
+        nc_def_dim(ncid, "Azimuth", product->header.rayCount, &dimensionIds[0]);
+    } else if (product->header.isRHI) {
+        nc_def_dim(ncid, "Elevation", product->header.rayCount, &dimensionIds[0]);
+    } else {
+        nc_def_dim(ncid, "Beam", product->header.rayCount, &dimensionIds[0]);
+    }
+    nc_def_dim(ncid, "Gate", product->header.gateCount, &dimensionIds[1]);
+    
+    // Define variables
+    nc_def_var(ncid, "Azimuth", NC_FLOAT, 1, dimensionIds, &variableIdAzimuth);
+    nc_def_var(ncid, "Elevation", NC_FLOAT, 1, dimensionIds, &variableIdElevation);
+    nc_def_var(ncid, "Beamwidth", NC_FLOAT, 1, dimensionIds, &variableIdBeamwidth);
+    nc_def_var(ncid, "GateWidth", NC_FLOAT, 1, dimensionIds, &variableIdGateWidth);
+    nc_def_var(ncid, product->desc.name, storage, 2, dimensionIds, &variableIdData);
+
+    nc_put_att_text(ncid, variableIdAzimuth, "Units", 7, "Degrees");
+    nc_put_att_text(ncid, variableIdElevation, "Units", 7, "Degrees");
+    nc_put_att_text(ncid, variableIdBeamwidth, "Units", 7, "Degrees");
+    nc_put_att_text(ncid, variableIdGateWidth, "Units", 6, "Meters");
+    nc_put_att_text(ncid, variableIdData, "Units", strlen(product->desc.unit), product->desc.unit);
+    if (storage == NC_SHORT) {
+        nc_put_att_short(ncid, variableIdData, "_FillValue", NC_SHORT, 1, &fill16);
+    } else if (storage == NC_UBYTE) {
+        nc_put_att_uchar(ncid, variableIdData, "_FillValue", NC_UBYTE, 1, &fill8);
+    }
+    if (packed) {
+        nc_put_att_float(ncid, variableIdData, "scale_factor", NC_FLOAT, 1, &scale);
+        nc_put_att_float(ncid, variableIdData, "add_offset", NC_FLOAT, 1, &offset);
+    }
+
+#if defined (COMPRESSED_NETCDF)
+
+    RKLog("Warning. Using NetCDF compression.\n");
+    nc_def_var_deflate(ncid, variableIdAzimuth, 1, 1, 3);
+    nc_def_var_deflate(ncid, variableIdElevation, 1, 1, 3);
+    nc_def_var_deflate(ncid, variableIdBeamwidth, 1, 1, 3);
+    nc_def_var_deflate(ncid, variableIdGateWidth, 1, 1, 3);
+    nc_def_var_deflate(ncid, variableIdData, 1, 1, 3);
+
+#else
+
+    if (packed) {
+        nc_def_var_deflate(ncid, variableIdData, 1, 1, 3);
+    }
+
+#endif
+    
+    // Global attributes - some are WDSS-II required
+    RKProductFilePutGlobalAttributes(ncid, product, NULL);
 
     // NetCDF definition ends here
     nc_enddef(ncid);
@@ -192,44 +327,24 @@ int RKProductFileWriterNC(RKProduct *product, const char *filename) {
 
     nc_put_var_float(ncid, variableIdAzimuth, product->startAzimuth);
     nc_put_var_float(ncid, variableIdElevation, product->startElevation);
-    for (j = 0; j < product->header.rayCount; j++) {
-        array1D[j] = RKUMinDiff(product->endAzimuth[j], product->startAzimuth[j]);
-    }
-    nc_put_var_float(ncid, variableIdBeamwidth, array1D);
-    for (j = 0; j < product->header.rayCount; j++) {
-        array1D[j] = product->header.gateSizeMeters;
-    }
-    nc_put_var_float(ncid, variableIdGateWidth, array1D);
-
-    x = product->data;
-    for (j = 0; j < product->header.rayCount * product->header.gateCount; j++) {
-        if (!isfinite(*x)) {
-            *x = W2_MISSING_DATA;
-        }
-        x++;
+    nc_put_var_float(ncid, variableIdBeamwidth, beamWidth);
+    nc_put_var_float(ncid, variableIdGateWidth, gateWidth);
+    if (storage == NC_SHORT) {
+        nc_put_var_short(ncid, variableIdData, (int16_t *)packed);
+    } else if (storage == NC_UBYTE) {
+        nc_put_var_uchar(ncid, variableIdData, (uint8_t *)packed);
+    } else if (product->flag & RKProductStatusView) {
+        RKProductFilePutVariable(ncid, variableIdData, product);
+    } else {
+        nc_put_var_float(ncid, variableIdData, product->data);
     }
-    nc_put_var_float(ncid, variableIdData, product->data);
 
 #elif RKloat == double
 
     nc_put_var_double(ncid, variableIdAzimuth, product->startAzimuth);
     nc_put_var_double(ncid, variableIdElevation, product->startElevation);
-    for (j = 0; j < product->header.rayCount; j++) {
-        array1D[j] = RKUMinDiff(product->endAzimuth[j], product->startAzimuth[j]);
-    }
-    nc_put_var_double(ncid, variableIdBeamwidth, array1D);
-    for (j = 0; j < product->header.rayCount; j++) {
-        array1D[j] = product->header.gateSizeMeters;
-    }
-    nc_put_var_double(ncid, variableIdGateWidth, array1D);
-
-    x = product->data;
-    for (j = 0; j < product->header.rayCount * product->header.gateCount; j++) {
-        if (!isfinite(*x)) {
-            *x = W2_MISSING_DATA;
-        }
-        x++;
-    }
+    nc_put_var_double(ncid, variableIdBeamwidth, beamWidth);
+    nc_put_var_double(ncid, variableIdGateWidth, gateWidth);
     nc_put_var_float(ncid, variableIdData, product->data);
 
 #else
@@ -238,14 +353,119 @@ int RKProductFileWriterNC(RKProduct *product, const char *filename) {
 
 #endif
 
-    ncclose(ncid);
-    
-    free(array1D);
+    j = nc_close_memio(ncid, &image);
 
-    return RKResultSuccess;
+    pthread_mutex_unlock(&productFileMutex);
+
+    free(beamWidth);
+    free(gateWidth);
+    free(packed);
+
+    if (j != NC_NOERR) {
+        RKLog("Error. Unable to build %s in memory. %s\n", filename, nc_strerror(j));
+        return RKResultFailedToOpenFileForProduct;
+    }
+    j = writeMemoryImage(filename, &image);
+    free(image.memory);
+
+    return j;
 }
 
-void RKProductDimensionsFromFile(const char *filename, uint32_t *rayCount, uint32_t *gateCount) {
+int RKProductFileWriterNC(RKProduct *product, const char *filename) {
+    return productFileWriterNC(product, filename, NC_FLOAT);
+}
+
+int RKProductFileWriterNCInt16(RKProduct *product, const char *filename) {
+    return productFileWriterNC(product, filename, NC_SHORT);
+}
+
+int RKProductFileWriterNCUInt8(RKProduct *product, const char *filename) {
+    return productFileWriterNC(product, filename, NC_UBYTE);
+}
+
+// Read a moment as floats, packed integers are unpacked with scale_factor and add_offset, _FillValue becomes NAN
+int RKProductFileGetVariable(const int ncid, const int variableId, RKFloat *dst, const size_t count) {
+    return RKProductFileGetVariableRange(ncid, variableId, dst, NULL, &count);
+}
+
+// Read a hyperslab of a variable, packed variables are unpacked. The whole variable is read when start is NULL, in
+// which case count only needs the total number of elements.
+int RKProductFileGetVariableRange(const int ncid, const int variableId, RKFloat *dst, const size_t *start, const size_t *count) {
+    int r;
+    int k, dimensionCount;
+    nc_type type;
+    float scale = 1.0f;
+    float offset = 0.0f;
+    size_t total = count[0];
+    if ((r = nc_inq_vartype(ncid, variableId, &type)) != NC_NOERR) {
+        return r;
+    }
+    if (start != NULL) {
+        if ((r = nc_inq_varndims(ncid, variableId, &dimensionCount)) != NC_NOERR) {
+            return r;
+        }
+        for (k = 1; k < dimensionCount; k++) {
+            total *= count[k];
+        }
+    }
+    if (type == NC_SHORT) {
+        int16_t fill = RKProductFilePackedFillInt16;
+        int16_t *packed = (int16_t *)malloc(total * sizeof(int16_t));
+        if (packed == NULL) {
+            return NC_ENOMEM;
+        }
+        nc_get_att_float(ncid, variableId, "scale_factor", &scale);
+        nc_get_att_float(ncid, variableId, "add_offset", &offset);
+        nc_get_att(ncid, variableId, "_FillValue", &fill);
+        r = start ? nc_get_vara_short(ncid, variableId, start, count, packed) : nc_get_var_short(ncid, variableId, packed);
+        if (r == NC_NOERR) {
+            RKSIMD_Dequantize16(packed, dst, scale, offset, fill, (int)total);
+        }
+        free(packed);
+    } else if (type == NC_UBYTE) {
+        uint8_t fill = RKProductFilePackedFillUInt8;
+        uint8_t *packed = (uint8_t *)malloc(total * sizeof(uint8_t));
+        if (packed == NULL) {
+            return NC_ENOMEM;
+        }
+        nc_get_att_float(ncid, variableId, "scale_factor", &scale);
+        nc_get_att_float(ncid, variableId, "add_offset", &offset);
+        nc_get_att(ncid, variableId, "_FillValue", &fill);
+        r = start ? nc_get_vara_uchar(ncid, variableId, start, count, packed) : nc_get_var_uchar(ncid, variableId, packed);
+        if (r == NC_NOERR) {
+            RKSIMD_Dequantize8(packed, dst, scale, offset, fill, (int)total);
+        }
+        free(packed);
+    } else {
+        r = start ? rk_nc_get_vara_float(ncid, variableId, start, count, dst) : rk_nc_get_var_float(ncid, variableId, dst);
+    }
+    return r;
+}
+
+// Write a moment as floats ray by ray, which works for a view of the rays. Non-finite values are written as the missing
+// data value without modifying the product.
+int RKProductFilePutVariable(const int ncid, const int variableId, const RKProduct *product) {
+    int j, k, r = NC_NOERR;
+    const RKFloat *x;
+    size_t start[] = {0, 0};
+    size_t count[] = {1, product->header.gateCount};
+    float *y = (float *)malloc(product->header.gateCount * sizeof(float));
+    if (y == NULL) {
+        return NC_ENOMEM;
+    }
+    for (k = 0; k < product->header.rayCount && r == NC_NOERR; k++) {
+        x = RKProductGetRayData(product, k);
+        for (j = 0; j < product->header.gateCount; j++) {
+            y[j] = isfinite(x[j]) ? x[j] : W2_MISSING_DATA;
+        }
+        start[0] = k;
+        r = nc_put_vara_float(ncid, variableId, start, count, y);
+    }
+    free(y);
+    return r;
+}
+
+static void productDimensionsFromFile(const char *filename, uint32_t *rayCount, uint32_t *gateCount) {
     int r;
     int ncid, tmpId;
     
@@ -299,7 +519,7 @@ void RKProductDimensionsFromFile(const char *filename, uint32_t *rayCount, uint3
     nc_close(ncid);
 }
 
-void RKProductReadFileIntoBuffer(RKProduct *product, const char *filename, const bool showInfo) {
+static void productReadFileIntoBuffer(RKProduct *product, const char *filename, const bool showInfo) {
     int r;
     int ncid, tmpId;
     float fv, *fp;
@@ -516,7 +736,7 @@ void RKProductReadFileIntoBuffer(RKProduct *product, const char *filename, const
     // Data array
     r = nc_inq_varid(ncid, product->desc.name, &tmpId);
     if (r == NC_NOERR) {
-        rk_nc_get_var_float(ncid, tmpId, product->data);
+        RKProductFileGetVariable(ncid, tmpId, product->data, rayCount * gateCount);
         fp = product->data;
         for (r = 0; r < product->capacity; r++) {
             if (*fp == missing || *fp == folded) {
@@ -532,6 +752,26 @@ void RKProductReadFileIntoBuffer(RKProduct *product, const char *filename, const
     nc_close(ncid);
 }
 
+void RKProductDimensionsFromFile(const char *filename, uint32_t *rayCount, uint32_t *gateCount) {
+    pthread_mutex_lock(&productFileMutex);
+    productDimensionsFromFile(filename, rayCount, gateCount);
+    pthread_mutex_unlock(&productFileMutex);
+}
+
+void RKProductReadFileIntoBuffer(RKProduct *product, const char *filename, const bool showInfo) {
+    pthread_mutex_lock(&productFileMutex);
+    productReadFileIntoBuffer(product, filename, showInfo);
+    pthread_mutex_unlock(&productFileMutex);
+}
+
+void RKProductFileLock(void) {
+    pthread_mutex_lock(&productFileMutex);
+}
+
+void RKProductFileUnlock(void) {
+    pthread_mutex_unlock(&productFileMutex);
+}
+
 RKProduct *RKProductFileReaderNC(const char *inputFile, const bool showInfo) {
     uint32_t rayCount = 0;
     uint32_t gateCount = 0;
@@ -47,6 +47,14 @@ static uint32_t getUID(UIDType type) {
 void RKUpdateWaveformCalibration(RKRadar *, const uint8_t, const RKWaveformCalibration *);
 void RKUpdateControl(RKRadar *, const uint8_t, const RKControl *);
 
+// Whether any key of the latest health of a node is (target), from the health records if there is a health engine
+static bool RKNodeHasCondition(RKRadar *radar, const RKHealthNode node, const RKStatusEnum target) {
+    if (radar->healthEngine) {
+        return RKHealthEngineFindCondition(radar->healthEngine, node, target, NULL, NULL);
+    }
+    return RKFindCondition(RKGetLatestHealthOfNode(radar, node)->string, target, false, NULL, NULL);
+}
+
 #pragma mark - Engine Monitor
 
 static size_t RKGetRadarMemoryUsage(RKRadar *radar) {
@@ -88,6 +96,8 @@ static size_t RKGetRadarMemoryUsage(RKRadar *radar) {
     }
     size += radar->healthLogger->memoryUsage;
     size += radar->sweepEngine->memoryUsage;
+    size += radar->volumeEngine->memoryUsage;
+    size += radar->compositeEngine->memoryUsage;
     size += radar->rawDataRecorder->memoryUsage;
     size += radar->hostMonitor->memoryUsage;
     return size;
@@ -234,9 +244,8 @@ static void *systemInspectorRunLoop(void *in) {
         if (radar->positions && radar->desc.initFlags & RKInitFlagPulsePositionCombiner) {
             pedestalOkay = positionRate == 0.0f ? false : true;
             // Position active / standby
-            health = RKGetLatestHealthOfNode(radar, RKHealthNodePedestal);
-            if (RKFindCondition(health->string, RKStatusEnumTooHigh, false, NULL, NULL) ||
-                RKFindCondition(health->string, RKStatusEnumHigh, false, NULL, NULL)) {
+            if (RKNodeHasCondition(radar, RKHealthNodePedestal, RKStatusEnumTooHigh) ||
+                RKNodeHasCondition(radar, RKHealthNodePedestal, RKStatusEnumHigh)) {
                 pedestalEnum = RKStatusEnumStandby;
             } else {
                 if (RKGetMinorSectorInDegrees(position0->azimuthDegrees, position1->azimuthDegrees) > 0.1f ||
@@ -263,18 +272,16 @@ static void *systemInspectorRunLoop(void *in) {
              (radar->hostMonitor->allKnown ? RKStatusEnumFault : RKStatusEnumUnknown));
 
             // Transceiver health
-            health = RKGetLatestHealthOfNode(radar, RKHealthNodeTransceiver);
-            if (RKFindCondition(health->string, RKStatusEnumTooHigh, false, NULL, NULL) ||
-                RKFindCondition(health->string, RKStatusEnumHigh, false, NULL, NULL)) {
+            if (RKNodeHasCondition(radar, RKHealthNodeTransceiver, RKStatusEnumTooHigh) ||
+                RKNodeHasCondition(radar, RKHealthNodeTransceiver, RKStatusEnumHigh)) {
                 transceiverEnum = RKStatusEnumStandby;
             } else {
                 transceiverEnum = RKStatusEnumNormal;
             }
 
             // Tweeta health
-            health = RKGetLatestHealthOfNode(radar, RKHealthNodeTweeta);
-            if (RKFindCondition(health->string, RKStatusEnumTooHigh, false, NULL, NULL) ||
-                RKFindCondition(health->string, RKStatusEnumHigh, false, NULL, NULL)) {
+            if (RKNodeHasCondition(radar, RKHealthNodeTweeta, RKStatusEnumTooHigh) ||
+                RKNodeHasCondition(radar, RKHealthNodeTweeta, RKStatusEnumHigh)) {
                 healthEnum = RKStatusEnumStandby;
             } else {
                 healthEnum = RKStatusEnumNormal;
@@ -322,9 +329,8 @@ static void *systemInspectorRunLoop(void *in) {
                 RKSetHealthReady(radar, health);
             }
 
-            // Get the latest consolidated health
-            health = RKGetLatestHealth(radar);
-            anyCritical = RKAnyCritical(health->string, false, criticalKey, criticalValue);
+            // Any critical key in the latest health of all nodes
+            anyCritical = RKHealthEngineFindCondition(radar->healthEngine, RKHealthNodeInvalid, RKStatusEnumCritical, criticalKey, criticalValue);
             if (anyCritical) {
                 RKLog("Warning. %s is in critical condition (value = %s, count = %d).\n", criticalKey, criticalValue, criticalCount);
                 if (criticalCount++ >= 20) {
@@ -882,6 +888,7 @@ RKRadar *RKInitWithDesc(const RKRadarDesc desc) {
     radar->healthLogger = RKHealthLoggerInit();
     RKHealthLoggerSetInputOutputBuffers(radar->healthLogger, &radar->desc, radar->fileManager,
                                         radar->healths, &radar->healthIndex);
+    RKHealthLoggerSetHealthEngine(radar->healthLogger, radar->healthEngine);
     radar->memoryUsage += radar->healthLogger->memoryUsage;
     radar->state |= RKRadarStateHealthLoggerInitialized;
 
@@ -892,6 +899,22 @@ RKRadar *RKInitWithDesc(const RKRadarDesc desc) {
                                       radar->rays, &radar->rayIndex,
                                       radar->products, &radar->productIndex);
     radar->memoryUsage += radar->sweepEngine->memoryUsage;
+    if (radar->momentEngine) {
+        RKMomentEngineSetRayEvictor(radar->momentEngine, radar->sweepEngine, &RKSweepEngineEvictRay);
+    }
+
+    // Volume cache of the sweeps
+    radar->volumeEngine = RKVolumeEngineInit();
+    RKSweepEngineSetVolumeEngine(radar->sweepEngine, radar->volumeEngine);
+    radar->memoryUsage += radar->volumeEngine->memoryUsage;
+
+    // Composite products that are updated ray by ray
+    radar->compositeEngine = RKCompositeEngineInit();
+    RKCompositeEngineSetInputOutputBuffers(radar->compositeEngine, &radar->desc,
+                                           radar->configs, &radar->configIndex,
+                                           radar->rays, &radar->rayIndex,
+                                           radar->sweepEngine);
+    radar->memoryUsage += radar->compositeEngine->memoryUsage;
     radar->state |= RKRadarStateSweepEngineInitialized;
 
     // Raw data recorder
@@ -1079,6 +1102,11 @@ int RKFree(RKRadar *radar) {
         radar->healthLogger = NULL;
     }
     if (radar->state & RKRadarStateSweepEngineInitialized) {
+        RKCompositeEngineFree(radar->compositeEngine);
+        radar->compositeEngine = NULL;
+        // The volume cache hands its sweeps back to the sweep engine
+        RKVolumeEngineFree(radar->volumeEngine);
+        radar->volumeEngine = NULL;
         RKSweepEngineFree(radar->sweepEngine);
         radar->sweepEngine = NULL;
     }
@@ -1145,6 +1173,7 @@ int RKFree(RKRadar *radar) {
             free(radar->products[i].startElevation);
             free(radar->products[i].endElevation);
             free(radar->products[i].data);
+            free(radar->products[i].rayData);
         }
         free(radar->products);
     }
@@ -1279,6 +1308,12 @@ int RKSetVerbosity(RKRadar *radar, const int verbose) {
     if (radar->sweepEngine) {
         RKSweepEngineSetVerbose(radar->sweepEngine, verbose);
     }
+    if (radar->volumeEngine) {
+        RKVolumeEngineSetVerbose(radar->volumeEngine, verbose);
+    }
+    if (radar->compositeEngine) {
+        RKCompositeEngineSetVerbose(radar->compositeEngine, verbose);
+    }
     if (radar->rawDataRecorder) {
         RKRawDataRecorderSetVerbose(radar->rawDataRecorder, verbose);
     }
@@ -1301,6 +1336,9 @@ int RKSetVerbosityUsingArray(RKRadar *radar, const uint8_t *array) {
             case 'a':
                 RKPositionEngineSetVerbose(radar->positionEngine, array[k]);
                 break;
+            case 'c':
+                RKCompositeEngineSetVerbose(radar->compositeEngine, array[k]);
+                break;
             case 'm':
                 RKMomentEngineSetVerbose(radar->momentEngine, array[k]);
                 break;
@@ -1313,6 +1351,9 @@ int RKSetVerbosityUsingArray(RKRadar *radar, const uint8_t *array) {
             case 's':
                 RKSweepEngineSetVerbose(radar->sweepEngine, array[k]);
                 break;
+            case 'v':
+                RKVolumeEngineSetVerbose(radar->volumeEngine, array[k]);
+                break;
             default:
                 break;
         }
@@ -1343,6 +1384,20 @@ int RKSetRecordingLevel(RKRadar *radar, const int level) {
             RKSweepEngineSetRecord(radar->sweepEngine, true);
             RKHealthLoggerSetRecord(radar->healthLogger, true);
             break;
+        case 4:
+            // Compressed I/Q in half precision, half the size of RKComplex
+            RKRawDataRecorderSetRawDataType(radar->rawDataRecorder, RKRawDataTypeAfterMatchedFilterFloat16);
+            RKRawDataRecorderSetRecord(radar->rawDataRecorder, true);
+            RKSweepEngineSetRecord(radar->sweepEngine, true);
+            RKHealthLoggerSetRecord(radar->healthLogger, true);
+            break;
+        case 3:
+            // Compressed I/Q as scaled int16, half the size of RKComplex
+            RKRawDataRecorderSetRawDataType(radar->rawDataRecorder, RKRawDataTypeAfterMatchedFilterInt16);
+            RKRawDataRecorderSetRecord(radar->rawDataRecorder, true);
+            RKSweepEngineSetRecord(radar->sweepEngine, true);
+            RKHealthLoggerSetRecord(radar->healthLogger, true);
+            break;
         case 1:
             RKRawDataRecorderSetRawDataType(radar->rawDataRecorder, RKRawDataTypeAfterMatchedFilter);
             RKRawDataRecorderSetRecord(radar->rawDataRecorder, true);
@@ -1358,6 +1413,12 @@ int RKSetRecordingLevel(RKRadar *radar, const int level) {
     return RKResultSuccess;
 }
 
+int RKSetRawDataFormat(RKRadar *radar, const RKRawDataFormat format) {
+    RKRawDataRecorderSetRawDataFormat(radar->rawDataRecorder, format);
+    RKLog("Raw data format: %s\n", format == RKRawDataFormatBlockDeflate ? "Block deflate" : "Plain");
+    return RKResultSuccess;
+}
+
 // NOTE: It is possible to call this function as RKSetWaveform(radar, radar->waveform);
 int RKSetWaveform(RKRadar *radar, RKWaveform *waveform) {
     if (radar->pulseEngine == NULL) {
@@ -1589,6 +1650,27 @@ int RKSetProductRecorder(RKRadar *radar, int (*productRecorder)(RKProduct *, con
     return RKResultSuccess;
 }
 
+int RKSetSweepRecorder(RKRadar *radar, int (*sweepRecorder)(RKProduct **, const uint32_t, const char *)) {
+    RKSweepEngineSetSweepRecorder(radar->sweepEngine, sweepRecorder);
+    return RKResultSuccess;
+}
+
+int RKSetSweepStreaming(RKRadar *radar, const bool value) {
+    RKSweepEngineSetSweepStreaming(radar->sweepEngine, value);
+    return RKResultSuccess;
+}
+
+int RKSetVolumeCache(RKRadar *radar, const uint8_t depth, const size_t memoryLimit) {
+    RKVolumeEngineSetMemoryLimit(radar->volumeEngine, memoryLimit);
+    RKVolumeEngineSetDepth(radar->volumeEngine, depth);
+    return RKResultSuccess;
+}
+
+int RKSetCompositeProducts(RKRadar *radar, const RKCompositeProductList list) {
+    RKCompositeEngineSetProductList(radar->compositeEngine, list);
+    return RKResultSuccess;
+}
+
 int RKSetPulseRingFilterByType(RKRadar *radar, RKFilterType type, const uint32_t gateCount) {
     RKIIRFilter *filter = (RKIIRFilter *)malloc(sizeof(RKIIRFilter));
     if (filter == NULL) {
@@ -1694,6 +1776,9 @@ int RKGoLive(RKRadar *radar) {
     RKRawDataRecorderStart(radar->rawDataRecorder);
     RKHealthLoggerStart(radar->healthLogger);
     RKSweepEngineStart(radar->sweepEngine);
+    if (radar->compositeEngine->productList) {
+        RKCompositeEngineStart(radar->compositeEngine);
+    }
 
     // Get the post-allocated memory
     radar->memoryUsage = RKGetRadarMemoryUsage(radar);
@@ -1939,6 +2024,9 @@ int RKStop(RKRadar *radar) {
         radar->state ^= RKRadarStateFileRecorderInitialized;
     }
     if (radar->state & RKRadarStateSweepEngineInitialized) {
+        if (radar->compositeEngine->state & RKEngineStateWantActive) {
+            RKCompositeEngineStop(radar->compositeEngine);
+        }
         RKSweepEngineStop(radar->sweepEngine);
         radar->state ^= RKRadarStateSweepEngineInitialized;
     }
@@ -1965,6 +2053,9 @@ int RKSoftRestart(RKRadar *radar) {
     RKSimpleEngineFree(radar->systemInspector);
 
     // Stop all data acquisition and DSP-related engines
+    if (radar->compositeEngine->state & RKEngineStateWantActive) {
+        RKCompositeEngineStop(radar->compositeEngine);
+    }
     RKSweepEngineStop(radar->sweepEngine);
     RKRawDataRecorderStop(radar->rawDataRecorder);
     RKHealthLoggerStop(radar->healthLogger);
@@ -2025,6 +2116,9 @@ int RKSoftRestart(RKRadar *radar) {
     RKHealthLoggerStart(radar->healthLogger);
     RKRawDataRecorderStart(radar->rawDataRecorder);
     RKSweepEngineStart(radar->sweepEngine);
+    if (radar->compositeEngine->productList) {
+        RKCompositeEngineStart(radar->compositeEngine);
+    }
 
     // Start the inspector
     radar->systemInspector = RKSystemInspector(radar);
@@ -2280,6 +2374,11 @@ int RKExecuteCommand(RKRadar *radar, const char *commandString, char * _Nullable
                                 "        s zvwd - streams Z, V, W and D\n"
                                 "\n"
                                 HIGHLIGHT("r") " - Toggle in between start and stop recording I/Q data\n"
+                                "    e.g.,\n"
+                                "        r 0 - records raw I/Q from the transceiver\n"
+                                "        r 1 - records I/Q after pulse compression\n"
+                                "        r 3 - records I/Q after pulse compression in scaled int16\n"
+                                "        r 4 - records I/Q after pulse compression in float16\n"
                                 "\n"
                                 HIGHLIGHT("v") " - Sets a simple VCP (coming soon)\n"
                                 "    e.g.,\n"
@@ -2392,6 +2491,12 @@ int RKExecuteCommand(RKRadar *radar, const char *commandString, char * _Nullable
                     } else if (commandString[k] == '1') {
                         radar->rawDataRecorder->rawDataType = RKRawDataTypeAfterMatchedFilter;
                         radar->rawDataRecorder->record = true;
+                    } else if (commandString[k] == '3') {
+                        radar->rawDataRecorder->rawDataType = RKRawDataTypeAfterMatchedFilterInt16;
+                        radar->rawDataRecorder->record = true;
+                    } else if (commandString[k] == '4') {
+                        radar->rawDataRecorder->rawDataType = RKRawDataTypeAfterMatchedFilterFloat16;
+                        radar->rawDataRecorder->record = true;
                     } else {
                         radar->rawDataRecorder->rawDataType = RKRawDataTypeNull;
                         radar->rawDataRecorder->record = false;
@@ -2401,7 +2506,9 @@ int RKExecuteCommand(RKRadar *radar, const char *commandString, char * _Nullable
                     sprintf(string, "ACK. Recorder is %s." RKEOL,
                             radar->rawDataRecorder->record == false ? "set to standby" :
                             (radar->rawDataRecorder->rawDataType == RKRawDataTypeFromTransceiver ? "recording raw I/Q" :
-                             (radar->rawDataRecorder->rawDataType == RKRawDataTypeAfterMatchedFilter ? "recording I/Q" : "in unknown state")));
+                             (radar->rawDataRecorder->rawDataType == RKRawDataTypeAfterMatchedFilter ? "recording I/Q" :
+                              (radar->rawDataRecorder->rawDataType == RKRawDataTypeAfterMatchedFilterInt16 ? "recording I/Q in scaled int16" :
+                               (radar->rawDataRecorder->rawDataType == RKRawDataTypeAfterMatchedFilterFloat16 ? "recording I/Q in float16" : "in unknown state")))));
                 }
                 break;
                 
@@ -2621,6 +2728,9 @@ RKHealth *RKGetLatestHealth(RKRadar *radar) {
     if (!(radar->healths[index].flag & RKHealthFlagReady)) {
         index = RKPreviousModuloS(index, radar->desc.healthBufferDepth);
     }
+    if (radar->healthEngine) {
+        RKHealthEngineHealthString(radar->healthEngine, &radar->healths[index]);
+    }
     return &radar->healths[index];
 }
 
@@ -2633,6 +2743,14 @@ RKHealth *RKGetLatestHealthOfNode(RKRadar *radar, const RKHealthNode node) {
 }
 
 RKStatusEnum RKGetEnumFromLatestHealth(RKRadar *radar, const char *keyword) {
+    // A key that has been reported is in the health records
+    if (radar->healthEngine) {
+        RKHealthKey key = RKHealthEngineFindKey(radar->healthEngine, keyword);
+        if (key != RKHealthKeyInvalid) {
+            return RKHealthEngineGetEnum(radar->healthEngine, key);
+        }
+    }
+    // Otherwise, a partial keyword, e.g., "heading" for "GPS Heading", from the consolidated string
     RKHealth *health = RKGetLatestHealth(radar);
     char *stringObject = RKGetValueOfKey(health->string, keyword);
     if (stringObject) {
@@ -24,10 +24,19 @@ static int RKRadarRelayGreet(RKClient *client) {
 		pthread_mutex_unlock(&engine->client->lock);
 		return RKResultIncompleteSend;
 	}
+	if (engine->compression != RKNetworkCompressionNone) {
+		size = sprintf(command, "e %d" RKEOL, engine->compression);
+		RKNetworkSendPackets(engine->client->sd, command, size, NULL);
+	}
 	if (engine->streams != RKStreamNull) {
 		if (engine->verbose) {
 			RKLog("%s Resuming stream ...\n", engine->name);
 		}
+		// Ask for the rays since the last one, which the upstream replays if they are still in its buffer
+		if (engine->rayIdentifier) {
+			size = sprintf(command, "k %" PRIu64 RKEOL, engine->rayIdentifier);
+			RKNetworkSendPackets(engine->client->sd, command, size, NULL);
+		}
 		size = sprintf(command, "s");
 		size += RKStringFromStream(command + size, engine->streams);
 		size += sprintf(command + size, RKEOL);
@@ -39,6 +48,41 @@ static int RKRadarRelayGreet(RKClient *client) {
 	return RKResultSuccess;
 }
 
+// Pulses are laid out as header, H and V samples. The samples go straight into the next slot of the pulse buffer,
+// gates beyond the local capacity go to userPayload, which is only a sink here
+static int RKRadarRelayScatter(RKClient *client, struct iovec *iov, const int capacity) {
+    RKRadarRelay *engine = (RKRadarRelay *)client->userResource;
+
+    if (client->netDelimiter.type != RKNetworkPacketTypePulseData || capacity < 5 ||
+        client->netDelimiter.size < sizeof(RKPulseHeader)) {
+        return 0;
+    }
+    const uint32_t rxGateCount = (client->netDelimiter.size - (uint32_t)sizeof(RKPulseHeader)) / (2 * sizeof(RKInt16C));
+    if (sizeof(RKPulseHeader) + 2 * rxGateCount * sizeof(RKInt16C) != client->netDelimiter.size) {
+        return 0;
+    }
+    RKPulse *pulse = RKGetPulseFromBuffer(engine->pulseBuffer, *engine->pulseIndex);
+    const uint32_t gateCount = MIN(rxGateCount, pulse->header.capacity);
+    const size_t excess = (rxGateCount - gateCount) * sizeof(RKInt16C);
+    int j = 0;
+    iov[j].iov_base = &engine->pulseHeaderCache;
+    iov[j++].iov_len = sizeof(RKPulseHeader);
+    iov[j].iov_base = RKGetInt16CDataFromPulse(pulse, 0);
+    iov[j++].iov_len = gateCount * sizeof(RKInt16C);
+    if (excess) {
+        iov[j].iov_base = client->userPayload;
+        iov[j++].iov_len = excess;
+    }
+    iov[j].iov_base = RKGetInt16CDataFromPulse(pulse, 1);
+    iov[j++].iov_len = gateCount * sizeof(RKInt16C);
+    if (excess) {
+        iov[j].iov_base = client->userPayload;
+        iov[j++].iov_len = excess;
+    }
+    engine->pulseGateCount = gateCount;
+    return j;
+}
+
 static int RKRadarRelayRead(RKClient *client) {
     // The shared user resource pointer
     RKRadarRelay *engine = (RKRadarRelay *)client->userResource;
@@ -106,6 +150,22 @@ static int RKRadarRelayRead(RKClient *client) {
             break;
 
         case RKNetworkPacketTypePulseData:
+            if (client->scattered) {
+                // The samples are already in place, only the header is left
+                pulse = RKGetPulseFromBuffer(engine->pulseBuffer, *engine->pulseIndex);
+                pulseStatus = engine->pulseHeaderCache.s;
+                engine->pulseHeaderCache.s = RKPulseStatusVacant;
+                engine->pulseHeaderCache.capacity = localPulseCapacity;
+                engine->pulseHeaderCache.gateCount = engine->pulseGateCount;
+                memcpy(&pulse->header, &engine->pulseHeaderCache, sizeof(RKPulseHeader));
+                pulse->header.s = pulseStatus;
+                engine->pulseScatterCount++;
+
+                *engine->pulseIndex = RKNextModuloS(*engine->pulseIndex, engine->radarDescription->pulseBufferDepth);
+                pulse = RKGetPulseFromBuffer(engine->pulseBuffer, *engine->pulseIndex);
+                pulse->header.s = RKPulseStatusVacant;
+                break;
+            }
             // Override the status of the payload
             pulse = (RKPulse *)client->userPayload;
             pulseStatus = pulse->header.s;
@@ -154,6 +214,18 @@ static int RKRadarRelayRead(RKClient *client) {
             }
             ray->header.s = RKRayStatusProcessing;
 
+            // Identifiers of the upstream are consecutive, a jump means rays are missed
+            if (engine->rayIdentifier && ray->header.i > engine->rayIdentifier + 1) {
+                engine->rayGapCount++;
+                engine->rayLostCount += ray->header.i - engine->rayIdentifier - 1;
+                if (engine->verbose) {
+                    RKLog("%s Missed %s rays after %s.\n", engine->name,
+                          RKUIntegerToCommaStyleString(ray->header.i - engine->rayIdentifier - 1),
+                          RKUIntegerToCommaStyleString(engine->rayIdentifier));
+                }
+            }
+            engine->rayIdentifier = ray->header.i;
+
             // Now we get a slot to fill it in
             ray = RKGetRayFromBuffer(engine->rayBuffer, *engine->rayIndex);
             memcpy(&ray->header, client->userPayload, sizeof(RKRayHeader));
@@ -280,6 +352,7 @@ static void *radarRelay(void *in) {
 	RKClientSetUserResource(engine->client, engine);
 	RKClientSetGreetHandler(engine->client, RKRadarRelayGreet);
     RKClientSetReceiveHandler(engine->client, &RKRadarRelayRead);
+    RKClientSetScatterHandler(engine->client, &RKRadarRelayScatter);
 
     engine->state |= RKEngineStateActive;
 
@@ -315,6 +388,7 @@ RKRadarRelay *RKRadarRelayInit(void) {
             rkGlobalParameters.showColor ? RKGetBackgroundColorOfIndex(RKEngineColorRadarRelay) : "",
             rkGlobalParameters.showColor ? RKNoColor : "");
     engine->memoryUsage += sizeof(RKRadarRelay);
+    engine->compression = RKNetworkCompressionNone;
     engine->state = RKEngineStateAllocated;
 
     return (RKRadarRelay *)engine;
@@ -355,6 +429,10 @@ void RKRadarRelaySetHost(RKRadarRelay *engine, const char *hostname) {
     strncpy(engine->host, hostname, RKNameLength - 1);
 }
 
+void RKRadarRelaySetCompression(RKRadarRelay *engine, const RKNetworkCompression compression) {
+    engine->compression = compression;
+}
+
 #pragma mark - Interactions
 
 int RKRadarRelayStart(RKRadarRelay *engine) {
@@ -0,0 +1,508 @@
+//
+//  RKRawDataFile.c
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#include <RadarKit/RKRawDataFile.h>
+#include <zlib.h>
+#include <sys/mman.h>
+
+#pragma mark - Helper Functions
+
+static void RKRawDataDeltaEncode(RKByte *data, const size_t size) {
+    RKByte p = 0, c;
+    for (size_t k = 0; k < size; k++) {
+        c = data[k];
+        data[k] = c - p;
+        p = c;
+    }
+}
+
+static void RKRawDataDeltaDecode(RKByte *data, const size_t size) {
+    RKByte p = 0;
+    for (size_t k = 0; k < size; k++) {
+        p += data[k];
+        data[k] = p;
+    }
+}
+
+// Offset where reading should stop, the beginning of the trailers or the end of the file
+static size_t RKRawDataReaderEndOffset(const RKRawDataReader *reader) {
+    if (reader->dataEndOffset) {
+        return (size_t)reader->dataEndOffset;
+    }
+    return reader->map ? reader->mapSize : SIZE_MAX;
+}
+
+// Hint the kernel about the pages ahead, and release the pages that have been consumed so that
+// going through a long file does not leave the entire file resident
+static void RKRawDataReaderAdvise(RKRawDataReader *reader) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t offset = reader->offset / page * page;
+    if (offset < reader->mapReleased) {
+        // Went backward through a seek, start over from here
+        reader->mapReleased = offset;
+        madvise(reader->map + offset, MIN(RKRawDataReaderReadAheadSize, reader->mapSize - offset), MADV_WILLNEED);
+    } else if (offset - reader->mapReleased >= RKRawDataReaderReleaseSize) {
+        madvise(reader->map + reader->mapReleased, offset - reader->mapReleased, MADV_DONTNEED);
+        reader->mapReleased = offset;
+    }
+}
+
+static int RKRawDataReaderSeek(RKRawDataReader *reader, const size_t offset) {
+    if (reader->map) {
+        if (offset > reader->mapSize) {
+            return RKResultNothingToRead;
+        }
+    } else if (fseek(reader->fid, (long)offset, SEEK_SET)) {
+        return RKResultNothingToRead;
+    }
+    reader->offset = offset;
+    if (reader->map) {
+        RKRawDataReaderAdvise(reader);
+    }
+    return RKResultSuccess;
+}
+
+// Get size bytes at the current offset, in place when mapped, or read into buffer otherwise
+static RKByte *RKRawDataReaderTake(RKRawDataReader *reader, void *buffer, const size_t size) {
+    RKByte *c;
+    if (reader->offset + size > RKRawDataReaderEndOffset(reader)) {
+        return NULL;
+    }
+    if (reader->map) {
+        c = reader->map + reader->offset;
+    } else if (fread(buffer, size, 1, reader->fid) == 1) {
+        c = (RKByte *)buffer;
+    } else {
+        return NULL;
+    }
+    reader->offset += size;
+    if (reader->map) {
+        RKRawDataReaderAdvise(reader);
+    }
+    return c;
+}
+
+static int RKRawDataReaderReserve(RKByte **buffer, size_t *capacity, const size_t size) {
+    if (*capacity >= size) {
+        return RKResultSuccess;
+    }
+    free(*buffer);
+    *buffer = (RKByte *)malloc(size);
+    if (*buffer == NULL) {
+        *capacity = 0;
+        RKLog("Error. Unable to allocate memory for %s B.\n", RKUIntegerToCommaStyleString(size));
+        return RKResultFailedToAllocateBuffer;
+    }
+    *capacity = size;
+    return RKResultSuccess;
+}
+
+// Gate count and size of the samples that follow the pulse header, including the scales of a scaled int16 pulse
+static int RKRawDataReaderPayloadSize(const RKRawDataReader *reader, RKRawDataPulseView *view, size_t *size) {
+    const size_t sampleSize = RKRawDataSampleSize(reader->dataType);
+    if (sampleSize == 0) {
+        return RKResultRawDataTypeUndefined;
+    }
+    view->gateCount = RKRawDataGateCount(&view->header, reader->dataType);
+    view->scale[0] = 1.0f;
+    view->scale[1] = 1.0f;
+    *size = 2 * view->gateCount * sampleSize;
+    if (reader->dataType == RKRawDataTypeAfterMatchedFilterInt16) {
+        *size += sizeof(RKRawDataPulseScale);
+    }
+    return RKResultSuccess;
+}
+
+// Point the view to the samples at c, the scales come first if there are any
+static void RKRawDataReaderSetViewData(const RKRawDataReader *reader, RKRawDataPulseView *view, RKByte *c) {
+    if (reader->dataType == RKRawDataTypeAfterMatchedFilterInt16) {
+        memcpy(view->scale, c, sizeof(RKRawDataPulseScale));
+        c += sizeof(RKRawDataPulseScale);
+    }
+    view->data[0] = c;
+    view->data[1] = c + view->gateCount * RKRawDataSampleSize(reader->dataType);
+}
+
+// View the next pulse of a plain file
+static int RKRawDataReaderPlainPulseView(RKRawDataReader *reader, RKRawDataPulseView *view) {
+    int r;
+    RKByte *c;
+    size_t size;
+    if ((c = RKRawDataReaderTake(reader, &view->header, sizeof(RKPulseHeader))) == NULL) {
+        return RKResultNothingToRead;
+    }
+    if (c != (RKByte *)&view->header) {
+        memcpy(&view->header, c, sizeof(RKPulseHeader));
+    }
+    if ((r = RKRawDataReaderPayloadSize(reader, view, &size)) != RKResultSuccess) {
+        return r;
+    }
+    if (reader->map == NULL && RKRawDataReaderReserve(&reader->block, &reader->blockCapacity, size) != RKResultSuccess) {
+        return RKResultFailedToAllocateBuffer;
+    }
+    if ((c = RKRawDataReaderTake(reader, reader->block, size)) == NULL) {
+        RKLog("Error. Truncated pulse of %s gates.\n", RKIntegerToCommaStyleString(view->gateCount));
+        return RKResultNothingToRead;
+    }
+    RKRawDataReaderSetViewData(reader, view, c);
+    reader->pulseNumber++;
+    return RKResultSuccess;
+}
+
+// View the pulse at blockReadIndex of the current block
+static int RKRawDataReaderBlockPulseView(RKRawDataReader *reader, RKRawDataPulseView *view) {
+    int r;
+    size_t size;
+    RKByte *c = reader->block + reader->blockReadIndex;
+    memcpy(&view->header, c, sizeof(RKPulseHeader));
+    c += sizeof(RKPulseHeader);
+    if ((r = RKRawDataReaderPayloadSize(reader, view, &size)) != RKResultSuccess) {
+        return r;
+    }
+    if (reader->blockReadIndex + sizeof(RKPulseHeader) + size > reader->blockHeader.size) {
+        RKLog("Error. Pulse of %s gates runs over the block.\n", RKIntegerToCommaStyleString(view->gateCount));
+        return RKResultNothingToRead;
+    }
+    RKRawDataReaderSetViewData(reader, view, c);
+    reader->blockReadIndex += sizeof(RKPulseHeader) + size;
+    reader->blockPulseIndex++;
+    reader->pulseNumber++;
+    return RKResultSuccess;
+}
+
+// Read and inflate the next block, the payload is inflated straight from the map when mapped
+static int RKRawDataReaderNextBlock(RKRawDataReader *reader) {
+    RKByte *c;
+    RKRawDataBlockHeader *header = &reader->blockHeader;
+    if ((c = RKRawDataReaderTake(reader, header, sizeof(RKRawDataBlockHeader))) == NULL) {
+        return RKResultNothingToRead;
+    }
+    if (c != (RKByte *)header) {
+        memcpy(header, c, sizeof(RKRawDataBlockHeader));
+    }
+    if (header->pulseCount == 0 || header->size == 0 || header->compressedSize == 0) {
+        RKLog("Error. Unexpected block header.   pulseCount = %u   size = %s\n",
+              header->pulseCount, RKUIntegerToCommaStyleString(header->size));
+        return RKResultNothingToRead;
+    }
+    if (RKRawDataReaderReserve(&reader->block, &reader->blockCapacity, header->size) != RKResultSuccess ||
+        RKRawDataReaderReserve(&reader->scratch, &reader->scratchCapacity, header->size) != RKResultSuccess ||
+        (reader->map == NULL &&
+         RKRawDataReaderReserve(&reader->compressed, &reader->compressedCapacity, header->compressedSize) != RKResultSuccess)) {
+        return RKResultFailedToAllocateBuffer;
+    }
+    if ((c = RKRawDataReaderTake(reader, reader->compressed, header->compressedSize)) == NULL) {
+        RKLog("Error. Truncated block of %s pulses.\n", RKIntegerToCommaStyleString(header->pulseCount));
+        return RKResultNothingToRead;
+    }
+    if (RKRawDataBlockDecode(reader->block, header->size, c, header->compressedSize,
+                             header->filter, header->elementSize, reader->scratch) != RKResultSuccess) {
+        return RKResultNothingToRead;
+    }
+    reader->blockReadIndex = 0;
+    reader->blockPulseIndex = 0;
+    return RKResultSuccess;
+}
+
+#pragma mark - Block Filter
+
+void RKRawDataShuffle(void *dst, const void *src, const size_t size, const uint8_t elementSize) {
+    size_t i, k;
+    const RKByte *s = (RKByte *)src;
+    RKByte *d = (RKByte *)dst;
+    const size_t count = size / elementSize;
+    for (k = 0; k < elementSize; k++) {
+        for (i = 0; i < count; i++) {
+            d[i] = s[i * elementSize + k];
+        }
+        d += count;
+    }
+    // The tail that does not make up an element
+    memcpy(d, s + count * elementSize, size - count * elementSize);
+}
+
+void RKRawDataUnshuffle(void *dst, const void *src, const size_t size, const uint8_t elementSize) {
+    size_t i, k;
+    const RKByte *s = (RKByte *)src;
+    RKByte *d = (RKByte *)dst;
+    const size_t count = size / elementSize;
+    for (k = 0; k < elementSize; k++) {
+        for (i = 0; i < count; i++) {
+            d[i * elementSize + k] = s[i];
+        }
+        s += count;
+    }
+    memcpy(d + count * elementSize, s, size - count * elementSize);
+}
+
+#pragma mark - Block Codec
+
+size_t RKRawDataBlockBound(const size_t size) {
+    return (size_t)compressBound((uLong)size);
+}
+
+//
+// Filter and deflate a block of size bytes from src to dst, which must be at least RKRawDataBlockBound(size).
+// The scratch space must be at least size bytes if filter is not RKRawDataBlockFilterNone.
+// Returns the number of compressed bytes, 0 on failure.
+//
+size_t RKRawDataBlockEncode(void *dst, const size_t capacity, const void *src, const size_t size,
+                            const RKRawDataBlockFilter filter, const uint8_t elementSize, void *scratch, const int level) {
+    const void *input = src;
+    if (filter & RKRawDataBlockFilterShuffle && elementSize > 1) {
+        RKRawDataShuffle(scratch, src, size, elementSize);
+        input = scratch;
+    }
+    if (filter & RKRawDataBlockFilterDelta) {
+        if (input != scratch) {
+            memcpy(scratch, src, size);
+            input = scratch;
+        }
+        RKRawDataDeltaEncode((RKByte *)scratch, size);
+    }
+    uLongf compressedSize = (uLongf)capacity;
+    int r = compress2((Bytef *)dst, &compressedSize, (const Bytef *)input, (uLong)size, level);
+    if (r != Z_OK) {
+        RKLog("Error. compress2() returned %d for a block of %s B.\n", r, RKUIntegerToCommaStyleString(size));
+        return 0;
+    }
+    return (size_t)compressedSize;
+}
+
+int RKRawDataBlockDecode(void *dst, const size_t size, const void *src, const size_t compressedSize,
+                         const RKRawDataBlockFilter filter, const uint8_t elementSize, void *scratch) {
+    const bool shuffled = filter & RKRawDataBlockFilterShuffle && elementSize > 1;
+    void *output = shuffled ? scratch : dst;
+    uLongf inflatedSize = (uLongf)size;
+    int r = uncompress((Bytef *)output, &inflatedSize, (const Bytef *)src, (uLong)compressedSize);
+    if (r != Z_OK || inflatedSize != size) {
+        RKLog("Error. uncompress() returned %d with %s / %s B.\n", r,
+              RKUIntegerToCommaStyleString(inflatedSize), RKUIntegerToCommaStyleString(size));
+        return RKResultFailedToDecompress;
+    }
+    if (filter & RKRawDataBlockFilterDelta) {
+        RKRawDataDeltaDecode((RKByte *)output, size);
+    }
+    if (shuffled) {
+        RKRawDataUnshuffle(dst, scratch, size, elementSize);
+    }
+    return RKResultSuccess;
+}
+
+#pragma mark - Reader
+
+//
+// The file reference fid should be at the first pulse, i.e., right after the file header and the waveform.
+// The file is memory mapped when possible, plain pulses are then viewed in place and block payloads are
+// inflated straight from the map. Otherwise, everything goes through fid.
+//
+RKRawDataReader *RKRawDataReaderInit(FILE *fid, const RKFileHeader *fileHeader) {
+    RKRawDataReader *reader = (RKRawDataReader *)malloc(sizeof(RKRawDataReader));
+    if (reader == NULL) {
+        RKLog("Error. Unable to allocate RKRawDataReader.\n");
+        return NULL;
+    }
+    memset(reader, 0, sizeof(RKRawDataReader));
+    reader->fid = fid;
+    reader->dataType = fileHeader->dataType;
+    // The format and the trailers came with build 7, the bytes were reserved before
+    reader->format = fileHeader->buildNo >= 7 ? fileHeader->format : RKRawDataFormatPlain;
+    long origin = ftell(fid);
+    reader->offset = (size_t)origin;
+    struct stat fileStat;
+    if (origin >= 0 && fstat(fileno(fid), &fileStat) == 0 && S_ISREG(fileStat.st_mode) && fileStat.st_size > origin) {
+        void *map = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(fid), 0);
+        if (map != MAP_FAILED) {
+            reader->map = (RKByte *)map;
+            reader->mapSize = (size_t)fileStat.st_size;
+            reader->mapReleased = reader->offset / (size_t)sysconf(_SC_PAGESIZE) * (size_t)sysconf(_SC_PAGESIZE);
+            madvise(reader->map, reader->mapSize, MADV_SEQUENTIAL);
+        }
+    }
+    if (fileHeader->buildNo < 7) {
+        return reader;
+    }
+    // Walk the trailers backward, pulses end where the first index begins
+    RKRawDataTrailer trailer;
+    long offset = 0;
+    if (fseek(fid, 0L, SEEK_END) == 0) {
+        offset = ftell(fid);
+    }
+    while (offset - (long)sizeof(RKRawDataTrailer) > origin) {
+        if (fseek(fid, offset - (long)sizeof(RKRawDataTrailer), SEEK_SET) ||
+            fread(&trailer, sizeof(RKRawDataTrailer), 1, fid) != 1 ||
+            trailer.offset < origin || trailer.offset >= offset) {
+            break;
+        }
+        if (!strncmp(trailer.tag, RKRawDataBlockIndexTag, 4) && reader->blockIndex == NULL) {
+            reader->blockIndex = (RKRawDataBlockIndex *)malloc(MAX(1, trailer.count) * sizeof(RKRawDataBlockIndex));
+            fseek(fid, (long)trailer.offset, SEEK_SET);
+            if (fread(reader->blockIndex, sizeof(RKRawDataBlockIndex), trailer.count, fid) == trailer.count) {
+                reader->blockIndexCount = trailer.count;
+            }
+        } else if (!strncmp(trailer.tag, RKRawDataPulseIndexTag, 4) && reader->pulseIndex == NULL) {
+            reader->pulseIndex = (RKRawDataPulseIndex *)malloc(MAX(1, trailer.count) * sizeof(RKRawDataPulseIndex));
+            fseek(fid, (long)trailer.offset, SEEK_SET);
+            if (fread(reader->pulseIndex, sizeof(RKRawDataPulseIndex), trailer.count, fid) == trailer.count) {
+                reader->pulseIndexCount = trailer.count;
+            }
+        } else {
+            break;
+        }
+        reader->dataEndOffset = (long)trailer.offset;
+        offset = (long)trailer.offset;
+    }
+    if (reader->format == RKRawDataFormatBlockDeflate && reader->blockIndexCount == 0) {
+        RKLog("Warning. Block index not found. File may be incomplete.\n");
+    }
+    fseek(fid, origin, SEEK_SET);
+    return reader;
+}
+
+void RKRawDataReaderFree(RKRawDataReader *reader) {
+    if (reader->map) {
+        munmap(reader->map, reader->mapSize);
+        // Leave fid where the reads have ended, as if everything had gone through it
+        fseek(reader->fid, (long)reader->offset, SEEK_SET);
+    }
+    free(reader->blockIndex);
+    free(reader->pulseIndex);
+    free(reader->block);
+    free(reader->compressed);
+    free(reader->scratch);
+    free(reader);
+}
+
+//
+// View the next pulse without copying the samples. The samples are in place in the mapped file, or in the
+// current block, or in a reader buffer when the file could not be mapped. The view is only valid until the
+// next read or seek.
+//
+int RKRawDataReaderReadPulseView(RKRawDataReader *reader, RKRawDataPulseView *view) {
+    int r;
+    if (reader->format == RKRawDataFormatPlain) {
+        return RKRawDataReaderPlainPulseView(reader, view);
+    } else if (reader->format != RKRawDataFormatBlockDeflate) {
+        return RKResultRawDataTypeUndefined;
+    }
+    if (reader->blockPulseIndex >= reader->blockHeader.pulseCount) {
+        if ((r = RKRawDataReaderNextBlock(reader)) != RKResultSuccess) {
+            return r;
+        }
+    }
+    return RKRawDataReaderBlockPulseView(reader, view);
+}
+
+int RKRawDataReaderReadPulse(RKRawDataReader *reader, RKPulse *pulse) {
+    int j, r;
+    RKRawDataPulseView view;
+    const uint32_t capacity = pulse->header.capacity;
+    if ((r = RKRawDataReaderReadPulseView(reader, &view)) != RKResultSuccess) {
+        return r;
+    }
+    if (view.gateCount > capacity) {
+        RKLog("Error. RKRawDataReaderReadPulse() gateCount = %s > %s\n",
+              RKIntegerToCommaStyleString(view.gateCount),
+              RKIntegerToCommaStyleString(capacity));
+        return RKResultTooBig;
+    }
+    memcpy(&pulse->header, &view.header, sizeof(RKPulseHeader));
+    pulse->header.capacity = capacity;
+    // Pulse payload: H and V data into channels 0 and 1, respectively
+    for (j = 0; j < 2; j++) {
+        if (reader->dataType == RKRawDataTypeFromTransceiver) {
+            memcpy(RKGetInt16CDataFromPulse(pulse, j), view.data[j], view.gateCount * sizeof(RKInt16C));
+        } else {
+            RKComplex *x = RKGetComplexDataFromPulse(pulse, j);
+            RKIQZ z = RKGetSplitComplexDataFromPulse(pulse, j);
+            RKRawDataDecodeSamples(x, view.data[j], view.scale[j], view.gateCount, reader->dataType);
+            RKSIMD_Complex2IQZ(x, &z, view.gateCount);
+        }
+    }
+    return RKResultSuccess;
+}
+
+//
+// Position the reader so that the next RKRawDataReaderReadPulse() returns the pulse of the pulse number.
+// All seek functions need the pulse index trailer, which is not available in files recorded before it was introduced.
+//
+int RKRawDataReaderSeekToPulse(RKRawDataReader *reader, const uint32_t pulseNumber) {
+    int r;
+    uint32_t b;
+    if (reader->pulseIndex == NULL) {
+        return RKResultNoPulseIndex;
+    }
+    if (pulseNumber >= reader->pulseIndexCount) {
+        return RKResultNothingToRead;
+    }
+    if (reader->format == RKRawDataFormatPlain) {
+        if ((r = RKRawDataReaderSeek(reader, reader->pulseIndex[pulseNumber].offset)) != RKResultSuccess) {
+            return r;
+        }
+        reader->pulseNumber = pulseNumber;
+        return RKResultSuccess;
+    }
+    // Find the block that contains the pulse, inflate it if it is not the current one
+    for (b = 0; b < reader->blockIndexCount; b++) {
+        if (pulseNumber < reader->blockIndex[b].pulseOrigin + reader->blockIndex[b].pulseCount) {
+            break;
+        }
+    }
+    if (b == reader->blockIndexCount || pulseNumber < reader->blockIndex[b].pulseOrigin) {
+        return RKResultNoPulseIndex;
+    }
+    if (reader->blockHeader.pulseCount == 0 || reader->blockHeader.pulseOrigin != reader->blockIndex[b].pulseOrigin) {
+        if ((r = RKRawDataReaderSeek(reader, reader->blockIndex[b].offset)) != RKResultSuccess ||
+            (r = RKRawDataReaderNextBlock(reader)) != RKResultSuccess) {
+            return r;
+        }
+    }
+    reader->blockReadIndex = reader->pulseIndex[pulseNumber].offset;
+    reader->blockPulseIndex = pulseNumber - reader->blockIndex[b].pulseOrigin;
+    reader->pulseNumber = pulseNumber;
+    return RKResultSuccess;
+}
+
+// Seek to the first pulse at or after the time
+int RKRawDataReaderSeekToTime(RKRawDataReader *reader, const double timeDouble) {
+    if (reader->pulseIndex == NULL) {
+        return RKResultNoPulseIndex;
+    }
+    // Pulses are recorded in time order, a binary search will do
+    uint32_t lo = 0, hi = reader->pulseIndexCount, m;
+    while (lo < hi) {
+        m = lo + (hi - lo) / 2;
+        if (reader->pulseIndex[m].timeDouble < timeDouble) {
+            lo = m + 1;
+        } else {
+            hi = m;
+        }
+    }
+    return RKRawDataReaderSeekToPulse(reader, lo);
+}
+
+// Seek to the next pulse, starting from the current one, that is the closest to the azimuth
+int RKRawDataReaderSeekToAzimuth(RKRawDataReader *reader, const float azimuthDegrees) {
+    uint32_t k, n, best = 0;
+    float d, dmin = 360.0f;
+    if (reader->pulseIndex == NULL) {
+        return RKResultNoPulseIndex;
+    }
+    // Search one full revolution from the current pulse and stop at the first crossing
+    for (n = 0; n < reader->pulseIndexCount; n++) {
+        k = (reader->pulseNumber + n) % reader->pulseIndexCount;
+        d = fabsf(fmodf(reader->pulseIndex[k].azimuthDegrees - azimuthDegrees + 540.0f, 360.0f) - 180.0f);
+        if (d < dmin) {
+            dmin = d;
+            best = k;
+        } else if (dmin < 1.0f && d > dmin + 1.0f) {
+            break;
+        }
+    }
+    return RKRawDataReaderSeekToPulse(reader, best);
+}
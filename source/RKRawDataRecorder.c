@@ -11,6 +11,17 @@
 // Internal Functions
 
 static void RKRawDataRecorderUpdateStatusString(RKRawDataRecorder *);
+static void RKRawDataRecorderBlockQueue(RKRawDataRecorder *);
+static size_t RKRawDataRecorderBlockWrite(RKRawDataRecorder *, const bool);
+static size_t RKRawDataRecorderBlockAddPulse(RKRawDataRecorder *, RKPulse *, const RKFileHeader *, const uint32_t);
+static void RKRawDataRecorderIndexPulse(RKRawDataRecorder *, RKPulse *, const uint64_t);
+static size_t RKRawDataRecorderPayloadSize(RKPulse *, const RKRawDataType);
+static void RKRawDataRecorderEncodePulse(RKByte *, RKPulse *, const RKRawDataType);
+static size_t RKRawDataRecorderWriteIndex(RKRawDataRecorder *, const RKFileHeader *);
+static void RKRawDataRecorderPreallocate(RKRawDataRecorder *, const RKPulse *, const RKFileHeader *);
+static size_t RKRawDataRecorderCloseFile(RKRawDataRecorder *);
+static void RKRawDataRecorderStartCompressors(RKRawDataRecorder *);
+static void *blockCompressor(void *);
 static void *pulseRecorder(void *);
 
 #pragma mark - Helper Functions
@@ -39,8 +50,269 @@ static void RKRawDataRecorderUpdateStatusString(RKRawDataRecorder *engine) {
     engine->statusBufferIndex = RKNextModuloS(engine->statusBufferIndex, RKBufferSSlotCount);
 }
 
+// Size of what follows the pulse header in file
+static size_t RKRawDataRecorderPayloadSize(RKPulse *pulse, const RKRawDataType type) {
+    size_t size = 2 * RKRawDataGateCount(&pulse->header, type) * RKRawDataSampleSize(type);
+    if (type == RKRawDataTypeAfterMatchedFilterInt16) {
+        size += sizeof(RKRawDataPulseScale);
+    }
+    return size;
+}
+
+// Pulse samples as they are in file: the scales if any, H and V data
+static void RKRawDataRecorderEncodePulse(RKByte *c, RKPulse *pulse, const RKRawDataType type) {
+    int j;
+    RKRawDataPulseScale scale;
+    const uint32_t gateCount = RKRawDataGateCount(&pulse->header, type);
+    const size_t dataSize = gateCount * RKRawDataSampleSize(type);
+    if (type == RKRawDataTypeFromTransceiver) {
+        memcpy(c, RKGetInt16CDataFromPulse(pulse, 0), dataSize);
+        memcpy(c + dataSize, RKGetInt16CDataFromPulse(pulse, 1), dataSize);
+        return;
+    }
+    RKByte *s = c;
+    if (type == RKRawDataTypeAfterMatchedFilterInt16) {
+        c += sizeof(RKRawDataPulseScale);
+    }
+    for (j = 0; j < 2; j++) {
+        RKRawDataEncodeSamples(c, &scale.scale[j], RKGetComplexDataFromPulse(pulse, j), gateCount, type);
+        c += dataSize;
+    }
+    if (type == RKRawDataTypeAfterMatchedFilterInt16) {
+        memcpy(s, &scale, sizeof(RKRawDataPulseScale));
+    }
+}
+
+// Hand the block being filled to the compressors
+static void RKRawDataRecorderBlockQueue(RKRawDataRecorder *engine) {
+    RKRawDataRecorderBlock *block = &engine->blocks[engine->blockFillIndex];
+    if (block->header.pulseCount == 0) {
+        return;
+    }
+    engine->blockRawSize += block->header.size;
+    pthread_mutex_lock(&engine->blockMutex);
+    block->state = RKRawDataBlockStateQueued;
+    pthread_cond_signal(&engine->blockQueued);
+    pthread_mutex_unlock(&engine->blockMutex);
+    engine->blockFillIndex = RKNextModuloS(engine->blockFillIndex, RKRawDataRecorderBlockSlotCount);
+}
+
+// Write the compressed blocks in order. If wait is true, also wait for all the queued blocks
+static size_t RKRawDataRecorderBlockWrite(RKRawDataRecorder *engine, const bool wait) {
+    size_t len = 0;
+    RKRawDataRecorderBlock *block;
+    pthread_mutex_lock(&engine->blockMutex);
+    while (true) {
+        block = &engine->blocks[engine->blockWriteIndex];
+        if (block->state == RKRawDataBlockStateCompressed) {
+            pthread_mutex_unlock(&engine->blockMutex);
+            if (block->header.compressedSize) {
+                if (engine->blockIndexCount == engine->blockIndexCapacity) {
+                    engine->blockIndexCapacity = MAX(1024, 2 * engine->blockIndexCapacity);
+                    engine->blockIndex = (RKRawDataBlockIndex *)realloc(engine->blockIndex, engine->blockIndexCapacity * sizeof(RKRawDataBlockIndex));
+                }
+                RKRawDataBlockIndex *index = &engine->blockIndex[engine->blockIndexCount++];
+                index->offset = engine->fileOffset;
+                index->pulseOrigin = block->header.pulseOrigin;
+                index->pulseCount = block->header.pulseCount;
+                len += RKRawDataRecorderCacheWrite(engine, &block->header, sizeof(RKRawDataBlockHeader));
+                len += RKRawDataRecorderCacheWrite(engine, block->compressed, block->header.compressedSize);
+                engine->blockCompressedSize += block->header.compressedSize;
+            } else {
+                RKLog("%s Error. Block of %s pulses dropped.\n", engine->name, RKIntegerToCommaStyleString(block->header.pulseCount));
+            }
+            block->header.pulseCount = 0;
+            block->header.size = 0;
+            pthread_mutex_lock(&engine->blockMutex);
+            block->state = RKRawDataBlockStateVacant;
+            engine->blockWriteIndex = RKNextModuloS(engine->blockWriteIndex, RKRawDataRecorderBlockSlotCount);
+        } else if (wait && block->state != RKRawDataBlockStateVacant) {
+            pthread_cond_wait(&engine->blockCompressed, &engine->blockMutex);
+        } else {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&engine->blockMutex);
+    return len;
+}
+
+// Copy a pulse into the block being filled, queue the block when it has blockDepth pulses
+static size_t RKRawDataRecorderBlockAddPulse(RKRawDataRecorder *engine, RKPulse *pulse, const RKFileHeader *fileHeader, const uint32_t n) {
+    size_t len = 0;
+    RKRawDataRecorderBlock *block = &engine->blocks[engine->blockFillIndex];
+    // Compressors have fallen behind, wait for this slot
+    if (block->state != RKRawDataBlockStateVacant) {
+        len += RKRawDataRecorderBlockWrite(engine, true);
+    }
+    const size_t size = sizeof(RKPulseHeader) + RKRawDataRecorderPayloadSize(pulse, fileHeader->dataType);
+    if (block->header.size + size > block->capacity) {
+        size_t capacity = MAX(fileHeader->blockDepth * size, block->header.size + size);
+        size_t compressedCapacity = RKRawDataBlockBound(capacity);
+        RKByte *b0 = (RKByte *)realloc(block->raw, capacity);
+        RKByte *b1 = (RKByte *)realloc(block->scratch, capacity);
+        RKByte *b2 = (RKByte *)realloc(block->compressed, compressedCapacity);
+        if (b0) block->raw = b0;
+        if (b1) block->scratch = b1;
+        if (b2) block->compressed = b2;
+        if (b0 == NULL || b1 == NULL || b2 == NULL) {
+            RKLog("%s Error. Unable to allocate a block of %s B.\n", engine->name, RKUIntegerToCommaStyleString(capacity));
+            return len;
+        }
+        engine->memoryUsage += 2 * (capacity - block->capacity) + compressedCapacity - block->compressedCapacity;
+        block->capacity = capacity;
+        block->compressedCapacity = compressedCapacity;
+    }
+    if (block->header.pulseCount == 0) {
+        block->header.filter = fileHeader->blockFilter;
+        block->header.elementSize = fileHeader->dataType == RKRawDataTypeAfterMatchedFilter ? sizeof(RKFloat) : sizeof(int16_t);
+        block->header.pulseOrigin = n;
+    }
+    RKRawDataRecorderIndexPulse(engine, pulse, block->header.size);
+    RKByte *c = block->raw + block->header.size;
+    memcpy(c, &pulse->header, sizeof(RKPulseHeader));
+    RKRawDataRecorderEncodePulse(c + sizeof(RKPulseHeader), pulse, fileHeader->dataType);
+    block->header.size += size;
+    block->header.pulseCount++;
+    if (block->header.pulseCount >= fileHeader->blockDepth) {
+        RKRawDataRecorderBlockQueue(engine);
+    }
+    len += RKRawDataRecorderBlockWrite(engine, false);
+    return len;
+}
+
+// Keep the offset, time and position of a pulse, offset is relative to the file (plain) or the block (block)
+static void RKRawDataRecorderIndexPulse(RKRawDataRecorder *engine, RKPulse *pulse, const uint64_t offset) {
+    if (engine->pulseEntryCount == engine->pulseEntryCapacity) {
+        uint32_t capacity = MAX(1024, 2 * engine->pulseEntryCapacity);
+        RKRawDataPulseIndex *entries = (RKRawDataPulseIndex *)realloc(engine->pulseEntries, capacity * sizeof(RKRawDataPulseIndex));
+        if (entries == NULL) {
+            RKLog("%s Error. Unable to expand the pulse index.\n", engine->name);
+            return;
+        }
+        engine->memoryUsage += (capacity - engine->pulseEntryCapacity) * sizeof(RKRawDataPulseIndex);
+        engine->pulseEntries = entries;
+        engine->pulseEntryCapacity = capacity;
+    }
+    RKRawDataPulseIndex *entry = &engine->pulseEntries[engine->pulseEntryCount++];
+    entry->offset = offset;
+    entry->timeDouble = pulse->header.timeDouble;
+    entry->azimuthDegrees = pulse->header.azimuthDegrees;
+    entry->elevationDegrees = pulse->header.elevationDegrees;
+}
+
+// Write out all blocks, then the pulse index and the block index, each followed by a trailer
+static size_t RKRawDataRecorderWriteIndex(RKRawDataRecorder *engine, const RKFileHeader *fileHeader) {
+    size_t len = 0;
+    RKRawDataTrailer trailer;
+    memset(&trailer, 0, sizeof(RKRawDataTrailer));
+    if (fileHeader->format == RKRawDataFormatBlockDeflate) {
+        RKRawDataRecorderBlockQueue(engine);
+        len += RKRawDataRecorderBlockWrite(engine, true);
+    }
+    if (engine->pulseEntryCount) {
+        trailer.offset = engine->fileOffset;
+        trailer.count = engine->pulseEntryCount;
+        memcpy(trailer.tag, RKRawDataPulseIndexTag, sizeof(trailer.tag));
+        len += RKRawDataRecorderCacheWrite(engine, engine->pulseEntries, engine->pulseEntryCount * sizeof(RKRawDataPulseIndex));
+        len += RKRawDataRecorderCacheWrite(engine, &trailer, sizeof(RKRawDataTrailer));
+    }
+    if (fileHeader->format == RKRawDataFormatBlockDeflate) {
+        trailer.offset = engine->fileOffset;
+        trailer.count = engine->blockIndexCount;
+        memcpy(trailer.tag, RKRawDataBlockIndexTag, sizeof(trailer.tag));
+        len += RKRawDataRecorderCacheWrite(engine, engine->blockIndex, engine->blockIndexCount * sizeof(RKRawDataBlockIndex));
+        len += RKRawDataRecorderCacheWrite(engine, &trailer, sizeof(RKRawDataTrailer));
+    }
+    engine->pulseEntryCount = 0;
+    engine->blockIndexCount = 0;
+    return len;
+}
+
+//
+// Reserve the space of a file that goes to maximumRecordDepth pulses like the first one. Block compressed files
+// are not reserved since their final size is not known ahead. Whatever is not used is released when the file
+// is closed.
+//
+static void RKRawDataRecorderPreallocate(RKRawDataRecorder *engine, const RKPulse *pulse, const RKFileHeader *fileHeader) {
+    size_t size;
+    engine->fileReserved = 0;
+    if (!engine->preallocate || fileHeader->format != RKRawDataFormatPlain) {
+        return;
+    }
+    size = RKRawDataRecorderPayloadSize((RKPulse *)pulse, fileHeader->dataType);
+    size = engine->fileOffset + engine->maximumRecordDepth * (sizeof(RKPulseHeader) + size + sizeof(RKRawDataPulseIndex))
+         + sizeof(RKRawDataTrailer);
+    if (RKFilePreallocate(engine->fd, size)) {
+        engine->fileReserved = size;
+    } else if (engine->verbose > 1) {
+        RKLog("%s Unable to preallocate %s B.   errno = %d\n", engine->name, RKUIntegerToCommaStyleString(size), errno);
+    }
+}
+
+// Flush the cache, release the unused reserve, let the pages go from the page cache and close the file
+static size_t RKRawDataRecorderCloseFile(RKRawDataRecorder *engine) {
+    size_t len = RKRawDataRecorderCacheFlush(engine);
+    RKFileReleasePreallocation(engine->fd, engine->fileOffset, engine->fileReserved);
+    RKFileDropCache(engine->fd);
+    close(engine->fd);
+    engine->fd = 0;
+    engine->fileReserved = 0;
+    return len;
+}
+
+// Start the block compressors if they have not been started, they run until the engine stops
+static void RKRawDataRecorderStartCompressors(RKRawDataRecorder *engine) {
+    int i;
+    if (engine->blockCompressorsActive) {
+        return;
+    }
+    engine->blockCompressorsActive = true;
+    for (i = 0; i < engine->compressorCount; i++) {
+        if (pthread_create(&engine->tidBlockCompressors[i], NULL, blockCompressor, engine) != 0) {
+            RKLog("%s Error. Failed to start a block compressor.\n", engine->name);
+        }
+    }
+}
+
 #pragma mark - Delegate Workers
 
+static void *blockCompressor(void *in) {
+    RKRawDataRecorder *engine = (RKRawDataRecorder *)in;
+
+    int k;
+    size_t size;
+    RKRawDataRecorderBlock *block;
+
+    pthread_mutex_lock(&engine->blockMutex);
+    while (engine->blockCompressorsActive) {
+        // The oldest queued block
+        block = NULL;
+        for (k = 0; k < RKRawDataRecorderBlockSlotCount; k++) {
+            block = &engine->blocks[(engine->blockWriteIndex + k) % RKRawDataRecorderBlockSlotCount];
+            if (block->state == RKRawDataBlockStateQueued) {
+                break;
+            }
+            block = NULL;
+        }
+        if (block == NULL) {
+            pthread_cond_wait(&engine->blockQueued, &engine->blockMutex);
+            continue;
+        }
+        block->state = RKRawDataBlockStateCompressing;
+        pthread_mutex_unlock(&engine->blockMutex);
+
+        size = RKRawDataBlockEncode(block->compressed, block->compressedCapacity, block->raw, block->header.size,
+                                    block->header.filter, block->header.elementSize, block->scratch, engine->compressionLevel);
+
+        pthread_mutex_lock(&engine->blockMutex);
+        block->header.compressedSize = size;
+        block->state = RKRawDataBlockStateCompressed;
+        pthread_cond_broadcast(&engine->blockCompressed);
+    }
+    pthread_mutex_unlock(&engine->blockMutex);
+    return NULL;
+}
+
 static void *pulseRecorder(void *in) {
     RKRawDataRecorder *engine = (RKRawDataRecorder *)in;
     
@@ -57,6 +329,7 @@ static void *pulseRecorder(void *in) {
     char filename[RKMaximumPathLength] = "";
     
     size_t len = 0;
+    size_t size = 0;
     size_t pulseCount = 0;
     uint64_t cacheFlushCount = 0;
 
@@ -72,6 +345,12 @@ static void *pulseRecorder(void *in) {
     RKWaveFileGlobalHeader *waveGlobalHeader = (void *)malloc(sizeof(RKWaveFileGlobalHeader));
     memset(waveGlobalHeader, 0, sizeof(RKWaveFileGlobalHeader));
 
+    // Block compressors are started with the first file of RKRawDataFormatBlockDeflate
+    pthread_mutex_init(&engine->blockMutex, NULL);
+    pthread_cond_init(&engine->blockQueued, NULL);
+    pthread_cond_init(&engine->blockCompressed, NULL);
+    engine->blockCompressorsActive = false;
+
 	// Update the engine state
 	engine->state |= RKEngineStateWantActive;
 	engine->state ^= RKEngineStateActivating;
@@ -144,9 +423,13 @@ static void *pulseRecorder(void *in) {
 
             // Close the current file
             if (engine->fd) {
-                len += RKRawDataRecorderCacheFlush(engine);
-                close(engine->fd);
-                engine->fd = 0;
+                len += RKRawDataRecorderWriteIndex(engine, fileHeader);
+                if (fileHeader->format == RKRawDataFormatBlockDeflate) {
+                    if (engine->verbose && engine->blockCompressedSize) {
+                        RKLog("%s Block compression ratio %.2f\n", engine->name, (float)engine->blockRawSize / engine->blockCompressedSize);
+                    }
+                }
+                len += RKRawDataRecorderCloseFile(engine);
                 RKLog("%s %sRecorded%s %s (%s pulses, %s %sB) w%d\n",
                       engine->name,
                       rkGlobalParameters.showColor ? RKGreenColor : "",
@@ -185,6 +468,15 @@ static void *pulseRecorder(void *in) {
                 sprintf(filename + i, ".rkc");
             }
             fileHeader->dataType = engine->rawDataType;
+            fileHeader->format = engine->rawDataFormat;
+            if (fileHeader->format == RKRawDataFormatBlockDeflate) {
+                RKRawDataRecorderStartCompressors(engine);
+                fileHeader->blockFilter = engine->blockFilter;
+                fileHeader->blockDepth = engine->blockDepth;
+            } else {
+                fileHeader->blockFilter = RKRawDataBlockFilterNone;
+                fileHeader->blockDepth = 0;
+            }
 
             n = 0;
 
@@ -196,9 +488,13 @@ static void *pulseRecorder(void *in) {
                 // 4-KB raw data file header
                 memcpy(&fileHeader->config, config, sizeof(RKConfig));
                 fileHeader->config.waveform = NULL;
-                engine->fd = open(filename, O_CREAT | O_WRONLY, 0000644);
+                engine->fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, 0000644);
                 engine->fileWriteCount = 0;
+                engine->fileOffset = 0;
+                engine->fileSynced = 0;
+                engine->fileWaited = 0;
                 engine->cacheWriteIndex = 0;
+                engine->pulseEntryCount = 0;
                 len = RKRawDataRecorderCacheWrite(engine, fileHeader, sizeof(RKFileHeader));
                 // 512-B wave header
                 strcpy(waveGlobalHeader->name, waveform->name);
@@ -218,6 +514,10 @@ static void *pulseRecorder(void *in) {
                     len += RKRawDataRecorderCacheWrite(engine, waveform->samples[i], waveform->depth * sizeof(RKComplex));
                     len += RKRawDataRecorderCacheWrite(engine, waveform->iSamples[i], waveform->depth * sizeof(RKInt16C));
                 }
+                RKRawDataRecorderPreallocate(engine, pulse, fileHeader);
+                engine->blockIndexCount = 0;
+                engine->blockRawSize = 0;
+                engine->blockCompressedSize = 0;
             } else {
                 len = sizeof(RKFileHeader) + sizeof(RKWaveFileGlobalHeader);
                 for (i = 0; i < waveform->count; i++) {
@@ -230,21 +530,39 @@ static void *pulseRecorder(void *in) {
         
         // Pulse to write cache
         if (engine->record && engine->fd) {
-            if (fileHeader->dataType == RKRawDataTypeFromTransceiver) {
+            if (fileHeader->format == RKRawDataFormatBlockDeflate) {
+                len += RKRawDataRecorderBlockAddPulse(engine, pulse, fileHeader, n);
+            } else if (fileHeader->dataType == RKRawDataTypeFromTransceiver) {
+                RKRawDataRecorderIndexPulse(engine, pulse, engine->fileOffset);
                 len += RKRawDataRecorderCacheWrite(engine, &pulse->header, sizeof(RKPulseHeader));
                 len += RKRawDataRecorderCacheWrite(engine, RKGetInt16CDataFromPulse(pulse, 0), pulse->header.gateCount * sizeof(RKInt16C));
                 len += RKRawDataRecorderCacheWrite(engine, RKGetInt16CDataFromPulse(pulse, 1), pulse->header.gateCount * sizeof(RKInt16C));
-            } else {
+            } else if (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter) {
+                RKRawDataRecorderIndexPulse(engine, pulse, engine->fileOffset);
                 len += RKRawDataRecorderCacheWrite(engine, &pulse->header, sizeof(RKPulseHeader));
                 len += RKRawDataRecorderCacheWrite(engine, RKGetComplexDataFromPulse(pulse, 0), pulse->header.downSampledGateCount * sizeof(RKComplex));
                 len += RKRawDataRecorderCacheWrite(engine, RKGetComplexDataFromPulse(pulse, 1), pulse->header.downSampledGateCount * sizeof(RKComplex));
-            }
-        } else {
-            if (fileHeader->dataType == RKRawDataTypeFromTransceiver) {
-                len += sizeof(RKPulseHeader) + 2 * pulse->header.gateCount * sizeof(RKInt16C);
             } else {
-                len += sizeof(RKPulseHeader) + 2 * pulse->header.downSampledGateCount * sizeof(RKComplex);
+                // Reduced precision samples are encoded in the scratch first
+                size = RKRawDataRecorderPayloadSize(pulse, fileHeader->dataType);
+                if (engine->pulseScratchCapacity < size) {
+                    free(engine->pulseScratch);
+                    engine->memoryUsage -= engine->pulseScratchCapacity;
+                    engine->pulseScratchCapacity = size;
+                    engine->pulseScratch = (RKByte *)malloc(size);
+                    if (engine->pulseScratch == NULL) {
+                        RKLog("%s Error. Unable to allocate pulse scratch.\n", engine->name);
+                        exit(EXIT_FAILURE);
+                    }
+                    engine->memoryUsage += engine->pulseScratchCapacity;
+                }
+                RKRawDataRecorderEncodePulse(engine->pulseScratch, pulse, fileHeader->dataType);
+                RKRawDataRecorderIndexPulse(engine, pulse, engine->fileOffset);
+                len += RKRawDataRecorderCacheWrite(engine, &pulse->header, sizeof(RKPulseHeader));
+                len += RKRawDataRecorderCacheWrite(engine, engine->pulseScratch, size);
             }
+        } else {
+            len += sizeof(RKPulseHeader) + RKRawDataRecorderPayloadSize(pulse, engine->rawDataType);
         }
         pulseCount++;
 
@@ -280,13 +598,28 @@ static void *pulseRecorder(void *in) {
     }
 
     if (engine->fd) {
-        close(engine->fd);
-        engine->fd = 0;
+        RKRawDataRecorderWriteIndex(engine, fileHeader);
+        RKRawDataRecorderCloseFile(engine);
         if (engine->fileWriteCount == 0) {
             remove(filename);
         }
     }
 
+    // Retire the block compressors
+    pthread_mutex_lock(&engine->blockMutex);
+    engine->blockCompressorsActive = false;
+    pthread_cond_broadcast(&engine->blockQueued);
+    pthread_mutex_unlock(&engine->blockMutex);
+    for (i = 0; i < engine->compressorCount; i++) {
+        if (engine->tidBlockCompressors[i]) {
+            pthread_join(engine->tidBlockCompressors[i], NULL);
+            engine->tidBlockCompressors[i] = (pthread_t)0;
+        }
+    }
+    pthread_cond_destroy(&engine->blockQueued);
+    pthread_cond_destroy(&engine->blockCompressed);
+    pthread_mutex_destroy(&engine->blockMutex);
+
     free(fileHeader);
     free(waveGlobalHeader);
     
@@ -309,6 +642,13 @@ RKRawDataRecorder *RKRawDataRecorderInit(void) {
     engine->state = RKEngineStateAllocated;
     engine->rawDataType = RKRawDataTypeAfterMatchedFilter;
     engine->maximumRecordDepth = RKRawDataRecorderDefaultMaximumRecorderDepth;
+    engine->rawDataFormat = RKRawDataFormatPlain;
+    engine->blockFilter = RKRawDataBlockFilterShuffle;
+    engine->blockDepth = RKRawDataRecorderDefaultBlockDepth;
+    engine->compressionLevel = 1;
+    engine->compressorCount = RKRawDataRecorderDefaultCompressorCount;
+    engine->preallocate = true;
+    engine->writeBehindSize = RKRawDataRecorderDefaultWriteBehindSize;
     engine->memoryUsage = sizeof(RKRawDataRecorder) + engine->cacheSize;
     return engine;
 }
@@ -317,6 +657,14 @@ void RKRawDataRecorderFree(RKRawDataRecorder *engine) {
     if (engine->state & RKEngineStateWantActive) {
         RKRawDataRecorderStop(engine);
     }
+    for (int k = 0; k < RKRawDataRecorderBlockSlotCount; k++) {
+        free(engine->blocks[k].raw);
+        free(engine->blocks[k].scratch);
+        free(engine->blocks[k].compressed);
+    }
+    free(engine->blockIndex);
+    free(engine->pulseEntries);
+    free(engine->pulseScratch);
     free(engine->cache);
     free(engine);
 }
@@ -367,6 +715,29 @@ void RKRawDataRecorderSetCacheSize(RKRawDataRecorder *engine, uint32_t size) {
     engine->memoryUsage += engine->cacheSize;
 }
 
+void RKRawDataRecorderSetRawDataFormat(RKRawDataRecorder *engine, const RKRawDataFormat format) {
+    engine->rawDataFormat = format;
+}
+
+void RKRawDataRecorderSetBlockCompression(RKRawDataRecorder *engine, const uint32_t depth, const RKRawDataBlockFilter filter, const int level) {
+    engine->blockDepth = MAX(1, depth);
+    engine->blockFilter = filter;
+    engine->compressionLevel = level;
+}
+
+// Takes effect at the next RKRawDataRecorderStart()
+void RKRawDataRecorderSetCompressorCount(RKRawDataRecorder *engine, const uint8_t count) {
+    engine->compressorCount = MAX(1, MIN(RKRawDataRecorderMaximumCompressorCount, count));
+}
+
+void RKRawDataRecorderSetPreallocation(RKRawDataRecorder *engine, const bool value) {
+    engine->preallocate = value;
+}
+
+void RKRawDataRecorderSetWriteBehindSize(RKRawDataRecorder *engine, const size_t size) {
+    engine->writeBehindSize = size;
+}
+
 #pragma mark - Interactions
 
 int RKRawDataRecorderStart(RKRawDataRecorder *engine) {
@@ -423,6 +794,7 @@ size_t RKRawDataRecorderCacheWrite(RKRawDataRecorder *engine, const void *payloa
     if (size == 0) {
         return 0;
     }
+    engine->fileOffset += size;
     size_t remainingSize = size;
     size_t lastChunkSize = 0;
     size_t writtenSize = 0;
@@ -447,11 +819,15 @@ size_t RKRawDataRecorderCacheWrite(RKRawDataRecorder *engine, const void *payloa
         if (remainingSize >= engine->cacheSize) {
             writtenSize += (uint32_t)write(engine->fd, (char *)(payload + lastChunkSize), remainingSize);
             engine->fileWriteCount++;
+            engine->fileSynced = RKFileWriteBehind(engine->fd, &engine->fileWaited, engine->fileSynced, engine->fileOffset, engine->writeBehindSize);
             return writtenSize;
         }
     }
     memcpy(engine->cache + engine->cacheWriteIndex, payload + lastChunkSize, remainingSize);
     engine->cacheWriteIndex += remainingSize;
+    if (writtenSize) {
+        engine->fileSynced = RKFileWriteBehind(engine->fd, &engine->fileWaited, engine->fileSynced, engine->fileOffset - engine->cacheWriteIndex, engine->writeBehindSize);
+    }
     return writtenSize;
 }
 
@@ -462,5 +838,6 @@ size_t RKRawDataRecorderCacheFlush(RKRawDataRecorder *engine) {
     size_t writtenSize = write(engine->fd, engine->cache, engine->cacheWriteIndex);
     engine->cacheWriteIndex = 0;
     engine->fileWriteCount++;
+    engine->fileSynced = RKFileWriteBehind(engine->fd, &engine->fileWaited, engine->fileSynced, engine->fileOffset, engine->writeBehindSize);
     return writtenSize;
 }
@@ -452,11 +452,27 @@ void RKSIMD_iyscl(RKComplex *src, const RKFloat m, const int n) {
     return;
 }
 
+//
+// Interleave / deinterleave between RKComplex and RKIQZ with unaligned access so that these can also work directly
+// on buffers that are only RKFloat aligned, e.g., pulses in a memory-mapped file
+//
 void RKSIMD_IQZ2Complex(RKIQZ *src, RKComplex *dst, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
     RKFloat *si = &src->i[0];
     RKFloat *sq = &src->q[0];
     RKFloat *d = &dst->i;
-    for (int k = 0; k < n; k++) {
+    RKVec i, q;
+    for (; k <= n - v; k += v) {
+        i = _rk_mm_loadu_pf(si);
+        q = _rk_mm_loadu_pf(sq);
+        _rk_mm_storeu_pf(d, _rk_mm_interleavelo_pf(i, q));
+        _rk_mm_storeu_pf(d + v, _rk_mm_interleavehi_pf(i, q));
+        si += v;
+        sq += v;
+        d += 2 * v;
+    }
+    for (; k < n; k++) {
         *d++ = *si++;
         *d++ = *sq++;
     }
@@ -464,10 +480,22 @@ void RKSIMD_IQZ2Complex(RKIQZ *src, RKComplex *dst, const int n) {
 }
 
 void RKSIMD_Complex2IQZ(RKComplex *src, RKIQZ *dst, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
     RKFloat *s = &src[0].i;
     RKFloat *di = &dst->i[0];
     RKFloat *dq = &dst->q[0];
-    for (int k = 0; k < n; k++) {
+    RKVec a, b;
+    for (; k <= n - v; k += v) {
+        a = _rk_mm_loadu_pf(s);
+        b = _rk_mm_loadu_pf(s + v);
+        _rk_mm_storeu_pf(di, _rk_mm_evens_pf(a, b));
+        _rk_mm_storeu_pf(dq, _rk_mm_odds_pf(a, b));
+        s += 2 * v;
+        di += v;
+        dq += v;
+    }
+    for (; k < n; k++) {
         *di++ = *s++;
         *dq++ = *s++;
     }
@@ -508,6 +536,399 @@ void RKSIMD_Int2Complex_reg(RKInt16C *src, RKComplex *dst, const int n) {
     return;
 }
 
+//
+// Conversions to / from reduced precision samples. Unaligned access throughout so that these can work directly on
+// pulses in a memory-mapped file. The counts n are in RKFloat, i.e., twice the gate count for complex samples.
+//
+
+// Maximum absolute value
+RKFloat RKSIMD_amax(const RKFloat *src, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    RKFloat m = 0.0f, f[sizeof(RKVec) / sizeof(RKFloat)];
+    RKVec mv = _rk_mm_setzero_pf();
+    for (; k <= n - v; k += v) {
+        mv = _rk_mm_max_pf(mv, _rk_mm_abs_pf(_rk_mm_loadu_pf(src + k)));
+    }
+    _rk_mm_storeu_pf(f, mv);
+    for (int j = 0; j < v; j++) {
+        m = MAX(m, f[j]);
+    }
+    for (; k < n; k++) {
+        m = MAX(m, fabsf(src[k]));
+    }
+    return m;
+}
+
+// dst = src x m, rounded to the nearest and saturated to int16
+void RKSIMD_Float2Int16(const RKFloat *src, int16_t *dst, const RKFloat m, const int n) {
+    int k = 0;
+    long v;
+    const int w = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec mv = _rk_mm_set1_pf(m);
+    const RKVec lo = _rk_mm_set1_pf(-32768.0f);
+    const RKVec hi = _rk_mm_set1_pf(32767.0f);
+    for (; k <= n - w; k += w) {
+        _rk_mm_storeu_pf_epi16(dst + k, _rk_mm_min_pf(_rk_mm_max_pf(_rk_mm_mul_pf(_rk_mm_loadu_pf(src + k), mv), lo), hi));
+    }
+    for (; k < n; k++) {
+        v = lrintf(src[k] * m);
+        dst[k] = (int16_t)MAX(-32768, MIN(32767, v));
+    }
+    return;
+}
+
+// dst = src x m
+void RKSIMD_Int162Float(const int16_t *src, RKFloat *dst, const RKFloat m, const int n) {
+    int k = 0;
+#if defined(_rk_mm_loadu_epi16_pf)
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec mv = _rk_mm_set1_pf(m);
+    for (; k <= n - v; k += v) {
+        _rk_mm_storeu_pf(dst + k, _rk_mm_mul_pf(_rk_mm_loadu_epi16_pf(src + k), mv));
+    }
+#endif
+    for (; k < n; k++) {
+        dst[k] = (RKFloat)src[k] * m;
+    }
+    return;
+}
+
+// IEEE 754 single to half precision, round to nearest even. Magnitudes beyond 65504 saturate instead of becoming
+// infinity, which would spoil every moment of the gate
+static uint16_t RKSIMD_half(const float f) {
+    uint32_t x, m, r, h, s;
+    int32_t e;
+    memcpy(&x, &f, sizeof(uint32_t));
+    s = (x >> 16) & 0x8000;
+    e = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    m = x & 0x7fffff;
+    if (e == 128 + 15 && m) {
+        // NaN
+        return s | 0x7e00;
+    } else if (e >= 0x1f) {
+        return s | RKSIMDHalfMaximumBits;
+    } else if (e <= 0) {
+        // Subnormal, or too small to be anything but zero
+        if (e < -10) {
+            return s;
+        }
+        m |= 0x800000;
+        r = 14 - e;
+        h = m >> r;
+        m &= (1 << r) - 1;
+        if (m > (1u << (r - 1)) || (m == (1u << (r - 1)) && (h & 1))) {
+            h++;
+        }
+        return s | h;
+    }
+    h = s | (e << 10) | (m >> 13);
+    m &= 0x1fff;
+    if (m > 0x1000 || (m == 0x1000 && (h & 1))) {
+        h++;
+    }
+    if ((h & 0x7fff) > RKSIMDHalfMaximumBits) {
+        // Rounded up to infinity
+        return s | RKSIMDHalfMaximumBits;
+    }
+    return h;
+}
+
+static float RKSIMD_single(const uint16_t h) {
+    float f;
+    uint32_t x, s = (uint32_t)(h & 0x8000) << 16, m = h & 0x3ff;
+    int32_t e = (h >> 10) & 0x1f;
+    if (e == 0x1f) {
+        x = s | 0x7f800000 | (m << 13);
+    } else if (e) {
+        x = s | ((e + 127 - 15) << 23) | (m << 13);
+    } else if (m) {
+        // Subnormal, normalize it
+        e = 127 - 15 + 1;
+        while (!(m & 0x400)) {
+            m <<= 1;
+            e--;
+        }
+        x = s | (e << 23) | ((m & 0x3ff) << 13);
+    } else {
+        x = s;
+    }
+    memcpy(&f, &x, sizeof(float));
+    return f;
+}
+
+void RKSIMD_Float2Half(const RKFloat *src, uint16_t *dst, const int n) {
+    int k = 0;
+#if defined(_rk_mm_storeu_pf_ph)
+    // Clamp first, NaN is the second operand so that it passes through
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec hi = _rk_mm_set1_pf(RKSIMDHalfMaximum);
+    const RKVec lo = _rk_mm_set1_pf(-RKSIMDHalfMaximum);
+    for (; k <= n - v; k += v) {
+        _rk_mm_storeu_pf_ph(dst + k, _rk_mm_max_pf(lo, _rk_mm_min_pf(hi, _rk_mm_loadu_pf(src + k))));
+    }
+#endif
+    for (; k < n; k++) {
+        dst[k] = RKSIMD_half(src[k]);
+    }
+    return;
+}
+
+void RKSIMD_Half2Float(const uint16_t *src, RKFloat *dst, const int n) {
+    int k = 0;
+#if defined(_rk_mm_loadu_ph_pf)
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    for (; k <= n - v; k += v) {
+        _rk_mm_storeu_pf(dst + k, _rk_mm_loadu_ph_pf(src + k));
+    }
+#endif
+    for (; k < n; k++) {
+        dst[k] = RKSIMD_single(src[k]);
+    }
+    return;
+}
+
+// dst = round((src - offset) / scale) saturated to [-32767, 32767], non-finite values become fill
+void RKSIMD_Quantize16(const RKFloat *src, int16_t *dst, const RKFloat scale, const RKFloat offset, const int16_t fill, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKFloat m = 1.0f / scale;
+    const RKVec mv = _rk_mm_set1_pf(m);
+    const RKVec ov = _rk_mm_set1_pf(offset);
+    const RKVec lo = _rk_mm_set1_pf(-32767.0f);
+    const RKVec hi = _rk_mm_set1_pf(32767.0f);
+    const RKVec fv = _rk_mm_set1_pf((RKFloat)fill);
+    const RKVec zero = _rk_mm_setzero_pf();
+    RKVec x;
+    RKVecMask f;
+    for (; k <= n - v; k += v) {
+        x = _rk_mm_loadu_pf(src + k);
+        // x - x is zero only for finite x
+        f = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(x, x), zero);
+        x = _rk_mm_min_pf(_rk_mm_max_pf(_rk_mm_mul_pf(_rk_mm_sub_pf(x, ov), mv), lo), hi);
+        _rk_mm_storeu_pf_epi16(dst + k, _rk_mm_blend_pf(fv, x, f));
+    }
+    for (; k < n; k++) {
+        if (isfinite(src[k])) {
+            dst[k] = (int16_t)lrintf(MAX(-32767.0f, MIN(32767.0f, (src[k] - offset) * m)));
+        } else {
+            dst[k] = fill;
+        }
+    }
+    return;
+}
+
+// dst = round((src - offset) / scale) saturated to [0, 254], non-finite values become fill
+void RKSIMD_Quantize8(const RKFloat *src, uint8_t *dst, const RKFloat scale, const RKFloat offset, const uint8_t fill, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKFloat m = 1.0f / scale;
+    const RKVec mv = _rk_mm_set1_pf(m);
+    const RKVec ov = _rk_mm_set1_pf(offset);
+    const RKVec lo = _rk_mm_setzero_pf();
+    const RKVec hi = _rk_mm_set1_pf(254.0f);
+    const RKVec fv = _rk_mm_set1_pf((RKFloat)fill);
+    RKVec x;
+    RKVecMask f;
+    for (; k <= n - v; k += v) {
+        x = _rk_mm_loadu_pf(src + k);
+        f = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(x, x), lo);
+        x = _rk_mm_min_pf(_rk_mm_max_pf(_rk_mm_mul_pf(_rk_mm_sub_pf(x, ov), mv), lo), hi);
+        _rk_mm_storeu_pf_epu8(dst + k, _rk_mm_blend_pf(fv, x, f));
+    }
+    for (; k < n; k++) {
+        if (isfinite(src[k])) {
+            dst[k] = (uint8_t)lrintf(MAX(0.0f, MIN(254.0f, (src[k] - offset) * m)));
+        } else {
+            dst[k] = fill;
+        }
+    }
+    return;
+}
+
+// dst = src x scale + offset, fill becomes NAN
+void RKSIMD_Dequantize16(const int16_t *src, RKFloat *dst, const RKFloat scale, const RKFloat offset, const int16_t fill, const int n) {
+    int k = 0;
+#if defined(_rk_mm_loadu_epi16_pf)
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec sv = _rk_mm_set1_pf(scale);
+    const RKVec ov = _rk_mm_set1_pf(offset);
+    const RKVec nv = _rk_mm_set1_pf(NAN);
+    const RKVec fv = _rk_mm_set1_pf((RKFloat)fill);
+    RKVec x;
+    for (; k <= n - v; k += v) {
+        x = _rk_mm_loadu_epi16_pf(src + k);
+        _rk_mm_storeu_pf(dst + k, _rk_mm_blend_pf(_rk_mm_add_pf(_rk_mm_mul_pf(x, sv), ov), nv, _rk_mm_cmpeq_pf(x, fv)));
+    }
+#endif
+    for (; k < n; k++) {
+        dst[k] = src[k] == fill ? NAN : (RKFloat)src[k] * scale + offset;
+    }
+    return;
+}
+
+// dst = src x scale + offset, fill becomes NAN
+void RKSIMD_Dequantize8(const uint8_t *src, RKFloat *dst, const RKFloat scale, const RKFloat offset, const uint8_t fill, const int n) {
+    int k = 0;
+#if defined(_rk_mm_loadu_epu8_pf)
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec sv = _rk_mm_set1_pf(scale);
+    const RKVec ov = _rk_mm_set1_pf(offset);
+    const RKVec nv = _rk_mm_set1_pf(NAN);
+    const RKVec fv = _rk_mm_set1_pf((RKFloat)fill);
+    RKVec x;
+    for (; k <= n - v; k += v) {
+        x = _rk_mm_loadu_epu8_pf(src + k);
+        _rk_mm_storeu_pf(dst + k, _rk_mm_blend_pf(_rk_mm_add_pf(_rk_mm_mul_pf(x, sv), ov), nv, _rk_mm_cmpeq_pf(x, fv)));
+    }
+#endif
+    for (; k < n; k++) {
+        dst[k] = src[k] == fill ? NAN : (RKFloat)src[k] * scale + offset;
+    }
+    return;
+}
+
+// Bilinear interpolation of samples gathered from src: dst[k] blends src[a[k]], src[a[k] + 1], src[b[k]] and src[b[k] + 1]
+// with weights wb[k] across a -> b and wg[k] across the +1 neighbor. Non-finite samples are left out and the remaining
+// weights are renormalized, NAN if none is left.
+void RKSIMD_BilinearGather(const RKFloat *src, const int32_t *a, const int32_t *b, const RKFloat *wb, const RKFloat *wg,
+                           RKFloat *dst, const int n) {
+    int k = 0;
+#if defined(_rk_mm_i32gather_pf)
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec one = _rk_mm_set1_pf(1.0f);
+    const RKVec zero = _rk_mm_setzero_pf();
+    const RKVecInt next = _rk_mm_set1_epi32(1);
+    RKVecInt ia, ib;
+    RKVecMask mv;
+    RKVec xv, wv, sv, tv, uv, vv, yv, zv;
+    for (; k <= n - v; k += v) {
+        ia = _rk_mm_loadu_si(a + k);
+        ib = _rk_mm_loadu_si(b + k);
+        vv = _rk_mm_loadu_pf(wb + k);
+        uv = _rk_mm_sub_pf(one, vv);
+        yv = _rk_mm_loadu_pf(wg + k);
+        zv = _rk_mm_sub_pf(one, yv);
+        // x - x is zero only for finite x
+        xv = _rk_mm_i32gather_pf(src, ia);
+        mv = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(xv, xv), zero);
+        wv = _rk_mm_maskz_pf(_rk_mm_mul_pf(uv, zv), mv);
+        sv = _rk_mm_mul_pf(wv, _rk_mm_maskz_pf(xv, mv));
+        tv = wv;
+        xv = _rk_mm_i32gather_pf(src, _rk_mm_add_epi32(ia, next));
+        mv = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(xv, xv), zero);
+        wv = _rk_mm_maskz_pf(_rk_mm_mul_pf(uv, yv), mv);
+        sv = _rk_mm_add_pf(sv, _rk_mm_mul_pf(wv, _rk_mm_maskz_pf(xv, mv)));
+        tv = _rk_mm_add_pf(tv, wv);
+        xv = _rk_mm_i32gather_pf(src, ib);
+        mv = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(xv, xv), zero);
+        wv = _rk_mm_maskz_pf(_rk_mm_mul_pf(vv, zv), mv);
+        sv = _rk_mm_add_pf(sv, _rk_mm_mul_pf(wv, _rk_mm_maskz_pf(xv, mv)));
+        tv = _rk_mm_add_pf(tv, wv);
+        xv = _rk_mm_i32gather_pf(src, _rk_mm_add_epi32(ib, next));
+        mv = _rk_mm_cmpeq_pf(_rk_mm_sub_pf(xv, xv), zero);
+        wv = _rk_mm_maskz_pf(_rk_mm_mul_pf(vv, yv), mv);
+        sv = _rk_mm_add_pf(sv, _rk_mm_mul_pf(wv, _rk_mm_maskz_pf(xv, mv)));
+        tv = _rk_mm_add_pf(tv, wv);
+        // 0 / 0 is NAN when none of the samples is finite
+        _rk_mm_storeu_pf(dst + k, _rk_mm_div_pf(sv, tv));
+    }
+#endif
+    RKFloat x[4], w[4], s, t;
+    int j;
+    for (; k < n; k++) {
+        x[0] = src[a[k]];
+        x[1] = src[a[k] + 1];
+        x[2] = src[b[k]];
+        x[3] = src[b[k] + 1];
+        w[0] = (1.0f - wb[k]) * (1.0f - wg[k]);
+        w[1] = (1.0f - wb[k]) * wg[k];
+        w[2] = wb[k] * (1.0f - wg[k]);
+        w[3] = wb[k] * wg[k];
+        s = 0.0f;
+        t = 0.0f;
+        for (j = 0; j < 4; j++) {
+            if (isfinite(x[j])) {
+                s += w[j] * x[j];
+                t += w[j];
+            }
+        }
+        dst[k] = t > 0.0f ? s / t : NAN;
+    }
+    return;
+}
+
+// Running maximum, dst[k] = max(src[k], dst[k]), a non-finite src[k] leaves dst[k] as is
+void RKSIMD_imax(const RKFloat *src, RKFloat *dst, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    for (; k <= n - v; k += v) {
+        // The second operand comes out when either one is NAN
+        _rk_mm_storeu_pf(dst + k, _rk_mm_max_pf(_rk_mm_loadu_pf(src + k), _rk_mm_loadu_pf(dst + k)));
+    }
+    for (; k < n; k++) {
+        if (src[k] > dst[k]) {
+            dst[k] = src[k];
+        }
+    }
+    return;
+}
+
+// Echo top, top[k] = max(top[k], h[k]) where z[k] reaches the threshold
+void RKSIMD_EchoTop(const RKFloat *z, const RKFloat *h, const RKFloat threshold, RKFloat *top, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec tv = _rk_mm_set1_pf(threshold);
+    RKVecMask mv;
+    RKVec yv;
+    for (; k <= n - v; k += v) {
+        mv = _rk_mm_cmpge_pf(_rk_mm_loadu_pf(z + k), tv);
+        yv = _rk_mm_loadu_pf(top + k);
+        _rk_mm_storeu_pf(top + k, _rk_mm_max_pf(_rk_mm_blend_pf(yv, _rk_mm_loadu_pf(h + k), mv), yv));
+    }
+    for (; k < n; k++) {
+        if (z[k] >= threshold && h[k] > top[k]) {
+            top[k] = h[k];
+        }
+    }
+    return;
+}
+
+// Vertically integrated liquid, one layer at a time. The layer between the sample below (hBelow[k], mBelow[k]) and
+// (h[k], m[k]) is added to vil[k] with the trapezoidal rule and the sample moves up. At the same height, the larger
+// m[k] is kept. A NAN in hBelow[k] means no sample below.
+void RKSIMD_VILLayer(const RKFloat *m, const RKFloat *h, RKFloat *mBelow, RKFloat *hBelow, RKFloat *vil, const int n) {
+    int k = 0;
+    const int v = sizeof(RKVec) / sizeof(RKFloat);
+    const RKVec half = _rk_mm_set1_pf(0.5f);
+    RKVecMask gv;
+    RKVec mv, hv, av, bv, dv;
+    for (; k <= n - v; k += v) {
+        mv = _rk_mm_loadu_pf(m + k);
+        hv = _rk_mm_loadu_pf(h + k);
+        av = _rk_mm_loadu_pf(mBelow + k);
+        bv = _rk_mm_loadu_pf(hBelow + k);
+        gv = _rk_mm_cmpgt_pf(hv, bv);
+        dv = _rk_mm_mul_pf(_rk_mm_mul_pf(half, _rk_mm_add_pf(mv, av)), _rk_mm_sub_pf(hv, bv));
+        _rk_mm_storeu_pf(vil + k, _rk_mm_add_pf(_rk_mm_loadu_pf(vil + k), _rk_mm_maskz_pf(dv, gv)));
+        _rk_mm_storeu_pf(mBelow + k, _rk_mm_blend_pf(_rk_mm_max_pf(av, mv), mv, gv));
+        _rk_mm_storeu_pf(hBelow + k, _rk_mm_max_pf(bv, hv));
+    }
+    for (; k < n; k++) {
+        if (h[k] > hBelow[k]) {
+            vil[k] += 0.5f * (m[k] + mBelow[k]) * (h[k] - hBelow[k]);
+            mBelow[k] = m[k];
+            hBelow[k] = h[k];
+        } else {
+            mBelow[k] = MAX(mBelow[k], m[k]);
+            if (isnan(hBelow[k])) {
+                hBelow[k] = h[k];
+            }
+        }
+    }
+    return;
+}
+
 // Subtract by a float
 void RKSIMD_subc(RKFloat *src, const RKFloat f, RKFloat *dst, const int n) {
     int k, K = (n * sizeof(RKFloat) + sizeof(RKVec) - 1) / sizeof(RKVec);
@@ -9,22 +9,225 @@
 //
 
 #include <RadarKit/RKServer.h>
+#include <RadarKit/RKRawDataFile.h>
+#include <zlib.h>
 
 // Internal function definitions
 
 void *RKServerRoutine(void *);
-void *RKOperatorRoutine(void *);
-void *RKOperatorCommandRoutine(void *);
+void *RKServerWorkerRoutine(void *);
+void *RKServerCommandRoutine(void *);
 RKOperator *RKOperatorCreate(RKServer *, int, const char *);
 void RKOperatorFree(RKOperator *);
 int RKDefaultWelcomeHandler(RKOperator *);
 int RKDefaultTerminateHandler(RKOperator *);
+static ssize_t RKOperatorFlushQueue(RKOperator *);
 
 // Implementation
 
+#pragma mark -
+#pragma mark Event descriptor
+
+// A thin layer over epoll on Linux and kqueue elsewhere, the write events are only watched for the operators that are blocked
+
+#define RKServerEventRead    1
+#define RKServerEventWrite   2
+
+static int RKServerEventCreate(void) {
+    #if defined(__linux__)
+    return epoll_create1(0);
+    #else
+    return kqueue();
+    #endif
+}
+
+static int RKServerEventAdd(const int fd, const int sd, void *userData) {
+    #if defined(__linux__)
+    struct epoll_event event = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = userData};
+    return epoll_ctl(fd, EPOLL_CTL_ADD, sd, &event);
+    #else
+    struct kevent event;
+    EV_SET(&event, sd, EVFILT_READ, EV_ADD, 0, 0, userData);
+    return kevent(fd, &event, 1, NULL, 0, NULL);
+    #endif
+}
+
+// Change the events of a socket that has been added, or remove it when there are no events left to watch
+static int RKServerEventWatch(const int fd, const int sd, void *userData, const int events, const int previous) {
+    #if defined(__linux__)
+    struct epoll_event event = {.events = 0, .data.ptr = userData};
+    if (events & RKServerEventRead) {
+        event.events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & RKServerEventWrite) {
+        event.events |= EPOLLOUT;
+    }
+    return epoll_ctl(fd, events == 0 ? EPOLL_CTL_DEL : (previous == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD), sd, &event);
+    #else
+    int count = 0;
+    struct kevent changes[2];
+    if ((events ^ previous) & RKServerEventRead) {
+        EV_SET(&changes[count++], sd, EVFILT_READ, events & RKServerEventRead ? EV_ADD : EV_DELETE, 0, 0, userData);
+    }
+    if ((events ^ previous) & RKServerEventWrite) {
+        EV_SET(&changes[count++], sd, EVFILT_WRITE, events & RKServerEventWrite ? EV_ADD : EV_DELETE, 0, 0, userData);
+    }
+    return count ? kevent(fd, changes, count, NULL, 0, NULL) : 0;
+    #endif
+}
+
+// Wait for up to timeoutMs, the user data of the ready descriptors are returned through userData
+static int RKServerEventWait(const int fd, void **userData, const int count, const int timeoutMs) {
+    int k, r;
+    #if defined(__linux__)
+    struct epoll_event events[count];
+    r = epoll_wait(fd, events, count, timeoutMs);
+    for (k = 0; k < r; k++) {
+        userData[k] = events[k].data.ptr;
+    }
+    #else
+    struct kevent events[count];
+    struct timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000};
+    r = kevent(fd, NULL, 0, events, count, &timeout);
+    for (k = 0; k < r; k++) {
+        userData[k] = events[k].udata;
+    }
+    #endif
+    return r;
+}
+
+static void RKSetNonBlocking(const int sd) {
+    int flags = fcntl(sd, F_GETFL, 0);
+    fcntl(sd, F_SETFL, flags | O_NONBLOCK);
+}
+
 #pragma mark -
 #pragma mark Private functions
 
+// Bring the events that the worker watches in line with rxPaused and txWatched, the caller must hold rxLock
+static void RKOperatorWatch(RKOperator *O) {
+    const int events = (O->rxPaused ? 0 : RKServerEventRead) | (O->txWatched ? RKServerEventWrite : 0);
+    if (events != O->events && RKServerEventWatch(O->worker->fd, O->sid, O, events, O->events) == 0) {
+        O->events = events;
+    }
+}
+
+// Watch the socket again once there is room in rxBuffer, the caller must hold rxLock
+static void RKOperatorResumeReading(RKOperator *O) {
+    if (O->rxPaused && O->rxLength < RKMaximumCommandLength - 1) {
+        O->rxPaused = false;
+        RKOperatorWatch(O);
+    }
+}
+
+// Take bytes that have been received but not consumed as commands first, then the socket. Only the I/O worker
+// reads the socket, anyone else, e.g., a command handler, gets EAGAIN until the worker has received more
+static ssize_t RKOperatorRead(RKOperator *O, void *buffer, const size_t size) {
+    pthread_mutex_lock(&O->rxLock);
+    if (O->rxLength == 0) {
+        pthread_mutex_unlock(&O->rxLock);
+        if (pthread_equal(pthread_self(), O->worker->tid)) {
+            return read(O->sid, buffer, size);
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+    size_t n = MIN(size, O->rxLength);
+    memcpy(buffer, O->rxBuffer, n);
+    O->rxLength -= n;
+    memmove(O->rxBuffer, O->rxBuffer + n, O->rxLength);
+    RKOperatorResumeReading(O);
+    pthread_mutex_unlock(&O->rxLock);
+    return n;
+}
+
+// Queue an operator for a command worker, the caller must hold rxLock and have set commandQueued
+static void RKServerPostCommands(RKServer *M, RKOperator *O) {
+    pthread_mutex_lock(&M->commandLock);
+    M->commandQueue[(M->commandQueueHead + M->commandQueueCount) % RKServerMaximumOperators] = O;
+    M->commandQueueCount++;
+    pthread_cond_signal(&M->commandPosted);
+    pthread_mutex_unlock(&M->commandLock);
+}
+
+// Execute every complete line as a command, a command handler may consume what follows through RKServerReceiveUserPayload().
+// This runs on a command worker so that a slow command handler does not hold up the streams of the I/O worker
+static void RKOperatorExecuteCommands(RKOperator *O) {
+    RKServer *M = O->M;
+    char *str, *e;
+    size_t n;
+
+    pthread_mutex_lock(&O->rxLock);
+    while (O->state == RKOperatorStateActive && M->state == RKServerStateActive && O->rxLength > 0 && O->payloadsExpected == 0) {
+        e = memchr(O->rxBuffer, '\n', O->rxLength);
+        if (e) {
+            n = e - O->rxBuffer + 1;
+        } else if (O->rxLength >= RKMaximumCommandLength - 1) {
+            // A line that fills up the buffer is taken as is, just like fgets()
+            n = O->rxLength;
+        } else {
+            break;
+        }
+        str = O->commands[O->commandIndexWrite];
+        memcpy(str, O->rxBuffer, n);
+        str[n] = '\0';
+        O->rxLength -= n;
+        memmove(O->rxBuffer, O->rxBuffer + n, O->rxLength);
+        RKOperatorResumeReading(O);
+        RKStripTail(str);
+        O->commandIndexWrite = O->commandIndexWrite == RKServerBufferDepth - 1 ? 0 : O->commandIndexWrite + 1;
+        memset(O->commands[O->commandIndexWrite], 0, RKMaximumCommandLength);
+        // The command to execute, rxLock is let go so that the handler may read a payload
+        O->cmd = O->commands[O->commandIndexRead];
+        pthread_mutex_unlock(&O->rxLock);
+        if (M->c) {
+            M->c(O);
+        } else {
+            RKLog("%s No command handler. cmd '%s' from Op-%03d (%s)\n", M->name, O->cmd, O->iid, O->ip);
+        }
+        pthread_mutex_lock(&O->rxLock);
+        O->commandIndexRead = O->commandIndexRead == RKServerBufferDepth - 1 ? 0 : O->commandIndexRead + 1;
+    }
+    // Anything received from here on queues the operator again
+    O->commandQueued = false;
+    pthread_mutex_unlock(&O->rxLock);
+}
+
+// Drain the socket of an operator that has something to read, the commands are handed to a command worker
+static void RKOperatorIngest(RKOperator *O) {
+    RKServer *M = O->M;
+    ssize_t r;
+
+    pthread_mutex_lock(&O->rxLock);
+    while (O->state == RKOperatorStateActive && O->rxLength < RKMaximumCommandLength - 1) {
+        r = recv(O->sid, O->rxBuffer + O->rxLength, RKMaximumCommandLength - 1 - O->rxLength, 0);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        } else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (r <= 0) {
+            // When the socket has been disconnected by the client
+            O->cmd = NULL;
+            RKLog("%s %s Client disconnected.\n", M->name, O->name);
+            O->state = RKOperatorStateClosing;
+            break;
+        }
+        gettimeofday(&O->latestReadTime, NULL);
+        O->rxLength += r;
+    }
+    if (O->rxLength >= RKMaximumCommandLength - 1 && !O->rxPaused) {
+        // Stop watching the socket until the command worker takes some, otherwise every wait returns right away
+        O->rxPaused = true;
+        RKOperatorWatch(O);
+    }
+    // Payloads that a stream handler is waiting for stay in rxBuffer for RKOperatorReceivePayload()
+    if (O->state == RKOperatorStateActive && O->rxLength > 0 && !O->commandQueued && O->payloadsExpected == 0) {
+        O->commandQueued = true;
+        RKServerPostCommands(O->M, O);
+    }
+    pthread_mutex_unlock(&O->rxLock);
+}
+
 void *RKServerRoutine(void *in) {
     RKServer *M = (RKServer *)in;
 
@@ -67,33 +270,80 @@ void *RKServerRoutine(void *in) {
         M->state = RKServerStateNull;
         return NULL;
     }
+    RKSetNonBlocking(M->sd);
+
+    // Event descriptor for the connection requests
+    int fd = RKServerEventCreate();
+    if (fd < 0 || RKServerEventAdd(fd, M->sd, M) < 0) {
+        RKLog("%s Error. Failed to create an event descriptor.   errno = %d (%s)\n", M->name, errno, RKErrnoString(errno));
+        M->state = RKServerStateNull;
+        close(M->sd);
+        return NULL;
+    }
 
     if (M->verbose) {
-        RKLog("%s sd = %d   port = %d\n", M->name, M->sd, M->port);
+        RKLog("%s sd = %d   port = %d   workers = %d\n", M->name, M->sd, M->port, M->workerCount);
     } else {
         RKLog("%s listening to port %d\n", M->name, M->port);
 
     }
 
     M->state = RKServerStateActive;
-    
+
+    // The I/O workers, each serves a share of the operators
+    for (k = 0; k < M->workerCount; k++) {
+        RKServerWorker *W = &M->workers[k];
+        W->M = M;
+        W->id = k;
+        W->operatorCount = 0;
+        W->fd = RKServerEventCreate();
+        if (W->fd < 0) {
+            RKLog("%s Error. Failed to create an event descriptor for worker %d.\n", M->name, k);
+            M->workerCount = k;
+            break;
+        }
+        pthread_mutex_init(&W->lock, NULL);
+        if (pthread_create(&W->tid, NULL, RKServerWorkerRoutine, W)) {
+            RKLog("%s Error. Failed to create RKServerWorkerRoutine().\n", M->name);
+            pthread_mutex_destroy(&W->lock);
+            close(W->fd);
+            M->workerCount = k;
+            break;
+        }
+    }
+    if (M->workerCount == 0) {
+        M->state = RKServerStateClosing;
+    }
+
+    // The command workers, which run the command handler for any operator that has received a command
+    M->commandQueueHead = 0;
+    M->commandQueueCount = 0;
+    for (k = 0; k < RKServerCommandWorkers; k++) {
+        if (pthread_create(&M->commandTids[k], NULL, RKServerCommandRoutine, M)) {
+            RKLog("%s Error. Failed to create RKServerCommandRoutine().\n", M->name);
+            M->state = RKServerStateClosing;
+            break;
+        }
+    }
+    const int commandWorkerCount = k;
+
     int             sid;
-    fd_set          rfd;
-    struct timeval  timeout;
+    void            *ready;
     const char      busy_msg[] = "Server busy." RKEOL;
     int             nclient;
 
     // Accept connection requests and create and assign an operator for the client
     while (M->state == RKServerStateActive) {
-        // Use select to prevent accept() from blocking
-        FD_ZERO(&rfd);
-        FD_SET(M->sd, &rfd);
-        timeout.tv_sec = 0; timeout.tv_usec = 100000;
-        ii = select(M->sd + 1, &rfd, NULL, NULL, &timeout);
-        if (ii > 0 && FD_ISSET(M->sd, &rfd)) {
-            // Accept a connection, this part shouldn't be blocked. Reuse sa since we no longer need it
+        ii = RKServerEventWait(fd, &ready, 1, 100);
+        if (ii < 0 && errno != EINTR) {
+            RKLog("%s Error. Failed at waiting for events.\n", M->name);
+        }
+        // Accept all the pending connections, this part shouldn't be blocked. Reuse sa since we no longer need it
+        while (ii > 0 && M->state == RKServerStateActive) {
             if ((sid = accept(M->sd, (struct sockaddr *)&sa, &sa_len)) == -1) {
-                RKLog("%s Error. Failed at accept().\n", M->name);
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    RKLog("%s Error. Failed at accept().\n", M->name);
+                }
                 break;
             }
             // Count the number of clients, or operators that are busy
@@ -113,15 +363,12 @@ void *RKServerRoutine(void *in) {
                 close(sid);
             } else {
                 RKOperator *O = RKOperatorCreate(M, sid, inet_ntoa(sa.sin_addr));
-                M->operators[O->iid] = O;
+                if (O) {
+                    M->operators[O->iid] = O;
+                } else {
+                    close(sid);
+                }
             }
-        } else if (ii == 0) {
-            // This isn't really an error, just mean no one is connecting & timeout...
-            usleep(1000);
-        } else if (ii == -1) {
-            RKLog("%s Error. Failed at select().\n", M->name);
-        } else {
-            RKLog("%s Error. At an unknown state.\n", M->name);
         }
 
         // Go through all operator to see which one should be freed
@@ -135,205 +382,187 @@ void *RKServerRoutine(void *in) {
             }
         }
     } // while (M->state == RKServerStateActive) ...
-    
+
     if (M->verbose > 1) {
         RKLog("%s Returning ...\n", M->name);
     }
-    
+
+    // Workers hang up their operators as they retire
+    for (k = 0; k < M->workerCount; k++) {
+        pthread_join(M->workers[k].tid, NULL);
+        pthread_mutex_destroy(&M->workers[k].lock);
+        close(M->workers[k].fd);
+    }
+    // Command workers go through what is left in the queue, which only clears the flags now, and retire
+    pthread_mutex_lock(&M->commandLock);
+    pthread_cond_broadcast(&M->commandPosted);
+    pthread_mutex_unlock(&M->commandLock);
+    for (k = 0; k < commandWorkerCount; k++) {
+        pthread_join(M->commandTids[k], NULL);
+    }
+    for (k = 0; k < RKServerMaximumOperators; k++) {
+        if (M->busy[k] && M->operators[k] != NULL) {
+            RKOperatorFree(M->operators[k]);
+        }
+    }
+    close(fd);
+    close(M->sd);
+
     M->state = RKServerStateFree;
-    
+
     return NULL;
 }
 
 
-void *RKOperatorRoutine(void *in) {
+void *RKServerWorkerRoutine(void *in) {
 
-    RKOperator      *O = (RKOperator *)in;
-    RKServer        *M = O->M;
+    RKServerWorker  *W = (RKServerWorker *)in;
+    RKServer        *M = W->M;
+    RKOperator      *O;
 
-    int             r;
+    int             k, n;
+    void            *ready[RKServerMaximumOperators];
 
-    FILE            *fp;
-    fd_set          rfd;
-    fd_set          wfd;
-    fd_set          efd;
-
-    char            *str;
+    bool            busy, blocked;
 
+    struct timeval  now;
     struct timeval  timeout;
     struct timeval  user_timeout = {M->timeoutSeconds, 0};
-    struct timeval  latestReadTime;
-    struct timeval  latestWriteTime;
-
-    pthread_mutex_init(&O->lock, NULL);
-
-    O->state = RKOperatorStateActive;
-
-    if (pthread_create(&O->tidExecute, NULL, RKOperatorCommandRoutine, O)) {
-        RKLog("%s Error. Failed to create RKOperatorCommandRoutine().\n", M->name);
-        return (void *)RKResultErrorCreatingOperatorCommandRoutine;
-    }
 
-    RKLog("%s %s Started.   ireq = %d\n", M->name, O->name, M->ireq++);
-
-    // Greet with welcome function
-    if (M->w != NULL) {
-        M->w(O);
-    }
-
-    // Initialize some time values
-    gettimeofday(&latestReadTime, NULL);
-    gettimeofday(&latestWriteTime, NULL);
-
-    // Get a file descriptor for get line
-    fp = fdopen(O->sid, "r");
-    if (fp == NULL) {
-        RKLog("%s unable to get a file descriptor fro socket descriptor.\n", M->name);
-        return (void *)RKResultSDToFDError;
+    if (M->verbose > 1) {
+        RKLog("%s Worker %d started.\n", M->name, W->id);
     }
 
-    // Run loop for the read/write
-    while (M->state == RKServerStateActive && O->state == RKOperatorStateActive) {
-        //
-        //  Stream worker
-        //
-        FD_ZERO(&wfd);
-        FD_ZERO(&efd);
-        FD_SET(O->sid, &wfd);
-        FD_SET(O->sid, &efd);
-        if (M->s != NULL) {
-            timeout.tv_sec = 0;
-            timeout.tv_usec = RKServerSelectTimeoutUs;
-            r = select(O->sid + 1, NULL, &wfd, &efd, &timeout);
-            if (r > 0) {
-                if (FD_ISSET(O->sid, &efd)) {
-                    // Exceptions
-                    RKLog("%s encountered an exception error.\n", M->name);
-                    break;
-                } else if (FD_ISSET(O->sid, &wfd)) {
-                    // Ready to write (stream)
-                    gettimeofday(&latestWriteTime, NULL);
-                    M->s(O);
-                }
-            } else if (r < 0) {
-                // Errors
-                RKLog("%s Error. Encountered something bad.\n", M->name);
-                break;
-            } else {
-                // Timeout (r == 0)
-                gettimeofday(&timeout, NULL);
-                timersub(&timeout, &user_timeout, &timeout);
-                if (timercmp(&timeout, &latestWriteTime, >=)) {
-                    // Dismiss with a terminate function
-                    RKLog("%s %s Encountered a timeout (%d seconds).\n", M->name, O->name, M->timeoutSeconds);
-                    if (M->t != NULL) {
-                        M->t(O);
-                    }
-                    break;
-                }
-            }
-        }
+    // Run loop for the read/write of all the operators of this worker
+    while (M->state == RKServerStateActive) {
         //
         //  Command queue
         //
-        FD_ZERO(&rfd);
-        FD_ZERO(&efd);
-        FD_SET(O->sid, &rfd);
-        FD_SET(O->sid, &efd);
-        timeout.tv_sec = 0;
-        timeout.tv_usec = RKServerSelectTimeoutUs;
-        r = select(O->sid + 1, &rfd, NULL, &efd, &timeout);
-        if (r > 0) {
-            if (FD_ISSET(O->sid, &efd)) {
-                // Exceptions
-                RKLog("%s %s Encountered an exception error.\n", M->name, O->name);
-                break;
-            } else if (FD_ISSET(O->sid, &rfd)) {
-                // Ready to read (command)
-                gettimeofday(&latestReadTime, NULL);
-                str = O->commands[O->commandIndexWrite];
-                if (fgets(str, RKMaximumCommandLength - 1, fp) == NULL) {
-                    // When the socket has been disconnected by the client
-                    O->cmd = NULL;
-                    RKLog("%s %s Client disconnected.\n", M->name, O->name);
-                    if (M->t != NULL) {
-                        M->t(O);
-                    }
-                    break;
-                }
-                RKStripTail(str);
-                O->commandIndexWrite = O->commandIndexWrite == RKServerBufferDepth - 1 ? 0 : O->commandIndexWrite + 1;
-                memset(O->commands[O->commandIndexWrite], 0, RKMaximumCommandLength);
+        n = RKServerEventWait(W->fd, ready, RKServerMaximumOperators, RKServerStreamPeriodMs);
+        if (n < 0 && errno != EINTR) {
+            RKLog("%s Error. Worker %d encountered an unexpected error.\n", M->name, W->id);
+            usleep(10000);
+        }
+        for (k = 0; k < n; k++) {
+            RKOperatorIngest((RKOperator *)ready[k]);
+        }
+
+        gettimeofday(&now, NULL);
+        timersub(&now, &user_timeout, &timeout);
+
+        pthread_mutex_lock(&W->lock);
+        n = W->operatorCount;
+        pthread_mutex_unlock(&W->lock);
+
+        k = 0;
+        while (k < n) {
+            O = W->operators[k];
+            //
+            //  Stream worker
+            //
+            pthread_mutex_lock(&O->lock);
+            if (O->queueCount > 0) {
+                RKOperatorFlushQueue(O);
             }
-        } else if (r < 0) {
-            // Errors
-            RKLog("%s %s Error. Encountered an unexpected error.\n", M->name, O->name);
-            break;
-        } else if (M->options & RKServerOptionExpectBeacon) {
-            // Timeout (r == 0)
-            gettimeofday(&timeout, NULL);
-            timersub(&timeout, &user_timeout, &timeout);
-            if (timercmp(&timeout, &latestReadTime, >=)) {
-                // Dismiss with a terminate function
+            // A blocked operator resumes once the client has taken half of the queue
+            if (O->blocked && O->queueCount <= RKServerSendQueueDepth / 2 && O->queueSize <= RKServerSendQueueCapacity / 2) {
+                O->blocked = false;
+            }
+            blocked = O->blocked;
+            // A stream client that has not taken anything for a while is hung up, an empty queue is as good as a write
+            if (O->queueCount == 0) {
+                O->latestWriteTime = now;
+            } else if (O->state == RKOperatorStateActive && M->s != NULL && timercmp(&timeout, &O->latestWriteTime, >=)) {
+                RKLog("%s %s Encountered a stream timeout (%d seconds).\n", M->name, O->name, M->timeoutSeconds);
+                O->state = RKOperatorStateClosing;
+            }
+            pthread_mutex_unlock(&O->lock);
+            // Writability wakes up the worker to flush the queue of a blocked operator
+            if (O->txWatched != blocked) {
+                pthread_mutex_lock(&O->rxLock);
+                O->txWatched = blocked;
+                RKOperatorWatch(O);
+                pthread_mutex_unlock(&O->rxLock);
+            }
+            // Nothing more is produced for a blocked operator
+            if (O->state == RKOperatorStateActive && M->s != NULL && !blocked) {
+                M->s(O);
+            }
+            if (O->state == RKOperatorStateActive && M->options & RKServerOptionExpectBeacon && timercmp(&timeout, &O->latestReadTime, >=)) {
                 RKLog("%s %s Encountered a timeout (%d seconds).\n", M->name, O->name, M->timeoutSeconds);
-                if (M->t != NULL) {
-                    M->t(O);
-                }
-                break;
+                O->state = RKOperatorStateClosing;
+            }
+            if (O->state == RKOperatorStateActive) {
+                k++;
+                continue;
+            }
+            // The command worker must be done with this operator first
+            pthread_mutex_lock(&O->rxLock);
+            busy = O->commandQueued;
+            pthread_mutex_unlock(&O->rxLock);
+            if (busy) {
+                k++;
+                continue;
+            }
+            // Dismiss with a terminate function, whether it was hung up deliberately, disconnected or timed out
+            if (M->t != NULL) {
+                M->t(O);
+            }
+            pthread_mutex_lock(&O->rxLock);
+            O->rxPaused = true;
+            O->txWatched = false;
+            RKOperatorWatch(O);
+            pthread_mutex_unlock(&O->rxLock);
+            pthread_mutex_lock(&W->lock);
+            W->operators[k] = W->operators[--W->operatorCount];
+            W->operators[W->operatorCount] = NULL;
+            pthread_mutex_unlock(&W->lock);
+            n--;
+            O->state = RKOperatorStateHungUp;
+            if (M->verbose > 1) {
+                RKLog(">%s %s Operator returning ...\n", M->name, O->name);
             }
         }
     } // while () ...
 
-    // If the state was changed deliberately by RKOperatorHangUp()
-    if (O->state == RKOperatorStateClosing) {
-        if (M->t != NULL) {
-            M->t(O);
-        }
+    // Hang up everyone without the terminate function, just like the server. A command worker only clears the flags from here on
+    pthread_mutex_lock(&W->lock);
+    for (k = 0; k < W->operatorCount; k++) {
+        W->operators[k]->state = RKOperatorStateHungUp;
+        W->operators[k] = NULL;
     }
-
-    // Set the state if all the 'break' conditions signals the RKOperatorCommandRoutine to quit as well.
-    O->state = RKOperatorStateClosing;
-
-    pthread_join(O->tidExecute, NULL);
-    pthread_mutex_destroy(&O->lock);
-    fclose(fp);
-
-    O->state = RKOperatorStateHungUp;
+    W->operatorCount = 0;
+    pthread_mutex_unlock(&W->lock);
 
     if (M->verbose > 1) {
-        RKLog(">%s %s Operator routine returning ...\n", M->name, O->name);
+        RKLog("%s Worker %d returning ...\n", M->name, W->id);
     }
 
     return NULL;
 }
 
 
-void *RKOperatorCommandRoutine(void *in) {
-    
-    RKOperator      *O = (RKOperator *)in;
-    RKServer        *M = O->M;
-    
+void *RKServerCommandRoutine(void *in) {
+
+    RKServer        *M = (RKServer *)in;
+    RKOperator      *O;
+
     while (true) {
-        while (O->commandIndexRead == O->commandIndexWrite && M->state == RKServerStateActive && O->state == RKOperatorStateActive) {
-            usleep(10000);
+        pthread_mutex_lock(&M->commandLock);
+        while (M->commandQueueCount == 0 && M->state == RKServerStateActive) {
+            pthread_cond_wait(&M->commandPosted, &M->commandLock);
         }
-        if (M->state != RKServerStateActive || O->state != RKOperatorStateActive) {
+        if (M->commandQueueCount == 0) {
+            pthread_mutex_unlock(&M->commandLock);
             break;
         }
-        // The command to execute
-        O->cmd = O->commands[O->commandIndexRead];
-        if (M->c) {
-            M->c(O);
-        } else {
-            RKLog("%s No command handler. cmd '%s' from Op-%03d (%s)\n", M->name, O->cmd, O->iid, O->ip);
-        }
-        O->commandIndexRead = O->commandIndexRead == RKServerBufferDepth - 1 ? 0 : O->commandIndexRead + 1;
-    }
-    
-    if (M->verbose > 1) {
-        RKLog(">%s %s Command routine returning ...\n", M->name, O->name);
+        O = M->commandQueue[M->commandQueueHead];
+        M->commandQueueHead = M->commandQueueHead == RKServerMaximumOperators - 1 ? 0 : M->commandQueueHead + 1;
+        M->commandQueueCount--;
+        pthread_mutex_unlock(&M->commandLock);
+        RKOperatorExecuteCommands(O);
     }
-    
+
     return NULL;
 }
 
@@ -380,15 +609,45 @@ RKOperator *RKOperatorCreate(RKServer *M, int sid, const char *ip) {
     memcpy(&O->delimTx, &O->delimString, sizeof(RKNetDelimiter));
     O->delimTx.type = RKNetworkPacketTypeBytes;
     O->beacon.type = RKNetworkPacketTypeBeacon;
+    pthread_mutex_init(&O->lock, NULL);
+    pthread_mutex_init(&O->rxLock, NULL);
+    RKSetNonBlocking(sid);
+
+    // The least busy worker serves this operator
+    RKServerWorker *W = &M->workers[0];
+    for (k = 1; k < M->workerCount; k++) {
+        if (W->operatorCount > M->workers[k].operatorCount) {
+            W = &M->workers[k];
+        }
+    }
+    O->worker = W;
 
-    if (pthread_create(&O->tidRead, NULL, RKOperatorRoutine, O)) {
-        RKLog("%s Error. Failed to create RKOperatorRoutine().\n", M->name);
-        pthread_mutex_unlock(&M->lock);
-        return NULL;
+    O->state = RKOperatorStateActive;
+
+    RKLog("%s %s Started.   ireq = %d   worker = %d\n", M->name, O->name, M->ireq++, W->id);
+
+    // Greet with welcome function
+    if (M->w != NULL) {
+        M->w(O);
+    }
+
+    // Initialize some time values
+    gettimeofday(&O->latestReadTime, NULL);
+    O->latestWriteTime = O->latestReadTime;
+
+    // Hand over to the worker
+    pthread_mutex_lock(&W->lock);
+    W->operators[W->operatorCount++] = O;
+    if (RKServerEventAdd(W->fd, sid, O) < 0) {
+        RKLog("%s Error. Unable to watch %s.   errno = %d (%s)\n", M->name, O->name, errno, RKErrnoString(errno));
+        O->state = RKOperatorStateClosing;
+    } else {
+        O->events = RKServerEventRead;
     }
+    pthread_mutex_unlock(&W->lock);
 
     pthread_mutex_unlock(&M->lock);
-    
+
     return O;
 }
 
@@ -397,8 +656,18 @@ void RKOperatorFree(RKOperator *O) {
     RKServer *M = O->M;
     const int k = O->iid;
 
-    pthread_join(O->tidRead, NULL);
     close(O->sid);
+    pthread_mutex_destroy(&O->lock);
+    pthread_mutex_destroy(&O->rxLock);
+    if (O->compressBuffer) {
+        free(O->compressBuffer);
+    }
+    for (int j = 0; j < O->queueDepth; j++) {
+        if (O->queue[j].buffer) {
+            free(O->queue[j].buffer);
+        }
+    }
+    free(O->queue);
     free(O);
 
     M->busy[k] = false;
@@ -479,11 +748,14 @@ RKServer *RKServerInit(void) {
     }
     memset(M, 0, sizeof(RKServer));
     M->port = 10000;
-    M->maxClient = RKServerMaximumOperators;
+    M->maxClient = RKServerDefaultOperators;
     M->timeoutSeconds = 5;
+    M->workerCount = RKServerDefaultWorkers;
     M->w = &RKDefaultWelcomeHandler;
     M->t = &RKDefaultTerminateHandler;
     pthread_mutex_init(&M->lock, NULL);
+    pthread_mutex_init(&M->commandLock, NULL);
+    pthread_cond_init(&M->commandPosted, NULL);
 
     // Ignore broken pipe for clients that disconnect unexpectedly
     signal(SIGPIPE, SIG_IGN);
@@ -496,6 +768,9 @@ void RKServerFree(RKServer *M) {
     while (M->state > RKServerStateFree) {
         usleep(100000);
     }
+    pthread_cond_destroy(&M->commandPosted);
+    pthread_mutex_destroy(&M->commandLock);
+    pthread_mutex_destroy(&M->lock);
     free(M);
 }
 
@@ -510,6 +785,22 @@ void RKServerSetPort(RKServer *M, const int port) {
     M->port = port;
 }
 
+void RKServerSetMaximumClientCount(RKServer *M, const int count) {
+    M->maxClient = MAX(1, MIN(RKServerMaximumOperators, count));
+}
+
+void RKServerSetOptions(RKServer *M, const RKServerOption options) {
+    M->options = options;
+}
+
+void RKServerSetWorkerCount(RKServer *M, const int count) {
+    if (M->state > RKServerStateFree) {
+        RKLog("%s Error. Worker count cannot be changed while the server is running.\n", M->name);
+        return;
+    }
+    M->workerCount = MAX(1, MIN(RKServerMaximumWorkers, count));
+}
+
 void RKServerSetWelcomeHandler(RKServer *M, int (*function)(RKOperator *)) {
     M->w = function;
 }
@@ -602,7 +893,7 @@ ssize_t RKServerReceiveUserPayload(RKOperator *O, void *buffer, RKNetworkMessage
             k = 0;
             readCount = 0;
             while (readCount++ < O->timeoutSeconds * 100) {
-                if ((r = read(O->sid, delimiter + k, sizeof(RKNetDelimiter) - k)) > 0) {
+                if ((r = RKOperatorRead(O, (char *)delimiter + k, sizeof(RKNetDelimiter) - k)) > 0) {
                     if (r) {
                         k += r;
                         if (k == sizeof(RKNetDelimiter)) {
@@ -646,7 +937,7 @@ ssize_t RKServerReceiveUserPayload(RKOperator *O, void *buffer, RKNetworkMessage
             k = 0;
             readCount = 0;
             while (readCount++ < M->timeoutSeconds * 100) {
-                if ((r = (int)read(O->sid, buffer + k, delimiter->size - k)) > 0) {
+                if ((r = (int)RKOperatorRead(O, buffer + k, delimiter->size - k)) > 0) {
                     k += r;
                     if (k >= delimiter->size) {
                         break;
@@ -683,7 +974,7 @@ ssize_t RKServerReceiveUserPayload(RKOperator *O, void *buffer, RKNetworkMessage
             k = 0;
             readCount = 0;
             while (readCount++ < M->timeoutSeconds * 100) {
-                if ((r = (int)read(O->sid, buffer + k, blockLength - k)) > 0) {
+                if ((r = (int)RKOperatorRead(O, buffer + k, blockLength - k)) > 0) {
                     k += r;
                     if (k >= blockLength) {
                         break;
@@ -727,11 +1018,220 @@ ssize_t RKServerReceiveUserPayload(RKOperator *O, void *buffer, RKNetworkMessage
     return -1;
 }
 
-// In counts of 10ms, should be plenty, in-transit buffer should be able to hold it
-#define RKSocketTimeCountOf10ms  10
+// Send what the queue holds without waiting, return the bytes sent or a negative value on error
+static ssize_t RKOperatorFlushQueue(RKOperator *O) {
+    int k, count;
+    size_t n;
+    ssize_t sentSize;
+    ssize_t totalSentSize = 0;
+    struct msghdr msg;
+    struct iovec iov[RKServerMaximumFragments];
+    RKOperatorPacket *packet;
+
+    memset(&msg, 0, sizeof(struct msghdr));
+    while (O->queueCount > 0) {
+        count = MIN(O->queueCount, RKServerMaximumFragments);
+        for (k = 0; k < count; k++) {
+            packet = &O->queue[(O->queueHead + k) % O->queueDepth];
+            iov[k].iov_base = packet->buffer + packet->offset;
+            iov[k].iov_len = packet->size - packet->offset;
+        }
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        if ((sentSize = sendmsg(O->sid, &msg, 0)) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                break;
+            }
+            O->state = RKOperatorStateClosing;
+            return -1;
+        }
+        totalSentSize += sentSize;
+        O->dropStreak = 0;
+        gettimeofday(&O->latestWriteTime, NULL);
+        // Retire the packets that are done, the last one may be partially sent
+        while (sentSize > 0) {
+            packet = &O->queue[O->queueHead];
+            n = MIN((size_t)sentSize, packet->size - packet->offset);
+            packet->offset += n;
+            O->queueSize -= n;
+            sentSize -= n;
+            if (packet->offset == packet->size) {
+                packet->size = 0;
+                packet->offset = 0;
+                O->queueHead = (O->queueHead + 1) % O->queueDepth;
+                O->queueCount--;
+            }
+        }
+    }
+    return totalSentSize;
+}
+
+// Drop the oldest packet that may be dropped and has not been started, return false if there is none
+static bool RKOperatorDropOldest(RKOperator *O) {
+    int j, k;
+    RKOperatorPacket dropped;
+
+    for (k = 0; k < O->queueCount; k++) {
+        RKOperatorPacket *packet = &O->queue[(O->queueHead + k) % O->queueDepth];
+        if (packet->policy != RKOperatorSendPolicyDropOldest || packet->offset > 0) {
+            continue;
+        }
+        // Close the gap and recycle the buffer at the tail
+        dropped = *packet;
+        for (j = k; j < O->queueCount - 1; j++) {
+            O->queue[(O->queueHead + j) % O->queueDepth] = O->queue[(O->queueHead + j + 1) % O->queueDepth];
+        }
+        O->queueSize -= dropped.size;
+        dropped.size = 0;
+        O->queue[(O->queueHead + O->queueCount - 1) % O->queueDepth] = dropped;
+        O->queueCount--;
+        return true;
+    }
+    return false;
+}
+
+// Double the queue, the packets are laid out from the head so that the buffers of the vacant ones are kept too
+static bool RKOperatorGrowQueue(RKOperator *O) {
+    const uint32_t depth = O->queueDepth ? 2 * O->queueDepth : RKServerSendQueueDepth;
+    RKOperatorPacket *queue = (RKOperatorPacket *)malloc(depth * sizeof(RKOperatorPacket));
+    if (queue == NULL) {
+        return false;
+    }
+    memset(queue, 0, depth * sizeof(RKOperatorPacket));
+    for (uint32_t k = 0; k < O->queueDepth; k++) {
+        queue[k] = O->queue[(O->queueHead + k) % O->queueDepth];
+    }
+    free(O->queue);
+    O->queue = queue;
+    O->queueDepth = depth;
+    O->queueHead = 0;
+    return true;
+}
+
+// Keep a copy of a packet for RKOperatorFlushQueue(), return the size or 0 if the packet is dropped. A packet
+// that has been partially sent is forced into the queue since the rest of it cannot be dropped
+static ssize_t RKOperatorEnqueue(RKOperator *O, struct iovec *iov, const int count, const size_t size, const bool forced) {
+    int k;
+    void *p;
+    RKOperatorPacket *packet;
+    const RKOperatorSendPolicy policy = forced ? RKOperatorSendPolicyBlock : O->sendPolicy;
+
+    while (O->queueCount >= RKServerSendQueueDepth || (O->queueCount > 0 && O->queueSize + size > RKServerSendQueueCapacity)) {
+        if (policy == RKOperatorSendPolicyDropOldest) {
+            O->dropCount++;
+            if (++O->dropStreak > RKServerMaximumDropStreak) {
+                RKLog("%s %s Dropped %s packets without progress.\n", O->M->name, O->name, RKIntegerToCommaStyleString(O->dropStreak));
+                O->state = RKOperatorStateClosing;
+                return -1;
+            }
+            if (!RKOperatorDropOldest(O)) {
+                return 0;
+            }
+            continue;
+        }
+        // Back pressure, the droppable ones go first. Otherwise, the packet is kept over the limits and the operator is
+        // blocked, the worker stops calling the stream handler until the client has taken half of the queue
+        if (RKOperatorDropOldest(O)) {
+            O->dropCount++;
+            continue;
+        }
+        O->blocked = true;
+        break;
+    }
+    if (O->queueCount == O->queueDepth && !RKOperatorGrowQueue(O)) {
+        RKLog("%s %s Error. Unable to grow the queue.\n", O->M->name, O->name);
+        O->state = RKOperatorStateClosing;
+        return -1;
+    }
+
+    packet = &O->queue[(O->queueHead + O->queueCount) % O->queueDepth];
+    if (packet->capacity < size) {
+        free(packet->buffer);
+        if ((packet->buffer = malloc(size)) == NULL) {
+            RKLog("%s %s Error. Unable to allocate a queued packet.\n", O->M->name, O->name);
+            packet->capacity = 0;
+            O->state = RKOperatorStateClosing;
+            return -1;
+        }
+        packet->capacity = size;
+    }
+    for (p = packet->buffer, k = 0; k < count; k++) {
+        memcpy(p, iov[k].iov_base, iov[k].iov_len);
+        p += iov[k].iov_len;
+    }
+    packet->size = size;
+    packet->offset = 0;
+    packet->policy = policy;
+    O->queueCount++;
+    O->queueSize += size;
+    O->queuePeakCount = MAX(O->queuePeakCount, O->queueCount);
+    return size;
+}
+
+// Send all the fragments in as few system calls as possible. Whatever the client cannot take right now goes
+// to the queue, which is flushed by the worker, so a slow client never holds up the worker of the others.
+// Return the size sent or queued, 0 if dropped, or -1 if the operator is closing, which is then left alone
+static ssize_t RKOperatorSendVector(RKOperator *O, struct iovec *iov, int count, const size_t size) {
+    ssize_t sentSize;
+    ssize_t totalSentSize = 0;
+    struct msghdr msg;
+
+    // Nothing goes to a socket that has failed or an operator that is being hung up
+    if (O->state != RKOperatorStateActive) {
+        return -1;
+    }
+
+    // Packets that are already waiting go first
+    if (O->queueCount > 0 && RKOperatorFlushQueue(O) < 0) {
+        return -1;
+    }
+    if (O->queueCount > 0) {
+        return RKOperatorEnqueue(O, iov, count, size, false);
+    }
+
+    memset(&msg, 0, sizeof(struct msghdr));
+    while (count > 0) {
+        msg.msg_iov = iov;
+        msg.msg_iovlen = MIN(count, RKServerMaximumFragments);
+        if ((sentSize = sendmsg(O->sid, &msg, 0)) > 0) {
+            totalSentSize += sentSize;
+            // Skip the fragments that are done, then advance into the partially sent one
+            while (count > 0 && sentSize >= iov->iov_len) {
+                sentSize -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base += sentSize;
+                iov->iov_len -= sentSize;
+            }
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            O->state = RKOperatorStateClosing;
+            return -1;
+        } else if (totalSentSize == 0) {
+            // Nothing has gone out, the packet is subject to the send policy
+            return RKOperatorEnqueue(O, iov, count, size, false);
+        } else {
+            if ((sentSize = RKOperatorEnqueue(O, iov, count, size - totalSentSize, true)) < 0) {
+                return sentSize;
+            }
+            totalSentSize += sentSize;
+            break;
+        }
+    }
+
+    return totalSentSize;
+}
 
 // Use as:
 // RKOperatorSendPackets(operator, payload, size, payload, size, ..., NULL);
+//
+// All payloads are gathered into one sendmsg(), up to RKServerMaximumFragments at a time. Sockets are
+// non-blocking, what the client cannot take is queued and handled according to O->sendPolicy when
+// the queue is full, see RKOperatorSetSendPolicy(). The payloads are one message no matter how many,
+// they are queued or dropped together
 
 ssize_t RKOperatorSendPackets(RKOperator *O, ...) {
 
@@ -740,11 +1240,13 @@ ssize_t RKOperatorSendPackets(RKOperator *O, ...) {
     void      *payload;
     ssize_t   payloadSize = 1;
 
-    ssize_t   grandTotalSentSize = 0;
-    ssize_t   totalSentSize = 0;
     ssize_t   sentSize = 0;
+    size_t    size = 0;
 
-    int timeout_count = 0;
+    struct iovec fragments[RKServerMaximumFragments];
+    struct iovec *iov = fragments, *more;
+    int capacity = RKServerMaximumFragments;
+    int count = 0;
 
     pthread_mutex_lock(&O->lock);
 
@@ -754,33 +1256,161 @@ ssize_t RKOperatorSendPackets(RKOperator *O, ...) {
     payload = va_arg(arg, void *);
     while (payload != NULL) {
         payloadSize = va_arg(arg, ssize_t);
-        //printf("size %d @ %p\n", (int)payloadSize, payload);
-        sentSize = 0;
-        totalSentSize = 0;
-        while (totalSentSize < payloadSize && timeout_count++ < RKSocketTimeCountOf10ms) {
-            if ((sentSize = send(O->sid, payload + sentSize, payloadSize - sentSize, 0)) > 0) {
-                totalSentSize += sentSize;
-            }
-            if (totalSentSize < payloadSize) {
-                usleep(1000);
-            } else if (sentSize < 0) {
-                pthread_mutex_unlock(&O->lock);
-                return RKResultIncompleteSend;
+        if (payloadSize > 0) {
+            if (count == capacity) {
+                capacity *= 2;
+                if ((more = (struct iovec *)malloc(capacity * sizeof(struct iovec))) == NULL) {
+                    RKLog("%s %s Error. Unable to gather %d payloads.\n", O->M->name, O->name, capacity);
+                    if (iov != fragments) {
+                        free(iov);
+                    }
+                    va_end(arg);
+                    pthread_mutex_unlock(&O->lock);
+                    return -1;
+                }
+                memcpy(more, iov, count * sizeof(struct iovec));
+                if (iov != fragments) {
+                    free(iov);
+                }
+                iov = more;
             }
+            iov[count].iov_base = payload;
+            iov[count].iov_len = payloadSize;
+            size += payloadSize;
+            count++;
         }
-        grandTotalSentSize += totalSentSize;
         payload = va_arg(arg, void *);
     }
-    
+
     va_end(arg);
-    
+
+    if (count > 0) {
+        sentSize = RKOperatorSendVector(O, iov, count, size);
+    }
+    if (iov != fragments) {
+        free(iov);
+    }
+
     pthread_mutex_unlock(&O->lock);
-    
-    if (timeout_count >= RKSocketTimeCountOf10ms) {
-        return RKResultTimeout;
+
+    return sentSize;
+}
+
+// Use as:
+// RKOperatorSendCompressiblePackets(operator, elementSize, delimiter, payload, size, payload, size, ..., NULL);
+//
+// The delimiter describes the concatenated payloads. If the client has negotiated compression, they are
+// gathered, byte shuffled by elementSize and deflated into one payload. The delimiter that goes out has
+// RKNetDelimiterSubtypeDeflated and the element size in subtype, the compressed size in size and the
+// original size in decodedSize. Small or incompressible payloads go out as they are with subtype = 0.
+
+ssize_t RKOperatorSendCompressiblePackets(RKOperator *O, const uint8_t elementSize, RKNetDelimiter *delimiter, ...) {
+
+    va_list   arg;
+
+    void      *payload;
+    ssize_t   payloadSize;
+    ssize_t   sentSize;
+    size_t    size = 0;
+
+    struct iovec iov[RKServerMaximumFragments];
+    int count = 1;
+
+    va_start(arg, delimiter);
+
+    payload = va_arg(arg, void *);
+    while (payload != NULL) {
+        payloadSize = va_arg(arg, ssize_t);
+        if (count == RKServerMaximumFragments) {
+            RKLog("%s %s Error. More than %d payloads.\n", O->M->name, O->name, RKServerMaximumFragments - 1);
+            va_end(arg);
+            return -1;
+        }
+        if (payloadSize > 0) {
+            iov[count].iov_base = payload;
+            iov[count].iov_len = payloadSize;
+            size += payloadSize;
+            count++;
+        }
+        payload = va_arg(arg, void *);
     }
-    
-    return grandTotalSentSize;
+
+    va_end(arg);
+
+    pthread_mutex_lock(&O->lock);
+
+    RKNetDelimiter header;
+    memcpy(&header, delimiter, sizeof(RKNetDelimiter));
+    header.subtype = 0;
+    header.size = (uint32_t)size;
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(RKNetDelimiter);
+
+    if (O->compression != RKNetworkCompressionNone && size >= RKNetworkCompressionThreshold) {
+        // Gathered payload, shuffle scratch, then the deflated block
+        const size_t capacity = 2 * size + RKRawDataBlockBound(size);
+        if (O->compressCapacity < capacity) {
+            free(O->compressBuffer);
+            O->compressBuffer = malloc(capacity);
+            O->compressCapacity = O->compressBuffer ? capacity : 0;
+        }
+        if (O->compressBuffer) {
+            uint8_t *gather = (uint8_t *)O->compressBuffer;
+            uint8_t *scratch = gather + size;
+            uint8_t *block = scratch + size;
+            uint8_t *p = gather;
+            for (int k = 1; k < count; k++) {
+                memcpy(p, iov[k].iov_base, iov[k].iov_len);
+                p += iov[k].iov_len;
+            }
+            const size_t blockSize = RKServerCompressPayload(block, scratch, gather, size, elementSize, O->compression);
+            if (blockSize > 0) {
+                header.subtype = RKNetDelimiterSubtypeDeflated | (elementSize & RKNetDelimiterSubtypeShuffleMask);
+                header.size = (uint32_t)blockSize;
+                header.decodedSize = (uint32_t)size;
+                iov[1].iov_base = block;
+                iov[1].iov_len = blockSize;
+                count = 2;
+                O->compressInputSize += size;
+                O->compressOutputSize += blockSize;
+            }
+        }
+    }
+
+    sentSize = RKOperatorSendVector(O, iov, count, sizeof(RKNetDelimiter) + header.size);
+
+    pthread_mutex_unlock(&O->lock);
+
+    return sentSize;
+}
+
+// Send a payload that has been compressed by RKServerCompressPayload(), e.g., one that is compressed once and sent to
+// many clients. The delimiter describes the original payload of size bytes, as in RKOperatorSendCompressiblePackets()
+
+ssize_t RKOperatorSendCompressedPacket(RKOperator *O, const uint8_t elementSize, RKNetDelimiter *delimiter,
+                                       const void *block, const size_t blockSize, const size_t size) {
+    ssize_t sentSize;
+    struct iovec iov[2];
+
+    pthread_mutex_lock(&O->lock);
+
+    RKNetDelimiter header;
+    memcpy(&header, delimiter, sizeof(RKNetDelimiter));
+    header.subtype = RKNetDelimiterSubtypeDeflated | (elementSize & RKNetDelimiterSubtypeShuffleMask);
+    header.size = (uint32_t)blockSize;
+    header.decodedSize = (uint32_t)size;
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(RKNetDelimiter);
+    iov[1].iov_base = (void *)block;
+    iov[1].iov_len = blockSize;
+    O->compressInputSize += size;
+    O->compressOutputSize += blockSize;
+
+    sentSize = RKOperatorSendVector(O, iov, 2, sizeof(RKNetDelimiter) + blockSize);
+
+    pthread_mutex_unlock(&O->lock);
+
+    return sentSize;
 }
 
 ssize_t RKOperatorSendString(RKOperator *O, const char *string) {
@@ -809,6 +1439,107 @@ void RKOperatorHangUp(RKOperator *O) {
     return;
 }
 
+// Packets sent from now on are kept in the queue up to RKServerSendQueueDepth / RKServerSendQueueCapacity when the
+// client falls behind. When the queue is full, RKOperatorSendPolicyDropOldest drops the oldest droppable packet, or
+// the new one, and hangs up the operator after RKServerMaximumDropStreak drops without progress.
+// RKOperatorSendPolicyBlock drops the droppable ones first, then keeps the packet over the limits and blocks the
+// operator. Nothing waits for the client, the stream handler is not called until the queue has drained to half
+void RKOperatorSetSendPolicy(RKOperator *O, const RKOperatorSendPolicy policy) {
+    pthread_mutex_lock(&O->lock);
+    O->sendPolicy = policy;
+    pthread_mutex_unlock(&O->lock);
+}
+
+void RKOperatorSetCompression(RKOperator *O, const RKNetworkCompression compression) {
+    pthread_mutex_lock(&O->lock);
+    O->compression = compression;
+    pthread_mutex_unlock(&O->lock);
+}
+
+// Whether the send queue is under half of its limits, a stream that is produced over several passes of the stream handler
+// only goes on while there is room, so that its packets never pile up over the limits
+bool RKOperatorHasRoom(RKOperator *O) {
+    bool room;
+    pthread_mutex_lock(&O->lock);
+    room = !O->blocked && O->queueCount < RKServerSendQueueDepth / 2 && O->queueSize < RKServerSendQueueCapacity / 2;
+    pthread_mutex_unlock(&O->lock);
+    return room;
+}
+
+// The next count payloads from the client are for the stream handler, which takes them through RKOperatorReceivePayload().
+// Commands that follow are held until then. A count of 0 gives up on the ones that have not come
+void RKOperatorExpectPayloads(RKOperator *O, const uint32_t count) {
+    pthread_mutex_lock(&O->rxLock);
+    O->payloadsExpected = count;
+    O->payloadOffset = 0;
+    if (count == 0 && O->state == RKOperatorStateActive && O->rxLength > 0 && !O->commandQueued) {
+        O->commandQueued = true;
+        RKServerPostCommands(O->M, O);
+    }
+    pthread_mutex_unlock(&O->rxLock);
+}
+
+// Receive a delimited payload without waiting, for the stream handler on the I/O worker. What has arrived is kept in
+// delimRx and buffer, the rest is picked up in the next call. Return the payload size once it is complete, or -1 with
+// errno set to EAGAIN if more is to come, like a non-blocking read(). Any other error hangs up the operator since the
+// framing is lost
+ssize_t RKOperatorReceivePayload(RKOperator *O, void *buffer, const size_t capacity) {
+    ssize_t r;
+    size_t k;
+    RKNetDelimiter *delimiter = &O->delimRx;
+
+    while (O->payloadOffset < sizeof(RKNetDelimiter) ||
+           (delimiter->size <= capacity && O->payloadOffset < sizeof(RKNetDelimiter) + delimiter->size)) {
+        if (O->payloadOffset < sizeof(RKNetDelimiter)) {
+            r = RKOperatorRead(O, (uint8_t *)delimiter + O->payloadOffset, sizeof(RKNetDelimiter) - O->payloadOffset);
+        } else {
+            k = O->payloadOffset - sizeof(RKNetDelimiter);
+            r = RKOperatorRead(O, (uint8_t *)buffer + k, delimiter->size - k);
+        }
+        if (r > 0) {
+            O->payloadOffset += r;
+        } else if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            errno = EAGAIN;
+            return -1;
+        } else {
+            RKLog("%s %s Error. Client disconnected while sending a payload.\n", O->M->name, O->name);
+            O->state = RKOperatorStateClosing;
+            errno = ECONNRESET;
+            return -1;
+        }
+    }
+    if (delimiter->size > capacity) {
+        RKLog("%s %s Error. Payload size = %s (type %d) is more than what I can handle.\n", O->M->name, O->name,
+              RKIntegerToCommaStyleString(delimiter->size), delimiter->type);
+        O->state = RKOperatorStateClosing;
+        errno = EMSGSIZE;
+        return -1;
+    }
+    k = delimiter->size;
+    if (k < capacity) {
+        *((char *)buffer + k) = '\0';
+    }
+    pthread_mutex_lock(&O->rxLock);
+    O->payloadOffset = 0;
+    if (O->payloadsExpected > 0 && --O->payloadsExpected == 0 && O->rxLength > 0 && !O->commandQueued) {
+        O->commandQueued = true;
+        RKServerPostCommands(O->M, O);
+    }
+    pthread_mutex_unlock(&O->rxLock);
+    return k;
+}
+
+// Byte shuffle and deflate a payload at the level of a compression, the block must hold RKRawDataBlockBound(size) and
+// the scratch size bytes. Return the block size, or 0 if the payload should go out as it is
+size_t RKServerCompressPayload(void *block, void *scratch, const void *payload, const size_t size, const uint8_t elementSize, const RKNetworkCompression compression) {
+    if (compression == RKNetworkCompressionNone || size < RKNetworkCompressionThreshold) {
+        return 0;
+    }
+    const int level = compression == RKNetworkCompressionFast ? Z_BEST_SPEED : Z_DEFAULT_COMPRESSION;
+    const size_t blockSize = RKRawDataBlockEncode(block, RKRawDataBlockBound(size), payload, size, RKRawDataBlockFilterShuffle, elementSize, scratch, level);
+    return blockSize < size ? blockSize : 0;
+}
+
 ssize_t RKServerReadCustomPayload(RKOperator *O, void *payload) {
     fd_set          rfd;
     fd_set          efd;
@@ -62,12 +62,225 @@ static void *rayReleaser(void *in) {
     // Set them free
     for (i = 0; i < engine->scratchSpaces[scratchSpaceIndex].rayCount; i++) {
         ray = engine->scratchSpaces[scratchSpaceIndex].rays[i];
+        // Rays that the products refer to in place are let go when the next sweep replaces them or when they are evicted
+        if (ray->header.s & RKRayStatusBeingConsumed) {
+            continue;
+        }
         ray->header.s = RKRayStatusVacant;
     }
 
     return NULL;
 }
 
+// The products no longer refer to the rays, the ray buffer slots can be reused. Call with productMutex held and release
+// the returned sweep, which is the reference that the pin has held, after the lock is let go
+static RKSweep *RKSweepEngineUnpinRays(RKSweepEngine *engine) {
+    int j;
+    RKSweep *sweep = engine->pinnedSweep;
+    if (sweep == NULL) {
+        return NULL;
+    }
+    for (j = 0; j < sweep->header.rayCount; j++) {
+        sweep->rays[j]->header.s &= ~RKRayStatusBeingConsumed;
+    }
+    engine->pinnedSweep = NULL;
+    return sweep;
+}
+
+// Products that refer to the rays in place are read through RKProductGetRayData(), only the built-in writers do that
+static bool RKSweepEngineProductRecorderReadsViews(RKSweepEngine *engine) {
+    return engine->productRecorder == &RKProductFileWriterNC ||
+           engine->productRecorder == &RKProductFileWriterNCInt16 ||
+           engine->productRecorder == &RKProductFileWriterNCUInt8;
+}
+
+static bool RKSweepEngineSweepRecorderReadsViews(RKSweepEngine *engine) {
+    return engine->sweepRecorder == &RKSweepFileWriterNC;
+}
+
+// A writer that reads the rays in place is counted, the rays are not let go until it is done
+static void RKSweepEngineBeginViewRead(RKSweepEngine *engine) {
+    pthread_mutex_lock(&engine->productMutex);
+    engine->viewReaderCount++;
+    pthread_mutex_unlock(&engine->productMutex);
+}
+
+static void RKSweepEngineEndViewRead(RKSweepEngine *engine) {
+    pthread_mutex_lock(&engine->productMutex);
+    if (--engine->viewReaderCount == 0) {
+        pthread_cond_broadcast(&engine->viewReadersDone);
+    }
+    pthread_mutex_unlock(&engine->productMutex);
+}
+
+// Give a product its own copy for a recorder that only reads the data, the rays are let go once no product refers to them
+static void RKSweepEngineDetachView(RKSweepEngine *engine, RKProduct *product) {
+    int p;
+    RKSweep *sweep = NULL;
+    pthread_mutex_lock(&engine->productMutex);
+    RKProductDetachView(product);
+    for (p = 0; p < engine->radarDescription->productBufferDepth; p++) {
+        if (engine->productBuffer[p].flag & RKProductStatusView) {
+            break;
+        }
+    }
+    if (p == engine->radarDescription->productBufferDepth && engine->viewReaderCount == 0) {
+        sweep = RKSweepEngineUnpinRays(engine);
+    }
+    pthread_mutex_unlock(&engine->productMutex);
+    if (sweep) {
+        RKSweepEngineReleaseSweep(engine, sweep);
+    }
+}
+
+// Copy all the products that still refer to the rays in place and let go of the rays, only when the moment engine needs
+// the ray buffer slots back or the engine stops. Writers that are reading the rays in place are let finish first
+static void RKSweepEngineDetachViews(RKSweepEngine *engine) {
+    int p;
+    RKSweep *sweep;
+    pthread_mutex_lock(&engine->productMutex);
+    while (engine->viewReaderCount) {
+        pthread_cond_wait(&engine->viewReadersDone, &engine->productMutex);
+    }
+    for (p = 0; p < engine->radarDescription->productBufferDepth; p++) {
+        RKProductDetachView(&engine->productBuffer[p]);
+    }
+    sweep = RKSweepEngineUnpinRays(engine);
+    pthread_mutex_unlock(&engine->productMutex);
+    if (sweep) {
+        RKSweepEngineReleaseSweep(engine, sweep);
+    }
+}
+
+// Give a collected sweep its own copy of the rays so that it outlives the ray buffer slots, e.g., in the volume cache
+static int RKSweepEngineCopyRays(RKSweepEngine *engine, RKSweep *sweep) {
+    int j, m;
+    RKRay *S, *T;
+    RKBuffer rayBuffer;
+    const uint32_t alignment = RKSIMDAlignSize / sizeof(RKFloat);
+    const uint32_t capacity = (uint32_t)ceilf((float)sweep->header.gateCount / alignment) * alignment;
+
+    if (RKRayBufferAlloc(&rayBuffer, capacity, sweep->header.rayCount) == 0) {
+        RKLog("%s Error. Unable to allocate %d rays of %d gates.\n", engine->name, sweep->header.rayCount, capacity);
+        return RKResultFailedToAllocateBuffer;
+    }
+    for (j = 0; j < sweep->header.rayCount; j++) {
+        S = sweep->rays[j];
+        T = RKGetRayFromBuffer(rayBuffer, j);
+        memcpy(&T->header, &S->header, sizeof(RKRayHeader));
+        T->header.capacity = capacity;
+        T->header.gateCount = MIN(S->header.gateCount, capacity);
+        for (m = 0; m < RKBaseMomentCount; m++) {
+            if (!(S->header.baseMomentList & (RKBaseMomentListProductZ << m))) {
+                continue;
+            }
+            memcpy(RKGetFloatDataFromRay(T, m), RKGetFloatDataFromRay(S, m), T->header.gateCount * sizeof(float));
+            memcpy(RKGetUInt8DataFromRay(T, m), RKGetUInt8DataFromRay(S, m), T->header.gateCount * sizeof(uint8_t));
+        }
+        sweep->rays[j] = T;
+    }
+    sweep->rayBuffer = rayBuffer;
+    sweep->header.external = false;
+    return RKResultSuccess;
+}
+
+// Sweep references of the volume cache go through the same lock as the other holders
+static void RKSweepEngineRetainVolumeSweep(void *in, RKSweep *sweep) {
+    RKSweepEngine *engine = (RKSweepEngine *)in;
+    pthread_mutex_lock(&engine->sweepMutex);
+    sweep->referenceCount++;
+    pthread_mutex_unlock(&engine->sweepMutex);
+}
+
+static void RKSweepEngineReleaseVolumeSweep(void *in, RKSweep *sweep) {
+    RKSweepEngineReleaseSweep((RKSweepEngine *)in, sweep);
+}
+
+// Drop the reference held by a scratch space before it is refilled, the sweep lives on until its last holder releases it
+static void RKSweepEngineRetireSweep(RKSweepEngine *engine, const uint8_t scratchSpaceIndex) {
+    pthread_mutex_lock(&engine->sweepMutex);
+    RKSweep *sweep = engine->scratchSpaces[scratchSpaceIndex].sweep;
+    engine->scratchSpaces[scratchSpaceIndex].sweep = NULL;
+    pthread_mutex_unlock(&engine->sweepMutex);
+    if (sweep) {
+        RKSweepEngineReleaseSweep(engine, sweep);
+    }
+}
+
+// Conclude the written products. If wait is true, also wait for all the queued products
+static void RKSweepEngineProductCollect(RKSweepEngine *engine, const bool wait) {
+    int k, result;
+    RKSweepProductJob *job;
+    char filename[RKMaximumPathLength];
+
+    pthread_mutex_lock(&engine->productJobMutex);
+    while (engine->productJobPendingCount) {
+        job = NULL;
+        for (k = 0; k < RKSweepEngineProductJobSlotCount; k++) {
+            if (engine->productJobs[k].state == RKSweepProductJobStateWritten) {
+                job = &engine->productJobs[k];
+                break;
+            }
+        }
+        if (job == NULL) {
+            if (!wait) {
+                break;
+            }
+            pthread_cond_wait(&engine->productJobWritten, &engine->productJobMutex);
+            continue;
+        }
+        strcpy(filename, job->filename);
+        result = job->result;
+        job->product = NULL;
+        job->state = RKSweepProductJobStateVacant;
+        engine->productJobPendingCount--;
+        pthread_mutex_unlock(&engine->productJobMutex);
+
+        if (result != RKResultSuccess) {
+            RKLog("%s Error creating %s\n", engine->name, filename);
+        }
+        // Notify file manager of a new addition if the file handling script does not remove them
+        if (!(engine->fileHandlingScriptProperties & RKScriptPropertyRemoveNCFiles)) {
+            RKFileManagerAddFile(engine->fileManager, filename, RKFileTypeMoment);
+        }
+
+        pthread_mutex_lock(&engine->productJobMutex);
+    }
+    pthread_mutex_unlock(&engine->productJobMutex);
+}
+
+// Hand a product to the writers, wait for a vacant slot if the queue is full
+static void RKSweepEngineProductQueue(RKSweepEngine *engine, RKProduct *product, const char *filename) {
+    int k;
+    bool written;
+    RKSweepProductJob *job;
+
+    while (true) {
+        pthread_mutex_lock(&engine->productJobMutex);
+        written = false;
+        for (k = 0; k < RKSweepEngineProductJobSlotCount; k++) {
+            job = &engine->productJobs[k];
+            if (job->state == RKSweepProductJobStateVacant) {
+                job->product = product;
+                strncpy(job->filename, filename, RKMaximumPathLength - 1);
+                job->result = RKResultSuccess;
+                job->state = RKSweepProductJobStateQueued;
+                engine->productJobPendingCount++;
+                pthread_cond_signal(&engine->productJobQueued);
+                pthread_mutex_unlock(&engine->productJobMutex);
+                return;
+            }
+            written |= job->state == RKSweepProductJobStateWritten;
+        }
+        // Writers have fallen behind, wait for one of them
+        if (!written) {
+            pthread_cond_wait(&engine->productJobWritten, &engine->productJobMutex);
+        }
+        pthread_mutex_unlock(&engine->productJobMutex);
+        RKSweepEngineProductCollect(engine, false);
+    }
+}
+
 static void *sweepManager(void *in) {
     RKSweepEngine *engine = (RKSweepEngine *)in;
 
@@ -79,12 +292,17 @@ static void *sweepManager(void *in) {
     // Notify the thread creator that I have grabbed the parameter
     engine->tic++;
 
+    // The sweep file stream that has received the rays, if any
+    RKSweepFileStream *stream = engine->scratchSpaces[scratchSpaceIndex].stream;
+    engine->scratchSpaces[scratchSpaceIndex].stream = NULL;
+
     // Collect rays that belong to a sweep to a scratch space
-    RKSweep *sweep = RKSweepCollect(engine, scratchSpaceIndex);
+    RKSweep *sweep = RKSweepEngineAcquireSweep(engine, scratchSpaceIndex);
     if (sweep == NULL) {
         if (engine->verbose > 1) {
             RKLog("%s Empty sweep   scratchSpaceIndex = %d\n", scratchSpaceIndex);
         }
+        RKSweepFileStreamDiscard(stream);
         return NULL;
     }
     if (engine->verbose) {
@@ -104,18 +322,40 @@ static void *sweepManager(void *in) {
               1.0e-3f * S->header.gateCount * S->header.gateSizeMeters);
     }
 
-    // Mark the rays being used by user algorithms
+    int productCount = __builtin_popcount(sweep->header.baseMomentList & engine->baseMomentList);
+
+    // Base products of the previous sweep stay in place until they are replaced by the ones of this sweep, those that
+    // are not replaced are copied out. Then mark the rays that the base products refer to, see RKSweepEngineEvictRay()
+    pthread_mutex_lock(&engine->sweepMutex);
+    sweep->referenceCount++;
+    pthread_mutex_unlock(&engine->sweepMutex);
+    pthread_mutex_lock(&engine->productMutex);
+    for (i = 0; i < engine->radarDescription->productBufferDepth; i++) {
+        if (!(engine->productBuffer[i].flag & RKProductStatusView)) {
+            continue;
+        }
+        for (p = 0; p < productCount && engine->baseMomentProductIds[p] != engine->productBuffer[i].pid; p++) {}
+        if (p == productCount) {
+            RKProductDetachView(&engine->productBuffer[i]);
+        }
+    }
+    RKSweep *previousSweep = engine->pinnedSweep;
     for (j = 0; j < sweep->header.rayCount; j++) {
         sweep->rays[j]->header.s |= RKRayStatusBeingConsumed;
     }
+    engine->pinnedSweep = sweep;
+    pthread_mutex_unlock(&engine->productMutex);
+
+    // The volume cache keeps a reference, the rays have been copied out of the ray buffer, see RKSweepEngineAcquireSweep()
+    if (engine->volumeEngine && !sweep->header.external) {
+        RKVolumeEngineAddSweep(engine->volumeEngine, sweep);
+    }
 
     // Localize the scratch space storage
     char *filename = engine->scratchSpaces[scratchSpaceIndex].filename;
     char *filelist = engine->scratchSpaces[scratchSpaceIndex].filelist;
     char *summary = engine->scratchSpaces[scratchSpaceIndex].summary;
 
-    int productCount = __builtin_popcount(sweep->header.baseMomentList & engine->baseMomentList);
-
     // Base products
     for (p = 0; p < productCount; p++) {
         if (engine->baseMomentProductIds[p]) {
@@ -124,13 +364,33 @@ static void *sweepManager(void *in) {
                 RKLog("Error. Unable to get a product slot   p = %d   pid = %d.\n", p, engine->baseMomentProductIds[p]);
                 continue;
             }
-            RKProductInitFromSweep(product, sweep);
+            // Base moments refer to the rays in place, except the ones that will be converted to degrees or the ones
+            // of rays that have been evicted already
+            pthread_mutex_lock(&engine->productMutex);
+            if (engine->pinnedSweep != sweep || (engine->convertToDegrees && !strcasecmp(product->desc.unit, "radians"))) {
+                RKProductInitFromSweep(product, sweep);
+            } else {
+                RKProductInitViewFromSweep(product, sweep);
+            }
+            pthread_mutex_unlock(&engine->productMutex);
             RKSweepEngineSetProductComplete(engine, sweep, product);
         }
     }
 
+    // No product refers to the rays of the previous sweep now
+    if (previousSweep) {
+        pthread_mutex_lock(&engine->productMutex);
+        for (j = 0; j < previousSweep->header.rayCount; j++) {
+            previousSweep->rays[j]->header.s &= ~RKRayStatusBeingConsumed;
+        }
+        pthread_mutex_unlock(&engine->productMutex);
+        RKSweepEngineReleaseSweep(engine, previousSweep);
+    }
+
     if (engine->productBuffer == NULL) {
         RKLog("%s Unexpected NULL memory.\n", engine->name);
+        RKSweepEngineReleaseSweep(engine, sweep);
+        RKSweepFileStreamDiscard(stream);
         return NULL;
     }
 
@@ -164,6 +424,8 @@ static void *sweepManager(void *in) {
         }
     }
     if (!(engine->state & RKEngineStateWantActive)) {
+        RKSweepEngineReleaseSweep(engine, sweep);
+        RKSweepFileStreamDiscard(stream);
         return NULL;
     }
 
@@ -190,6 +452,10 @@ static void *sweepManager(void *in) {
     int summarySize = 0;
     bool filenameTooLong;
 
+    // Products that go into one sweep file
+    RKProduct *sweepProducts[RKMaximumProductCount];
+    uint32_t sweepProductCount = 0;
+
     // Product recording
     for (p = 0; p < engine->radarDescription->productBufferDepth; p++) {
         if (engine->productBuffer[p].flag == RKProductStatusVacant) {
@@ -206,15 +472,21 @@ static void *sweepManager(void *in) {
                   engine->name,
                   RKVariableInString("rayCount", &product->header.rayCount, RKValueTypeUInt32),
                   RKVariableInString("gateCount", &product->header.gateCount, RKValueTypeUInt32));
-            RKShowArray(product->data, product->desc.symbol, product->header.gateCount, product->header.rayCount);
+            if (!(product->flag & RKProductStatusView)) {
+                RKShowArray(product->data, product->desc.symbol, product->header.gateCount, product->header.rayCount);
+            }
+        }
+        // Full filename with symbol and extension, or without symbol if all products go into one sweep file
+        if (engine->sweepRecorder) {
+            sprintf(product->header.suggestedFilename, "%s.%s", sweep->header.filename, engine->productFileExtension);
+        } else {
+            sprintf(product->header.suggestedFilename, "%s-%s.%s", sweep->header.filename, product->desc.symbol, engine->productFileExtension);
         }
-        // Full filename with symbol and extension
-        sprintf(product->header.suggestedFilename, "%s-%s.%s", sweep->header.filename, product->desc.symbol, engine->productFileExtension);
         strncpy(filename, product->header.suggestedFilename, RKMaximumPathLength - 80);
         filenameTooLong = strlen(sweep->header.filename) > 48;
 
         // Keep concatenating the filename into filelist
-        if (engine->hasFileHandlingScript) {
+        if (engine->hasFileHandlingScript && (engine->sweepRecorder == NULL || sweepProductCount == 0)) {
             sprintf(filelist + strlen(filelist), " %s", filename);
         }
 
@@ -227,29 +499,32 @@ static void *sweepManager(void *in) {
                  *x = *x * radiansToDegrees;
                  x++;
              }
+             product->desc.mininimumValue *= radiansToDegrees;
+             product->desc.maximumValue *= radiansToDegrees;
              sprintf(product->desc.unit, "Degrees");
          }
 
-        // Call a product writer only if the engine is set to record and the is a valid product recorder
-        if (engine->record && engine->productRecorder) {
-            if (engine->verbose > 1) {
-                RKLog("%s Creating %s ...\n", engine->name, filename);
+        // Queue the product for the writers only if the engine is set to record and the is a valid product recorder
+        if (engine->record && engine->sweepRecorder) {
+            if (sweepProductCount < RKMaximumProductCount) {
+                sweepProducts[sweepProductCount++] = product;
             }
+        } else if (engine->record && engine->productRecorder) {
             RKPreparePath(filename);
-            i = engine->productRecorder(product, filename);
-            if (i != RKResultSuccess) {
-                RKLog("%s Error creating %s\n", engine->name, filename);
-            }
-            // Notify file manager of a new addition if the file handling script does not remove them
-            if (!(engine->fileHandlingScriptProperties & RKScriptPropertyRemoveNCFiles)) {
-                RKFileManagerAddFile(engine->fileManager, filename, RKFileTypeMoment);
-            }
+            RKSweepEngineProductQueue(engine, product, filename);
         } else if (engine->verbose > 1) {
             RKLog("%s Skipping %s ...\n", engine->name, filename);
         }
         
         // Make a summary for logging
-        if (p == 0) {
+        if (p == 0 && engine->sweepRecorder) {
+            // There are at least two '/'s in the filename: ...rootDataFolder/moment/YYYYMMDD/RK-YYYYMMDD-HHMMSS-Enn.n.nc
+            summarySize = sprintf(summary, rkGlobalParameters.showColor ? RKGreenColor "%s" RKNoColor " %s%s.%s   " RKYellowColor "%s" RKNoColor : "%s %s%s.%s   %s",
+                                  engine->record ? "Recorded": "Skipped",
+                                  filenameTooLong ? "..." : "",
+                                  filenameTooLong ? RKLastTwoPartsOfPath(sweep->header.filename) : sweep->header.filename,
+                                  engine->productFileExtension, product->desc.symbol);
+        } else if (p == 0) {
             // There are at least two '/'s in the filename: ...rootDataFolder/moment/YYYYMMDD/RK-YYYYMMDD-HHMMSS-Enn.n-Z.nc
             summarySize = sprintf(summary, rkGlobalParameters.showColor ? RKGreenColor "%s" RKNoColor " %s%s-" RKYellowColor "%s" RKNoColor ".%s" : "%s %s%s-%s.%s",
                                   engine->record ? "Recorded": "Skipped",
@@ -261,11 +536,55 @@ static void *sweepManager(void *in) {
         }
     }
 
+    // The streamed rays can only be concluded if they are exactly the rays of this sweep
+    if (stream && (sweepProductCount == 0 ||
+                   stream->rayCount != sweep->header.rayCount ||
+                   stream->gateCount != sweep->header.gateCount ||
+                   stream->isPPI != sweep->header.isPPI ||
+                   stream->firstRayIdentifier != sweep->rays[0]->header.i)) {
+        if (engine->verbose > 1) {
+            RKLog("%s Streamed %d rays do not match the sweep of %d rays.\n", engine->name, stream->rayCount, sweep->header.rayCount);
+        }
+        RKSweepFileStreamDiscard(stream);
+        stream = NULL;
+    }
+
+    // All products in one sweep file
+    if (sweepProductCount) {
+        if (engine->verbose > 1) {
+            RKLog("%s %s %s ...\n", engine->name, stream ? "Concluding" : "Creating", filename);
+        }
+        RKPreparePath(filename);
+        if (stream || RKSweepEngineSweepRecorderReadsViews(engine)) {
+            RKSweepEngineBeginViewRead(engine);
+            if (stream) {
+                i = RKSweepFileStreamFinish(stream, sweepProducts, sweepProductCount, filename);
+            } else {
+                i = engine->sweepRecorder(sweepProducts, sweepProductCount, filename);
+            }
+            RKSweepEngineEndViewRead(engine);
+        } else {
+            for (p = 0; p < sweepProductCount; p++) {
+                RKSweepEngineDetachView(engine, sweepProducts[p]);
+            }
+            i = engine->sweepRecorder(sweepProducts, sweepProductCount, filename);
+        }
+        if (i != RKResultSuccess) {
+            RKLog("%s Error creating %s\n", engine->name, filename);
+        }
+        if (!(engine->fileHandlingScriptProperties & RKScriptPropertyRemoveNCFiles)) {
+            RKFileManagerAddFile(engine->fileManager, filename, RKFileTypeMoment);
+        }
+    }
+
+    // Wait for the writers to finish all the products of this sweep, the products keep referring to the rays in place
+    RKSweepEngineProductCollect(engine, true);
+
     // Unmark the state
     engine->state ^= RKEngineStateWritingFile;
 
     // We are done with the sweep
-    RKSweepFree(sweep);
+    RKSweepEngineReleaseSweep(engine, sweep);
 
     // Show a summary of all the files created
     if (engine->verbose && summarySize > 0) {
@@ -280,7 +599,7 @@ static void *sweepManager(void *in) {
             RKLog("Error. Failed using system() -> %d   errno = %d\n", j, errno);
         }
         // Potential filenames that may be generated by the custom command. Need to notify file manager about them.
-        RKReplaceFileExtension(filename, strrchr(filename, '-'), ".__");
+        RKReplaceFileExtension(filename, strrchr(filename, engine->sweepRecorder ? '.' : '-'), ".__");
         if (engine->fileHandlingScriptProperties & RKScriptPropertyProduceArchive) {
             if (engine->fileHandlingScriptProperties & RKScriptPropertyProduceTarXz) {
                 RKReplaceFileExtension(filename, "__", "tar.xz");
@@ -291,16 +610,108 @@ static void *sweepManager(void *in) {
             }
             RKLog("%s %s", engine->name, filename);
             if (RKFilenameExists(filename)) {
+                RKFileDropCacheOfFilename(filename);
                 RKFileManagerAddFile(engine->fileManager, filename, RKFileTypeMoment);
             }
         }
     }
 
+    // Product files are not read again soon, let them go from the page cache, which also starts their write-back
+    if (engine->record && (engine->productRecorder || engine->sweepRecorder)) {
+        for (p = 0; p < engine->radarDescription->productBufferDepth; p++) {
+            if (engine->productBuffer[p].flag != RKProductStatusVacant) {
+                RKFileDropCacheOfFilename(engine->productBuffer[p].header.suggestedFilename);
+            }
+        }
+    }
+
     return NULL;
 }
 
 #pragma mark - Delegate Workers
 
+static void *productWriter(void *in) {
+    RKSweepEngine *engine = (RKSweepEngine *)in;
+
+    int k;
+    RKSweepProductJob *job;
+
+    pthread_mutex_lock(&engine->productJobMutex);
+    while (engine->productWritersActive) {
+        job = NULL;
+        for (k = 0; k < RKSweepEngineProductJobSlotCount; k++) {
+            if (engine->productJobs[k].state == RKSweepProductJobStateQueued) {
+                job = &engine->productJobs[k];
+                break;
+            }
+        }
+        if (job == NULL) {
+            pthread_cond_wait(&engine->productJobQueued, &engine->productJobMutex);
+            continue;
+        }
+        job->state = RKSweepProductJobStateWriting;
+        pthread_mutex_unlock(&engine->productJobMutex);
+
+        if (engine->verbose > 1) {
+            RKLog("%s Creating %s ...\n", engine->name, job->filename);
+        }
+        if (RKSweepEngineProductRecorderReadsViews(engine)) {
+            RKSweepEngineBeginViewRead(engine);
+            k = engine->productRecorder(job->product, job->filename);
+            RKSweepEngineEndViewRead(engine);
+        } else {
+            RKSweepEngineDetachView(engine, job->product);
+            k = engine->productRecorder(job->product, job->filename);
+        }
+
+        pthread_mutex_lock(&engine->productJobMutex);
+        job->result = k;
+        job->state = RKSweepProductJobStateWritten;
+        pthread_cond_broadcast(&engine->productJobWritten);
+    }
+    pthread_mutex_unlock(&engine->productJobMutex);
+    return NULL;
+}
+
+// Feed a ray to the sweep file stream, which begins at a sweep begin marker or the ray after a sweep end marker
+static void RKSweepEngineStreamRay(RKSweepEngine *engine, RKRay *ray) {
+    int p;
+    char filename[RKMaximumPathLength];
+    RKProductDesc descs[RKBaseMomentIndexCount];
+
+    // A sweep begins here, a stream that has not seen the end of its sweep is abandoned
+    if (ray->header.marker & RKMarkerSweepBegin) {
+        if (engine->sweepStream) {
+            if (engine->verbose > 1) {
+                RKLog("%s Abandoning an incomplete sweep stream of %d rays.\n", engine->name, engine->sweepStream->rayCount);
+            }
+            RKSweepFileStreamDiscard(engine->sweepStream);
+            engine->sweepStream = NULL;
+        }
+        engine->sweepStreamArmed = true;
+    }
+    if (engine->sweepStream == NULL && engine->sweepStreamArmed) {
+        engine->sweepStreamArmed = false;
+        RKBaseMomentList momentList = engine->baseMomentList;
+        const int productCount = MIN(RKBaseMomentIndexCount, __builtin_popcount(momentList));
+        for (p = 0; p < productCount; p++) {
+            descs[p] = RKGetNextProductDescription(&momentList);
+        }
+        RKConfig *config = &engine->configBuffer[ray->header.configIndex];
+        sprintf(filename, "%s%s%s/.%s-stream-%u.%s",
+                engine->radarDescription->dataPath, engine->radarDescription->dataPath[0] == '\0' ? "" : "/", RKDataFolderMoment,
+                engine->radarDescription->filePrefix, engine->sweepStreamCount++, engine->productFileExtension);
+        RKPreparePath(filename);
+        engine->sweepStream = RKSweepFileStreamOpen(filename, descs, productCount, ray->header.gateCount,
+                                                    (config->startMarker & RKMarkerScanTypeMask) == RKMarkerScanTypePPI,
+                                                    (config->startMarker & RKMarkerScanTypeMask) == RKMarkerScanTypeRHI,
+                                                    engine->convertToDegrees);
+    }
+    if (engine->sweepStream) {
+        RKSweepFileStreamAppendRay(engine->sweepStream, ray);
+    }
+}
+
 static void *rayGatherer(void *in) {
     RKSweepEngine *engine = (RKSweepEngine *)in;
     
@@ -321,6 +732,14 @@ static void *rayGatherer(void *in) {
     engine->state |= RKEngineStateWantActive;
     engine->state ^= RKEngineStateActivating;
 
+    // Product writers, each builds its file in memory through the NetCDF lock and writes it to the disk on its own
+    engine->productWritersActive = true;
+    for (p = 0; p < engine->productWriterCount; p++) {
+        if (pthread_create(&engine->tidProductWriters[p], NULL, productWriter, engine) != 0) {
+            RKLog("%s Error. Failed to start a product writer.\n", engine->name);
+        }
+    }
+
     RKBaseMomentList momentList = engine->baseMomentList;
     const int productCount = __builtin_popcount(momentList);
     for (p = 0; p < productCount; p++) {
@@ -384,6 +803,11 @@ static void *rayGatherer(void *in) {
         // Lag of the engine
         engine->lag = fmodf(((float)*engine->rayIndex + engine->radarDescription->rayBufferDepth - j) / engine->radarDescription->rayBufferDepth, 1.0f);
 
+        // Rays go into the sweep file as they arrive so that the file is almost complete at the end of the sweep
+        if (engine->streamSweep && engine->record && engine->sweepRecorder) {
+            RKSweepEngineStreamRay(engine, ray);
+        }
+
         // A sweep is complete
         if (ray->header.marker & RKMarkerSweepEnd) {
             // Gather the rays
@@ -402,6 +826,14 @@ static void *rayGatherer(void *in) {
                 RKLog("%s Info. RKMarkerSweepEnd   is = %d   j = %d   n = %d\n", engine->name, is, j, n);
             }
 
+            // The stream, if any, goes with the rays to the sweepManager
+            if (engine->scratchSpaces[engine->scratchSpaceIndex].stream) {
+                RKSweepFileStreamDiscard(engine->scratchSpaces[engine->scratchSpaceIndex].stream);
+            }
+            engine->scratchSpaces[engine->scratchSpaceIndex].stream = engine->sweepStream;
+            engine->sweepStream = NULL;
+            engine->sweepStreamArmed = true;
+
             // If the sweepManager is still going, wait for it to finish, launch a new one, wait for engine->rayAnchorsIndex is grabbed through engine->tic
             if (tidSweepManager) {
                 pthread_join(tidSweepManager, NULL);
@@ -428,6 +860,7 @@ static void *rayGatherer(void *in) {
 
             // Ready for next collection while the sweepManager is busy
             engine->scratchSpaceIndex = RKNextModuloS(engine->scratchSpaceIndex, RKSweepScratchSpaceDepth);
+            RKSweepEngineRetireSweep(engine, engine->scratchSpaceIndex);
             if (engine->verbose > 1) {
                 RKLog("%s Info. RKMarkerSweepEnd   scratchSpaceIndex -> %d.\n", engine->name, engine->scratchSpaceIndex);
             }
@@ -462,6 +895,7 @@ static void *rayGatherer(void *in) {
 
                 // Ready for next collection while the sweepManager is busy
                 engine->scratchSpaceIndex = RKNextModuloS(engine->scratchSpaceIndex, RKSweepScratchSpaceDepth);
+                RKSweepEngineRetireSweep(engine, engine->scratchSpaceIndex);
                 if (engine->verbose > 1) {
                     RKLog("%s RKMarkerSweepBegin   scratchSpaceIndex -> %d.\n", engine->name, engine->scratchSpaceIndex);
                 }
@@ -489,6 +923,23 @@ static void *rayGatherer(void *in) {
         pthread_join(tidSweepManager, NULL);
         tidSweepManager = (pthread_t)0;
     }
+    if (engine->sweepStream) {
+        RKSweepFileStreamDiscard(engine->sweepStream);
+        engine->sweepStream = NULL;
+    }
+    // Retire the product writers
+    pthread_mutex_lock(&engine->productJobMutex);
+    engine->productWritersActive = false;
+    pthread_cond_broadcast(&engine->productJobQueued);
+    pthread_mutex_unlock(&engine->productJobMutex);
+    for (p = 0; p < engine->productWriterCount; p++) {
+        if (engine->tidProductWriters[p]) {
+            pthread_join(engine->tidProductWriters[p], NULL);
+            engine->tidProductWriters[p] = (pthread_t)0;
+        }
+    }
+    // Nothing reads the products any more, let go of the rays
+    RKSweepEngineDetachViews(engine);
     for (p = 0; p < productCount; p++) {
         RKSweepEngineUnregisterProduct(engine, engine->baseMomentProductIds[p]);
     }
@@ -496,6 +947,15 @@ static void *rayGatherer(void *in) {
     return NULL;
 }
 
+// Called by the moment engine when the products have not let go of a ray in time
+void RKSweepEngineEvictRay(void *in, RKRay *ray) {
+    RKSweepEngine *engine = (RKSweepEngine *)in;
+    if (engine->verbose) {
+        RKLog("%s Warning. Products still refer to ray %lu, copying them out.\n", engine->name, ray->header.i);
+    }
+    RKSweepEngineDetachViews(engine);
+}
+
 #pragma mark - Life Cycle
 
 RKSweepEngine *RKSweepEngineInit(void) {
@@ -514,15 +974,30 @@ RKSweepEngine *RKSweepEngineInit(void) {
     engine->productTimeoutSeconds = 5;
     engine->baseMomentList = RKBaseMomentListProductZVWDPR;
     engine->productRecorder = &RKProductFileWriterNC;
+    engine->productWriterCount = RKSweepEngineDefaultProductWriterCount;
+    pthread_mutex_init(&engine->sweepMutex, NULL);
     pthread_mutex_init(&engine->productMutex, NULL);
+    pthread_cond_init(&engine->viewReadersDone, NULL);
+    pthread_mutex_init(&engine->productJobMutex, NULL);
+    pthread_cond_init(&engine->productJobQueued, NULL);
+    pthread_cond_init(&engine->productJobWritten, NULL);
     return engine;
 }
 
 void RKSweepEngineFree(RKSweepEngine *engine) {
+    int k;
     if (engine->state & RKEngineStateWantActive) {
         RKSweepEngineStop(engine);
     }
+    for (k = 0; k < RKSweepScratchSpaceDepth; k++) {
+        RKSweepEngineRetireSweep(engine, k);
+    }
+    pthread_mutex_destroy(&engine->sweepMutex);
     pthread_mutex_destroy(&engine->productMutex);
+    pthread_cond_destroy(&engine->viewReadersDone);
+    pthread_cond_destroy(&engine->productJobQueued);
+    pthread_cond_destroy(&engine->productJobWritten);
+    pthread_mutex_destroy(&engine->productJobMutex);
     free(engine);
 }
 
@@ -565,6 +1040,29 @@ void RKSweepEngineSetProductRecorder(RKSweepEngine *engine, int (*routine)(RKPro
     engine->productRecorder = routine;
 }
 
+void RKSweepEngineSetSweepRecorder(RKSweepEngine *engine, int (*routine)(RKProduct **, const uint32_t, const char *)) {
+    engine->sweepRecorder = routine;
+}
+
+void RKSweepEngineSetSweepStreaming(RKSweepEngine *engine, const bool value) {
+    engine->streamSweep = value;
+}
+
+void RKSweepEngineSetVolumeEngine(RKSweepEngine *engine, RKVolumeEngine *volumeEngine) {
+    engine->volumeEngine = volumeEngine;
+    if (volumeEngine) {
+        RKVolumeEngineSetSweepOwner(volumeEngine, engine, &RKSweepEngineRetainVolumeSweep, &RKSweepEngineReleaseVolumeSweep);
+    }
+}
+
+void RKSweepEngineSetProductWriterCount(RKSweepEngine *engine, const uint8_t count) {
+    if (engine->state & RKEngineStateActive) {
+        RKLog("%s Error. Product writer count cannot be changed while the engine is active.\n", engine->name);
+        return;
+    }
+    engine->productWriterCount = MAX(1, MIN(RKSweepEngineMaximumProductWriterCount, count));
+}
+
 #pragma mark - Interactions
 
 int RKSweepEngineStart(RKSweepEngine *engine) {
@@ -862,3 +1360,49 @@ int RKSweepFree(RKSweep *sweep) {
     free(sweep);
     return RKResultSuccess;
 }
+
+// The sweep of a scratch space, collected on the first request and shared by all subsequent ones until the
+// scratch space is reused. It must not be modified and must be returned through RKSweepEngineReleaseSweep()
+RKSweep *RKSweepEngineAcquireSweep(RKSweepEngine *engine, const uint8_t scratchSpaceIndex) {
+    RKSweep *sweep;
+    RKSweepScratchSpace *space = &engine->scratchSpaces[scratchSpaceIndex % RKSweepScratchSpaceDepth];
+    pthread_mutex_lock(&engine->sweepMutex);
+    if (space->sweep == NULL) {
+        space->sweep = RKSweepCollect(engine, scratchSpaceIndex % RKSweepScratchSpaceDepth);
+        // Only a sweep that owns its rays can be kept in the volume cache
+        if (space->sweep && engine->volumeEngine && engine->volumeEngine->depth) {
+            RKSweepEngineCopyRays(engine, space->sweep);
+        }
+        if (space->sweep) {
+            // The scratch space holds a reference until it is reused
+            space->sweep->referenceCount = 1;
+        }
+    }
+    sweep = space->sweep;
+    if (sweep) {
+        sweep->referenceCount++;
+    }
+    pthread_mutex_unlock(&engine->sweepMutex);
+    return sweep;
+}
+
+int RKSweepEngineReleaseSweep(RKSweepEngine *engine, RKSweep *sweep) {
+    if (sweep == NULL) {
+        return RKResultNullInput;
+    }
+    pthread_mutex_lock(&engine->sweepMutex);
+    if (sweep->referenceCount == 0) {
+        pthread_mutex_unlock(&engine->sweepMutex);
+        RKLog("%s Error. Releasing a sweep that is not shared.\n", engine->name);
+        return RKResultNullInput;
+    }
+    uint32_t count = --sweep->referenceCount;
+    pthread_mutex_unlock(&engine->sweepMutex);
+    if (count == 0) {
+        if (engine->verbose > 2) {
+            RKLog("%s Sweep S%lu freed.\n", engine->name, sweep->header.config.i);
+        }
+        return RKSweepFree(sweep);
+    }
+    return RKResultSuccess;
+}
@@ -8,6 +8,37 @@
 
 #include <RadarKit/RKSweepFile.h>
 
+// Base moments that can be read from a sweep file, in conventions of RADAR-20180101-010203-EL10.2-Z.nc
+// for a file per moment or by variable name in a multi-moment sweep file
+static const char symbols[][RKNameLength] = {"Z", "V", "W", "D", "P", "R", "K"};
+static const char productNames[][RKNameLength] = {
+    "Intensity",
+    "Radial_Velocity",
+    "Width",
+    "Differential_Reflectivity",
+    "PhiDP",
+    "RhoHV",
+    "KDP"
+};
+static const uint32_t products[] = {
+    RKBaseMomentListProductZ,
+    RKBaseMomentListProductV,
+    RKBaseMomentListProductW,
+    RKBaseMomentListProductD,
+    RKBaseMomentListProductP,
+    RKBaseMomentListProductR,
+    RKBaseMomentListProductK
+};
+static const uint32_t productIndices[] = {
+    RKBaseMomentIndexZ,
+    RKBaseMomentIndexV,
+    RKBaseMomentIndexW,
+    RKBaseMomentIndexD,
+    RKBaseMomentIndexP,
+    RKBaseMomentIndexR,
+    RKBaseMomentIndexK
+};
+
 static void getGlobalTextAttribute(char *dst, const char *name, const int ncid) {
     size_t n = 0;
     nc_get_att_text(ncid, NC_GLOBAL, name, dst);
@@ -15,22 +46,17 @@ static void getGlobalTextAttribute(char *dst, const char *name, const int ncid)
     dst[n] = 0;
 }
 
-RKSweep *RKSweepFileRead(const char *inputFile) {
-    int j, k, r;
-    int ncid, tmpId;
+// Allocate a sweep from the dimensions, global attributes and ray angles of an opened file. Only the rays and gates
+// from the origins are kept, up to the counts when they are non-zero.
+static RKSweep *sweepInitFromFile(const int ncid, const size_t rayOrigin, const size_t gateOrigin,
+                                  size_t *rayCountInOut, size_t *gateCountInOut, void **scratchOut) {
+    int j, r;
+    int tmpId;
     float *fp, fv;
     int iv;
 
-    MAKE_FUNCTION_NAME(name)
-
     RKName typeName;
     RKName scanType;
-    char filename[RKMaximumPathLength];
-    memset(filename, 0, RKMaximumPathLength);
-
-    uint32_t firstPartLength = 0;
-
-    uint32_t productList = 0;
 
     size_t rayCount = 0;
     size_t gateCount = 0;
@@ -41,348 +67,903 @@ RKSweep *RKSweepFileRead(const char *inputFile) {
     // A scratch space for netcdf API
     void *scratch = NULL;
 
-    // Try to go through all the sublings to gather a productLiset
-    // For now, we only try Z, V, W, D, P, R, K
-    // Filename in conventions of RADAR-20180101-010203-EL10.2-Z.nc
+    // Dimensions
+    if ((r = nc_inq_dimid(ncid, "Azimuth", &tmpId)) != NC_NOERR) {
+        r = nc_inq_dimid(ncid, "azimuth", &tmpId);
+    }
+    if (r != NC_NOERR) {
+        if ((r = nc_inq_dimid(ncid, "Beam", &tmpId)) != NC_NOERR) {
+            r = nc_inq_dimid(ncid, "beam", &tmpId);
+        }
+    }
+    if (r == NC_NOERR) {
+        nc_inq_dimlen(ncid, tmpId, &rayCount);
+    } else {
+        RKLog("Warning. Early return (rayCount)\n");
+        return NULL;
+    }
+    if ((r = nc_inq_dimid(ncid, "Gate", &tmpId)) != NC_NOERR)
+        r = nc_inq_dimid(ncid, "gate", &tmpId);
+    if (r == NC_NOERR) {
+        nc_inq_dimlen(ncid, tmpId, &gateCount);
+    } else {
+        RKLog("Warning. Early return (gateCount)\n");
+        return NULL;
+    }
 
-    // Find the last '.'
-    char *e = NULL;
-    e = strstr(inputFile, ".");
-    if (e == NULL) {
-        e = (char *)inputFile + strlen(inputFile) - 1;
+    if (rayOrigin >= rayCount || gateOrigin >= gateCount) {
+        RKLog("Error. Origin (%zu, %zu) outside of %zu x %zu.\n", rayOrigin, gateOrigin, rayCount, gateCount);
+        return NULL;
     }
-    while (*(e + 1) >= '0' && *(e + 1) <= '9') {
-        e = strstr(e + 1, ".");
+    rayCount -= rayOrigin;
+    gateCount -= gateOrigin;
+    if (*rayCountInOut > 0 && *rayCountInOut < rayCount) {
+        rayCount = *rayCountInOut;
     }
-    // Find the previous '-'
-    char *b = e;
-    while (b != inputFile && *b != '-') {
-        b--;
+    if (*gateCountInOut > 0 && *gateCountInOut < gateCount) {
+        gateCount = *gateCountInOut;
     }
-    if (b == inputFile) {
-        RKLog("%s Unable to find product symbol.\n", name);
+
+    if (gateCount > RKMaximumGateCount) {
+        RKLog("Info. gateCount = %d capped to %d\n", gateCount, RKMaximumGateCount);
+        gateCount = RKMaximumGateCount;
+    }
+
+    // Derive the RKSIMDAlignSize compliant capacity
+    capacity = (uint32_t)ceilf((float)gateCount / RKSIMDAlignSize) * RKSIMDAlignSize;
+
+    RKLog("rayCount = %s   gateCount = %s   capacity = %s\n",
+          RKIntegerToCommaStyleString(rayCount), RKIntegerToCommaStyleString(gateCount), RKIntegerToCommaStyleString(capacity));
+
+    // A scratch space for netcdf API
+    scratch = (void *)malloc(rayCount * capacity * sizeof(float));
+    if (scratch == NULL) {
+        RKLog("Error. Unable to allocate memory for a scratch space.\n");
         return NULL;
     }
 
-    b++;
-    firstPartLength = (uint32_t)(b - inputFile);
-    char symbol[RKMaximumSymbolLength];
-    memset(symbol, 0, RKMaximumSymbolLength);
-    strncpy(symbol, b, MIN(RKMaximumSymbolLength, e - b));
-    // Substitute symbol with the ones I know
-    char symbols[][RKNameLength] = {"Z", "V", "W", "D", "P", "R", "K"};
-    RKName productNames[] = {
-        "Intensity",
-        "Radial_Velocity",
-        "Width",
-        "Differential_Reflectivity",
-        "PhiDP",
-        "RhoHV",
-        "KDP"
-    };
-    uint32_t products[] = {
-        RKBaseMomentListProductZ,
-        RKBaseMomentListProductV,
-        RKBaseMomentListProductW,
-        RKBaseMomentListProductD,
-        RKBaseMomentListProductP,
-        RKBaseMomentListProductR,
-        RKBaseMomentListProductK
-    };
-    uint32_t productIndices[] = {
-        RKBaseMomentIndexZ,
-        RKBaseMomentIndexV,
-        RKBaseMomentIndexW,
-        RKBaseMomentIndexD,
-        RKBaseMomentIndexP,
-        RKBaseMomentIndexR,
-        RKBaseMomentIndexK
-    };
-
-    // First part: go through all the symbols I know of, get the very first filename
-    for (k = 0; k < sizeof(symbols) / RKNameLength; k++) {
-        b = symbols[k];
-        strncpy(filename, inputFile, firstPartLength);
-        snprintf(filename + firstPartLength, RKMaximumPathLength - firstPartLength, "%s%s", b, e);
-        // Read in the header from the very first file that exists
-        if (RKFilenameExists(filename)) {
-            // Read the first file
-            if ((r = nc_open(filename, NC_NOWRITE, &ncid)) > 0) {
-                RKLog("%s Error opening file %s (%s)\n", name, inputFile, nc_strerror(r));
-                return NULL;
-            }
-            // Dimensions
-            if ((r = nc_inq_dimid(ncid, "Azimuth", &tmpId)) != NC_NOERR) {
-                r = nc_inq_dimid(ncid, "azimuth", &tmpId);
-            }
-            if (r != NC_NOERR) {
-                if ((r = nc_inq_dimid(ncid, "Beam", &tmpId)) != NC_NOERR) {
-                    r = nc_inq_dimid(ncid, "beam", &tmpId);
-                }
-            }
-            if (r == NC_NOERR) {
-                nc_inq_dimlen(ncid, tmpId, &rayCount);
-            } else {
-                nc_close(ncid);
-                RKLog("Warning. Early return (rayCount)\n");
-                return NULL;
-            }
-            if ((r = nc_inq_dimid(ncid, "Gate", &tmpId)) != NC_NOERR)
-                r = nc_inq_dimid(ncid, "gate", &tmpId);
-            if (r == NC_NOERR) {
-                nc_inq_dimlen(ncid, tmpId, &gateCount);
-            } else {
-                RKLog("Warning. Early return (gateCount)\n");
-                nc_close(ncid);
-                return NULL;
-            }
+    // Allocate the return object
+    sweep = (RKSweep *)malloc(sizeof(RKSweep));
+    if (sweep == NULL) {
+        RKLog("Error. Unable to allocate memory.\n");
+        free(scratch);
+        return NULL;
+    }
+    memset(sweep, 0, sizeof(RKSweep));
+    RKRayBufferAlloc(&sweep->rayBuffer, (uint32_t)capacity, (uint32_t)rayCount);
+    for (j = 0; j < rayCount; j++) {
+        sweep->rays[j] = RKGetRayFromBuffer(sweep->rayBuffer, j);
+    }
+    ray = (RKRay *)sweep->rayBuffer;
+
+    // Global attributes
+    getGlobalTextAttribute(typeName, "TypeName", ncid);
+    getGlobalTextAttribute(scanType, "ScanType", ncid);
+    getGlobalTextAttribute(sweep->header.desc.name, "radarName-value", ncid);
+    r = nc_get_att_double(ncid, NC_GLOBAL, "LatitudeDouble", &sweep->header.desc.latitude);
+    if (r != NC_NOERR) {
+        r = nc_get_att_float(ncid, NC_GLOBAL, "Latitude", &fv);
+        if (r == NC_NOERR) {
+            sweep->header.desc.latitude = (double)fv;
+        }
+    }
+    r = nc_get_att(ncid, NC_GLOBAL, "LongitudeDouble", &sweep->header.desc.longitude);
+    if (r != NC_NOERR) {
+        r = nc_get_att_float(ncid, NC_GLOBAL, "Longitude", &fv);
+        if (r == NC_NOERR) {
+            sweep->header.desc.longitude = (double)fv;
+        }
+    }
+    r = nc_get_att_float(ncid, NC_GLOBAL, "Heading", &sweep->header.desc.heading);
+    if (r != NC_NOERR) {
+        RKLog("No radar heading found.\n");
+    }
+    r = nc_get_att_float(ncid, NC_GLOBAL, "Height", &sweep->header.desc.radarHeight);
+    if (r != NC_NOERR) {
+        RKLog("No radar height found.\n");
+    }
+    r = nc_get_att_float(ncid, NC_GLOBAL, "Elevation", &ray->header.sweepElevation);
+    if (r != NC_NOERR && sweep->header.config.startMarker & RKMarkerScanTypePPI) {
+        RKLog("Warning. No sweep elevation found.\n");
+    }
+    r = nc_get_att_float(ncid, NC_GLOBAL, "Azimuth", &ray->header.sweepAzimuth);
+    if (r != NC_NOERR && sweep->header.config.startMarker & RKMarkerScanTypeRHI) {
+        RKLog("Warning. No sweep azimuth found.\n");
+    }
+    if (!strcmp(scanType, "PPI")) {
+        sweep->header.config.sweepElevation = ray->header.sweepElevation;
+        sweep->header.config.startMarker |= RKMarkerScanTypePPI;
+    } else if (!strcmp(scanType, "RHI")) {
+        sweep->header.config.sweepAzimuth = ray->header.sweepAzimuth;
+        sweep->header.config.startMarker |= RKMarkerScanTypeRHI;
+    }
+    r = nc_get_att_int(ncid, NC_GLOBAL, "PRF-value", &iv);
+    if (r == NC_NOERR) {
+        if (iv == 0) {
+            RKLog("Warning. Recorded PRF = 0 Hz, assuming 1000 Hz.\n");
+            iv = 1000;
+        }
+        sweep->header.config.prt[0] = 1.0f / (RKFloat)iv;
+    } else {
+        RKLog("Warning. No PRF information found.\n");
+    }
+    r = nc_get_att_float(ncid, NC_GLOBAL, "Nyquist_Vel-value", &fv);
+    if (r == NC_NOERR) {
+        sweep->header.desc.wavelength = 4.0f * fv * (RKFloat)sweep->header.config.prt[0];
+        RKLog("Radar wavelength = %.4f m\n", sweep->header.desc.wavelength);
+    }
 
-            if (gateCount > RKMaximumGateCount) {
-                RKLog("Info. gateCount = %d capped to %d\n", gateCount, RKMaximumGateCount);
-                gateCount = RKMaximumGateCount;
-            }
+    // Elevation array
+    if ((r = nc_inq_varid(ncid, "Elevation", &tmpId)) != NC_NOERR) {
+        r = nc_inq_varid(ncid, "elevation", &tmpId);
+    }
+    if (r == NC_NOERR) {
+        nc_get_vara_float(ncid, tmpId, &rayOrigin, &rayCount, scratch);
+        fp = (float *)scratch;
+        for (j = 0; j < rayCount; j++) {
+            ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
+            ray->header.startElevation = *fp++;
+            ray->header.endElevation = ray->header.startElevation;
+        }
+    } else {
+        RKLog("Warning. No elevation array.\n");
+    }
 
-            // Derive the RKSIMDAlignSize compliant capacity
-            capacity = (uint32_t)ceilf((float)gateCount / RKSIMDAlignSize) * RKSIMDAlignSize;
+    // Azimuth array
+    if ((r = nc_inq_varid(ncid, "Azimuth", &tmpId)) != NC_NOERR) {
+        r = nc_inq_varid(ncid, "azimuth", &tmpId);
+    }
+    if (r == NC_NOERR) {
+        nc_get_vara_float(ncid, tmpId, &rayOrigin, &rayCount, scratch);
+        fp = (float *)scratch;
+        for (j = 0; j < rayCount; j++) {
+            ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
+            ray->header.startAzimuth = *fp++;
+        }
+    } else {
+        RKLog("Warning. No azimuth array.\n");
+    }
 
-            RKLog("rayCount = %s   gateCount = %s   capacity = %s\n",
-                  RKIntegerToCommaStyleString(rayCount), RKIntegerToCommaStyleString(gateCount), RKIntegerToCommaStyleString(capacity));
+    // Gatewidth array (this is here for historical reasons)
+    if ((r = nc_inq_varid(ncid, "GateWidth", &tmpId)) != NC_NOERR) {
+        if ((r = nc_inq_varid(ncid, "Gatewidth", &tmpId)) != NC_NOERR) {
+            r = nc_inq_varid(ncid, "gatewidth", &tmpId);
+        }
+    }
+    if (r == NC_NOERR) {
+        nc_get_vara_float(ncid, tmpId, &rayOrigin, &rayCount, scratch);
+        fp = (float *)scratch;
+        for (j = 0; j < rayCount; j++) {
+            ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
+            ray->header.gateCount = gateCount;
+            ray->header.gateSizeMeters = *fp++;
+        }
+    } else {
+        RKLog("Warning. No gatewidth array.\n");
+    }
 
-            // A scratch space for netcdf API
-            scratch = (void *)malloc(rayCount * capacity * sizeof(float));
-            if (scratch == NULL) {
-                RKLog("Error. Unable to allocate memory for a scratch space.\n");
-                return NULL;
-            }
+    // Beamwidth array (this is here for historical reasons)
+    if ((r = nc_inq_varid(ncid, "BeamWidth", &tmpId)) != NC_NOERR) {
+        if ((r = nc_inq_varid(ncid, "Beamwidth", &tmpId)) != NC_NOERR) {
+            r = nc_inq_varid(ncid, "beamwidth", &tmpId);
+        }
+    }
+    if (r == NC_NOERR) {
+        nc_get_vara_float(ncid, tmpId, &rayOrigin, &rayCount, scratch);
+        fp = (float *)scratch;
+        for (j = 0; j < rayCount; j++) {
+            ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
+            ray->header.endAzimuth = ray->header.startAzimuth + *fp;
+            ray->header.endElevation = ray->header.endElevation + *fp++;
+        }
+    } else {
+        RKLog("Warning. No beamwidth array.\n");
+    }
+
+    *rayCountInOut = rayCount;
+    *gateCountInOut = gateCount;
+    *scratchOut = scratch;
+    return sweep;
+}
+
+// Read a moment variable into the rays, missing data and range folded gates become NAN
+static void sweepReadMoment(const int ncid, const int variableId, RKSweep *sweep, const RKBaseMomentIndex index, void *scratch,
+                            const size_t rayOrigin, const size_t gateOrigin, const size_t rayCount, const size_t gateCount) {
+    int j;
+    float *fp;
+    RKRay *ray;
+    const float w2_missing_data = W2_MISSING_DATA;
+    const float w2_range_folded = W2_RANGE_FOLDED;
+    const size_t start[] = {rayOrigin, gateOrigin};
+    const size_t count[] = {rayCount, gateCount};
+
+    RKProductFileGetVariableRange(ncid, variableId, scratch, start, count);
+    fp = (float *)scratch;
+    for (j = 0; j < rayCount * gateCount; j++) {
+        if (*fp == w2_missing_data || *fp == w2_range_folded) {
+            *fp = NAN;
+        }
+        fp++;
+    }
+    for (j = 0; j < rayCount; j++) {
+        ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
+        fp = RKGetFloatDataFromRay(ray, index);
+        memcpy(fp, scratch + j * gateCount * sizeof(float), gateCount * sizeof(float));
+    }
+}
+
+static RKSweepFileReader *sweepFileReaderInit(const char *inputFile, const uint32_t rayOrigin, const uint32_t rayCount,
+                                              const uint32_t gateOrigin, const uint32_t gateCount) {
+    int j, k, r;
+    int ncid, tmpId;
+    size_t n;
 
-            // Allocate the return object
-            sweep = (RKSweep *)malloc(sizeof(RKSweep));
-            if (sweep == NULL) {
-                RKLog("Error. Unable to allocate memory.\n");
-                free(scratch);
+    MAKE_FUNCTION_NAME(name)
+
+    char filename[RKMaximumPathLength];
+    memset(filename, 0, RKMaximumPathLength);
+
+    uint32_t firstPartLength = 0;
+
+    size_t sweepRayCount = rayCount;
+    size_t sweepGateCount = gateCount;
+    RKRay *ray = NULL;
+
+    RKSweepFileReader *reader = (RKSweepFileReader *)malloc(sizeof(RKSweepFileReader));
+    if (reader == NULL) {
+        RKLog("%s Error. Unable to allocate memory.\n", name);
+        return NULL;
+    }
+    memset(reader, 0, sizeof(RKSweepFileReader));
+    reader->rayOrigin = rayOrigin;
+    reader->gateOrigin = gateOrigin;
+
+    // A multi-moment sweep file has all the moments, only the variable names are noted here
+    if (RKFilenameExists(inputFile) && nc_open(inputFile, NC_NOWRITE, &ncid) == NC_NOERR) {
+        if (nc_inq_attlen(ncid, NC_GLOBAL, "Moments", &n) == NC_NOERR) {
+            reader->sweep = sweepInitFromFile(ncid, rayOrigin, gateOrigin, &sweepRayCount, &sweepGateCount, (void **)&reader->scratch);
+            if (reader->sweep == NULL) {
+                nc_close(ncid);
+                free(reader);
                 return NULL;
             }
-            memset(sweep, 0, sizeof(RKSweep));
-            RKRayBufferAlloc(&sweep->rayBuffer, (uint32_t)capacity, (uint32_t)rayCount);
-            for (j = 0; j < rayCount; j++) {
-                sweep->rays[j] = RKGetRayFromBuffer(sweep->rayBuffer, j);
-            }
-            ray = (RKRay *)sweep->rayBuffer;
-
-            // Global attributes
-            getGlobalTextAttribute(typeName, "TypeName", ncid);
-            getGlobalTextAttribute(scanType, "ScanType", ncid);
-            getGlobalTextAttribute(sweep->header.desc.name, "radarName-value", ncid);
-            r = nc_get_att_double(ncid, NC_GLOBAL, "LatitudeDouble", &sweep->header.desc.latitude);
-            if (r != NC_NOERR) {
-                r = nc_get_att_float(ncid, NC_GLOBAL, "Latitude", &fv);
-                if (r == NC_NOERR) {
-                    sweep->header.desc.latitude = (double)fv;
-                }
-            }
-            r = nc_get_att(ncid, NC_GLOBAL, "LongitudeDouble", &sweep->header.desc.longitude);
-            if (r != NC_NOERR) {
-                r = nc_get_att_float(ncid, NC_GLOBAL, "Longitude", &fv);
-                if (r == NC_NOERR) {
-                    sweep->header.desc.longitude = (double)fv;
-                }
-            }
-            r = nc_get_att_float(ncid, NC_GLOBAL, "Heading", &sweep->header.desc.heading);
-            if (r != NC_NOERR) {
-                RKLog("No radar heading found.\n");
-            }
-            r = nc_get_att_float(ncid, NC_GLOBAL, "Height", &sweep->header.desc.radarHeight);
-            if (r != NC_NOERR) {
-                RKLog("No radar height found.\n");
-            }
-            r = nc_get_att_float(ncid, NC_GLOBAL, "Elevation", &ray->header.sweepElevation);
-            if (r != NC_NOERR && sweep->header.config.startMarker & RKMarkerScanTypePPI) {
-                RKLog("Warning. No sweep elevation found.\n");
-            }
-            r = nc_get_att_float(ncid, NC_GLOBAL, "Azimuth", &ray->header.sweepAzimuth);
-            if (r != NC_NOERR && sweep->header.config.startMarker & RKMarkerScanTypeRHI) {
-                RKLog("Warning. No sweep azimuth found.\n");
-            }
-            if (!strcmp(scanType, "PPI")) {
-                sweep->header.config.sweepElevation = ray->header.sweepElevation;
-                sweep->header.config.startMarker |= RKMarkerScanTypePPI;
-            } else if (!strcmp(scanType, "RHI")) {
-                sweep->header.config.sweepAzimuth = ray->header.sweepAzimuth;
-                sweep->header.config.startMarker |= RKMarkerScanTypeRHI;
-            }
-            r = nc_get_att_int(ncid, NC_GLOBAL, "PRF-value", &iv);
-            if (r == NC_NOERR) {
-                if (iv == 0) {
-                    RKLog("Warning. Recorded PRF = 0 Hz, assuming 1000 Hz.\n");
-                    iv = 1000;
+            for (k = 0; k < sizeof(symbols) / RKNameLength; k++) {
+                if (nc_inq_varid(ncid, productNames[k], &tmpId) == NC_NOERR) {
+                    strncpy(reader->filenames[productIndices[k]], inputFile, RKMaximumPathLength - 1);
+                    reader->availableMomentList |= products[k];
                 }
-                sweep->header.config.prt[0] = 1.0f / (RKFloat)iv;
-            } else {
-                RKLog("Warning. No PRF information found.\n");
-            }
-            r = nc_get_att_float(ncid, NC_GLOBAL, "Nyquist_Vel-value", &fv);
-            if (r == NC_NOERR) {
-                sweep->header.desc.wavelength = 4.0f * fv * (RKFloat)sweep->header.config.prt[0];
-                RKLog("Radar wavelength = %.4f m\n", sweep->header.desc.wavelength);
             }
+        }
+        nc_close(ncid);
+    }
 
-            // Elevation array
-            if ((r = nc_inq_varid(ncid, "Elevation", &tmpId)) != NC_NOERR) {
-                r = nc_inq_varid(ncid, "elevation", &tmpId);
-            }
-            if (r == NC_NOERR) {
-                nc_get_var_float(ncid, tmpId, scratch);
-                fp = (float *)scratch;
-                for (j = 0; j < rayCount; j++) {
-                    ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-                    ray->header.startElevation = *fp++;
-                    ray->header.endElevation = ray->header.startElevation;
-                }
-            } else {
-                RKLog("Warning. No elevation array.\n");
-            }
+    // Otherwise, try to go through all the sublings to gather a productLiset
+    // For now, we only try Z, V, W, D, P, R, K
+    // Filename in conventions of RADAR-20180101-010203-EL10.2-Z.nc
+    if (reader->sweep == NULL) {
+        // Find the last '.'
+        char *e = NULL;
+        e = strstr(inputFile, ".");
+        if (e == NULL) {
+            e = (char *)inputFile + strlen(inputFile) - 1;
+        }
+        while (*(e + 1) >= '0' && *(e + 1) <= '9') {
+            e = strstr(e + 1, ".");
+        }
+        // Find the previous '-'
+        char *b = e;
+        while (b != inputFile && *b != '-') {
+            b--;
+        }
+        if (b == inputFile) {
+            RKLog("%s Unable to find product symbol.\n", name);
+            free(reader);
+            return NULL;
+        }
 
-            // Azimuth array
-            if ((r = nc_inq_varid(ncid, "Azimuth", &tmpId)) != NC_NOERR) {
-                r = nc_inq_varid(ncid, "azimuth", &tmpId);
-            }
-            if (r == NC_NOERR) {
-                nc_get_var_float(ncid, tmpId, scratch);
-                fp = (float *)scratch;
-                for (j = 0; j < rayCount; j++) {
-                    ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-                    ray->header.startAzimuth = *fp++;
-                }
-            } else {
-                RKLog("Warning. No azimuth array.\n");
-            }
+        b++;
+        firstPartLength = (uint32_t)(b - inputFile);
 
-            // Gatewidth array (this is here for historical reasons)
-            if ((r = nc_inq_varid(ncid, "GateWidth", &tmpId)) != NC_NOERR) {
-                if ((r = nc_inq_varid(ncid, "Gatewidth", &tmpId)) != NC_NOERR) {
-                    r = nc_inq_varid(ncid, "gatewidth", &tmpId);
-                }
+        // Go through all the symbols I know of, the header is read from the very first file that exists
+        for (k = 0; k < sizeof(symbols) / RKNameLength; k++) {
+            strncpy(filename, inputFile, firstPartLength);
+            snprintf(filename + firstPartLength, RKMaximumPathLength - firstPartLength, "%s%s", symbols[k], e);
+            if (!RKFilenameExists(filename)) {
+                continue;
             }
-            if (r == NC_NOERR) {
-                nc_get_var_float(ncid, tmpId, scratch);
-                fp = (float *)scratch;
-                for (j = 0; j < rayCount; j++) {
-                    ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-                    ray->header.gateCount = gateCount;
-                    ray->header.gateSizeMeters = *fp++;
-                }
-            } else {
-                RKLog("Warning. No gatewidth array.\n");
+            strcpy(reader->filenames[productIndices[k]], filename);
+            reader->availableMomentList |= products[k];
+            if (reader->sweep) {
+                continue;
             }
-
-            // Beamwidth array (this is here for historical reasons)
-            if ((r = nc_inq_varid(ncid, "BeamWidth", &tmpId)) != NC_NOERR) {
-                if ((r = nc_inq_varid(ncid, "Beamwidth", &tmpId)) != NC_NOERR) {
-                    r = nc_inq_varid(ncid, "beamwidth", &tmpId);
-                }
+            if ((r = nc_open(filename, NC_NOWRITE, &ncid)) > 0) {
+                RKLog("%s Error opening file %s (%s)\n", name, filename, nc_strerror(r));
+                free(reader);
+                return NULL;
             }
-            if (r == NC_NOERR) {
-                nc_get_var_float(ncid, tmpId, scratch);
-                fp = (float *)scratch;
-                for (j = 0; j < rayCount; j++) {
-                    ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-                    ray->header.endAzimuth = ray->header.startAzimuth + *fp;
-                    ray->header.endElevation = ray->header.endElevation + *fp++;
-                }
-            } else {
-                RKLog("Warning. No beamwidth array.\n");
+            reader->sweep = sweepInitFromFile(ncid, rayOrigin, gateOrigin, &sweepRayCount, &sweepGateCount, (void **)&reader->scratch);
+            nc_close(ncid);
+            if (reader->sweep == NULL) {
+                free(reader);
+                return NULL;
             }
+        }
 
-            // Be a good citizen, close the file
-            nc_close(ncid);
-            break;
+        // If none of the files exist, sweep is NULL. There is no point continuing
+        if (reader->sweep == NULL) {
+            RKLog("%s Inconsistent state.\n", name);
+            free(reader);
+            return NULL;
         }
     }
 
-    // If none of the files exist, sweep is NULL. There is no point continuing
-    if (sweep == NULL) {
-        RKLog("%s Inconsistent state.\n", name);
-        return NULL;
+    reader->rayCount = (uint32_t)sweepRayCount;
+    reader->gateCount = (uint32_t)sweepGateCount;
+
+    ray = RKGetRayFromBuffer(reader->sweep->rayBuffer, 0);
+
+    reader->sweep->header.rayCount = reader->rayCount;
+    reader->sweep->header.gateCount = reader->gateCount;
+    reader->sweep->header.gateSizeMeters = ray->header.gateSizeMeters;
+
+    for (j = 0; j < reader->rayCount; j++) {
+        ray = RKGetRayFromBuffer(reader->sweep->rayBuffer, j);
+        ray->header.i += reader->sweep->header.rayCount;
+        ray->header.s = RKRayStatusReady;
     }
 
-    // Second pass: go through all the symbols I know of and actually read in the data
-    const float w2_missing_data = W2_MISSING_DATA;
-    const float w2_range_folded = W2_RANGE_FOLDED;
+    return reader;
+}
+
+static int sweepFileReaderLoad(RKSweepFileReader *reader, const RKBaseMomentList momentList) {
+    int j, k, r;
+    int ncid = -1, tmpId;
+
+    MAKE_FUNCTION_NAME(name)
+
+    const char *openedFile = NULL;
+    int result = RKResultSuccess;
+
     for (k = 0; k < sizeof(symbols) / RKNameLength; k++) {
-        b = symbols[k];
-        strncpy(filename, inputFile, firstPartLength);
-        snprintf(filename + firstPartLength, RKMaximumPathLength - firstPartLength, "%s%s", b, e);
-        if (!RKFilenameExists(filename)) {
-            RKLog("%s not found.\n", filename);
+        if (!(momentList & products[k]) || reader->loadedMomentList & products[k]) {
+            continue;
+        }
+        if (!(reader->availableMomentList & products[k])) {
+            RKLog("%s Base moment %s not found.\n", name, productNames[k]);
+            continue;
+        }
+        // Moments of a multi-moment sweep file share one open
+        if (openedFile == NULL || strcmp(openedFile, reader->filenames[productIndices[k]])) {
+            if (openedFile) {
+                nc_close(ncid);
+                openedFile = NULL;
+            }
+            if ((r = nc_open(reader->filenames[productIndices[k]], NC_NOWRITE, &ncid)) > 0) {
+                RKLog("%s Error opening file %s (%s)\n", name, reader->filenames[productIndices[k]], nc_strerror(r));
+                result = RKResultFailedToOpenFileForProduct;
+                continue;
+            }
+            openedFile = reader->filenames[productIndices[k]];
+            RKLog("%s %s (*)\n", name, openedFile);
+        }
+        if (nc_inq_varid(ncid, productNames[k], &tmpId) != NC_NOERR) {
+            RKLog("%s Base moment %s not found.\n", name, productNames[k]);
             continue;
         }
-        productList |= products[k];
+        sweepReadMoment(ncid, tmpId, reader->sweep, productIndices[k], reader->scratch,
+                        reader->rayOrigin, reader->gateOrigin, reader->rayCount, reader->gateCount);
+        reader->loadedMomentList |= products[k];
+    }
+    if (openedFile) {
+        nc_close(ncid);
+    }
+
+    reader->sweep->header.baseMomentList = reader->loadedMomentList;
+    for (j = 0; j < reader->rayCount; j++) {
+        reader->sweep->rays[j]->header.baseMomentList = reader->loadedMomentList;
+    }
 
-        // Open the file
-        if ((r = nc_open(filename, NC_NOWRITE, &ncid)) > 0) {
-            RKLog("%s Error opening file %s (%s)\n", name, inputFile, nc_strerror(r));
-            free(scratch);
+    return result;
+}
+
+static void sweepFileReaderFree(RKSweepFileReader *reader) {
+    if (reader->sweep) {
+        RKRayBufferFree(reader->sweep->rayBuffer);
+        free(reader->sweep);
+    }
+    free(reader->scratch);
+    free(reader);
+}
+
+RKSweep *RKSweepFileRead(const char *inputFile) {
+    return RKSweepFileReadMoments(inputFile, RKBaseMomentListProductZVWDPRK);
+}
+
+RKSweep *RKSweepFileReadMoments(const char *inputFile, const RKBaseMomentList momentList) {
+    RKSweep *sweep = NULL;
+    RKProductFileLock();
+    RKSweepFileReader *reader = sweepFileReaderInit(inputFile, 0, 0, 0, 0);
+    if (reader) {
+        sweepFileReaderLoad(reader, momentList);
+        sweep = reader->sweep;
+        reader->sweep = NULL;
+        sweepFileReaderFree(reader);
+    }
+    RKProductFileUnlock();
+    return sweep;
+}
+
+RKSweepFileReader *RKSweepFileReaderInit(const char *inputFile) {
+    return RKSweepFileReaderInitWithRange(inputFile, 0, 0, 0, 0);
+}
+
+// Only the rays and gates within the range are read, a count of 0 means all the way to the end
+RKSweepFileReader *RKSweepFileReaderInitWithRange(const char *inputFile, const uint32_t rayOrigin, const uint32_t rayCount,
+                                                  const uint32_t gateOrigin, const uint32_t gateCount) {
+    RKProductFileLock();
+    RKSweepFileReader *reader = sweepFileReaderInit(inputFile, rayOrigin, rayCount, gateOrigin, gateCount);
+    RKProductFileUnlock();
+    return reader;
+}
+
+int RKSweepFileReaderLoadMoments(RKSweepFileReader *reader, const RKBaseMomentList momentList) {
+    RKProductFileLock();
+    int r = sweepFileReaderLoad(reader, momentList);
+    RKProductFileUnlock();
+    return r;
+}
+
+// Data of a ray, the moment is read from the file the first time it is needed. NULL if the moment is not available.
+RKFloat *RKSweepFileReaderGetRayData(RKSweepFileReader *reader, const RKBaseMomentIndex index, const uint32_t rayIndex) {
+    int k;
+    for (k = 0; k < sizeof(symbols) / RKNameLength; k++) {
+        if (productIndices[k] == index) {
+            break;
+        }
+    }
+    if (k == sizeof(symbols) / RKNameLength || rayIndex >= reader->rayCount || !(reader->availableMomentList & products[k])) {
+        return NULL;
+    }
+    if (!(reader->loadedMomentList & products[k])) {
+        RKSweepFileReaderLoadMoments(reader, products[k]);
+        if (!(reader->loadedMomentList & products[k])) {
             return NULL;
         }
+    }
+    return RKGetFloatDataFromRay(reader->sweep->rays[rayIndex], index);
+}
+
+void RKSweepFileReaderFree(RKSweepFileReader *reader) {
+    if (reader == NULL) {
+        return;
+    }
+    sweepFileReaderFree(reader);
+}
+
+// Ray and gate dimensions, and the ray angles that are shared by all the moments
+static void sweepFileDefineDimensions(const int ncid, const bool isPPI, const bool isRHI, const size_t rayCount, const size_t gateCount,
+                                      int *dimensionIds, int *coordinateIds) {
+    if (isPPI) {
+        nc_def_dim(ncid, "Azimuth", rayCount, &dimensionIds[0]);
+    } else if (isRHI) {
+        nc_def_dim(ncid, "Elevation", rayCount, &dimensionIds[0]);
+    } else {
+        nc_def_dim(ncid, "Beam", rayCount, &dimensionIds[0]);
+    }
+    nc_def_dim(ncid, "Gate", gateCount, &dimensionIds[1]);
+    nc_def_var(ncid, "Azimuth", NC_FLOAT, 1, dimensionIds, &coordinateIds[0]);
+    nc_def_var(ncid, "Elevation", NC_FLOAT, 1, dimensionIds, &coordinateIds[1]);
+    nc_def_var(ncid, "Beamwidth", NC_FLOAT, 1, dimensionIds, &coordinateIds[2]);
+    nc_def_var(ncid, "GateWidth", NC_FLOAT, 1, dimensionIds, &coordinateIds[3]);
+    nc_put_att_text(ncid, coordinateIds[0], "Units", 7, "Degrees");
+    nc_put_att_text(ncid, coordinateIds[1], "Units", 7, "Degrees");
+    nc_put_att_text(ncid, coordinateIds[2], "Units", 7, "Degrees");
+    nc_put_att_text(ncid, coordinateIds[3], "Units", 6, "Meters");
+}
+
+// A moment with its own unit, symbol and colormap, chunked in blocks of rays
+static int sweepFileDefineMoment(const int ncid, const int *dimensionIds, const size_t rayCount, const size_t gateCount, const RKProductDesc *desc) {
+    int variableId;
+    const float missing = W2_MISSING_DATA;
+    const size_t chunkSizes[] = {rayCount == NC_UNLIMITED ? RKSweepFileChunkRayCount : MIN(RKSweepFileChunkRayCount, rayCount), gateCount};
+    nc_def_var(ncid, desc->name, NC_FLOAT, 2, dimensionIds, &variableId);
+    nc_def_var_chunking(ncid, variableId, NC_CHUNKED, chunkSizes);
+    nc_def_var_deflate(ncid, variableId, 1, 1, RKSweepFileDeflateLevel);
+    nc_put_att_float(ncid, variableId, "_FillValue", NC_FLOAT, 1, &missing);
+    nc_put_att_text(ncid, variableId, "Units", strlen(desc->unit), desc->unit);
+    nc_put_att_text(ncid, variableId, "Symbol", strlen(desc->symbol), desc->symbol);
+    nc_put_att_text(ncid, variableId, "ColorMap", strlen(desc->colormap), desc->colormap);
+    return variableId;
+}
+
+//
+// Write all the products of a sweep into one file. The products share the dimensions, the ray angles and the
+// global attributes, which come from the first product. Moments are chunked in blocks of rays so that a ray
+// can be read without inflating the entire sweep.
+//
+int RKSweepFileWriterNC(RKProduct **products, const uint32_t count, const char *filename) {
+    int j, k;
+    int ncid;
+    int dimensionIds[2];
+    int coordinateIds[4];
+    int variableIds[RKMaximumProductCount];
+
+    float *x;
+
+    if (count == 0 || products == NULL || products[0] == NULL) {
+        return RKResultNullInput;
+    }
 
-        RKLog("%s %s (*)\n", name, filename);
+    RKProduct *product = products[0];
+    RKProduct *moments[RKMaximumProductCount];
+    char symbolList[RKMaximumStringLength];
+    uint32_t momentCount = 0;
+
+    // Only products with the same dimensions can share the file
+    symbolList[0] = '\0';
+    for (k = 0; k < count && momentCount < RKMaximumProductCount; k++) {
+        if (products[k]->header.rayCount != product->header.rayCount || products[k]->header.gateCount != product->header.gateCount) {
+            RKLog("Warning. Product %s (%d x %d) does not fit the sweep (%d x %d).\n", products[k]->desc.symbol,
+                  products[k]->header.rayCount, products[k]->header.gateCount, product->header.rayCount, product->header.gateCount);
+            continue;
+        }
+        snprintf(symbolList + strlen(symbolList), RKMaximumStringLength - strlen(symbolList), "%s%s",
+                 momentCount ? " " : "", products[k]->desc.symbol);
+        moments[momentCount++] = products[k];
+    }
 
-        // Product
-        r = nc_inq_varid(ncid, productNames[k], &tmpId);
-        if (r != NC_NOERR) {
-            RKLog("Base moment %s not found.\n", productNames[k]);
+    // Local memory, everything that does not involve the library is prepared before taking the lock
+    float *beamWidth = (float *)malloc(product->header.rayCount * sizeof(float));
+    float *gateWidth = (float *)malloc(product->header.rayCount * sizeof(float));
+    for (j = 0; j < product->header.rayCount; j++) {
+        beamWidth[j] = RKUMinDiff(product->endAzimuth[j], product->startAzimuth[j]);
+        gateWidth[j] = product->header.gateSizeMeters;
+    }
+    for (k = 0; k < momentCount; k++) {
+        if (moments[k]->flag & RKProductStatusView) {
             continue;
         }
-        nc_get_var_float(ncid, tmpId, scratch);
-        fp = (float *)scratch;
-        for (j = 0; j < rayCount * gateCount; j++) {
-            if (*fp == w2_missing_data || *fp == w2_range_folded) {
-                *fp = NAN;
+        x = moments[k]->data;
+        for (j = 0; j < product->header.rayCount * product->header.gateCount; j++) {
+            if (!isfinite(*x)) {
+                *x = W2_MISSING_DATA;
             }
-            fp++;
+            x++;
         }
-        for (j = 0; j < rayCount; j++) {
-            ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-            fp = RKGetFloatDataFromRay(ray, productIndices[k]);
-            memcpy(fp, scratch + j * gateCount * sizeof(float), gateCount * sizeof(float));
+    }
+
+    RKProductFileLock();
+
+    // Chunking and deflate need the NetCDF-4 format
+    if ((j = nc_create(filename, NC_NETCDF4 | NC_CLOBBER, &ncid)) > 0) {
+        RKProductFileUnlock();
+        RKLog("Error. Unable to create %s", filename);
+        free(beamWidth);
+        free(gateWidth);
+        return RKResultFailedToOpenFileForProduct;
+    }
+
+    sweepFileDefineDimensions(ncid, product->header.isPPI, product->header.isRHI, product->header.rayCount, product->header.gateCount,
+                              dimensionIds, coordinateIds);
+    for (k = 0; k < momentCount; k++) {
+        variableIds[k] = sweepFileDefineMoment(ncid, dimensionIds, product->header.rayCount, product->header.gateCount, &moments[k]->desc);
+    }
+    RKProductFilePutGlobalAttributes(ncid, product, symbolList);
+
+    // NetCDF definition ends here
+    nc_enddef(ncid);
+
+    // Data
+    nc_put_var_float(ncid, coordinateIds[0], product->startAzimuth);
+    nc_put_var_float(ncid, coordinateIds[1], product->startElevation);
+    nc_put_var_float(ncid, coordinateIds[2], beamWidth);
+    nc_put_var_float(ncid, coordinateIds[3], gateWidth);
+    for (k = 0; k < momentCount; k++) {
+        if (moments[k]->flag & RKProductStatusView) {
+            RKProductFilePutVariable(ncid, variableIds[k], moments[k]);
+        } else {
+            nc_put_var_float(ncid, variableIds[k], moments[k]->data);
         }
-        nc_close(ncid);
     }
 
-    // We are done with the scratch space at this point, we can free it
-    free(scratch);
+    nc_close(ncid);
 
-    // This really should not happen
-    if (sweep == NULL) {
-        RKLog("%s Inconsistent state towards the end.\n", name);
+    RKProductFileUnlock();
+
+    free(beamWidth);
+    free(gateWidth);
+
+    return RKResultSuccess;
+}
+
+#pragma mark - Stream
+
+// Write the queued rays to the file, every completed block of rays is deflated and flushed right away
+static void *sweepFileStreamWriter(void *in) {
+    RKSweepFileStream *stream = (RKSweepFileStream *)in;
+
+    int k;
+    float *x;
+
+    const size_t count[] = {1, stream->gateCount};
+
+    RKProductFileLock();
+    if (nc_create(stream->filename, NC_NETCDF4 | NC_CLOBBER, &stream->ncid) != NC_NOERR) {
+        RKLog("Error. Unable to create %s\n", stream->filename);
+        stream->ncid = -1;
+        stream->result = RKResultFailedToOpenFileForProduct;
+    } else {
+        sweepFileDefineDimensions(stream->ncid, stream->isPPI, stream->isRHI, NC_UNLIMITED, stream->gateCount, stream->dimensionIds, stream->coordinateIds);
+        for (k = 0; k < stream->momentCount; k++) {
+            stream->variableIds[k] = sweepFileDefineMoment(stream->ncid, stream->dimensionIds, NC_UNLIMITED, stream->gateCount, &stream->momentDescriptions[k]);
+        }
+        nc_enddef(stream->ncid);
+    }
+    RKProductFileUnlock();
+
+    pthread_mutex_lock(&stream->mutex);
+    while (true) {
+        while (stream->writtenRayCount == stream->rayCount && stream->active) {
+            pthread_cond_wait(&stream->rayQueued, &stream->mutex);
+        }
+        if (stream->writtenRayCount == stream->rayCount) {
+            break;
+        }
+        const size_t start[] = {stream->writtenRayCount, 0};
+        const bool skip = stream->discarded || stream->result != RKResultSuccess;
+        x = stream->queue + (stream->writtenRayCount % RKSweepFileStreamQueueDepth) * stream->queueSlotSize;
+        pthread_mutex_unlock(&stream->mutex);
+
+        if (!skip) {
+            RKProductFileLock();
+            for (k = 0; k < 4; k++) {
+                nc_put_var1_float(stream->ncid, stream->coordinateIds[k], start, &x[k]);
+            }
+            for (k = 0; k < stream->momentCount; k++) {
+                nc_put_vara_float(stream->ncid, stream->variableIds[k], start, count, x + 4 + k * stream->gateCount);
+            }
+            if ((start[0] + 1) % RKSweepFileChunkRayCount == 0) {
+                nc_sync(stream->ncid);
+            }
+            RKProductFileUnlock();
+        }
+
+        pthread_mutex_lock(&stream->mutex);
+        stream->writtenRayCount++;
+        pthread_cond_signal(&stream->rayWritten);
+    }
+    pthread_mutex_unlock(&stream->mutex);
+    return NULL;
+}
+
+// Stop taking rays, wait for the writer to empty the queue and retire it
+static void sweepFileStreamConclude(RKSweepFileStream *stream, const bool discard) {
+    pthread_mutex_lock(&stream->mutex);
+    stream->active = false;
+    stream->discarded = discard;
+    pthread_cond_signal(&stream->rayQueued);
+    pthread_mutex_unlock(&stream->mutex);
+    pthread_join(stream->tidWriter, NULL);
+}
+
+static void sweepFileStreamFree(RKSweepFileStream *stream) {
+    pthread_mutex_destroy(&stream->mutex);
+    pthread_cond_destroy(&stream->rayQueued);
+    pthread_cond_destroy(&stream->rayWritten);
+    free(stream->queue);
+    free(stream);
+}
+
+//
+// Open a sweep file that receives the base moments of the products as the rays arrive. Products that are not
+// base moments are left for RKSweepFileStreamFinish(). Rays are appended along an unlimited dimension by a
+// writer thread, so the caller never waits for the library and the work is spread over the sweep.
+//
+RKSweepFileStream *RKSweepFileStreamOpen(const char *filename, const RKProductDesc *descs, const uint32_t count, const uint32_t gateCount,
+                                         const bool isPPI, const bool isRHI, const bool convertToDegrees) {
+    int j, k;
+
+    RKSweepFileStream *stream = (RKSweepFileStream *)malloc(sizeof(RKSweepFileStream));
+    if (stream == NULL) {
+        RKLog("Error. Unable to allocate a sweep file stream.\n");
+        return NULL;
+    }
+    memset(stream, 0, sizeof(RKSweepFileStream));
+    strncpy(stream->filename, filename, RKMaximumPathLength - 1);
+    stream->gateCount = gateCount;
+    stream->isPPI = isPPI;
+    stream->isRHI = isRHI;
+    for (k = 0; k < count && stream->momentCount < RKBaseMomentIndexCount; k++) {
+        for (j = 0; j < sizeof(symbols) / sizeof(symbols[0]); j++) {
+            if (!strcmp(descs[k].symbol, symbols[j])) {
+                break;
+            }
+        }
+        if (j == sizeof(symbols) / sizeof(symbols[0])) {
+            continue;
+        }
+        memcpy(&stream->momentDescriptions[stream->momentCount], &descs[k], sizeof(RKProductDesc));
+        stream->momentIndices[stream->momentCount] = productIndices[j];
+        stream->momentScales[stream->momentCount] = 1.0f;
+        if (convertToDegrees && !strcasecmp(descs[k].unit, "radians")) {
+            stream->momentScales[stream->momentCount] = 180.0f / M_PI;
+            sprintf(stream->momentDescriptions[stream->momentCount].unit, "Degrees");
+        }
+        stream->momentCount++;
+    }
+    stream->queueSlotSize = 4 + stream->momentCount * gateCount;
+    stream->queue = (float *)malloc(RKSweepFileStreamQueueDepth * stream->queueSlotSize * sizeof(float));
+    if (stream->momentCount == 0 || stream->queue == NULL) {
+        free(stream->queue);
+        free(stream);
+        return NULL;
+    }
+    stream->active = true;
+    stream->result = RKResultSuccess;
+    pthread_mutex_init(&stream->mutex, NULL);
+    pthread_cond_init(&stream->rayQueued, NULL);
+    pthread_cond_init(&stream->rayWritten, NULL);
+    if (pthread_create(&stream->tidWriter, NULL, sweepFileStreamWriter, stream)) {
+        RKLog("Error. Unable to launch a sweep file stream writer.\n");
+        sweepFileStreamFree(stream);
         return NULL;
     }
 
-    ray = RKGetRayFromBuffer(sweep->rayBuffer, 0);
+    return stream;
+}
 
-    sweep->header.rayCount = (uint32_t)rayCount;
-    sweep->header.gateCount = (uint32_t)gateCount;
-    sweep->header.gateSizeMeters = ray->header.gateSizeMeters;
-    sweep->header.baseMomentList = productList;
+// Copy a ray into the queue, only waits if the writer has fallen behind by the depth of the queue
+int RKSweepFileStreamAppendRay(RKSweepFileStream *stream, RKRay *ray) {
+    int j, k;
+    float *x, *y;
 
-    for (j = 0; j < rayCount; j++) {
-        ray = RKGetRayFromBuffer(sweep->rayBuffer, j);
-        ray->header.i += sweep->header.rayCount;
-        ray->header.s = RKRayStatusReady;
-        ray->header.baseMomentList = productList;
+    if (stream == NULL || ray == NULL) {
+        return RKResultNullInput;
     }
 
-    /*
-     RKLog("  -> %s%s%s%s%s%s%s\n",
-     productList & RKBaseMomentListProductZ ? "Z" : "",
-     productList & RKBaseMomentListProductV ? "V" : "",
-     productList & RKBaseMomentListProductW ? "W" : "",
-     productList & RKBaseMomentListProductD ? "D" : "",
-     productList & RKBaseMomentListProductP ? "P" : "",
-     productList & RKBaseMomentListProductR ? "R" : "",
-     productList & RKBaseMomentListProductK ? "K" : ""
-     );
-     */
+    const uint32_t gateCount = MIN(stream->gateCount, ray->header.gateCount);
 
-    return sweep;
+    pthread_mutex_lock(&stream->mutex);
+    while (stream->rayCount - stream->writtenRayCount >= RKSweepFileStreamQueueDepth) {
+        pthread_cond_wait(&stream->rayWritten, &stream->mutex);
+    }
+    pthread_mutex_unlock(&stream->mutex);
+
+    // The slot at rayCount is not read by the writer until rayCount advances
+    y = stream->queue + (stream->rayCount % RKSweepFileStreamQueueDepth) * stream->queueSlotSize;
+    *y++ = ray->header.startAzimuth;
+    *y++ = ray->header.startElevation;
+    *y++ = RKUMinDiff(ray->header.endAzimuth, ray->header.startAzimuth);
+    *y++ = ray->header.gateSizeMeters;
+    for (k = 0; k < stream->momentCount; k++) {
+        x = RKGetFloatDataFromRay(ray, stream->momentIndices[k]);
+        for (j = 0; j < gateCount; j++) {
+            *y++ = isfinite(*x) ? *x * stream->momentScales[k] : W2_MISSING_DATA;
+            x++;
+        }
+        for (; j < stream->gateCount; j++) {
+            *y++ = W2_MISSING_DATA;
+        }
+    }
+
+    pthread_mutex_lock(&stream->mutex);
+    if (stream->rayCount == 0) {
+        stream->firstRayIdentifier = ray->header.i;
+    }
+    stream->rayCount++;
+    pthread_cond_signal(&stream->rayQueued);
+    pthread_mutex_unlock(&stream->mutex);
+
+    return RKResultSuccess;
+}
+
+//
+// Conclude the stream with the other products of the sweep and the global attributes, which come from the
+// first product, then move the file to its final name. The stream is freed.
+//
+int RKSweepFileStreamFinish(RKSweepFileStream *stream, RKProduct **products, const uint32_t count, const char *filename) {
+    int j, k, m;
+    float *x;
+
+    if (stream == NULL || count == 0 || products == NULL || products[0] == NULL) {
+        RKSweepFileStreamDiscard(stream);
+        return RKResultNullInput;
+    }
+
+    // All the appended rays are in the file once the writer retires
+    sweepFileStreamConclude(stream, false);
+    if (stream->result != RKResultSuccess) {
+        m = stream->result;
+        RKSweepFileStreamDiscard(stream);
+        return m;
+    }
+
+    const size_t start[] = {0, 0};
+    const size_t edge[] = {stream->rayCount, stream->gateCount};
+
+    RKProduct *others[RKMaximumProductCount];
+    int otherIds[RKMaximumProductCount];
+    uint32_t otherCount = 0;
+    char symbolList[RKMaximumStringLength];
+
+    // Products that were not streamed and fit the sweep
+    symbolList[0] = '\0';
+    for (k = 0; k < stream->momentCount; k++) {
+        snprintf(symbolList + strlen(symbolList), RKMaximumStringLength - strlen(symbolList), "%s%s",
+                 k ? " " : "", stream->momentDescriptions[k].symbol);
+    }
+    for (k = 0; k < count && otherCount < RKMaximumProductCount; k++) {
+        for (m = 0; m < stream->momentCount; m++) {
+            if (!strcmp(products[k]->desc.name, stream->momentDescriptions[m].name)) {
+                break;
+            }
+        }
+        if (m < stream->momentCount) {
+            continue;
+        }
+        if (products[k]->header.rayCount != stream->rayCount || products[k]->header.gateCount != stream->gateCount) {
+            RKLog("Warning. Product %s (%d x %d) does not fit the sweep (%d x %d).\n", products[k]->desc.symbol,
+                  products[k]->header.rayCount, products[k]->header.gateCount, stream->rayCount, stream->gateCount);
+            continue;
+        }
+        if (!(products[k]->flag & RKProductStatusView)) {
+            x = products[k]->data;
+            for (j = 0; j < stream->rayCount * stream->gateCount; j++) {
+                if (!isfinite(*x)) {
+                    *x = W2_MISSING_DATA;
+                }
+                x++;
+            }
+        }
+        snprintf(symbolList + strlen(symbolList), RKMaximumStringLength - strlen(symbolList), " %s", products[k]->desc.symbol);
+        others[otherCount++] = products[k];
+    }
+
+    RKProductFileLock();
+
+    nc_redef(stream->ncid);
+    for (k = 0; k < otherCount; k++) {
+        otherIds[k] = sweepFileDefineMoment(stream->ncid, stream->dimensionIds, NC_UNLIMITED, stream->gateCount, &others[k]->desc);
+    }
+    RKProductFilePutGlobalAttributes(stream->ncid, products[0], symbolList);
+    nc_enddef(stream->ncid);
+    for (k = 0; k < otherCount; k++) {
+        if (others[k]->flag & RKProductStatusView) {
+            RKProductFilePutVariable(stream->ncid, otherIds[k], others[k]);
+        } else {
+            nc_put_vara_float(stream->ncid, otherIds[k], start, edge, others[k]->data);
+        }
+    }
+    k = nc_close(stream->ncid);
+
+    RKProductFileUnlock();
+
+    if (k != NC_NOERR) {
+        RKLog("Error. Unable to finish %s\n", stream->filename);
+        remove(stream->filename);
+        m = RKResultFailedToOpenFileForProduct;
+    } else if (rename(stream->filename, filename)) {
+        RKLog("Error. Unable to move %s to %s\n", stream->filename, filename);
+        m = RKResultFailedToOpenFileForProduct;
+    } else {
+        m = RKResultSuccess;
+    }
+    sweepFileStreamFree(stream);
+    return m;
+}
+
+void RKSweepFileStreamDiscard(RKSweepFileStream *stream) {
+    if (stream == NULL) {
+        return;
+    }
+    if (stream->active) {
+        sweepFileStreamConclude(stream, true);
+    }
+    if (stream->ncid >= 0) {
+        RKProductFileLock();
+        nc_close(stream->ncid);
+        RKProductFileUnlock();
+        remove(stream->filename);
+    }
+    sweepFileStreamFree(stream);
 }
@@ -45,7 +45,7 @@ static int string_cmp_by_filename(const void *a, const void *b) {
 #pragma mark - Test Wrapper and Help Text
 
 char *RKTestByNumberDescription(const int indent) {
-    static char text[4096];
+    static char text[8192];
     char helpText[] =
     " 0 - Show types\n"
     " 1 - Show colors\n"
@@ -68,6 +68,14 @@ char *RKTestByNumberDescription(const int indent) {
     "18 - Write a netcdf file using RKProductFileWriterNC()\n"
     "19 - RKTestReviseLogicalValues()\n"
     "20 - Reading a .rkc file; -T20 FILENAME\n"
+    "21 - Write two netcdf files at the same time\n"
+    "22 - Stream a sweep file ray by ray and read it back\n"
+    "23 - Read a range of rays and gates from sweep and product files\n"
+    "24 - Keep sweep references in the volume cache\n"
+    "25 - Relay pulses straight into the pulse buffer\n"
+    "26 - Grid a synthetic sweep - RKGridEngineGridSweep()\n"
+    "27 - Composite a synthetic volume - RKCompositeEngine\n"
+    "28 - Keep the latest health of the nodes - RKHealthEngineIngest()\n"
     "\n"
     "30 - SIMD quick test\n"
     "31 - SIMD test with numbers shown\n"
@@ -94,9 +102,16 @@ char *RKTestByNumberDescription(const int indent) {
     "60 - Measure the speed of SIMD calculations\n"
     "61 - Measure the speed of pulse compression\n"
     "62 - Measure the speed of various moment methods\n"
-    "63 - Measure the speed of cached write\n";
+    "63 - Measure the speed of cached write\n"
+    "\n"
+    "70 - Serve several clients with the worker pool - RKServer\n"
+    "71 - Gather several payloads into one message - RKOperatorSendPackets()\n"
+    "72 - Deflate payloads and inflate them back - RKOperatorSendCompressiblePackets()\n"
+    "73 - Drop the oldest messages of a slow client - RKOperatorSendPolicyDropOldest\n"
+    "74 - Resume the ray streams after an identifier - RKCommandCenter / RKRadarRelay\n"
+    "75 - Aggregate the ray streams of several radars - RKCommandCenter\n";
     RKIndentCopy(text, helpText, indent);
-    if (strlen(text) > 3000) {
+    if (strlen(text) > 7000) {
         fprintf(stderr, "Warning. Approaching limit. (%lu)\n", strlen(text));
     }
     return text;
@@ -186,6 +201,30 @@ void RKTestByNumber(const int number, const void *arg) {
             }
             RKTestReadIQ((char *)arg);
             break;
+        case 21:
+            RKTestProductWriteConcurrently();
+            break;
+        case 22:
+            RKTestSweepFileStream();
+            break;
+        case 23:
+            RKTestSweepFileReaderRange();
+            break;
+        case 24:
+            RKTestVolumeCache();
+            break;
+        case 25:
+            RKTestRadarRelayScatter();
+            break;
+        case 26:
+            RKTestGridEngine();
+            break;
+        case 27:
+            RKTestCompositeEngine();
+            break;
+        case 28:
+            RKTestHealthRecords();
+            break;
         case 30:
             RKTestSIMD(RKTestSIMDFlagNull);
             break;
@@ -265,6 +304,24 @@ void RKTestByNumber(const int number, const void *arg) {
         case 63:
             RKTestCacheWrite();
             break;
+        case 70:
+            RKTestServerWorkerPool();
+            break;
+        case 71:
+            RKTestServerGatherPackets();
+            break;
+        case 72:
+            RKTestServerCompression();
+            break;
+        case 73:
+            RKTestServerDropOldest();
+            break;
+        case 74:
+            RKTestResumeRayStream();
+            break;
+        case 75:
+            RKTestAggregateRayStreams();
+            break;
         case 99:
             RKTestExperiment();
             break;
@@ -455,6 +512,25 @@ void RKTestParseJSONString(void) {
            anyCritical ? criticalKey : ""
            );
 
+    printf("\n");
+    printf("Health records:\n");
+    printf("---------------\n");
+    RKHealthEngine *healthEngine = RKHealthEngineInit();
+    RKHealthEngineIngest(healthEngine, RKHealthNodeTransceiver, string);
+    bool recordCritical = RKHealthEngineFindCondition(healthEngine, RKHealthNodeInvalid, RKStatusEnumCritical, criticalKey, criticalValue);
+    RKHealthRecord record;
+    if (RKHealthEngineGetRecord(healthEngine, RKHealthEngineFindKey(healthEngine, "gps latitude"), &record)) {
+        printf("%s = %.7f (Enum %d)\n", record.name, record.number, record.statusEnum);
+    }
+    printf("anyCritical = %s%s%s%s%s\n",
+           rkGlobalParameters.showColor ? "\033[38;5;207m" : "",
+           recordCritical ? "true" : "false",
+           rkGlobalParameters.showColor ? RKNoColor : "",
+           recordCritical ? " --> " : "",
+           recordCritical ? criticalKey : ""
+           );
+    RKHealthEngineFree(healthEngine);
+
     printf("\n");
     char strObj[] = "0";
     stringObject = strObj;
@@ -807,6 +883,832 @@ void RKTestProductWrite(void) {
     RKProductBufferFree(product, 1);
 }
 
+typedef struct rk_test_product_job {
+    RKProduct        *product;
+    char             filename[64];
+    bool             packed;
+    int              result;
+    double           elapsed;
+} RKTestProductJob;
+
+static void *productWriteLoop(void *in) {
+    RKTestProductJob *job = (RKTestProductJob *)in;
+    struct timeval s, e;
+    gettimeofday(&s, NULL);
+    if (job->packed) {
+        job->result = RKProductFileWriterNCInt16(job->product, job->filename);
+    } else {
+        job->result = RKProductFileWriterNC(job->product, job->filename);
+    }
+    gettimeofday(&e, NULL);
+    job->elapsed = RKTimevalDiff(e, s);
+    return NULL;
+}
+
+void RKTestProductWriteConcurrently(void) {
+    SHOW_FUNCTION_NAME
+    int g, i, k;
+    float *v;
+    bool good, all_good = true;
+    struct timeval s, e;
+    pthread_t tid[2];
+    RKTestProductJob jobs[2];
+    const uint32_t rayCount = 360;
+    const uint32_t gateCount = 2000;
+
+    memset(jobs, 0, sizeof(jobs));
+    for (i = 0; i < 2; i++) {
+        RKTestProductJob *job = &jobs[i];
+        RKProductBufferAlloc(&job->product, 1, rayCount, gateCount);
+        RKProduct *product = job->product;
+        product->desc.type = RKProductTypePPI;
+        sprintf(product->desc.name, "Reflectivity");
+        sprintf(product->desc.unit, "dBZ");
+        sprintf(product->desc.colormap, "Reflectivity");
+        product->desc.mininimumValue = -32.0f;
+        product->desc.maximumValue = 96.0f;
+        sprintf(product->header.radarName, "RadarKit");
+        product->header.latitude = 35.23682;
+        product->header.longitude = -97.46381;
+        product->header.wavelength = 0.0314f;
+        product->header.sweepElevation = 2.4f;
+        product->header.rayCount = rayCount;
+        product->header.gateCount = gateCount;
+        product->header.gateSizeMeters = 30.0f;
+        product->header.prt[0] = 1.0e-3f;
+        product->header.isPPI = true;
+        product->header.startTime = 201443696;
+        product->header.endTime = 201443696 + 10;
+        for (k = 0; k < rayCount; k++) {
+            product->startAzimuth[k] = (float)k;
+            product->endAzimuth[k] = (float)(k + 1);
+            product->startElevation[k] = 2.4f;
+            product->endElevation[k] = 2.4f;
+        }
+        v = product->data;
+        for (k = 0; k < rayCount; k++) {
+            for (g = 0; g < gateCount; g++) {
+                *v++ = (float)((k * 7 + g * 13 + i * 5) % 1280) * 0.1f - 32.0f;
+            }
+        }
+        job->packed = i == 1;
+        sprintf(job->filename, "concurrent-%s.nc", job->packed ? "int16" : "float");
+    }
+
+    // One after another, then both at the same time
+    gettimeofday(&s, NULL);
+    for (i = 0; i < 2; i++) {
+        productWriteLoop(&jobs[i]);
+    }
+    gettimeofday(&e, NULL);
+    const double serialTime = RKTimevalDiff(e, s);
+    gettimeofday(&s, NULL);
+    for (i = 0; i < 2; i++) {
+        pthread_create(&tid[i], NULL, productWriteLoop, &jobs[i]);
+    }
+    for (i = 0; i < 2; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    gettimeofday(&e, NULL);
+    const double concurrentTime = RKTimevalDiff(e, s);
+    printf("Serial %.4f s    Concurrent %.4f s (%.4f s, %.4f s)\n", serialTime, concurrentTime, jobs[0].elapsed, jobs[1].elapsed);
+
+    // Read both back, floats should be exact, packed values within half of a quantization step
+    for (i = 0; i < 2; i++) {
+        RKTestProductJob *job = &jobs[i];
+        RKProduct *product = RKProductFileReaderNC(job->filename, false);
+        good = job->result == RKResultSuccess && product != NULL
+            && product->header.rayCount == rayCount && product->header.gateCount == gateCount;
+        if (good) {
+            const float tolerance = job->packed ? 0.5f * (job->product->desc.maximumValue - job->product->desc.mininimumValue) / 65534.0f + 1.0e-4f : 0.0f;
+            for (k = 0; k < rayCount * gateCount; k++) {
+                if (fabsf(product->data[k] - job->product->data[k]) > tolerance) {
+                    good = false;
+                    break;
+                }
+            }
+        }
+        all_good &= good;
+        printf("%s %s\n", job->filename, OXSTR(good));
+        if (product) {
+            RKProductBufferFree(product, 1);
+        }
+        RKProductBufferFree(job->product, 1);
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Two products written concurrently", all_good);
+}
+
+void RKTestSweepFileStream(void) {
+    SHOW_FUNCTION_NAME
+    int g, k, m;
+    float *x, *y;
+    bool good, all_good = true;
+    RKBuffer rayBuffer;
+    RKProduct *product;
+    RKProductDesc descs[2];
+    const char filename[] = "stream.nc";
+    const uint32_t rayCount = 45;
+    const uint32_t gateCount = 320;
+    const RKBaseMomentIndex indices[] = {RKBaseMomentIndexZ, RKBaseMomentIndexV};
+
+    // Rays of two moments, the ray count is not a multiple of the chunk size, more rays than the queue
+    RKRayBufferAlloc(&rayBuffer, gateCount, rayCount);
+    RKBaseMomentList momentList = RKBaseMomentListProductZ | RKBaseMomentListProductV;
+    descs[0] = RKGetNextProductDescription(&momentList);
+    descs[1] = RKGetNextProductDescription(&momentList);
+    for (k = 0; k < rayCount; k++) {
+        RKRay *ray = RKGetRayFromBuffer(rayBuffer, k);
+        ray->header.i = 1000 + k;
+        ray->header.gateCount = gateCount;
+        ray->header.gateSizeMeters = 30.0f;
+        ray->header.startAzimuth = (float)k;
+        ray->header.endAzimuth = (float)(k + 1);
+        ray->header.startElevation = 2.4f;
+        ray->header.endElevation = 2.4f;
+        for (m = 0; m < 2; m++) {
+            x = RKGetFloatDataFromRay(ray, indices[m]);
+            for (g = 0; g < gateCount; g++) {
+                *x++ = g % 17 == 0 ? NAN : (float)((k * 31 + g * 7 + m * 11) % 200) * 0.5f - 20.0f;
+            }
+        }
+    }
+
+    // A product that is not streamed, it goes in with the global attributes when the stream is finished
+    RKProductBufferAlloc(&product, 1, rayCount, gateCount);
+    sprintf(product->desc.name, "Extra");
+    sprintf(product->desc.symbol, "X");
+    sprintf(product->desc.unit, "Unitless");
+    sprintf(product->desc.colormap, "Default");
+    sprintf(product->header.radarName, "RadarKit");
+    product->header.rayCount = rayCount;
+    product->header.gateCount = gateCount;
+    product->header.gateSizeMeters = 30.0f;
+    product->header.wavelength = 0.0314f;
+    product->header.prt[0] = 1.0e-3f;
+    product->header.sweepElevation = 2.4f;
+    product->header.isPPI = true;
+    for (k = 0; k < rayCount * gateCount; k++) {
+        product->data[k] = (float)(k % 100);
+    }
+
+    RKSweepFileStream *stream = RKSweepFileStreamOpen(".stream.nc", descs, 2, gateCount, true, false, false);
+    good = stream != NULL;
+    for (k = 0; k < rayCount && good; k++) {
+        good = RKSweepFileStreamAppendRay(stream, RKGetRayFromBuffer(rayBuffer, k)) == RKResultSuccess;
+    }
+    good = good && stream->rayCount == rayCount && stream->firstRayIdentifier == 1000;
+    good = good && RKSweepFileStreamFinish(stream, &product, 1, filename) == RKResultSuccess;
+    printf("Open / append / finish %s\n", OXSTR(good));
+    all_good &= good;
+
+    // Read it back, the streamed moments and the concluding product should come out as they went in
+    RKSweep *sweep = good ? RKSweepFileRead(filename) : NULL;
+    good = sweep != NULL && sweep->header.rayCount == rayCount && sweep->header.gateCount == gateCount
+        && (sweep->header.baseMomentList & (RKBaseMomentListProductZ | RKBaseMomentListProductV)) == (RKBaseMomentListProductZ | RKBaseMomentListProductV);
+    for (k = 0; k < rayCount && good; k++) {
+        RKRay *ray = RKGetRayFromBuffer(rayBuffer, k);
+        good = sweep->rays[k]->header.startAzimuth == ray->header.startAzimuth;
+        for (m = 0; m < 2 && good; m++) {
+            x = RKGetFloatDataFromRay(ray, indices[m]);
+            y = RKGetFloatDataFromRay(sweep->rays[k], indices[m]);
+            for (g = 0; g < gateCount; g++) {
+                if (isfinite(x[g]) ? x[g] != y[g] : isfinite(y[g])) {
+                    good = false;
+                    break;
+                }
+            }
+        }
+    }
+    printf("Streamed moments read back %s\n", OXSTR(good));
+    all_good &= good;
+    if (sweep) {
+        RKSweepFree(sweep);
+    }
+    good = false;
+    int ncid, variableId;
+    if (nc_open(filename, NC_NOWRITE, &ncid) == NC_NOERR) {
+        float *data = (float *)malloc(rayCount * gateCount * sizeof(float));
+        good = nc_inq_varid(ncid, "Extra", &variableId) == NC_NOERR
+            && RKProductFileGetVariable(ncid, variableId, data, rayCount * gateCount) == NC_NOERR
+            && !memcmp(data, product->data, rayCount * gateCount * sizeof(float));
+        nc_close(ncid);
+        free(data);
+    }
+    printf("Concluding product read back %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKProductBufferFree(product, 1);
+    RKRayBufferFree(rayBuffer);
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Sweep file stream round trip", all_good);
+}
+
+static void rangeTestFill(RKProduct *product, const int m) {
+    int g, k;
+    for (k = 0; k < product->header.rayCount; k++) {
+        for (g = 0; g < product->header.gateCount; g++) {
+            product->data[k * product->header.gateCount + g] = g % 13 == 0 ? NAN : (float)((k * 17 + g * 3 + m * 5) % 240) * 0.5f - 40.0f;
+        }
+    }
+}
+
+void RKTestSweepFileReaderRange(void) {
+    SHOW_FUNCTION_NAME
+    int g, k, m, ncid, variableId;
+    float *x, *y;
+    bool good, all_good = true;
+    RKProduct *products;
+    const uint32_t rayCount = 90;
+    const uint32_t gateCount = 200;
+    const uint32_t rayOrigin = 30, rayRange = 20;
+    const uint32_t gateOrigin = 50, gateRange = 100;
+    const RKBaseMomentIndex indices[] = {RKBaseMomentIndexZ, RKBaseMomentIndexV};
+
+    // Two moments in one sweep file, the reflectivity in a packed product file
+    RKProductBufferAlloc(&products, 2, rayCount, gateCount);
+    RKBaseMomentList momentList = RKBaseMomentListProductZ | RKBaseMomentListProductV;
+    for (m = 0; m < 2; m++) {
+        RKProduct *product = &products[m];
+        product->desc = RKGetNextProductDescription(&momentList);
+        product->desc.mininimumValue = -40.0f;
+        product->desc.maximumValue = 80.0f;
+        sprintf(product->header.radarName, "RadarKit");
+        product->header.rayCount = rayCount;
+        product->header.gateCount = gateCount;
+        product->header.gateSizeMeters = 60.0f;
+        product->header.wavelength = 0.0314f;
+        product->header.prt[0] = 1.0e-3f;
+        product->header.sweepElevation = 0.5f;
+        product->header.isPPI = true;
+        for (k = 0; k < rayCount; k++) {
+            product->startAzimuth[k] = (float)k * 4.0f;
+            product->endAzimuth[k] = (float)(k + 1) * 4.0f;
+            product->startElevation[k] = 0.5f;
+            product->endElevation[k] = 0.5f;
+        }
+        rangeTestFill(product, m);
+    }
+    RKProduct *sweepProducts[] = {&products[0], &products[1]};
+    good = RKProductFileWriterNCInt16(&products[0], "range-Z.nc") == RKResultSuccess
+        && RKSweepFileWriterNC(sweepProducts, 2, "range.nc") == RKResultSuccess;
+    printf("Writing range.nc and range-Z.nc %s\n", OXSTR(good));
+    all_good &= good;
+
+    // The sweep writer puts the missing values in place of NAN, so the expected values are generated again
+    for (m = 0; m < 2; m++) {
+        rangeTestFill(&products[m], m);
+    }
+
+    // A range of rays and gates, moments are read when they are first needed
+    RKSweepFileReader *reader = RKSweepFileReaderInitWithRange("range.nc", rayOrigin, rayRange, gateOrigin, gateRange);
+    good = reader != NULL && reader->rayCount == rayRange && reader->gateCount == gateRange && reader->loadedMomentList == 0;
+    for (k = 0; k < rayRange && good; k++) {
+        good = reader->sweep->rays[k]->header.startAzimuth == products[0].startAzimuth[rayOrigin + k];
+        for (m = 0; m < 2 && good; m++) {
+            x = products[m].data + (rayOrigin + k) * gateCount + gateOrigin;
+            y = RKSweepFileReaderGetRayData(reader, indices[m], k);
+            if (y == NULL) {
+                good = false;
+                break;
+            }
+            for (g = 0; g < gateRange; g++) {
+                if (isfinite(x[g]) ? x[g] != y[g] : isfinite(y[g])) {
+                    good = false;
+                    break;
+                }
+            }
+        }
+    }
+    good = good && RKSweepFileReaderGetRayData(reader, indices[0], rayRange) == NULL;
+    printf("RKSweepFileReaderInitWithRange() rays %d-%d, gates %d-%d %s\n",
+           rayOrigin, rayOrigin + rayRange - 1, gateOrigin, gateOrigin + gateRange - 1, OXSTR(good));
+    all_good &= good;
+    RKSweepFileReaderFree(reader);
+
+    // The same range from the packed product, values within half of a quantization step
+    good = false;
+    if (nc_open("range-Z.nc", NC_NOWRITE, &ncid) == NC_NOERR) {
+        const size_t start[] = {rayOrigin, gateOrigin};
+        const size_t count[] = {rayRange, gateRange};
+        const float tolerance = 0.5f * (products[0].desc.maximumValue - products[0].desc.mininimumValue) / 65534.0f + 1.0e-4f;
+        float *data = (float *)malloc(rayRange * gateRange * sizeof(float));
+        good = nc_inq_varid(ncid, products[0].desc.name, &variableId) == NC_NOERR
+            && RKProductFileGetVariableRange(ncid, variableId, data, start, count) == NC_NOERR;
+        for (k = 0; k < rayRange && good; k++) {
+            x = products[0].data + (rayOrigin + k) * gateCount + gateOrigin;
+            y = data + k * gateRange;
+            for (g = 0; g < gateRange; g++) {
+                if (isfinite(x[g]) ? fabsf(x[g] - y[g]) > tolerance : isfinite(y[g])) {
+                    good = false;
+                    break;
+                }
+            }
+        }
+        nc_close(ncid);
+        free(data);
+    }
+    printf("RKProductFileGetVariableRange() packed int16 %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKProductBufferFree(products, 2);
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Reading a range of a sweep / product file", all_good);
+}
+
+static RKSweep *volumeTestSweep(const float elevation, const time_t startTime) {
+    int j;
+    RKSweep *sweep = (RKSweep *)malloc(sizeof(RKSweep));
+    memset(sweep, 0, sizeof(RKSweep));
+    RKRayBufferAlloc(&sweep->rayBuffer, 64, 16);
+    for (j = 0; j < 16; j++) {
+        sweep->rays[j] = RKGetRayFromBuffer(sweep->rayBuffer, j);
+        sweep->rays[j]->header.gateCount = 64;
+    }
+    sweep->header.rayCount = 16;
+    sweep->header.gateCount = 64;
+    sweep->header.startTime = startTime;
+    sweep->header.endTime = startTime + 10;
+    sweep->header.isPPI = true;
+    sweep->header.config.sweepElevation = elevation;
+    sweep->referenceCount = 1;
+    return sweep;
+}
+
+void RKTestVolumeCache(void) {
+    SHOW_FUNCTION_NAME
+    int k;
+    bool good, all_good = true;
+    RKSweep *sweeps[6];
+    RKVolume *volume, *held;
+
+    RKVolumeEngine *engine = RKVolumeEngineInit();
+    RKVolumeEngineSetVerbose(engine, 1);
+
+    // Three volumes of two sweeps, a new volume starts when the elevation goes back down
+    for (k = 0; k < 6; k++) {
+        sweeps[k] = volumeTestSweep(k % 2 ? 1.5f : 0.5f, 1000 + 20 * k);
+    }
+
+    // The cache is off by default
+    RKVolumeEngineAddSweep(engine, sweeps[0]);
+    volume = RKVolumeEngineAcquireVolume(engine, 0);
+    good = engine->depth == 0 && volume == NULL && sweeps[0]->referenceCount == 1;
+    printf("Cache is off by default %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKVolumeEngineSetDepth(engine, 2);
+    for (k = 0; k < 6; k++) {
+        RKVolumeEngineAddSweep(engine, sweeps[k]);
+    }
+    const size_t sweepSize = (engine->memoryUsage - sizeof(RKVolumeEngine)) / 4;
+    held = RKVolumeEngineAcquireVolume(engine, 0);
+    volume = RKVolumeEngineAcquireCompleteVolume(engine);
+    good = engine->volumeCount == 2
+        && held && held->header.sweepCount == 2 && held->sweeps[0] == sweeps[4] && held->sweeps[1] == sweeps[5]
+        && volume && volume->header.complete && volume->sweeps[0] == sweeps[2] && volume->sweeps[1] == sweeps[3]
+        && sweeps[0]->referenceCount == 1 && sweeps[1]->referenceCount == 1
+        && sweeps[2]->referenceCount == 2 && sweeps[5]->referenceCount == 2;
+    printf("Volumes refer to the sweeps, the oldest one is let go %s\n", OXSTR(good));
+    all_good &= good;
+    RKVolumeEngineReleaseVolume(engine, volume);
+
+    // A limit of one and a half sweeps drops the previous volume and the first sweep of the current one
+    RKVolumeEngineSetMemoryLimit(engine, sweepSize * 3 / 2);
+    volume = RKVolumeEngineAcquireVolume(engine, 0);
+    good = engine->volumeCount == 1
+        && volume && volume != held && volume->header.sweepCount == 1 && volume->sweeps[0] == sweeps[5]
+        && held->header.sweepCount == 2 && held->sweeps[0] == sweeps[4]
+        && sweeps[2]->referenceCount == 1 && sweeps[4]->referenceCount == 2 && sweeps[5]->referenceCount == 3
+        && engine->memoryUsage == sizeof(RKVolumeEngine) + sweepSize;
+    printf("Current volume is trimmed to the memory limit, the held volume is intact %s\n", OXSTR(good));
+    all_good &= good;
+    RKVolumeEngineReleaseVolume(engine, volume);
+    RKVolumeEngineReleaseVolume(engine, held);
+
+    // Sweeps that do not own their rays cannot be kept
+    sweeps[0]->header.external = true;
+    good = RKVolumeEngineAddSweep(engine, sweeps[0]) != RKResultSuccess && sweeps[0]->referenceCount == 1;
+    sweeps[0]->header.external = false;
+    printf("External sweep is refused %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKVolumeEngineFree(engine);
+    good = true;
+    for (k = 0; k < 6; k++) {
+        good &= sweeps[k]->referenceCount == 1;
+        RKRayBufferFree(sweeps[k]->rayBuffer);
+        free(sweeps[k]);
+    }
+    printf("All references are returned %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Volume cache of sweep references", all_good);
+}
+
+#define RELAY_TEST_PORT          10099
+#define RELAY_TEST_PULSE_COUNT   8
+
+static int relayTestPulseCount = 0;
+
+static uint32_t relayTestGateCount(const int k) {
+    return k % 2 ? 600 : 1200;
+}
+
+static void relayTestFill(RKInt16C *x, const uint32_t gateCount, const int k, const int p) {
+    for (uint32_t g = 0; g < gateCount; g++) {
+        x[g].i = (int16_t)(100 * k + g);
+        x[g].q = (int16_t)(p ? -g : g);
+    }
+}
+
+static int relayTestCommandHandler(RKOperator *O) {
+    return RKResultSuccess;
+}
+
+// Pulses with more and fewer gates than the relay can keep, all of them in the first pass
+static int relayTestStreamHandler(RKOperator *O) {
+    RKPulseHeader header;
+    RKInt16C h[1200], v[1200];
+    while (relayTestPulseCount < RELAY_TEST_PULSE_COUNT) {
+        const int k = relayTestPulseCount++;
+        memset(&header, 0, sizeof(RKPulseHeader));
+        header.i = k;
+        header.s = RKPulseStatusHasIQData;
+        header.gateCount = relayTestGateCount(k);
+        header.capacity = header.gateCount;
+        relayTestFill(h, header.gateCount, k, 0);
+        relayTestFill(v, header.gateCount, k, 1);
+        O->delimTx.type = RKNetworkPacketTypePulseData;
+        O->delimTx.size = (uint32_t)(sizeof(RKPulseHeader) + 2 * header.gateCount * sizeof(RKInt16C));
+        RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), &header, sizeof(RKPulseHeader),
+                              h, header.gateCount * sizeof(RKInt16C), v, header.gateCount * sizeof(RKInt16C), NULL);
+    }
+    return RKResultSuccess;
+}
+
+void RKTestRadarRelayScatter(void) {
+    SHOW_FUNCTION_NAME
+    int k, s;
+    bool good, all_good = true;
+    RKName host;
+    const uint32_t capacity = 1024;
+    uint32_t pulseIndex = 0, rayIndex = 0;
+    RKBuffer pulses, rays;
+    RKInt16C x[1200];
+
+    RKPulseBufferAlloc(&pulses, capacity, 16);
+    RKRayBufferAlloc(&rays, 64, 4);
+    RKRadarDesc desc;
+    memset(&desc, 0, sizeof(RKRadarDesc));
+    desc.pulseBufferDepth = 16;
+    desc.rayBufferDepth = 4;
+
+    relayTestPulseCount = 0;
+    RKServer *server = RKServerInit();
+    RKServerSetName(server, "<RelayTestServer>");
+    RKServerSetPort(server, RELAY_TEST_PORT);
+    RKServerSetWelcomeHandler(server, NULL);
+    RKServerSetCommandHandler(server, &relayTestCommandHandler);
+    RKServerSetStreamHandler(server, &relayTestStreamHandler);
+    RKServerSetTerminateHandler(server, NULL);
+    RKServerStart(server);
+
+    RKRadarRelay *relay = RKRadarRelayInit();
+    RKRadarRelaySetInputOutputBuffers(relay, &desc, NULL, NULL, NULL, NULL, NULL, NULL, NULL, pulses, &pulseIndex, rays, &rayIndex);
+    snprintf(host, RKNameLength, "localhost:%d", RELAY_TEST_PORT);
+    RKRadarRelaySetHost(relay, host);
+    good = relay->compression == RKNetworkCompressionNone;
+    printf("Relay asks for no compression by default %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKRadarRelayStart(relay);
+    s = 0;
+    while (pulseIndex < RELAY_TEST_PULSE_COUNT && s++ < 300) {
+        usleep(10000);
+    }
+    good = pulseIndex == RELAY_TEST_PULSE_COUNT && relay->pulseScatterCount == RELAY_TEST_PULSE_COUNT;
+    printf("Pulses are scattered into the pulse buffer %s\n", OXSTR(good));
+    all_good &= good;
+    RKRadarRelayStop(relay);
+    RKServerStop(server);
+    RKServerWait(server);
+
+    // Gates beyond the capacity are thrown away, the rest are in place with the header of the upstream
+    good = pulseIndex == RELAY_TEST_PULSE_COUNT;
+    for (k = 0; k < RELAY_TEST_PULSE_COUNT && good; k++) {
+        RKPulse *pulse = RKGetPulseFromBuffer(pulses, k);
+        const uint32_t gateCount = MIN(relayTestGateCount(k), capacity);
+        good = pulse->header.i == k && pulse->header.gateCount == gateCount && pulse->header.capacity == capacity
+            && pulse->header.s == RKPulseStatusHasIQData;
+        relayTestFill(x, gateCount, k, 0);
+        good &= memcmp(RKGetInt16CDataFromPulse(pulse, 0), x, gateCount * sizeof(RKInt16C)) == 0;
+        relayTestFill(x, gateCount, k, 1);
+        good &= memcmp(RKGetInt16CDataFromPulse(pulse, 1), x, gateCount * sizeof(RKInt16C)) == 0;
+    }
+    printf("Scattered samples and headers are intact %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKRadarRelayFree(relay);
+    RKServerFree(server);
+    RKPulseBufferFree(pulses);
+    RKRayBufferFree(rays);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Radar relay scatter path", all_good);
+}
+
+#define GRID_TEST_RAY_COUNT      360
+#define GRID_TEST_GATE_COUNT     208
+#define GRID_TEST_GATE_SIZE      100.0f
+#define GRID_TEST_WIDTH          209
+#define GRID_TEST_CELL_SIZE      200.0f
+
+// A PPI of reflectivity that goes up with range and velocity that goes with the cosine of azimuth
+static RKSweep *gridTestSweep(void) {
+    int g, k;
+    float *z, *v;
+    RKSweep *sweep = (RKSweep *)malloc(sizeof(RKSweep));
+    memset(sweep, 0, sizeof(RKSweep));
+    RKRayBufferAlloc(&sweep->rayBuffer, GRID_TEST_GATE_COUNT, GRID_TEST_RAY_COUNT);
+    for (k = 0; k < GRID_TEST_RAY_COUNT; k++) {
+        RKRay *ray = RKGetRayFromBuffer(sweep->rayBuffer, k);
+        ray->header.gateCount = GRID_TEST_GATE_COUNT;
+        ray->header.gateSizeMeters = GRID_TEST_GATE_SIZE;
+        ray->header.startAzimuth = (float)k;
+        ray->header.endAzimuth = (float)(k + 1);
+        ray->header.startElevation = 0.5f;
+        ray->header.endElevation = 0.5f;
+        z = RKGetFloatDataFromRay(ray, RKBaseMomentIndexZ);
+        v = RKGetFloatDataFromRay(ray, RKBaseMomentIndexV);
+        for (g = 0; g < GRID_TEST_GATE_COUNT; g++) {
+            z[g] = g == 100 ? NAN : 0.1f * (float)g;
+            v[g] = 10.0f * cosf(((float)k + 0.5f) * M_PI / 180.0f);
+        }
+        sweep->rays[k] = ray;
+    }
+    sweep->header.rayCount = GRID_TEST_RAY_COUNT;
+    sweep->header.gateCount = GRID_TEST_GATE_COUNT;
+    sweep->header.gateSizeMeters = GRID_TEST_GATE_SIZE;
+    sweep->header.baseMomentList = RKBaseMomentListProductZ | RKBaseMomentListProductV;
+    sweep->header.isPPI = true;
+    sweep->header.config.sweepElevation = 0.5f;
+    return sweep;
+}
+
+void RKTestGridEngine(void) {
+    SHOW_FUNCTION_NAME
+    int i, j, k;
+    float x, y, f, e;
+    bool good, all_good = true;
+    const int cellCount = GRID_TEST_WIDTH * GRID_TEST_WIDTH;
+    const float c = 0.5f * (float)(GRID_TEST_WIDTH - 1);
+
+    RKSweep *sweep = gridTestSweep();
+    RKGridEngine *engine = RKGridEngineInit();
+    RKGridEngineSetGrid(engine, GRID_TEST_WIDTH, GRID_TEST_WIDTH, GRID_TEST_CELL_SIZE);
+    RKGridEngineSetWorkerCount(engine, 4);
+    RKGridEngineStart(engine);
+
+    good = RKGridEngineGridSweep(engine, sweep) == RKResultSuccess;
+    RKFloat *z = RKGridEngineGetData(engine, RKBaseMomentIndexZ);
+    RKFloat *v = RKGridEngineGetData(engine, RKBaseMomentIndexV);
+    good &= z != NULL && v != NULL && RKGridEngineGetData(engine, RKBaseMomentIndexW) == NULL;
+    printf("Gridded moments are the ones in the sweep %s\n", OXSTR(good));
+    all_good &= good;
+
+    // Cells within the range are interpolated, the NAN gate is left out, the corners are out of range
+    bool inside = true, outside = true, zGood = true, vGood = true;
+    for (k = 0; k < cellCount && good; k++) {
+        i = k % GRID_TEST_WIDTH;
+        j = k / GRID_TEST_WIDTH;
+        x = ((float)i - c) * GRID_TEST_CELL_SIZE;
+        y = (c - (float)j) * GRID_TEST_CELL_SIZE;
+        f = sqrtf(x * x + y * y) / GRID_TEST_GATE_SIZE;
+        if (f > (float)(GRID_TEST_GATE_COUNT - 1)) {
+            outside &= isnan(z[k]) && isnan(v[k]);
+            continue;
+        }
+        // Only a cell right on the NAN gate has no other sample to go with
+        inside &= (isfinite(z[k]) || f == 100.0f) && isfinite(v[k]);
+        if (fabsf(f - 100.0f) > 1.0f) {
+            zGood &= fabsf(z[k] - 0.1f * f) < 1.0e-3f;
+        }
+        if (f > 10.0f) {
+            e = 10.0f * y / (f * GRID_TEST_GATE_SIZE);
+            vGood &= fabsf(v[k] - e) < 0.2f;
+        }
+    }
+    good &= inside && outside && zGood && vGood;
+    printf("Cells in range %s   out of range %s   Z %s   V %s\n", OXSTR(inside), OXSTR(outside), OXSTR(zGood), OXSTR(vGood));
+    all_good &= good;
+
+    // The same sweep geometry reuses the cached table, one worker gets the same cells
+    RKFloat *copy = (RKFloat *)malloc(cellCount * sizeof(RKFloat));
+    memcpy(copy, z, cellCount * sizeof(RKFloat));
+    RKGridEngineStop(engine);
+    RKGridEngineSetWorkerCount(engine, 1);
+    RKGridEngineStart(engine);
+    good = RKGridEngineGridSweep(engine, sweep) == RKResultSuccess;
+    for (j = 0, k = 0; k < RKGridEngineTableSlotCount; k++) {
+        j += engine->tables[k].gate != NULL;
+    }
+    good &= j == 1 && !memcmp(copy, RKGridEngineGetData(engine, RKBaseMomentIndexZ), cellCount * sizeof(RKFloat));
+    printf("Cached table and a single worker give the same cells %s\n", OXSTR(good));
+    all_good &= good;
+
+    free(copy);
+    RKGridEngineFree(engine);
+    RKRayBufferFree(sweep->rayBuffer);
+    free(sweep);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Grid engine output of a synthetic sweep", all_good);
+}
+
+#define COMPOSITE_TEST_GATE_COUNT     208
+#define COMPOSITE_TEST_GATE_SIZE      100.0f
+#define COMPOSITE_TEST_RAY_COUNT      720
+
+// Beam height (km) of a gate with the 4/3 earth model
+static double compositeTestHeight(const int gate, const float elevation) {
+    const double R = 4.0 / 3.0 * 6371.0;
+    const double r = 1.0e-3 * gate * COMPOSITE_TEST_GATE_SIZE;
+    return sqrt(r * r + R * R + 2.0 * r * R * sin(elevation * M_PI / 180.0)) - R;
+}
+
+// Reflectivity of the two sweeps, 30 dBZ at 0.5 deg, 45 dBZ over azimuth 90 - 180 and 10 dBZ elsewhere at 1.5 deg
+static float compositeTestZ(const int sweep, const int bin) {
+    return sweep == 0 ? 30.0f : (bin >= 90 && bin < 180 ? 45.0f : 10.0f);
+}
+
+static float compositeTestLiquid(const float z) {
+    return 3.44e-3f * powf(10.0f, (0.4f / 7.0f) * z);
+}
+
+void RKTestCompositeEngine(void) {
+    SHOW_FUNCTION_NAME
+    int b, g, k, s;
+    float *z, h0, h1, z0, z1, e;
+    bool good, all_good = true;
+    uint32_t rayIndex = 0;
+    RKBuffer rayBuffer;
+    RKProduct *products;
+    RKRadarDesc desc;
+
+    memset(&desc, 0, sizeof(RKRadarDesc));
+    desc.rayBufferDepth = 1024;
+    RKRayBufferAlloc(&rayBuffer, COMPOSITE_TEST_GATE_COUNT, desc.rayBufferDepth);
+    RKProductBufferAlloc(&products, RKMaximumProductCount, 1, 16);
+    RKConfig *config = (RKConfig *)malloc(sizeof(RKConfig));
+    memset(config, 0, sizeof(RKConfig));
+    config->startMarker = RKMarkerScanTypePPI;
+    uint32_t configIndex = 0;
+
+    // The sweep engine is not started, it only keeps the product registry
+    RKSweepEngine *sweepEngine = RKSweepEngineInit();
+    RKSweepEngineSetInputOutputBuffer(sweepEngine, &desc, NULL, config, &configIndex, rayBuffer, &rayIndex, products, NULL);
+
+    RKCompositeEngine *engine = RKCompositeEngineInit();
+    RKCompositeEngineSetInputOutputBuffers(engine, &desc, config, &configIndex, rayBuffer, &rayIndex, sweepEngine);
+    RKCompositeEngineSetProductList(engine, RKCompositeProductListAll);
+    RKCompositeEngineStart(engine);
+
+    good = engine->productIds[0] && engine->productIds[1] && engine->productIds[2];
+    printf("Products are registered with the sweep engine %s\n", OXSTR(good));
+    all_good &= good;
+
+    // Two sweeps of a volume, the last ray of the buffer is left for the engine to wait on
+    for (k = 0; k < COMPOSITE_TEST_RAY_COUNT; k++) {
+        s = k / 360;
+        b = k % 360;
+        RKRay *ray = RKGetRayFromBuffer(rayBuffer, k);
+        ray->header.i = k;
+        ray->header.configIndex = 0;
+        ray->header.marker = RKMarkerScanTypePPI | (k == 0 ? RKMarkerVolumeBegin : 0) | (b == 0 ? RKMarkerSweepBegin : 0);
+        ray->header.baseMomentList = RKBaseMomentListProductZ;
+        ray->header.gateCount = COMPOSITE_TEST_GATE_COUNT;
+        ray->header.gateSizeMeters = COMPOSITE_TEST_GATE_SIZE;
+        ray->header.sweepElevation = s == 0 ? 0.5f : 1.5f;
+        ray->header.startElevation = ray->header.sweepElevation;
+        ray->header.endElevation = ray->header.sweepElevation;
+        ray->header.startAzimuth = (float)b;
+        ray->header.endAzimuth = (float)(b + 1);
+        z = RKGetFloatDataFromRay(ray, RKBaseMomentIndexZ);
+        for (g = 0; g < COMPOSITE_TEST_GATE_COUNT; g++) {
+            z[g] = compositeTestZ(s, b);
+        }
+        ray->header.s = RKRayStatusReady;
+        rayIndex = k + 1;
+    }
+    s = 0;
+    while (engine->tic < COMPOSITE_TEST_RAY_COUNT + 1 && ++s < 500) {
+        usleep(10000);
+    }
+    good = engine->tic == COMPOSITE_TEST_RAY_COUNT + 1 && engine->volumeCount == 1 && engine->gateCount == COMPOSITE_TEST_GATE_COUNT;
+    printf("Rays are folded into one volume %s\n", OXSTR(good));
+    all_good &= good;
+
+    // Gates map to cells one for one, the higher sweep shows up only where it reaches the threshold
+    bool crGood = true, etGood = true, vilGood = true;
+    for (b = 0; b < RKCompositeEngineAzimuthBinCount; b++) {
+        z0 = compositeTestZ(0, b);
+        z1 = compositeTestZ(1, b);
+        for (g = 0; g < COMPOSITE_TEST_GATE_COUNT; g++) {
+            k = b * engine->capacity + g;
+            h0 = compositeTestHeight(g, 0.5f);
+            h1 = compositeTestHeight(g, 1.5f);
+            crGood &= engine->maxZ[k] == MAX(z0, z1);
+            e = z1 >= engine->echoTopThreshold ? h1 : h0;
+            etGood &= fabsf(engine->echoTop[k] - e) < 1.0e-4f;
+            e = 0.5f * (compositeTestLiquid(z0) + compositeTestLiquid(z1)) * (h1 - h0);
+            vilGood &= fabsf(engine->vil[k] - e) < 1.0e-3f * e + 1.0e-6f;
+        }
+    }
+    good = crGood && etGood && vilGood;
+    printf("CR %s   ET %s   VIL %s\n", OXSTR(crGood), OXSTR(etGood), OXSTR(vilGood));
+    all_good &= good;
+
+    RKCompositeEngineStop(engine);
+    good = engine->maxZ == NULL && products[0].flag == RKProductStatusVacant;
+    printf("Stopping releases the fields and the products %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKCompositeEngineFree(engine);
+    RKSweepEngineFree(sweepEngine);
+    RKProductBufferFree(products, RKMaximumProductCount);
+    RKRayBufferFree(rayBuffer);
+    free(config);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Composite engine output of a synthetic volume", all_good);
+}
+
+void RKTestHealthRecords(void) {
+    SHOW_FUNCTION_NAME
+    bool good, all_good = true;
+    char key[RKNameLength], value[RKNameLength];
+    char *string = (char *)malloc(RKMaximumStringLength);
+    RKHealthRecord record;
+    RKHealth health;
+    RKRadarDesc desc;
+
+    memset(&desc, 0, sizeof(RKRadarDesc));
+    desc.healthNodeCount = RKHealthNodeTweeta;
+    desc.heading = 12.5f;
+    RKHealthEngine *engine = RKHealthEngineInit();
+    RKHealthEngineSetInputOutputBuffers(engine, &desc, NULL, NULL, NULL);
+
+    RKHealthEngineIngest(engine, RKHealthNodeTransceiver,
+                         "{\"FPGA Temp\":{\"Value\":\"69.3degC\",\"Enum\":0}, \"PLL Locked\":{\"Value\":true,\"Enum\":2}, \"Count\":42}");
+    RKHealthEngineIngest(engine, RKHealthNodePedestal, "{\"GPS Heading\":{\"Value\":\"123.4 deg\",\"Enum\":0}}");
+
+    // Keys are found regardless of the case, the values are typed
+    RKHealthKey k = RKHealthEngineFindKey(engine, "fpga temp");
+    good = k != RKHealthKeyInvalid && RKHealthEngineGetRecord(engine, k, &record) && record.node == RKHealthNodeTransceiver
+        && record.type == RKHealthValueTypeString && fabs(record.number - 69.3) < 1.0e-9 && record.hasEnum && record.statusEnum == RKStatusEnumNormal;
+    good &= RKHealthEngineGetRecord(engine, RKHealthEngineFindKey(engine, "PLL Locked"), &record)
+        && record.type == RKHealthValueTypeBool && record.number == 1.0 && RKHealthEngineGetEnum(engine, RKHealthEngineFindKey(engine, "PLL Locked")) == RKStatusEnumFault;
+    good &= RKHealthEngineGetRecord(engine, RKHealthEngineFindKey(engine, "Count"), &record)
+        && record.type == RKHealthValueTypeNumber && record.number == 42.0 && !record.hasEnum;
+    good &= RKHealthEngineGetRecord(engine, RKHealthEngineFindKey(engine, "GPS Heading"), &record) && record.role == RKHealthKeyRoleHeading;
+    printf("Records are typed and found by key %s\n", OXSTR(good));
+    all_good &= good;
+
+    good = RKHealthEngineFindCondition(engine, RKHealthNodeTransceiver, RKStatusEnumFault, key, value) && !strcmp(key, "PLL Locked")
+        && !RKHealthEngineFindCondition(engine, RKHealthNodePedestal, RKStatusEnumFault, NULL, NULL);
+    printf("A fault is found in the node that reports it %s\n", OXSTR(good));
+    all_good &= good;
+
+    // A key that is no longer reported is gone, the keys of the other nodes stay
+    RKHealthEngineIngest(engine, RKHealthNodeTransceiver, "{\"FPGA Temp\":{\"Value\":\"70.1degC\",\"Enum\":1}}");
+    good = !RKHealthEngineGetRecord(engine, RKHealthEngineFindKey(engine, "PLL Locked"), &record)
+        && !RKHealthEngineFindCondition(engine, RKHealthNodeInvalid, RKStatusEnumFault, NULL, NULL)
+        && RKHealthEngineGetEnum(engine, RKHealthEngineFindKey(engine, "FPGA Temp")) == RKStatusEnumHigh
+        && RKHealthEngineGetRecord(engine, RKHealthEngineFindKey(engine, "GPS Heading"), &record);
+    printf("The latest health of a node replaces its keys %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKHealthEngineJSONString(engine, string, RKMaximumStringLength);
+    good = strstr(string, "\"FPGA Temp\":{\"Value\":\"70.1degC\",\"Enum\":1}") && strstr(string, "\"GPS Heading\"")
+        && !strstr(string, "PLL Locked") && strstr(string, "\"Log Time\":") && string[strlen(string) - 1] == '}';
+    printf("JSON of the records %s\n", OXSTR(good));
+    all_good &= good;
+
+    // A deferred health is written once, with its own time and the overrides that were decided for it
+    memset(&health, 0, sizeof(RKHealth));
+    health.time.tv_sec = 1700000000;
+    health.flag = RKHealthFlagReady | RKHealthFlagDeferred;
+    engine->headingOverride = true;
+    char *s = RKHealthEngineHealthString(engine, &health);
+    good = s == health.string && health.flag == RKHealthFlagReady && strstr(s, "\"Log Time\":1700000000}")
+        && strstr(s, "\"Sys Heading\":{\"Value\":\"12.50 deg\",\"Enum\":0}");
+    strcpy(string, s);
+    engine->headingOverride = false;
+    good &= !strcmp(RKHealthEngineHealthString(engine, &health), string);
+    printf("Deferred health string is produced on the first read %s\n", OXSTR(good));
+    all_good &= good;
+
+    RKHealthEngineFree(engine);
+    free(string);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Health record store", all_good);
+}
+
 void RKTestReviseLogicalValues(void) {
     SHOW_FUNCTION_NAME
     char string[] = "{"
@@ -822,10 +1724,10 @@ void RKTestReviseLogicalValues(void) {
 
 void RKTestReadIQ(const char *filename) {
     SHOW_FUNCTION_NAME
-    int i, j, k, p = 0;
+    int k, p = 0;
     size_t tr;
     time_t startTime;
-    size_t readsize, bytes, mem = 0;
+    size_t bytes, mem = 0;
     char timestr[32];
     long filesize = 0;
     uint32_t u32;
@@ -849,7 +1751,12 @@ void RKTestReadIQ(const char *filename) {
     RKConfig *config = &fileHeader->config;
     RKWaveform *waveform = NULL;
 
-    readsize = fread(fileHeader, sizeof(RKFileHeader), 1, fid);
+    if (fread(fileHeader, sizeof(RKFileHeader), 1, fid) != 1) {
+        RKLog("Error. Unable to read the file header.\n");
+        fclose(fid);
+        free(fileHeader);
+        return;
+    }
     if (fileHeader->buildNo <= 4) {
         RKLog("Error. Sorry but I wasn't programmed to read this. Ask my father.\n");
         return;
@@ -872,7 +1779,9 @@ void RKTestReadIQ(const char *filename) {
     RKLog(">fileHeader.preface = '%s'   buildNo = %d\n", fileHeader->preface, fileHeader->buildNo);
     RKLog(">fileHeader.dataType = '%s'\n",
            fileHeader->dataType == RKRawDataTypeFromTransceiver ? "Raw" :
-           (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter ? "Compressed" : "Unknown"));
+           (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter ? "Compressed" :
+            (fileHeader->dataType == RKRawDataTypeAfterMatchedFilterInt16 ? "Compressed, scaled int16" :
+             (fileHeader->dataType == RKRawDataTypeAfterMatchedFilterFloat16 ? "Compressed, float16" : "Unknown"))));
     RKLog(">desc.name = '%s'\n", fileHeader->desc.name);
     RKLog(">desc.latitude, longitude = %.6f, %.6f\n", fileHeader->desc.latitude, fileHeader->desc.longitude);
     RKLog(">desc.pulseCapacity = %s\n", RKIntegerToCommaStyleString(fileHeader->desc.pulseCapacity));
@@ -906,7 +1815,7 @@ void RKTestReadIQ(const char *filename) {
     const uint32_t rayCapacity = ((uint32_t)ceilf((float)fileHeader->desc.pulseCapacity / fileHeader->desc.pulseToRayRatio / (float)RKSIMDAlignSize)) * RKSIMDAlignSize;
     if (fileHeader->dataType == RKRawDataTypeFromTransceiver) {
         u32 = fileHeader->desc.pulseCapacity;
-    } else if (fileHeader->dataType == RKRawDataTypeAfterMatchedFilter) {
+    } else if (RKRawDataSampleSize(fileHeader->dataType)) {
         u32 = (uint32_t)ceilf((float)rayCapacity * sizeof(int16_t) / RKSIMDAlignSize) * RKSIMDAlignSize / sizeof(int16_t);
     } else {
         RKLog("Error. Unable to handle dataType %d", fileHeader->dataType);
@@ -930,15 +1839,16 @@ void RKTestReadIQ(const char *filename) {
         sprintf(sweepEndMarker, "%sE%s", RKGetColorOfIndex(2), RKNoColor);
     }
 
+    RKRawDataReader *reader = RKRawDataReaderInit(fid, fileHeader);
+    if (reader == NULL) {
+        exit(EXIT_FAILURE);
+    }
+
     for (k = 0; k < RKRawDataRecorderDefaultMaximumRecorderDepth; k++) {
         RKPulse *pulse = RKGetPulseFromBuffer(pulseBuffer, 0);
-        // Pulse header
-        readsize = fread(&pulse->header, sizeof(RKPulseHeader), 1, fid);
-        if (readsize != 1) {
+        if (RKRawDataReaderReadPulse(reader, pulse) != RKResultSuccess) {
             break;
         }
-        // Restore pulse capacity variable since we are not using whatever that was recorded in the file (radar)
-        pulse->header.capacity = pulseCapacity;
         if (pulse->header.downSampledGateCount > pulseCapacity) {
             printf("Error. Pulse contains %s gates / %s capacity allocated.\n",
                    RKIntegerToCommaStyleString(pulse->header.downSampledGateCount),
@@ -947,22 +1857,6 @@ void RKTestReadIQ(const char *filename) {
         startTime = pulse->header.time.tv_sec;
         tr = strftime(timestr, 24, "%F %T", gmtime(&startTime));
         tr += sprintf(timestr + tr, ".%06d", (int)pulse->header.time.tv_usec);
-        // Pulse payload of H and V data into channels 0 and 1, respectively. Also, copy to split-complex storage
-        for (j = 0; j < 2; j++) {
-            RKComplex *x = RKGetComplexDataFromPulse(pulse, j);
-            RKIQZ z = RKGetSplitComplexDataFromPulse(pulse, j);
-            readsize = fread(x, sizeof(RKComplex), pulse->header.downSampledGateCount, fid);
-            if (readsize != pulse->header.downSampledGateCount || readsize > pulseCapacity) {
-                printf("Error. This should not happen.  readsize = %s != %s || > %s\n",
-                       RKIntegerToCommaStyleString(readsize),
-                       RKIntegerToCommaStyleString(pulse->header.downSampledGateCount),
-                       RKIntegerToCommaStyleString(pulseCapacity));
-            }
-            for (i = 0; i < pulse->header.downSampledGateCount; i++) {
-                z.i[i] = x[i].i;
-                z.q[i] = x[i].q;
-            }
-        }
         if (p % 100 == 0) {
             printf("p:%06d/%06" PRIu64 " %s  E%5.2f, A%6.2f  %s x %.1f m\n", p, pulse->header.i, timestr,
                    pulse->header.elevationDegrees, pulse->header.azimuthDegrees,
@@ -972,12 +1866,31 @@ void RKTestReadIQ(const char *filename) {
         p++;
     }
     printf("fpos = %s / %s   k = %s\n",
-          RKUIntegerToCommaStyleString(ftell(fid)), RKUIntegerToCommaStyleString(filesize),
+          RKUIntegerToCommaStyleString(reader->offset), RKUIntegerToCommaStyleString(filesize),
           RKIntegerToCommaStyleString(k));
-    if (ftell(fid) != filesize) {
+    if (reader->offset != (size_t)(reader->dataEndOffset ? reader->dataEndOffset : filesize)) {
         printf("Warning. There is leftover in the file.");
     }
 
+    // Random access through the pulse index
+    if (reader->pulseIndexCount) {
+        RKPulse *pulse = RKGetPulseFromBuffer(pulseBuffer, 0);
+        RKRawDataPulseIndex *entry = &reader->pulseIndex[reader->pulseIndexCount / 2];
+        if (RKRawDataReaderSeekToTime(reader, entry->timeDouble) == RKResultSuccess &&
+            RKRawDataReaderReadPulse(reader, pulse) == RKResultSuccess) {
+            printf("Seek to time %.6f -> p:%06u  %.6f  %s\n", entry->timeDouble, reader->pulseNumber - 1, pulse->header.timeDouble,
+                   pulse->header.timeDouble == entry->timeDouble ? rkGlobalParameters.showColor ? RKGreenColor "okay" RKNoColor : "okay" :
+                   rkGlobalParameters.showColor ? RKRedColor "failed" RKNoColor : "failed");
+        }
+        if (RKRawDataReaderSeekToAzimuth(reader, 90.0f) == RKResultSuccess &&
+            RKRawDataReaderReadPulse(reader, pulse) == RKResultSuccess) {
+            printf("Seek to azimuth 90.00 -> p:%06u  A%6.2f\n", reader->pulseNumber - 1, pulse->header.azimuthDegrees);
+        }
+    } else {
+        printf("No pulse index in the file.\n");
+    }
+
+    RKRawDataReaderFree(reader);
     fclose(fid);
     if (waveform) {
         RKWaveformFree(waveform);
@@ -1250,6 +2163,228 @@ void RKTestSIMD(const RKTestSIMDFlag flag) {
     }
     RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Conversion from i16 to float", all_good);
 
+    //
+
+    float scale = 1.0f;
+    for (i = 0; i < n; i++) {
+        cc[i].i = 0.37f * (RKFloat)(i - n / 2);
+        cc[i].q = 1.0e-3f * (RKFloat)(i * i);
+    }
+    RKRawDataEncodeSamples(is, &scale, cc, n, RKRawDataTypeAfterMatchedFilterInt16);
+    RKRawDataDecodeSamples(cd, is, scale, n, RKRawDataTypeAfterMatchedFilterInt16);
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    all_good = true;
+    for (i = 0; i < n; i++) {
+        // Errors should be within half of the scale
+        good = fabsf(cd[i].i - cc[i].i) <= 0.5f * scale && fabsf(cd[i].q - cc[i].q) <= 0.5f * scale;
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%+9.4f%+9.4fi -> %+6d%+6di x %.2e -> %+9.4f%+9.4fi  %s\n", cc[i].i, cc[i].q, is[i].i, is[i].q, scale, cd[i].i, cd[i].q, OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Conversion from float to scaled i16 and back", all_good);
+
+    RKRawDataEncodeSamples(is, &scale, cc, n, RKRawDataTypeAfterMatchedFilterFloat16);
+    RKRawDataDecodeSamples(cd, is, scale, n, RKRawDataTypeAfterMatchedFilterFloat16);
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    all_good = true;
+    for (i = 0; i < n; i++) {
+        // Relative errors should be within 2^-11
+        good = fabsf(cd[i].i - cc[i].i) <= ldexpf(fabsf(cc[i].i), -11) && fabsf(cd[i].q - cc[i].q) <= ldexpf(fabsf(cc[i].q), -11);
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%+9.4f%+9.4fi -> %+9.4f%+9.4fi  %s\n", cc[i].i, cc[i].q, cd[i].i, cd[i].q, OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Conversion from float to f16 and back", all_good);
+
+    // Beyond the range of f16, through both the vector and the scalar paths
+    const RKFloat big[] = {7.0e4f, -1.0e6f, 65519.0f, INFINITY, 1.0f, -65504.0f, 3.0e38f, 2.0f, -7.0e4f, 65519.0f, -INFINITY};
+    const int nb = sizeof(big) / sizeof(RKFloat);
+    RKSIMD_Float2Half(big, (uint16_t *)is, nb);
+    RKSIMD_Half2Float((uint16_t *)is, (RKFloat *)cd, nb);
+    all_good = true;
+    for (i = 0; i < nb; i++) {
+        good = ((RKFloat *)cd)[i] == MIN(RKSIMDHalfMaximum, MAX(-RKSIMDHalfMaximum, big[i]));
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%+12.4e -> %+12.4e  %s\n", big[i], ((RKFloat *)cd)[i], OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Saturation from float to f16", all_good);
+
+    // Packed moments: a ramp from -40 to 100 with non-finite values, quantized over -32 to 96
+    RKFloat *fs = (RKFloat *)cc;
+    RKFloat *fd = (RKFloat *)cd;
+    const int nf = 2 * n - 1;
+    for (i = 0; i < nf; i++) {
+        fs[i] = i % 7 == 3 ? NAN : (i % 11 == 5 ? INFINITY : -40.0f + 140.0f * (RKFloat)i / nf);
+    }
+    int16_t *i16 = (int16_t *)is;
+    scale = 128.0f / 65534.0f;
+    RKSIMD_Quantize16(fs, i16, scale, 32.0f, -32768, nf);
+    RKSIMD_Dequantize16(i16, fd, scale, 32.0f, -32768, nf);
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    all_good = true;
+    for (i = 0; i < nf; i++) {
+        // Non-finite values become NAN, others are clamped then within half of the scale
+        if (isfinite(fs[i])) {
+            good = fabsf(fd[i] - MAX(-32.0f, MIN(96.0f, fs[i]))) <= 0.5f * scale + 1.0e-5f;
+        } else {
+            good = isnan(fd[i]);
+        }
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%+9.4f -> %+6d -> %+9.4f  %s\n", fs[i], i16[i], fd[i], OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Quantization to packed i16 and back", all_good);
+
+    uint8_t *u8 = (uint8_t *)is;
+    scale = 128.0f / 254.0f;
+    RKSIMD_Quantize8(fs, u8, scale, -32.0f, 255, nf);
+    RKSIMD_Dequantize8(u8, fd, scale, -32.0f, 255, nf);
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    all_good = true;
+    for (i = 0; i < nf; i++) {
+        if (isfinite(fs[i])) {
+            good = fabsf(fd[i] - MAX(-32.0f, MIN(96.0f, fs[i]))) <= 0.5f * scale + 1.0e-5f;
+        } else {
+            good = isnan(fd[i]);
+        }
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%+9.4f -> %3u -> %+9.4f  %s\n", fs[i], u8[i], fd[i], OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Quantization to packed u8 and back", all_good);
+
+    // Samples of two neighboring rays, the second one is 2 * n later; a run of NAN leaves some outputs without any sample
+    RKFloat *gs = dst->i;
+    RKFloat *gd = dst->q;
+    RKFloat *wb = (RKFloat *)cs;
+    RKFloat *wg = wb + nf;
+    int32_t *ga = (int32_t *)cpy->i;
+    int32_t *gb = (int32_t *)cpy->q;
+    for (i = 0; i < 4 * n; i++) {
+        gs[i] = (i % (2 * n) >= 10 && i % (2 * n) <= 13) ? NAN : (i % 9 == 4 ? INFINITY : -20.0f + 0.75f * (RKFloat)i);
+    }
+    for (i = 0; i < nf; i++) {
+        ga[i] = (i * 5) % (2 * n - 1);
+        gb[i] = ga[i] + 2 * n;
+        wb[i] = (RKFloat)(i % 8) / 8.0f;
+        wg[i] = (RKFloat)(i % 5) / 5.0f;
+    }
+    ga[3] = 10;
+    gb[3] = 12 + 2 * n;
+    RKSIMD_BilinearGather(gs, ga, gb, wb, wg, gd, nf);
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    all_good = true;
+    for (i = 0; i < nf; i++) {
+        // Scalar reference: weighted average of the finite samples, NAN if there is none
+        int j;
+        const int32_t o[] = {ga[i], ga[i] + 1, gb[i], gb[i] + 1};
+        const double w[] = {(1.0 - wb[i]) * (1.0 - wg[i]), (1.0 - wb[i]) * wg[i], wb[i] * (1.0 - wg[i]), wb[i] * wg[i]};
+        double u = 0.0, v = 0.0;
+        for (j = 0; j < 4; j++) {
+            if (isfinite(gs[o[j]])) {
+                u += w[j] * gs[o[j]];
+                v += w[j];
+            }
+        }
+        if (v > 0.0) {
+            good = fabs(gd[i] - u / v) <= tiny * MAX(1.0, fabs(u / v));
+        } else {
+            good = isnan(gd[i]);
+        }
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%3d %3d  %.3f %.3f -> %+9.4f vs %+9.4f  %s\n", ga[i], gb[i], wb[i], wg[i], gd[i], v > 0.0 ? u / v : NAN, OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Bilinear gather against scalar reference", all_good);
+
+    // Composite fields: two layers of reflectivity and height folded into the same bins, NAN is no echo
+    RKFloat *cz = src->i;
+    RKFloat *ch = src->q;
+    RKFloat *cm = dst->i;
+    RKFloat *ca = cpy->i;
+    RKFloat *cb = cpy->q;
+    RKFloat *cv = (RKFloat *)cs;
+    RKFloat *ct = cv + nf;
+    RKFloat *ce = ct + nf;
+    RKFloat *rz = (RKFloat *)cd;
+    RKFloat *rt = rz + nf;
+    RKFloat *ra = rt + nf;
+    RKFloat *rb = ra + nf;
+    RKFloat *rv = rb + nf;
+    RKFloat *re = (RKFloat *)cc;
+    for (i = 0; i < nf; i++) {
+        ce[i] = -INFINITY;
+        ct[i] = -INFINITY;
+        ca[i] = 0.0f;
+        cb[i] = NAN;
+        cv[i] = 0.0f;
+        re[i] = -INFINITY;
+        rt[i] = -INFINITY;
+        ra[i] = 0.0f;
+        rb[i] = NAN;
+        rv[i] = 0.0f;
+    }
+    all_good = true;
+    if (flag & RKTestSIMDFlagShowNumbers) {
+        printf("====\n");
+    }
+    int j;
+    for (j = 0; j < 3; j++) {
+        for (i = 0; i < nf; i++) {
+            cz[i] = (i + j) % 5 == 2 ? NAN : -10.0f + (RKFloat)((i * 7 + j * 13) % 60);
+            // The third layer repeats the height of the second one in every other bin
+            ch[i] = 0.1f * (RKFloat)i + (j == 2 && i % 2 ? 1.0f : (RKFloat)j);
+            cm[i] = isfinite(cz[i]) ? 1.0e-3f * (cz[i] + 10.0f) : 0.0f;
+        }
+        RKSIMD_imax(cz, ce, nf);
+        RKSIMD_EchoTop(cz, ch, 18.0f, ct, nf);
+        RKSIMD_VILLayer(cm, ch, ca, cb, cv, nf);
+        for (i = 0; i < nf; i++) {
+            if (cz[i] > re[i]) {
+                re[i] = cz[i];
+            }
+            if (cz[i] >= 18.0f && ch[i] > rt[i]) {
+                rt[i] = ch[i];
+            }
+            if (isnan(rb[i])) {
+                ra[i] = MAX(ra[i], cm[i]);
+                rb[i] = ch[i];
+            } else if (ch[i] > rb[i]) {
+                rv[i] += 0.5f * (cm[i] + ra[i]) * (ch[i] - rb[i]);
+                ra[i] = cm[i];
+                rb[i] = ch[i];
+            } else {
+                ra[i] = MAX(ra[i], cm[i]);
+            }
+        }
+    }
+    for (i = 0; i < nf; i++) {
+        good = ce[i] == re[i] && ct[i] == rt[i] && fabsf(cv[i] - rv[i]) <= tiny * MAX(1.0f, fabsf(rv[i]))
+            && ca[i] == ra[i] && cb[i] == rb[i];
+        if (flag & RKTestSIMDFlagShowNumbers) {
+            printf("%3d  CR %+6.1f vs %+6.1f   ET %+6.2f vs %+6.2f   VIL %.6f vs %.6f  %s\n", i, ce[i], re[i], ct[i], rt[i], cv[i], rv[i], OXSTR(good));
+        }
+        all_good &= good;
+    }
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Composite imax, EchoTop and VILLayer against scalar reference", all_good);
+
     if (flag & RKTestSIMDFlagPerformanceTestAll) {
         printf("\n==== Performance Test ====\n\n");
         printf("Using %s gates\n", RKIntegerToCommaStyleString(RKMaximumGateCount));
@@ -2196,6 +3331,685 @@ void RKTestCacheWrite(void) {
     RKRawDataRecorderFree(fileEngine);
 }
 
+#pragma mark - Network Tests
+
+#define SERVER_TEST_PORT         10098
+#define SERVER_TEST_CLIENT_COUNT 6
+
+// A plain client socket to the test server, reads give up after two seconds
+static int serverTestConnect(const int port) {
+    struct sockaddr_in address;
+    struct timeval timeout = {2, 0};
+    int sd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&address, 0, sizeof(struct sockaddr_in));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(struct timeval));
+    if (connect(sd, (struct sockaddr *)&address, sizeof(struct sockaddr_in)) < 0) {
+        RKLog("Error. Unable to connect to port %d.   errno = %d (%s)\n", port, errno, RKErrnoString(errno));
+        close(sd);
+        return -1;
+    }
+    return sd;
+}
+
+// A delimiter and its payload, the payload is skipped if it does not fit
+static ssize_t serverTestReceive(const int sd, RKNetDelimiter *delimiter, void *payload, const size_t capacity) {
+    char skip[1024];
+    ssize_t r, n = 0;
+    if (recv(sd, delimiter, sizeof(RKNetDelimiter), MSG_WAITALL) != sizeof(RKNetDelimiter)) {
+        return -1;
+    }
+    while (n < delimiter->size) {
+        if (delimiter->size <= capacity) {
+            r = recv(sd, (char *)payload + n, delimiter->size - n, MSG_WAITALL);
+        } else {
+            r = recv(sd, skip, MIN(sizeof(skip), delimiter->size - n), MSG_WAITALL);
+        }
+        if (r <= 0) {
+            return -1;
+        }
+        n += r;
+    }
+    return delimiter->size <= capacity ? n : -1;
+}
+
+// Echo the command back, a slow one holds up a command worker but not the I/O workers
+static int serverTestCommandHandler(RKOperator *O) {
+    if (!strcmp(O->cmd, "sleep")) {
+        usleep(500000);
+    }
+    RKOperatorSendCommandResponse(O, O->cmd);
+    return RKResultSuccess;
+}
+
+void RKTestServerWorkerPool(void) {
+    SHOW_FUNCTION_NAME
+    int k, s;
+    bool good, all_good = true;
+    char command[64], response[64];
+    int sd[SERVER_TEST_CLIENT_COUNT];
+    RKNetDelimiter delimiter;
+    struct timeval t0, t1;
+
+    RKServer *server = RKServerInit();
+    RKServerSetName(server, "<PoolTestServer>");
+    RKServerSetPort(server, SERVER_TEST_PORT);
+    RKServerSetWorkerCount(server, 2);
+    RKServerSetWelcomeHandler(server, NULL);
+    RKServerSetCommandHandler(server, &serverTestCommandHandler);
+    RKServerSetTerminateHandler(server, NULL);
+    RKServerStart(server);
+
+    for (k = 0; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        sd[k] = serverTestConnect(SERVER_TEST_PORT);
+    }
+    s = 0;
+    while (server->workers[0].operatorCount + server->workers[1].operatorCount < SERVER_TEST_CLIENT_COUNT && s++ < 100) {
+        usleep(10000);
+    }
+    good = server->workers[0].operatorCount == SERVER_TEST_CLIENT_COUNT / 2 && server->workers[1].operatorCount == SERVER_TEST_CLIENT_COUNT / 2;
+    printf("Clients are spread over the workers (%d, %d) %s\n", server->workers[0].operatorCount, server->workers[1].operatorCount, OXSTR(good));
+    all_good &= good;
+
+    // Every client gets the answer to its own command
+    for (k = 0; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        snprintf(command, sizeof(command), "hello %d\n", k);
+        s = send(sd[k], command, strlen(command), 0);
+    }
+    good = true;
+    for (k = 0; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        memset(response, 0, sizeof(response));
+        snprintf(command, sizeof(command), "hello %d", k);
+        good &= serverTestReceive(sd[k], &delimiter, response, sizeof(response) - 1) > 0
+            && delimiter.type == RKNetworkPacketTypeCommandResponse && !strcmp(response, command);
+    }
+    printf("Each client gets its own response %s\n", OXSTR(good));
+    all_good &= good;
+
+    // A slow command of one client does not hold up the others
+    s = send(sd[0], "sleep\n", 6, 0);
+    usleep(50000);
+    gettimeofday(&t0, NULL);
+    for (k = 1; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        snprintf(command, sizeof(command), "again %d\n", k);
+        s = send(sd[k], command, strlen(command), 0);
+    }
+    good = true;
+    for (k = 1; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        memset(response, 0, sizeof(response));
+        snprintf(command, sizeof(command), "again %d", k);
+        good &= serverTestReceive(sd[k], &delimiter, response, sizeof(response) - 1) > 0 && !strcmp(response, command);
+    }
+    gettimeofday(&t1, NULL);
+    good &= RKTimevalDiff(t1, t0) < 0.25;
+    memset(response, 0, sizeof(response));
+    good &= serverTestReceive(sd[0], &delimiter, response, sizeof(response) - 1) > 0 && !strcmp(response, "sleep");
+    printf("Other clients are answered during a slow command (%.0f ms) %s\n", 1.0e3 * RKTimevalDiff(t1, t0), OXSTR(good));
+    all_good &= good;
+
+    for (k = 0; k < SERVER_TEST_CLIENT_COUNT; k++) {
+        close(sd[k]);
+    }
+    RKServerStop(server);
+    RKServerWait(server);
+    RKServerFree(server);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Server worker pool", all_good);
+}
+
+#define GATHER_TEST_PORT         10097
+#define GATHER_TEST_SIZE_A       (3 * 1024 * 1024)
+#define GATHER_TEST_SIZE_B       (5 * 1024 * 1024 + 3)
+#define GATHER_TEST_SIZE_C       5
+
+static uint8_t *gatherTestPayloads[3];
+static ssize_t gatherTestSentSize = 0;
+static int gatherTestStage = 0;
+
+static void gatherTestFill(uint8_t *x, const size_t size, const int p) {
+    for (size_t i = 0; i < size; i++) {
+        x[i] = (uint8_t)(7 * i + p);
+    }
+}
+
+// A message of several payloads, one of them empty, and a short one after it
+static int gatherTestStreamHandler(RKOperator *O) {
+    if (gatherTestStage > 0) {
+        return RKResultSuccess;
+    }
+    O->delimTx.type = RKNetworkPacketTypeBytes;
+    O->delimTx.size = GATHER_TEST_SIZE_A + GATHER_TEST_SIZE_B + GATHER_TEST_SIZE_C;
+    gatherTestSentSize = RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter),
+                                               gatherTestPayloads[0], (ssize_t)GATHER_TEST_SIZE_A,
+                                               gatherTestPayloads[2], (ssize_t)0,
+                                               gatherTestPayloads[1], (ssize_t)GATHER_TEST_SIZE_B,
+                                               gatherTestPayloads[2], (ssize_t)GATHER_TEST_SIZE_C, NULL);
+    O->delimTx.size = 3;
+    RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter), "end", (ssize_t)3, NULL);
+    gatherTestStage = 1;
+    return RKResultSuccess;
+}
+
+void RKTestServerGatherPackets(void) {
+    SHOW_FUNCTION_NAME
+    int k;
+    bool good, all_good = true;
+    char end[4] = {0};
+    RKNetDelimiter delimiter;
+    const size_t sizes[] = {GATHER_TEST_SIZE_A, GATHER_TEST_SIZE_B, GATHER_TEST_SIZE_C};
+    const size_t size = GATHER_TEST_SIZE_A + GATHER_TEST_SIZE_B + GATHER_TEST_SIZE_C;
+
+    for (k = 0; k < 3; k++) {
+        gatherTestPayloads[k] = (uint8_t *)malloc(sizes[k]);
+        gatherTestFill(gatherTestPayloads[k], sizes[k], k);
+    }
+    uint8_t *message = (uint8_t *)malloc(size);
+    gatherTestSentSize = 0;
+    gatherTestStage = 0;
+
+    RKServer *server = RKServerInit();
+    RKServerSetName(server, "<GatherTestServer>");
+    RKServerSetPort(server, GATHER_TEST_PORT);
+    RKServerSetWelcomeHandler(server, NULL);
+    RKServerSetStreamHandler(server, &gatherTestStreamHandler);
+    RKServerSetTerminateHandler(server, NULL);
+    RKServerStart(server);
+
+    // The client holds off so that what the socket cannot take goes into the queue
+    int sd = serverTestConnect(GATHER_TEST_PORT);
+    usleep(200000);
+    good = gatherTestSentSize == sizeof(RKNetDelimiter) + size;
+    printf("The whole message is taken in one call (%zd B) %s\n", gatherTestSentSize, OXSTR(good));
+    all_good &= good;
+
+    good = serverTestReceive(sd, &delimiter, message, size) == size;
+    for (k = 0; k < 3 && good; k++) {
+        good = !memcmp(message + (k > 0 ? GATHER_TEST_SIZE_A : 0) + (k > 1 ? GATHER_TEST_SIZE_B : 0), gatherTestPayloads[k], sizes[k]);
+    }
+    printf("Payloads arrive contiguous and in order (queue peak = %u) %s\n",
+           server->operators[0] ? server->operators[0]->queuePeakCount : 0, OXSTR(good));
+    all_good &= good;
+
+    good = serverTestReceive(sd, &delimiter, end, 3) == 3 && !strcmp(end, "end");
+    printf("The next message follows right after %s\n", OXSTR(good));
+    all_good &= good;
+
+    close(sd);
+    RKServerStop(server);
+    RKServerWait(server);
+    RKServerFree(server);
+    for (k = 0; k < 3; k++) {
+        free(gatherTestPayloads[k]);
+    }
+    free(message);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Gathered packets of the server", all_good);
+}
+
+#define COMPRESS_TEST_PORT       10096
+#define COMPRESS_TEST_COUNT      16384
+
+static float *compressTestRamp;
+static uint8_t *compressTestNoise;
+static int compressTestStage = 0;
+
+static int compressTestWelcomeHandler(RKOperator *O) {
+    RKOperatorSetCompression(O, RKNetworkCompressionFast);
+    return RKResultSuccess;
+}
+
+// A smooth field in two pieces, a short payload, noise that does not deflate and a block that is compressed once
+static int compressTestStreamHandler(RKOperator *O) {
+    const size_t half = COMPRESS_TEST_COUNT / 2 * sizeof(float);
+    const size_t size = COMPRESS_TEST_COUNT * sizeof(float);
+    if (compressTestStage > 0) {
+        return RKResultSuccess;
+    }
+    O->delimTx.type = RKNetworkPacketTypeRayDisplay;
+    O->delimTx.source = 3;
+    RKOperatorSendCompressiblePackets(O, sizeof(float), &O->delimTx, compressTestRamp, (ssize_t)half,
+                                      compressTestRamp + COMPRESS_TEST_COUNT / 2, (ssize_t)half, NULL);
+    RKOperatorSendCompressiblePackets(O, sizeof(float), &O->delimTx, compressTestRamp, (ssize_t)256, NULL);
+    RKOperatorSendCompressiblePackets(O, 1, &O->delimTx, compressTestNoise, (ssize_t)size, NULL);
+    uint8_t *block = (uint8_t *)malloc(RKRawDataBlockBound(size) + size);
+    const size_t blockSize = RKServerCompressPayload(block, block + RKRawDataBlockBound(size), compressTestRamp, size, sizeof(float), RKNetworkCompressionFast);
+    RKOperatorSendCompressedPacket(O, sizeof(float), &O->delimTx, block, blockSize, size);
+    free(block);
+    compressTestStage = 1;
+    return RKResultSuccess;
+}
+
+void RKTestServerCompression(void) {
+    SHOW_FUNCTION_NAME
+    int k;
+    bool good, all_good = true;
+    RKNetDelimiter delimiter;
+    uint32_t x = 1;
+    const size_t size = COMPRESS_TEST_COUNT * sizeof(float);
+
+    compressTestRamp = (float *)malloc(size);
+    compressTestNoise = (uint8_t *)malloc(size);
+    for (k = 0; k < COMPRESS_TEST_COUNT; k++) {
+        compressTestRamp[k] = 0.01f * (float)k;
+    }
+    for (k = 0; k < size; k++) {
+        x = 1664525 * x + 1013904223;
+        compressTestNoise[k] = (uint8_t)(x >> 24);
+    }
+    uint8_t *block = (uint8_t *)malloc(RKRawDataBlockBound(size));
+    uint8_t *payload = (uint8_t *)malloc(2 * size);
+    compressTestStage = 0;
+
+    RKServer *server = RKServerInit();
+    RKServerSetName(server, "<CompressTestServer>");
+    RKServerSetPort(server, COMPRESS_TEST_PORT);
+    RKServerSetWelcomeHandler(server, &compressTestWelcomeHandler);
+    RKServerSetStreamHandler(server, &compressTestStreamHandler);
+    RKServerSetTerminateHandler(server, NULL);
+    RKServerStart(server);
+
+    int sd = serverTestConnect(COMPRESS_TEST_PORT);
+
+    // The delimiter tells the element size, the block size and the original size, the rest is kept
+    good = serverTestReceive(sd, &delimiter, block, RKRawDataBlockBound(size)) > 0
+        && delimiter.subtype == (RKNetDelimiterSubtypeDeflated | sizeof(float)) && delimiter.size < size && delimiter.decodedSize == size
+        && delimiter.type == RKNetworkPacketTypeRayDisplay && delimiter.source == 3;
+    good &= good && RKRawDataBlockDecode(payload, delimiter.decodedSize, block, delimiter.size, RKRawDataBlockFilterShuffle,
+                                         delimiter.subtype & RKNetDelimiterSubtypeShuffleMask, payload + size) == RKResultSuccess
+        && !memcmp(payload, compressTestRamp, size);
+    printf("Gathered payloads are deflated and inflate back (%u -> %u B) %s\n", delimiter.decodedSize, delimiter.size, OXSTR(good));
+    all_good &= good;
+
+    good = serverTestReceive(sd, &delimiter, payload, size) == 256 && delimiter.subtype == 0 && !memcmp(payload, compressTestRamp, 256);
+    printf("A payload under the threshold goes as it is %s\n", OXSTR(good));
+    all_good &= good;
+
+    good = serverTestReceive(sd, &delimiter, payload, size) == size && delimiter.subtype == 0 && !memcmp(payload, compressTestNoise, size);
+    printf("A payload that does not deflate goes as it is %s\n", OXSTR(good));
+    all_good &= good;
+
+    good = serverTestReceive(sd, &delimiter, block, RKRawDataBlockBound(size)) > 0
+        && delimiter.subtype == (RKNetDelimiterSubtypeDeflated | sizeof(float)) && delimiter.decodedSize == size && delimiter.source == 3;
+    good &= good && RKRawDataBlockDecode(payload, delimiter.decodedSize, block, delimiter.size, RKRawDataBlockFilterShuffle,
+                                         delimiter.subtype & RKNetDelimiterSubtypeShuffleMask, payload + size) == RKResultSuccess
+        && !memcmp(payload, compressTestRamp, size);
+    printf("A block compressed once inflates back %s\n", OXSTR(good));
+    all_good &= good;
+
+    close(sd);
+    RKServerStop(server);
+    RKServerWait(server);
+    RKServerFree(server);
+    free(compressTestRamp);
+    free(compressTestNoise);
+    free(block);
+    free(payload);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Compressed delimiters of the server", all_good);
+}
+
+#define DROP_TEST_PORT           10095
+#define DROP_TEST_MESSAGE_COUNT  3000
+#define DROP_TEST_FRAGMENT_COUNT 4
+#define DROP_TEST_FRAGMENT_SIZE  1024
+
+static uint32_t dropTestFragments[DROP_TEST_FRAGMENT_COUNT][DROP_TEST_FRAGMENT_SIZE];
+static uint32_t dropTestMessageCount = 0;
+
+// Messages of several fragments, faster than the client takes them
+static int dropTestStreamHandler(RKOperator *O) {
+    int j, g, n;
+    RKOperatorSetSendPolicy(O, RKOperatorSendPolicyDropOldest);
+    for (n = 0; n < 3 && dropTestMessageCount < DROP_TEST_MESSAGE_COUNT; n++) {
+        for (j = 0; j < DROP_TEST_FRAGMENT_COUNT; j++) {
+            for (g = 0; g < DROP_TEST_FRAGMENT_SIZE; g++) {
+                dropTestFragments[j][g] = dropTestMessageCount * 1000 + j;
+            }
+        }
+        O->delimTx.type = RKNetworkPacketTypeBytes;
+        O->delimTx.size = sizeof(dropTestFragments);
+        RKOperatorSendPackets(O, &O->delimTx, sizeof(RKNetDelimiter),
+                              dropTestFragments[0], (ssize_t)sizeof(dropTestFragments[0]),
+                              dropTestFragments[1], (ssize_t)sizeof(dropTestFragments[1]),
+                              dropTestFragments[2], (ssize_t)sizeof(dropTestFragments[2]),
+                              dropTestFragments[3], (ssize_t)sizeof(dropTestFragments[3]), NULL);
+        dropTestMessageCount++;
+    }
+    return RKResultSuccess;
+}
+
+void RKTestServerDropOldest(void) {
+    SHOW_FUNCTION_NAME
+    int j, g, n;
+    bool good, all_good = true;
+    bool whole = true, ordered = true;
+    uint32_t id = 0, last = 0, gapCount = 0, receivedCount = 0;
+    RKNetDelimiter delimiter;
+    static uint32_t message[DROP_TEST_FRAGMENT_COUNT][DROP_TEST_FRAGMENT_SIZE];
+
+    dropTestMessageCount = 0;
+    RKServer *server = RKServerInit();
+    RKServerSetName(server, "<DropTestServer>");
+    RKServerSetPort(server, DROP_TEST_PORT);
+    RKServerSetWelcomeHandler(server, NULL);
+    RKServerSetStreamHandler(server, &dropTestStreamHandler);
+    RKServerSetTerminateHandler(server, NULL);
+    RKServerStart(server);
+
+    // A slow client, a few messages at a time until the last one
+    int sd = serverTestConnect(DROP_TEST_PORT);
+    for (n = 0; id < DROP_TEST_MESSAGE_COUNT - 1; n++) {
+        if (n % 20 == 0) {
+            usleep(30000);
+        }
+        if (serverTestReceive(sd, &delimiter, message, sizeof(message)) != sizeof(message)) {
+            break;
+        }
+        id = message[0][0] / 1000;
+        for (j = 0; j < DROP_TEST_FRAGMENT_COUNT; j++) {
+            for (g = 0; g < DROP_TEST_FRAGMENT_SIZE; g++) {
+                whole &= message[j][g] == id * 1000 + j;
+            }
+        }
+        if (receivedCount++ > 0) {
+            ordered &= id > last;
+            gapCount += id != last + 1;
+        }
+        last = id;
+    }
+    RKOperator *O = server->operators[0];
+
+    good = id == DROP_TEST_MESSAGE_COUNT - 1 && O != NULL && O->state == RKOperatorStateActive;
+    printf("The newest message arrives and the client stays connected %s\n", OXSTR(good));
+    all_good &= good;
+
+    good = whole && ordered;
+    printf("Messages are whole and in order (%u of %u) %s\n", receivedCount, DROP_TEST_MESSAGE_COUNT, OXSTR(good));
+    all_good &= good;
+
+    good = O != NULL && gapCount > 0 && O->dropCount == DROP_TEST_MESSAGE_COUNT - receivedCount && O->queuePeakCount <= RKServerSendQueueDepth;
+    printf("Drops are whole messages (%u gaps, %u dropped, queue peak %u) %s\n", gapCount,
+           O ? (uint32_t)O->dropCount : 0, O ? O->queuePeakCount : 0, OXSTR(good));
+    all_good &= good;
+
+    close(sd);
+    RKServerStop(server);
+    RKServerWait(server);
+    RKServerFree(server);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Drop-oldest send policy of the server", all_good);
+}
+
+#define RESUME_TEST_PORT         10094
+#define RESUME_TEST_DEPTH        64
+#define RESUME_TEST_ORIGIN       1000
+
+// Rays that are ready in the buffer, each index k is identified by origin + k
+static void resumeTestAddRays(RKRadar *radar, const int count) {
+    int g, k;
+    for (k = 0; k < count; k++) {
+        RKRay *ray = RKGetRayFromBuffer(radar->rays, radar->rayIndex);
+        ray->header.i = RESUME_TEST_ORIGIN + radar->rayIndex;
+        ray->header.gateCount = 16;
+        ray->header.gateSizeMeters = 100.0f;
+        ray->header.baseMomentList = RKBaseMomentListProductZ | RKBaseMomentListDisplayZ;
+        uint8_t *z = RKGetUInt8DataFromRay(ray, RKBaseMomentIndexZ);
+        for (g = 0; g < 16; g++) {
+            z[g] = (uint8_t)(ray->header.i + g);
+        }
+        ray->header.s = RKRayStatusReady;
+        radar->rayIndex = RKNextModuloS(radar->rayIndex, radar->desc.rayBufferDepth);
+    }
+}
+
+// Identifiers of the next rays that come in within two seconds, the other packets are skipped
+static int resumeTestReceiveRays(const int sd, RKIdentifier *identifiers, const int count) {
+    int k = 0;
+    char payload[4096];
+    RKNetDelimiter delimiter;
+    struct timeval t0, t1;
+    gettimeofday(&t0, NULL);
+    t1 = t0;
+    while (k < count && RKTimevalDiff(t1, t0) < 2.0 && serverTestReceive(sd, &delimiter, payload, sizeof(payload)) >= 0) {
+        gettimeofday(&t1, NULL);
+        if (delimiter.type == RKNetworkPacketTypeRayDisplay) {
+            identifiers[k++] = ((RKRayHeader *)payload)->i;
+        }
+    }
+    return k;
+}
+
+static bool resumeTestConsecutive(const RKIdentifier *identifiers, const int count, const RKIdentifier first) {
+    for (int k = 0; k < count; k++) {
+        if (identifiers[k] != first + k) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RKTestResumeRayStream(void) {
+    SHOW_FUNCTION_NAME
+    int k, s;
+    bool good, all_good = true;
+    char payload[256];
+    RKIdentifier identifiers[RESUME_TEST_DEPTH];
+    RKNetDelimiter delimiter;
+    RKName host;
+
+    // An upstream that is a relay itself, the rays are put in its buffer here
+    RKRadarDesc desc;
+    memset(&desc, 0, sizeof(RKRadarDesc));
+    desc.initFlags = RKInitFlagAllocConfigBuffer | RKInitFlagAllocMomentBuffer | RKInitFlagAllocStatusBuffer | RKInitFlagAllocHealthBuffer;
+    desc.pulseCapacity = 64;
+    desc.pulseToRayRatio = 1;
+    desc.configBufferDepth = 8;
+    desc.healthBufferDepth = 8;
+    desc.statusBufferDepth = 8;
+    desc.pulseBufferDepth = 16;
+    desc.rayBufferDepth = RESUME_TEST_DEPTH;
+    RKRadar *radar = RKInitWithDesc(desc);
+    resumeTestAddRays(radar, 40);
+    radar->state |= RKRadarStateLive;
+
+    RKCommandCenter *center = RKCommandCenterInit();
+    RKCommandCenterSetPort(center, RESUME_TEST_PORT);
+    RKCommandCenterAddRadar(center, radar);
+    RKCommandCenterStart(center);
+
+    // Rays after the identifier are replayed, the latest one is left until it is followed by another
+    int sd = serverTestConnect(RESUME_TEST_PORT);
+    s = send(sd, "k 1020\nsZ\n", 10, 0);
+    memset(payload, 0, sizeof(payload));
+    good = serverTestReceive(sd, &delimiter, payload, sizeof(payload) - 1) > 0 && strstr(payload, "ACK. Resume after ray 1020.");
+    good &= resumeTestReceiveRays(sd, identifiers, 18) == 18 && resumeTestConsecutive(identifiers, 18, 1021);
+    printf("Rays after the identifier are replayed %s\n", OXSTR(good));
+    all_good &= good;
+
+    resumeTestAddRays(radar, 5);
+    good = resumeTestReceiveRays(sd, identifiers, 5) == 5 && resumeTestConsecutive(identifiers, 5, 1039);
+    printf("Live rays follow the replay without a gap %s\n", OXSTR(good));
+    all_good &= good;
+    close(sd);
+
+    // An identifier that is older than the buffer replays all that are left
+    sd = serverTestConnect(RESUME_TEST_PORT);
+    s = send(sd, "k 5\nsZ\n", 7, 0);
+    good = resumeTestReceiveRays(sd, identifiers, 1) == 1 && identifiers[0] == RESUME_TEST_ORIGIN;
+    printf("Replay starts from the oldest ray in the buffer %s\n", OXSTR(good));
+    all_good &= good;
+    close(sd);
+    usleep(200000);
+
+    // A downstream relay that already has rays up to 1030 asks for the rest
+    RKBuffer pulses, rays;
+    uint32_t pulseIndex = 0, rayIndex = 0;
+    RKPulseBufferAlloc(&pulses, 64, 16);
+    RKRayBufferAlloc(&rays, 16, RESUME_TEST_DEPTH);
+    RKRadarRelay *relay = RKRadarRelayInit();
+    RKRadarRelaySetInputOutputBuffers(relay, &desc, NULL, NULL, NULL, NULL, NULL, NULL, NULL, pulses, &pulseIndex, rays, &rayIndex);
+    snprintf(host, RKNameLength, "localhost:%d", RESUME_TEST_PORT);
+    RKRadarRelaySetHost(relay, host);
+    relay->streams = RKStreamDisplayZ;
+    relay->rayIdentifier = 1030;
+    RKRadarRelayStart(relay);
+    s = 0;
+    while (rayIndex < 13 && s++ < 300) {
+        usleep(10000);
+    }
+    for (k = 0; k < rayIndex; k++) {
+        identifiers[k] = RKGetRayFromBuffer(rays, k)->header.i;
+    }
+    good = rayIndex == 13 && resumeTestConsecutive(identifiers, 13, 1031) && relay->rayLostCount == 0;
+    printf("A relay resumes after the last ray it has %s\n", OXSTR(good));
+    all_good &= good;
+
+    // The upstream hangs up, rays come in while the relay is away, it asks for them when it reconnects
+    for (k = 0; k < RKServerMaximumOperators; k++) {
+        if (center->server->busy[k] && center->server->operators[k]) {
+            RKOperatorHangUp(center->server->operators[k]);
+        }
+    }
+    usleep(500000);
+    resumeTestAddRays(radar, 5);
+    s = 0;
+    while (rayIndex < 18 && s++ < 800) {
+        usleep(10000);
+    }
+    for (k = 0; k < rayIndex; k++) {
+        identifiers[k] = RKGetRayFromBuffer(rays, k)->header.i;
+    }
+    good = rayIndex == 18 && resumeTestConsecutive(identifiers, 18, 1031) && relay->rayLostCount == 0;
+    printf("Rays sent while the relay was away are replayed after it reconnects %s\n", OXSTR(good));
+    all_good &= good;
+
+    // The upstream lets go of the relay before it stops
+    RKRadarRelayStop(relay);
+    RKRadarRelayFree(relay);
+    usleep(200000);
+    RKCommandCenterStop(center);
+    RKCommandCenterFree(center);
+    RKFree(radar);
+    RKPulseBufferFree(pulses);
+    RKRayBufferFree(rays);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Resume of the ray streams", all_good);
+}
+
+#define AGGREGATE_TEST_PORT      10093
+
+// Sources and identifiers of the next rays that come in within two seconds, the other packets are skipped
+static int aggregateTestReceiveRays(const int sd, uint16_t *sources, RKIdentifier *identifiers, const int count) {
+    int k = 0;
+    char payload[4096];
+    RKNetDelimiter delimiter;
+    struct timeval t0, t1;
+    gettimeofday(&t0, NULL);
+    t1 = t0;
+    while (k < count && RKTimevalDiff(t1, t0) < 2.0 && serverTestReceive(sd, &delimiter, payload, sizeof(payload)) >= 0) {
+        gettimeofday(&t1, NULL);
+        if (delimiter.type == RKNetworkPacketTypeRayDisplay) {
+            sources[k] = delimiter.source;
+            identifiers[k++] = ((RKRayHeader *)payload)->i;
+        }
+    }
+    return k;
+}
+
+// The next packet that is not a beacon, the size of its payload or -1
+static int aggregateTestReceiveResponse(const int sd, char *payload, const size_t capacity) {
+    int size;
+    RKNetDelimiter delimiter;
+    do {
+        memset(payload, 0, capacity);
+        size = serverTestReceive(sd, &delimiter, payload, capacity - 1);
+    } while (size >= 0 && delimiter.type == RKNetworkPacketTypeBeacon);
+    return size;
+}
+
+// Rays of the given source are consecutive from the first identifier, there are count of them
+static bool aggregateTestSourceRays(const uint16_t *sources, const RKIdentifier *identifiers, const int total,
+                                    const uint16_t source, const RKIdentifier first, const int count) {
+    int j = 0;
+    for (int k = 0; k < total; k++) {
+        if (sources[k] == source && identifiers[k] != first + j++) {
+            return false;
+        }
+    }
+    return j == count;
+}
+
+void RKTestAggregateRayStreams(void) {
+    SHOW_FUNCTION_NAME
+    int k;
+    bool good, all_good = true;
+    char payload[256];
+    uint16_t sources[RESUME_TEST_DEPTH];
+    RKIdentifier identifiers[RESUME_TEST_DEPTH];
+
+    // Two upstream relays behind one command center, at different places in their buffers
+    RKRadar *radars[2];
+    const char *names[] = {"Alpha", "Bravo"};
+    RKRadarDesc desc;
+    memset(&desc, 0, sizeof(RKRadarDesc));
+    desc.initFlags = RKInitFlagAllocConfigBuffer | RKInitFlagAllocMomentBuffer | RKInitFlagAllocStatusBuffer | RKInitFlagAllocHealthBuffer;
+    desc.pulseCapacity = 64;
+    desc.pulseToRayRatio = 1;
+    desc.configBufferDepth = 8;
+    desc.healthBufferDepth = 8;
+    desc.statusBufferDepth = 8;
+    desc.pulseBufferDepth = 16;
+    desc.rayBufferDepth = RESUME_TEST_DEPTH;
+    RKCommandCenter *center = RKCommandCenterInit();
+    RKCommandCenterSetPort(center, AGGREGATE_TEST_PORT);
+    for (k = 0; k < 2; k++) {
+        snprintf(desc.name, RKNameLength, "%s", names[k]);
+        radars[k] = RKInitWithDesc(desc);
+        resumeTestAddRays(radars[k], 10 + 20 * k);
+        radars[k]->state |= RKRadarStateLive;
+        RKCommandCenterAddRadar(center, radars[k]);
+    }
+    RKCommandCenterStart(center);
+
+    // The combined stream tags every ray with the index of its radar
+    int sd = serverTestConnect(AGGREGATE_TEST_PORT);
+    send(sd, "r *\n", 4, 0);
+    good = aggregateTestReceiveResponse(sd, payload, sizeof(payload)) > 0 && strstr(payload, "ACK. All 2 radars selected.");
+    send(sd, "sZ\n", 3, 0);
+    good &= aggregateTestReceiveResponse(sd, payload, sizeof(payload)) > 0 && strstr(payload, "\"type\": \"init\"");
+    usleep(200000);
+    resumeTestAddRays(radars[0], 3);
+    resumeTestAddRays(radars[1], 4);
+    k = aggregateTestReceiveRays(sd, sources, identifiers, 7);
+    good &= k == 7
+        && aggregateTestSourceRays(sources, identifiers, k, 0, RESUME_TEST_ORIGIN + 9, 3)
+        && aggregateTestSourceRays(sources, identifiers, k, 1, RESUME_TEST_ORIGIN + 29, 4);
+    printf("Rays of the combined stream carry the source of their radar %s\n", OXSTR(good));
+    all_good &= good;
+
+    // A single radar selected by name keeps its source, the rays of the other radar stay out
+    send(sd, "r Bravo\n", 8, 0);
+    good = aggregateTestReceiveResponse(sd, payload, sizeof(payload)) > 0 && strstr(payload, "ACK. Bravo selected.");
+    usleep(200000);
+    resumeTestAddRays(radars[0], 2);
+    resumeTestAddRays(radars[1], 3);
+    k = aggregateTestReceiveRays(sd, sources, identifiers, 5);
+    good &= k == 3 && aggregateTestSourceRays(sources, identifiers, k, 1, RESUME_TEST_ORIGIN + 33, 3);
+    printf("Rays of a selected radar carry its source alone %s\n", OXSTR(good));
+    all_good &= good;
+    close(sd);
+    usleep(200000);
+
+    RKCommandCenterStop(center);
+    RKCommandCenterFree(center);
+    RKFree(radars[0]);
+    RKFree(radars[1]);
+
+    RKSIMD_TEST_RESULT(rkGlobalParameters.showColor, "Aggregate ray streams of several radars", all_good);
+}
+
 #pragma mark - Transceiver Emulator
 
 //
@@ -2325,6 +4139,19 @@ void *RKTestTransceiverPlaybackRunLoop(void *input) {
         rewind(fid);
         fread(fileHeader, sizeof(RKFileHeader), 1, fid);
         //RKLog("%s", transceiver->name);
+        if (fileHeader->dataType != RKRawDataTypeFromTransceiver) {
+            RKLog("%s Skipping %s, which is not raw data from the transceiver.\n", transceiver->name,
+                  RKLastPartOfPath(filelist + k * RKMaximumPathLength));
+            fclose(fid);
+            if (++k == count) {
+                break;
+            }
+            continue;
+        }
+        if (fileHeader->buildNo >= 6) {
+            // Skip the waveform that is embedded after the file header
+            RKWaveformFree(RKWaveformReadFromReference(fid));
+        }
 
         RKLog("%s Waveform %s", transceiver->name, fileHeader->config.waveform);
         sprintf(string, "waveforms/%s.rkwav", fileHeader->config.waveformName);
@@ -2368,18 +4195,24 @@ void *RKTestTransceiverPlaybackRunLoop(void *input) {
         transceiver->chunkSize = (transceiver->periodOdd + transceiver->periodEven) >= 0.02 ? 1 : MAX(1, (int)round(0.05 / transceiver->prt));
         RKLog("%s Using chunkSize = %d\n", transceiver->name, transceiver->chunkSize);
 
-        while (transceiver->state & RKEngineStateWantActive && fpos < fsize) {
+        // Pulses are viewed in place through the reader, which also stops before the index trailers
+        RKRawDataReader *reader = RKRawDataReaderInit(fid, fileHeader);
+        if (reader == NULL) {
+            fclose(fid);
+            break;
+        }
+        RKRawDataPulseView view;
+
+        while (transceiver->state & RKEngineStateWantActive && RKRawDataReaderReadPulseView(reader, &view) == RKResultSuccess) {
             RKPulse *pulse = RKGetVacantPulse(radar);
             if (pulse == NULL) {
                 RKLog("%s Error. No vacant pulse for storage.\n", transceiver->name);
                 break;
             }
-            fread(pulseHeader, sizeof(RKPulseHeader), 1, fid);
-            gateCount = MIN(pulse->header.capacity, pulseHeader->gateCount);
-            fread(RKGetInt16CDataFromPulse(pulse, 0), sizeof(RKByte), gateCount * sizeof(RKInt16C), fid);
-            fseek(fid, (pulseHeader->gateCount - gateCount) * sizeof(RKInt16C), SEEK_CUR);
-            fread(RKGetInt16CDataFromPulse(pulse, 1), sizeof(RKByte), gateCount * sizeof(RKInt16C), fid);
-            fseek(fid, (pulseHeader->gateCount - gateCount) * sizeof(RKInt16C), SEEK_CUR);
+            memcpy(pulseHeader, &view.header, sizeof(RKPulseHeader));
+            gateCount = MIN(pulse->header.capacity, view.gateCount);
+            memcpy(RKGetInt16CDataFromPulse(pulse, 0), view.data[0], gateCount * sizeof(RKInt16C));
+            memcpy(RKGetInt16CDataFromPulse(pulse, 1), view.data[1], gateCount * sizeof(RKInt16C));
             
             pulse->header.gateSizeMeters = pulseHeader->gateSizeMeters;
             pulse->header.gateCount = gateCount;
@@ -2411,7 +4244,6 @@ void *RKTestTransceiverPlaybackRunLoop(void *input) {
             
 //            RKLog("%s pulse->header.s = %04x  marker = %04x gateCount = %d\n", transceiver->name, pulseHeader->marker, pulseHeader->s, gateCount);
             
-            fpos = ftell(fid);
             even = !even;
             tic++;
             
@@ -2425,11 +4257,12 @@ void *RKTestTransceiverPlaybackRunLoop(void *input) {
             }
         }
         
-        fpos = ftell(fid);
+        fpos = reader->offset;
         RKLog("%s Pulse count = %s   fpos = %s   fsize = %s\n", transceiver->name,
-              RKUIntegerToCommaStyleString(j),
+              RKUIntegerToCommaStyleString(reader->pulseNumber),
               RKUIntegerToCommaStyleString(fpos),
               RKUIntegerToCommaStyleString(fsize));
+        RKRawDataReaderFree(reader);
         fclose(fid);
         
         periodTotal = 0.0;
@@ -0,0 +1,373 @@
+//
+//  RKVolumeEngine.c
+//  RadarKit
+//
+//  Created by Boonleng Cheong on 10/18/26.
+//  Copyright © Boonleng Cheong. All rights reserved.
+//
+
+#include <RadarKit/RKVolumeEngine.h>
+
+#pragma mark - Helper Functions
+
+// Bytes of the rays of a sweep, which count toward the memory limit for as long as the cache holds the sweep
+static size_t RKVolumeEngineSweepSize(const RKSweep *sweep) {
+    const RKRay *ray = sweep->rays[0];
+    return sizeof(RKSweep) + sweep->header.rayCount * (sizeof(ray->headerBytes) + RKBaseMomentCount * ray->header.capacity * (sizeof(uint8_t) + sizeof(float)));
+}
+
+// Sweeps are reference counted by their owner if there is one, otherwise by the volume engine. Must have the mutex
+static void RKVolumeEngineRetainSweep(RKVolumeEngine *engine, RKSweep *sweep) {
+    if (engine->sweepRetainer) {
+        engine->sweepRetainer(engine->sweepOwner, sweep);
+    } else {
+        sweep->referenceCount++;
+    }
+}
+
+static void RKVolumeEngineReleaseSweep(RKVolumeEngine *engine, RKSweep *sweep) {
+    if (engine->sweepReleaser) {
+        engine->sweepReleaser(engine->sweepOwner, sweep);
+    } else if (--sweep->referenceCount == 0) {
+        RKRayBufferFree(sweep->rayBuffer);
+        free(sweep);
+    }
+}
+
+// Drop a reference of a volume, and the references of its sweeps once nobody holds the volume. Must have the mutex
+static void RKVolumeEngineDropVolume(RKVolumeEngine *engine, RKVolume *volume) {
+    int k;
+    if (--volume->referenceCount) {
+        return;
+    }
+    for (k = 0; k < volume->header.sweepCount; k++) {
+        RKVolumeEngineReleaseSweep(engine, volume->sweeps[k]);
+    }
+    if (engine->verbose > 1) {
+        RKLog("%s Volume V%lu freed.\n", engine->name, volume->header.i);
+    }
+    free(volume);
+}
+
+// The current volume, cloned first if a consumer holds it so that what the consumer has never changes. Must have the mutex
+static RKVolume *RKVolumeEngineCurrentVolumeForUpdate(RKVolumeEngine *engine) {
+    int k;
+    RKVolume *volume = engine->volumes[engine->volumeCount - 1];
+    if (volume->referenceCount == 1) {
+        return volume;
+    }
+    RKVolume *clone = (RKVolume *)malloc(sizeof(RKVolume));
+    if (clone == NULL) {
+        RKLog("%s Error. Unable to allocate a volume.\n", engine->name);
+        return NULL;
+    }
+    memcpy(clone, volume, sizeof(RKVolume));
+    clone->referenceCount = 1;
+    for (k = 0; k < clone->header.sweepCount; k++) {
+        RKVolumeEngineRetainSweep(engine, clone->sweeps[k]);
+    }
+    RKVolumeEngineDropVolume(engine, volume);
+    engine->volumes[engine->volumeCount - 1] = clone;
+    return clone;
+}
+
+// Let go of the oldest volumes that are beyond the depth or the memory limit. If the current volume alone is still over
+// the limit, its oldest sweeps go too. Must have the mutex
+static void RKVolumeEngineTrim(RKVolumeEngine *engine) {
+    int k;
+    size_t size = 0;
+    RKVolume *volume;
+    for (k = 0; k < engine->volumeCount; k++) {
+        size += engine->volumes[k]->memoryUsage;
+    }
+    while (engine->volumeCount > 1 && (engine->volumeCount > engine->depth || size > engine->memoryLimit)) {
+        size -= engine->volumes[0]->memoryUsage;
+        RKVolumeEngineDropVolume(engine, engine->volumes[0]);
+        engine->volumeCount--;
+        memmove(engine->volumes, engine->volumes + 1, engine->volumeCount * sizeof(RKVolume *));
+    }
+    if (engine->volumeCount && size > engine->memoryLimit) {
+        volume = RKVolumeEngineCurrentVolumeForUpdate(engine);
+        if (volume) {
+            RKLog("%s Warning. Volume V%lu of %s B is over the limit of %s B.\n", engine->name, volume->header.i,
+                  RKUIntegerToCommaStyleString(size), RKUIntegerToCommaStyleString(engine->memoryLimit));
+            for (k = 0; k < volume->header.sweepCount && size > engine->memoryLimit; k++) {
+                size -= RKVolumeEngineSweepSize(volume->sweeps[k]);
+                volume->memoryUsage -= RKVolumeEngineSweepSize(volume->sweeps[k]);
+                RKVolumeEngineReleaseSweep(engine, volume->sweeps[k]);
+            }
+            volume->header.sweepCount -= k;
+            memmove(volume->sweeps, volume->sweeps + k, volume->header.sweepCount * sizeof(RKSweep *));
+            if (volume->header.sweepCount) {
+                volume->header.startTime = volume->sweeps[0]->header.startTime;
+            } else {
+                RKVolumeEngineDropVolume(engine, volume);
+                engine->volumeCount = 0;
+            }
+        }
+    }
+    engine->memoryUsage = sizeof(RKVolumeEngine) + size;
+}
+
+// Whether the sweep starts a new volume. Volume markers are used if the radar provides them, otherwise a new volume
+// starts when the scan type changes or when a PPI comes back down to a lower elevation
+static bool RKVolumeEngineIsNewVolume(const RKVolume *volume, const RKSweep *sweep) {
+    if (volume == NULL || volume->header.complete || volume->header.sweepCount == RKMaximumSweepsPerVolume) {
+        return true;
+    }
+    if ((sweep->rays[0]->header.marker | sweep->header.config.startMarker) & RKMarkerVolumeBegin) {
+        return true;
+    }
+    const RKSweep *last = volume->sweeps[volume->header.sweepCount - 1];
+    if (last->header.isPPI != sweep->header.isPPI || last->header.isRHI != sweep->header.isRHI) {
+        return true;
+    }
+    if (sweep->header.isPPI && sweep->header.config.sweepElevation < last->header.config.sweepElevation - 0.05f) {
+        return true;
+    }
+    return false;
+}
+
+#pragma mark - Life Cycle
+
+RKVolumeEngine *RKVolumeEngineInit(void) {
+    RKVolumeEngine *engine = (RKVolumeEngine *)malloc(sizeof(RKVolumeEngine));
+    if (engine == NULL) {
+        RKLog("Error. Unable to allocate a volume engine.\n");
+        return NULL;
+    }
+    memset(engine, 0, sizeof(RKVolumeEngine));
+    sprintf(engine->name, "%s<VolumeEngine>%s",
+            rkGlobalParameters.showColor ? RKGetBackgroundColorOfIndex(RKEngineColorVolumeEngine) : "",
+            rkGlobalParameters.showColor ? RKNoColor : "");
+    engine->depth = RKVolumeEngineDefaultDepth;
+    engine->memoryLimit = RKVolumeEngineDefaultMemoryLimit;
+    engine->volumeId = 1;
+    engine->memoryUsage = sizeof(RKVolumeEngine);
+    pthread_mutex_init(&engine->mutex, NULL);
+    return engine;
+}
+
+void RKVolumeEngineFree(RKVolumeEngine *engine) {
+    int k;
+    pthread_mutex_lock(&engine->mutex);
+    for (k = 0; k < engine->volumeCount; k++) {
+        RKVolumeEngineDropVolume(engine, engine->volumes[k]);
+    }
+    engine->volumeCount = 0;
+    pthread_mutex_unlock(&engine->mutex);
+    pthread_mutex_destroy(&engine->mutex);
+    free(engine);
+}
+
+#pragma mark - Properties
+
+void RKVolumeEngineSetVerbose(RKVolumeEngine *engine, const int verbose) {
+    engine->verbose = verbose;
+}
+
+void RKVolumeEngineSetDepth(RKVolumeEngine *engine, const uint8_t depth) {
+    int k;
+    pthread_mutex_lock(&engine->mutex);
+    engine->depth = MIN(depth, RKVolumeEngineMaximumDepth);
+    if (engine->depth == 0) {
+        for (k = 0; k < engine->volumeCount; k++) {
+            RKVolumeEngineDropVolume(engine, engine->volumes[k]);
+        }
+        engine->volumeCount = 0;
+    }
+    RKVolumeEngineTrim(engine);
+    pthread_mutex_unlock(&engine->mutex);
+}
+
+void RKVolumeEngineSetSweepOwner(RKVolumeEngine *engine, void *owner,
+                                 void (*retainer)(void *, RKSweep *), void (*releaser)(void *, RKSweep *)) {
+    pthread_mutex_lock(&engine->mutex);
+    if (engine->volumeCount) {
+        pthread_mutex_unlock(&engine->mutex);
+        RKLog("%s Error. Sweep owner cannot be changed while sweeps are held.\n", engine->name);
+        return;
+    }
+    engine->sweepOwner = owner;
+    engine->sweepRetainer = retainer;
+    engine->sweepReleaser = releaser;
+    pthread_mutex_unlock(&engine->mutex);
+}
+
+void RKVolumeEngineSetMemoryLimit(RKVolumeEngine *engine, const size_t limit) {
+    pthread_mutex_lock(&engine->mutex);
+    engine->memoryLimit = limit;
+    RKVolumeEngineTrim(engine);
+    pthread_mutex_unlock(&engine->mutex);
+}
+
+#pragma mark - Interactions
+
+// Keep a reference of the sweep, which must own its rays and must not be modified afterwards
+int RKVolumeEngineAddSweep(RKVolumeEngine *engine, RKSweep *sweep) {
+    RKVolume *volume;
+
+    if (sweep == NULL || sweep->header.rayCount == 0) {
+        return RKResultNullInput;
+    }
+    if (engine->depth == 0) {
+        return RKResultSuccess;
+    }
+    if (sweep->header.external) {
+        RKLog("%s Error. Sweep S%lu refers to rays it does not own.\n", engine->name, sweep->header.config.i);
+        return RKResultNullInput;
+    }
+
+    pthread_mutex_lock(&engine->mutex);
+
+    volume = engine->volumeCount ? engine->volumes[engine->volumeCount - 1] : NULL;
+    if (RKVolumeEngineIsNewVolume(volume, sweep)) {
+        if (volume && !volume->header.complete) {
+            volume = RKVolumeEngineCurrentVolumeForUpdate(engine);
+            if (volume) {
+                volume->header.complete = true;
+            }
+        }
+        volume = (RKVolume *)malloc(sizeof(RKVolume));
+        if (volume == NULL) {
+            pthread_mutex_unlock(&engine->mutex);
+            RKLog("%s Error. Unable to allocate a volume.\n", engine->name);
+            return RKResultFailedToAllocateBuffer;
+        }
+        memset(volume, 0, sizeof(RKVolume));
+        volume->header.i = engine->volumeId++;
+        volume->header.startTime = sweep->header.startTime;
+        volume->referenceCount = 1;
+        if (engine->volumeCount == RKVolumeEngineMaximumDepth) {
+            RKVolumeEngineDropVolume(engine, engine->volumes[0]);
+            engine->volumeCount--;
+            memmove(engine->volumes, engine->volumes + 1, engine->volumeCount * sizeof(RKVolume *));
+        }
+        engine->volumes[engine->volumeCount++] = volume;
+    } else {
+        volume = RKVolumeEngineCurrentVolumeForUpdate(engine);
+        if (volume == NULL) {
+            pthread_mutex_unlock(&engine->mutex);
+            return RKResultFailedToAllocateBuffer;
+        }
+    }
+    RKVolumeEngineRetainSweep(engine, sweep);
+    volume->sweeps[volume->header.sweepCount++] = sweep;
+    volume->header.endTime = sweep->header.endTime;
+    volume->memoryUsage += RKVolumeEngineSweepSize(sweep);
+    if (sweep->rays[sweep->header.rayCount - 1]->header.marker & RKMarkerVolumeEnd) {
+        volume->header.complete = true;
+    }
+    engine->sweepCount++;
+
+    // The volume may be let go if it alone is over the memory limit
+    const RKVolumeHeader header = volume->header;
+
+    RKVolumeEngineTrim(engine);
+
+    if (engine->verbose) {
+        RKLog("%s V%lu S%d   E%.2f   %s   %s%s\n", engine->name,
+              header.i, header.sweepCount, sweep->header.config.sweepElevation,
+              RKVariableInString("volumeCount", &engine->volumeCount, RKValueTypeUInt8),
+              RKVariableInString("memoryUsage", &engine->memoryUsage, RKValueTypeSize),
+              header.complete ? "   complete" : "");
+    }
+
+    pthread_mutex_unlock(&engine->mutex);
+    return RKResultSuccess;
+}
+
+// The volume of an age, 0 is the current volume, which may still be receiving sweeps
+RKVolume *RKVolumeEngineAcquireVolume(RKVolumeEngine *engine, const uint8_t age) {
+    RKVolume *volume = NULL;
+    pthread_mutex_lock(&engine->mutex);
+    if (age < engine->volumeCount) {
+        volume = engine->volumes[engine->volumeCount - 1 - age];
+        volume->referenceCount++;
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return volume;
+}
+
+// The latest volume that will not receive any more sweeps
+RKVolume *RKVolumeEngineAcquireCompleteVolume(RKVolumeEngine *engine) {
+    int k;
+    RKVolume *volume = NULL;
+    pthread_mutex_lock(&engine->mutex);
+    for (k = engine->volumeCount - 1; k >= 0; k--) {
+        if (engine->volumes[k]->header.complete) {
+            volume = engine->volumes[k];
+            volume->referenceCount++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return volume;
+}
+
+// The latest volume that started at or before the time
+RKVolume *RKVolumeEngineAcquireVolumeAtTime(RKVolumeEngine *engine, const time_t time) {
+    int k;
+    RKVolume *volume = NULL;
+    pthread_mutex_lock(&engine->mutex);
+    for (k = engine->volumeCount - 1; k >= 0; k--) {
+        if (engine->volumes[k]->header.startTime <= time) {
+            volume = engine->volumes[k];
+            volume->referenceCount++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&engine->mutex);
+    return volume;
+}
+
+int RKVolumeEngineReleaseVolume(RKVolumeEngine *engine, RKVolume *volume) {
+    if (volume == NULL) {
+        return RKResultNullInput;
+    }
+    pthread_mutex_lock(&engine->mutex);
+    if (volume->referenceCount == 0) {
+        pthread_mutex_unlock(&engine->mutex);
+        RKLog("%s Error. Releasing a volume that is not held.\n", engine->name);
+        return RKResultNullInput;
+    }
+    RKVolumeEngineDropVolume(engine, volume);
+    pthread_mutex_unlock(&engine->mutex);
+    return RKResultSuccess;
+}
+
+// The PPI sweep closest to the elevation, the latest one if the elevation was scanned more than once
+RKSweep *RKVolumeGetSweepAtElevation(RKVolume *volume, const float elevation) {
+    int k;
+    float delta, minDelta = INFINITY;
+    RKSweep *sweep = NULL;
+    for (k = 0; k < volume->header.sweepCount; k++) {
+        if (!volume->sweeps[k]->header.isPPI) {
+            continue;
+        }
+        delta = fabsf(volume->sweeps[k]->header.config.sweepElevation - elevation);
+        if (delta <= minDelta) {
+            minDelta = delta;
+            sweep = volume->sweeps[k];
+        }
+    }
+    return sweep;
+}
+
+// The sweep that covers the time, or the one that started closest to it
+RKSweep *RKVolumeGetSweepAtTime(RKVolume *volume, const time_t time) {
+    int k;
+    double delta, minDelta = INFINITY;
+    RKSweep *sweep = NULL;
+    for (k = 0; k < volume->header.sweepCount; k++) {
+        if (volume->sweeps[k]->header.startTime <= time && time <= volume->sweeps[k]->header.endTime) {
+            return volume->sweeps[k];
+        }
+        delta = fabs(difftime(volume->sweeps[k]->header.startTime, time));
+        if (delta < minDelta) {
+            minDelta = delta;
+            sweep = volume->sweeps[k];
+        }
+    }
+    return sweep;
+}